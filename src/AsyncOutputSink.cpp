@@ -0,0 +1,264 @@
+#include "AsyncOutputSink.h"
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+
+namespace
+{
+    // Upper bound on how long a missed wake-up can delay the worker
+    const std::chrono::milliseconds WORKER_WAIT_TIMEOUT(1);
+}
+
+AsyncOutputSink::AsyncOutputSink(IOutputSink& target)
+    : m_target(target)
+    , m_overflowHead(0)
+    , m_pendingDeltaX(0)
+    , m_pendingDeltaY(0)
+    , m_coalescedMoves(0)
+    , m_overflowedEvents(0)
+    , m_overflowHighWater(0)
+    , m_running(false)
+    , m_discard(false)
+    , m_workerExited(false)
+    , m_workerWaiting(false)
+    , m_stopTimeoutMs(DEFAULT_STOP_TIMEOUT_MS)
+    , m_deliveredEvents(0)
+    , m_shortWrites(0)
+    , m_discardedEvents(0)
+{
+    // Reserve up front so the backlog does not allocate under normal bursts
+    m_overflow.reserve(QUEUE_CAPACITY);
+}
+
+AsyncOutputSink::~AsyncOutputSink()
+{
+    if (!Stop())
+    {
+        // Still blocked in the target (a hung window): only process exit follows, do not wait for it
+        m_worker.detach();
+    }
+}
+
+void AsyncOutputSink::Start()
+{
+    if (m_worker.joinable())
+    {
+        return;
+    }
+
+    m_discard.store(false);
+    m_workerExited.store(false);
+    m_running.store(true);
+    m_worker = std::thread(&AsyncOutputSink::WorkerLoop, this);
+}
+
+bool AsyncOutputSink::Stop()
+{
+    if (!m_worker.joinable())
+    {
+        return true;
+    }
+
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(m_stopTimeoutMs);
+
+    // Hand over everything still waiting on the producer side
+    bool drained = DrainBacklog();
+    while (!drained && std::chrono::steady_clock::now() < deadline)
+    {
+        NotifyWorker();
+        std::this_thread::yield();
+        drained = DrainBacklog();
+    }
+    if (!drained)
+    {
+        // The target stopped taking events: drop the backlog rather than hang
+        size_t dropped = m_overflow.size() - m_overflowHead;
+        dropped += (m_pendingDeltaX != 0 || m_pendingDeltaY != 0) ? 1 : 0;
+        m_discardedEvents.fetch_add(dropped, std::memory_order_relaxed);
+        m_overflow.clear();
+        m_overflowHead = 0;
+        m_pendingDeltaX = 0;
+        m_pendingDeltaY = 0;
+    }
+
+    // The worker exits once the queue is empty
+    m_running.store(false);
+    m_wake.notify_one();
+    while (!m_workerExited.load() && std::chrono::steady_clock::now() < deadline)
+    {
+        std::this_thread::sleep_for(WORKER_WAIT_TIMEOUT);
+    }
+
+    if (!m_workerExited.load())
+    {
+        // Out of time: the worker drops what is left as soon as the target returns
+        m_discard.store(true);
+        m_wake.notify_one();
+        return false;
+    }
+
+    m_worker.join();
+    return true;
+}
+
+size_t AsyncOutputSink::Submit(const OutputEvent* events, size_t count)
+{
+    bool backlogClear = DrainBacklog();
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        const OutputEvent& event = events[i];
+
+        if (event.type == OutputEventType::MouseMove)
+        {
+            // Relative motion is additive: merge it and send one move per submission
+            if (m_pendingDeltaX != 0 || m_pendingDeltaY != 0)
+            {
+                ++m_coalescedMoves;
+            }
+            m_pendingDeltaX += event.deltaX;
+            m_pendingDeltaY += event.deltaY;
+            continue;
+        }
+
+        // Edges keep their order: once something waits, everything after it waits too
+        if (!backlogClear || !m_queue.TryPush(event))
+        {
+            backlogClear = false;
+            m_overflow.push_back(event);
+            ++m_overflowedEvents;
+        }
+    }
+
+    size_t waiting = m_overflow.size() - m_overflowHead;
+    if (waiting > m_overflowHighWater)
+    {
+        m_overflowHighWater = waiting;
+    }
+
+    DrainBacklog();
+    NotifyWorker();
+
+    return count;
+}
+
+bool AsyncOutputSink::DrainBacklog()
+{
+    while (m_overflowHead < m_overflow.size())
+    {
+        if (!m_queue.TryPush(m_overflow[m_overflowHead]))
+        {
+            // Under steady back-pressure the list may never empty; drop the
+            // delivered front (no allocation) so it does not grow by what moved on
+            if (m_overflowHead >= m_overflow.size() / 2)
+            {
+                m_overflow.erase(m_overflow.begin(), m_overflow.begin() + static_cast<std::ptrdiff_t>(m_overflowHead));
+                m_overflowHead = 0;
+            }
+            return false;
+        }
+        ++m_overflowHead;
+    }
+
+    // clear() keeps the reserved capacity
+    m_overflow.clear();
+    m_overflowHead = 0;
+
+    if (m_pendingDeltaX != 0 || m_pendingDeltaY != 0)
+    {
+        if (!m_queue.TryPush(OutputEvent::MouseMove(m_pendingDeltaX, m_pendingDeltaY)))
+        {
+            return false;
+        }
+        m_pendingDeltaX = 0;
+        m_pendingDeltaY = 0;
+    }
+
+    return true;
+}
+
+void AsyncOutputSink::NotifyWorker()
+{
+    // Pairs with the fence in WorkerLoop: either we see the worker waiting,
+    // or the worker sees the items we just pushed
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (m_workerWaiting.load(std::memory_order_relaxed))
+    {
+        m_wake.notify_one();
+    }
+}
+
+void AsyncOutputSink::WorkerLoop()
+{
+    OutputEvent batch[WORKER_BATCH];
+    size_t count = 0;   // Events in batch the target has not taken yet
+
+    while (true)
+    {
+        if (m_discard.load())
+        {
+            // Stop() gave up waiting for the target
+            OutputEvent event;
+            while (m_queue.TryPop(event))
+            {
+                ++count;
+            }
+            m_discardedEvents.fetch_add(count, std::memory_order_relaxed);
+            break;
+        }
+
+        // An undelivered suffix goes out again, alone, before anything newer is taken
+        if (count == 0)
+        {
+            while (count < WORKER_BATCH && m_queue.TryPop(batch[count]))
+            {
+                ++count;
+            }
+        }
+
+        if (count > 0)
+        {
+            // May block (SendMessage to a hung window) - only this thread waits
+            size_t delivered = m_target.Submit(batch, count);
+            m_deliveredEvents.fetch_add(delivered, std::memory_order_relaxed);
+            if (delivered >= count)
+            {
+                count = 0;
+                continue;
+            }
+
+            m_shortWrites.fetch_add(1, std::memory_order_relaxed);
+            std::copy(batch + delivered, batch + count, batch);
+            count -= delivered;
+            if (delivered == 0)
+            {
+                // The target takes nothing right now: retry after a pause, or give up when Stop() times out
+                std::unique_lock<std::mutex> lock(m_wakeMutex);
+                m_wake.wait_for(lock, WORKER_WAIT_TIMEOUT, [this]() { return m_discard.load(); });
+            }
+            continue;
+        }
+
+        // Queue is empty: exit if stopping, otherwise wait for the producer.
+        // Stop() pushes the last events before it clears m_running, so look once more.
+        if (!m_running.load())
+        {
+            if (m_queue.IsEmpty())
+            {
+                break;
+            }
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(m_wakeMutex);
+        m_workerWaiting.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        m_wake.wait_for(lock, WORKER_WAIT_TIMEOUT, [this]()
+        {
+            return !m_queue.IsEmpty() || !m_running.load();
+        });
+        m_workerWaiting.store(false, std::memory_order_relaxed);
+    }
+
+    m_workerExited.store(true);
+}
@@ -0,0 +1,148 @@
+#pragma once
+
+#include "IOutputSink.h"
+#include "SpscQueue.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * AsyncOutputSink - Moves output emission onto a dedicated thread
+ *
+ * Submit() only encodes events into a lock-free SPSC queue and returns, so a
+ * slow or hung target window (synchronous SendMessage) can never stall the
+ * input loop. A worker thread drains the queue and hands batches to the real
+ * sink in order.
+ *
+ * Back-pressure when the queue is full:
+ *  - mouse motion is coalesced into one pending delta and sent when room frees up
+ *  - key and mouse button edges are never dropped; they wait, in order, in a
+ *    producer-side overflow list that is drained first on the next Submit()
+ *
+ * The worker hands the target one batch at a time. When the target delivers
+ * only part of it (a short write), the undelivered suffix is sent again before
+ * anything newer is taken from the queue, so no key edge is ever dropped.
+ *
+ * The overflow list reserves QUEUE_CAPACITY edges. A target that falls further
+ * behind than that makes it grow, which allocates on the Submit() thread; the
+ * capacity is kept afterwards, and the drained front is compacted away, so it
+ * only allocates again when the backlog reaches a new high.
+ */
+class AsyncOutputSink : public IOutputSink
+{
+public:
+    static const size_t QUEUE_CAPACITY = 256;
+    static const uint32_t DEFAULT_STOP_TIMEOUT_MS = 500;
+
+    /**
+     * @param target Sink that performs the actual output (used only on the worker thread)
+     */
+    explicit AsyncOutputSink(IOutputSink& target);
+    ~AsyncOutputSink() override;
+
+    AsyncOutputSink(const AsyncOutputSink&) = delete;
+    AsyncOutputSink& operator=(const AsyncOutputSink&) = delete;
+
+    /**
+     * Start the worker thread
+     */
+    void Start();
+
+    /**
+     * Deliver everything still queued, then stop the worker thread
+     * Waits at most the stop timeout. Whatever is still undelivered then is
+     * discarded (see GetDiscardedEventCount()), and a worker still blocked in
+     * the target is left running; calling Stop() again waits for it once more.
+     * @return true if the worker thread has ended
+     */
+    bool Stop();
+
+    /**
+     * Set how long Stop() waits for the target to take what is still queued
+     * @param milliseconds Timeout (default DEFAULT_STOP_TIMEOUT_MS)
+     */
+    void SetStopTimeout(uint32_t milliseconds) { m_stopTimeoutMs = milliseconds; }
+
+    /**
+     * Queue events for the worker thread (producer thread only, never blocks)
+     * @return Number of events accepted (always count; nothing is dropped)
+     */
+    size_t Submit(const OutputEvent* events, size_t count) override;
+
+    /**
+     * Get the number of mouse moves merged into a pending delta because the queue was full
+     */
+    uint64_t GetCoalescedMoveCount() const { return m_coalescedMoves; }
+
+    /**
+     * Get the number of edges that had to wait in the overflow list
+     */
+    uint64_t GetOverflowedEventCount() const { return m_overflowedEvents; }
+
+    /**
+     * Get the number of events the target sink reported delivered
+     */
+    uint64_t GetDeliveredEventCount() const { return m_deliveredEvents.load(std::memory_order_relaxed); }
+
+    /**
+     * Get the number of target Submit() calls that delivered fewer events than they were given
+     */
+    uint64_t GetShortWriteCount() const { return m_shortWrites.load(std::memory_order_relaxed); }
+
+    /**
+     * Get the number of events discarded because Stop() timed out before the target took them
+     */
+    uint64_t GetDiscardedEventCount() const { return m_discardedEvents.load(std::memory_order_relaxed); }
+
+    /**
+     * Get the largest number of edges the overflow list held at once
+     */
+    size_t GetOverflowHighWater() const { return m_overflowHighWater; }
+
+private:
+    static const size_t WORKER_BATCH = 64;
+
+    /**
+     * Push the overflow list and the pending mouse delta into the queue, in order
+     * @return true if nothing is left waiting
+     */
+    bool DrainBacklog();
+
+    /**
+     * Wake the worker if it is waiting for events
+     */
+    void NotifyWorker();
+
+    /**
+     * Worker thread body
+     */
+    void WorkerLoop();
+
+    IOutputSink& m_target;
+    SpscQueue<OutputEvent, QUEUE_CAPACITY> m_queue;
+
+    // Producer-side backlog (touched only by the Submit() thread)
+    std::vector<OutputEvent> m_overflow;
+    size_t m_overflowHead;
+    int32_t m_pendingDeltaX;
+    int32_t m_pendingDeltaY;
+    uint64_t m_coalescedMoves;
+    uint64_t m_overflowedEvents;
+    size_t m_overflowHighWater;
+
+    // Worker thread and its wake-up
+    std::thread m_worker;
+    std::atomic<bool> m_running;
+    std::atomic<bool> m_discard;        // Stop() timed out: drop what is left and exit
+    std::atomic<bool> m_workerExited;
+    std::atomic<bool> m_workerWaiting;
+    uint32_t m_stopTimeoutMs;
+    std::mutex m_wakeMutex;
+    std::condition_variable m_wake;
+    std::atomic<uint64_t> m_deliveredEvents;
+    std::atomic<uint64_t> m_shortWrites;
+    std::atomic<uint64_t> m_discardedEvents;
+};
@@ -0,0 +1,198 @@
+#include "AxisKernel.h"
+#include <cstddef>
+
+#if defined(__AVX2__)
+#define AXIS_KERNEL_AVX2
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define AXIS_KERNEL_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+    const PadState NEUTRAL_PAD = {};
+
+    // The four stick axes follow each other in PadState, so one 64-bit load takes them all
+    static_assert(offsetof(PadState, thumbLY) == offsetof(PadState, thumbLX) + 2 &&
+                  offsetof(PadState, thumbRX) == offsetof(PadState, thumbLX) + 4 &&
+                  offsetof(PadState, thumbRY) == offsetof(PadState, thumbLX) + 6,
+                  "PadState stick layout");
+    static_assert(sizeof(PadAxes) >= 8 && offsetof(PadAxes, rightX) == 4,
+                  "PadAxes stick layout");
+
+    /**
+     * Resolve the caller's pad list to exactly MAX_PADS readable states
+     */
+    void ResolvePads(const PadState* const* pads, int count, const PadState* resolved[AxisKernel::MAX_PADS])
+    {
+        for (int pad = 0; pad < AxisKernel::MAX_PADS; ++pad)
+        {
+            resolved[pad] = (pad < count && pads[pad]) ? pads[pad] : &NEUTRAL_PAD;
+        }
+    }
+
+#if defined(AXIS_KERNEL_SSE2) || defined(AXIS_KERNEL_AVX2)
+    /**
+     * Gather the sticks of four pads: left and right, one 32-bit (x, y) lane per pad
+     */
+    void GatherPads(const PadState* const pads[AxisKernel::MAX_PADS], __m128i& left, __m128i& right)
+    {
+        __m128i sticks[AxisKernel::MAX_PADS];
+        for (int pad = 0; pad < AxisKernel::MAX_PADS; ++pad)
+        {
+            sticks[pad] = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(&pads[pad]->thumbLX));
+        }
+
+        __m128i pads01 = _mm_unpacklo_epi32(sticks[0], sticks[1]);    // L0 L1 R0 R1
+        __m128i pads23 = _mm_unpacklo_epi32(sticks[2], sticks[3]);    // L2 L3 R2 R3
+        left = _mm_unpacklo_epi64(pads01, pads23);
+        right = _mm_unpackhi_epi64(pads01, pads23);
+    }
+
+    /**
+     * Store the shaped sticks into the per-pad outputs
+     */
+    void ScatterPads(__m128i left, __m128i right, PadAxes axes[AxisKernel::MAX_PADS])
+    {
+        __m128i pads01 = _mm_unpacklo_epi32(left, right);   // L0 R0 L1 R1
+        __m128i pads23 = _mm_unpackhi_epi32(left, right);   // L2 R2 L3 R3
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(&axes[0].leftX), pads01);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(&axes[1].leftX), _mm_unpackhi_epi64(pads01, pads01));
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(&axes[2].leftX), pads23);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(&axes[3].leftX), _mm_unpackhi_epi64(pads23, pads23));
+    }
+#endif
+
+#if defined(AXIS_KERNEL_SSE2)
+    /**
+     * Shape four (x, y) pairs: the vector form of StickProcessor::Process
+     *
+     * pmaddwd gives x*x + y*y per pad (bit 31 set only for (-32768, -32768),
+     * which the logical shift reads correctly). The Q16 gain is split into
+     * whole and fractional halves so |v| * gain / 65536 stays exact in
+     * 16-bit lanes: |v| * whole + mulhi(|v|, fraction).
+     */
+    __m128i ShapeSticks(__m128i sticks, const uint32_t* gainTable)
+    {
+        __m128i squared = _mm_madd_epi16(sticks, sticks);
+        __m128i index = _mm_srli_epi32(squared, StickProcessor::INDEX_SHIFT);
+
+        // No gather in SSE2; indices fit in 16 bits, so pextrw reads them without a store
+        __m128i gain = _mm_set_epi32(static_cast<int>(gainTable[_mm_extract_epi16(index, 6)]),
+                                     static_cast<int>(gainTable[_mm_extract_epi16(index, 4)]),
+                                     static_cast<int>(gainTable[_mm_extract_epi16(index, 2)]),
+                                     static_cast<int>(gainTable[_mm_extract_epi16(index, 0)]));
+
+        // Both 16-bit halves of each pad's lane get the same gain
+        __m128i fraction = _mm_and_si128(gain, _mm_set1_epi32(0xFFFF));
+        fraction = _mm_or_si128(fraction, _mm_slli_epi32(fraction, 16));
+        __m128i whole = _mm_srli_epi32(gain, 16);
+        whole = _mm_or_si128(whole, _mm_slli_epi32(whole, 16));
+
+        __m128i sign = _mm_srai_epi16(sticks, 15);
+        __m128i magnitude = _mm_sub_epi16(_mm_xor_si128(sticks, sign), sign);   // -32768 -> 32768 unsigned
+
+        __m128i shaped = _mm_adds_epu16(_mm_mulhi_epu16(magnitude, fraction), _mm_mullo_epi16(magnitude, whole));
+        shaped = _mm_sub_epi16(shaped, _mm_subs_epu16(shaped, _mm_set1_epi16(StickProcessor::OUTPUT_MAX)));
+        return _mm_sub_epi16(_mm_xor_si128(shaped, sign), sign);
+    }
+#endif
+
+#if defined(AXIS_KERNEL_AVX2)
+    /**
+     * Shape both sticks of four pads in one 256-bit pass (same steps as the SSE2 form)
+     * The low half holds the left sticks and uses the left table, the high half the right.
+     */
+    __m256i ShapeSticks(__m256i sticks, const uint32_t* leftTable, const uint32_t* rightTable)
+    {
+        __m256i squared = _mm256_madd_epi16(sticks, sticks);
+        __m256i index = _mm256_srli_epi32(squared, StickProcessor::INDEX_SHIFT);
+
+        __m128i leftGain = _mm_i32gather_epi32(reinterpret_cast<const int*>(leftTable), _mm256_castsi256_si128(index), 4);
+        __m128i rightGain = _mm_i32gather_epi32(reinterpret_cast<const int*>(rightTable), _mm256_extracti128_si256(index, 1), 4);
+        __m256i gain = _mm256_inserti128_si256(_mm256_castsi128_si256(leftGain), rightGain, 1);
+
+        __m256i fraction = _mm256_and_si256(gain, _mm256_set1_epi32(0xFFFF));
+        fraction = _mm256_or_si256(fraction, _mm256_slli_epi32(fraction, 16));
+        __m256i whole = _mm256_srli_epi32(gain, 16);
+        whole = _mm256_or_si256(whole, _mm256_slli_epi32(whole, 16));
+
+        __m256i sign = _mm256_srai_epi16(sticks, 15);
+        __m256i magnitude = _mm256_sub_epi16(_mm256_xor_si256(sticks, sign), sign);
+
+        __m256i shaped = _mm256_adds_epu16(_mm256_mulhi_epu16(magnitude, fraction), _mm256_mullo_epi16(magnitude, whole));
+        shaped = _mm256_sub_epi16(shaped, _mm256_subs_epu16(shaped, _mm256_set1_epi16(StickProcessor::OUTPUT_MAX)));
+        return _mm256_sub_epi16(_mm256_xor_si256(shaped, sign), sign);
+    }
+#endif
+}
+
+AxisKernel::AxisKernel()
+    : m_axes()
+{
+}
+
+void AxisKernel::Configure(const StickSettings& left, const StickSettings& right)
+{
+    m_leftStick.Configure(left);
+    m_rightStick.Configure(right);
+}
+
+void AxisKernel::Run(const PadState* const* pads, int count)
+{
+#if defined(AXIS_KERNEL_AVX2) || defined(AXIS_KERNEL_SSE2)
+    const PadState* resolved[MAX_PADS];
+    ResolvePads(pads, count, resolved);
+
+    __m128i left;
+    __m128i right;
+    GatherPads(resolved, left, right);
+
+#if defined(AXIS_KERNEL_AVX2)
+    __m256i shaped = ShapeSticks(_mm256_inserti128_si256(_mm256_castsi128_si256(left), right, 1),
+                                 m_leftStick.GetGainTable(), m_rightStick.GetGainTable());
+    left = _mm256_castsi256_si128(shaped);
+    right = _mm256_extracti128_si256(shaped, 1);
+#else
+    left = ShapeSticks(left, m_leftStick.GetGainTable());
+    right = ShapeSticks(right, m_rightStick.GetGainTable());
+#endif
+
+    ScatterPads(left, right, m_axes);
+    for (int pad = 0; pad < MAX_PADS; ++pad)
+    {
+        m_axes[pad].leftTrigger = resolved[pad]->leftTrigger;
+        m_axes[pad].rightTrigger = resolved[pad]->rightTrigger;
+    }
+#else
+    RunScalar(pads, count);
+#endif
+}
+
+void AxisKernel::RunScalar(const PadState* const* pads, int count)
+{
+    const PadState* resolved[MAX_PADS];
+    ResolvePads(pads, count, resolved);
+
+    for (int pad = 0; pad < MAX_PADS; ++pad)
+    {
+        const PadState& state = *resolved[pad];
+        PadAxes& axes = m_axes[pad];
+        m_leftStick.Process(state.thumbLX, state.thumbLY, axes.leftX, axes.leftY);
+        m_rightStick.Process(state.thumbRX, state.thumbRY, axes.rightX, axes.rightY);
+        axes.leftTrigger = state.leftTrigger;
+        axes.rightTrigger = state.rightTrigger;
+    }
+}
+
+const char* AxisKernel::GetImplementationName()
+{
+#if defined(AXIS_KERNEL_AVX2)
+    return "AVX2";
+#elif defined(AXIS_KERNEL_SSE2)
+    return "SSE2";
+#else
+    return "scalar";
+#endif
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "PadState.h"
+#include "StickProcessor.h"
+#include <cstdint>
+
+/**
+ * PadAxes - Shaped analog input of one pad, as the mapping stages consume it
+ */
+struct PadAxes
+{
+    int16_t leftX;          // Sticks after dead zones and response curve (-32767 to 32767)
+    int16_t leftY;
+    int16_t rightX;
+    int16_t rightY;
+    uint8_t leftTrigger;    // Raw triggers (0 to 255); the mapper's threshold switches decide
+    uint8_t rightTrigger;
+};
+
+/**
+ * AxisKernel - Shapes the sticks of up to four pads in one pass
+ *
+ * Run() gathers the pads into structure-of-arrays registers, one lane per
+ * pad: all left sticks as (x, y) pairs, then all right sticks. It then
+ * applies the baked StickProcessor tables to every pad at once with SSE2,
+ * or AVX2 when the build enables it (__AVX2__), and stores the per-pad
+ * PadAxes together with the raw triggers. RunScalar() is the portable path; both
+ * produce bit-identical results.
+ *
+ * A missing or disconnected pad is passed as nullptr and reads as neutral,
+ * so the kernel has no per-axis connection checks.
+ */
+class AxisKernel
+{
+public:
+    static const int MAX_PADS = 4;
+
+    AxisKernel();
+
+    /**
+     * Bake the stick tables (profile load, not per frame)
+     * @param left Left stick settings
+     * @param right Right stick settings
+     */
+    void Configure(const StickSettings& left, const StickSettings& right);
+
+    /**
+     * Shape all pads with the vector implementation
+     * @param pads Raw state of each pad, nullptr for a disconnected pad
+     * @param count Number of entries in pads (at most MAX_PADS; the rest read as neutral)
+     */
+    void Run(const PadState* const* pads, int count);
+
+    /**
+     * Shape all pads one value at a time (reference and fallback)
+     */
+    void RunScalar(const PadState* const* pads, int count);
+
+    /**
+     * Get the shaped axes of a pad (valid after Run/RunScalar)
+     */
+    const PadAxes& GetAxes(int pad) const { return m_axes[pad]; }
+
+    /**
+     * Get the name of the implementation Run() uses ("AVX2", "SSE2" or "scalar")
+     */
+    static const char* GetImplementationName();
+
+private:
+    StickProcessor m_leftStick;
+    StickProcessor m_rightStick;
+    PadAxes m_axes[MAX_PADS];
+};
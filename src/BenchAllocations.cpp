@@ -0,0 +1,41 @@
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+/**
+ * Global operator new/delete for GamepadBench that count allocations per thread
+ *
+ * Lets a benchmark check that a hot path allocates nothing. Kept out of
+ * BenchMain.cpp so the replacements are never inlined into their callers.
+ */
+
+namespace
+{
+    thread_local uint64_t t_allocationCount = 0;
+}
+
+uint64_t GetThreadAllocationCount()
+{
+    return t_allocationCount;
+}
+
+void* operator new(std::size_t size)
+{
+    ++t_allocationCount;
+    void* memory = std::malloc(size ? size : 1);
+    if (!memory)
+    {
+        throw std::bad_alloc();
+    }
+    return memory;
+}
+
+void operator delete(void* memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept
+{
+    std::free(memory);
+}
@@ -0,0 +1,4034 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <atomic>
+#include <condition_variable>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "StickProcessor.h"
+#include "AxisKernel.h"
+#include "PadDevice.h"
+#include "Mapper.h"
+#include "IInputSource.h"
+#include "IOutputSink.h"
+#include "AsyncOutputSink.h"
+#include "InjectionStrategy.h"
+#include "DeviceWatcher.h"
+#include "InputPoller.h"
+#include "LatencyHistogram.h"
+#include "OutputBatch.h"
+#include "OutputReconciler.h"
+#include "MonotonicClock.h"
+#include "FrameScheduler.h"
+#include "TimerWheel.h"
+#include "ProfileCompiler.h"
+#include "ProfileCache.h"
+#include "ProfileReloader.h"
+#include "TraceReader.h"
+#ifdef __linux__
+#include "EvdevInputSource.h"
+#include "InputCodes.h"
+#include "UinputOutputSink.h"
+#include <cerrno>
+#include <fcntl.h>
+#include <linux/input.h>
+#include <unistd.h>
+#endif
+
+// Shipped profiles (set by CMake to the source tree's profiles directory)
+#ifndef GAMEPADMAPPER_PROFILE_DIR
+#define GAMEPADMAPPER_PROFILE_DIR "profiles"
+#endif
+
+// Allocations made by the calling thread so far (BenchAllocations.cpp replaces operator new)
+uint64_t GetThreadAllocationCount();
+
+namespace
+{
+    const size_t SAMPLE_COUNT = 4096;
+
+    struct StickSample
+    {
+        int16_t x;
+        int16_t y;
+    };
+
+    /**
+     * Print one check of a section ("  name: ok (detail)" or "  name: FAILED (detail)")
+     * @param passed Result of the section, cleared if the check fails
+     * @return ok
+     */
+    bool Check(bool& passed, const std::string& name, bool ok, const std::string& detail = std::string())
+    {
+        passed = passed && ok;
+        std::cout << "  " << name << ": " << (ok ? "ok" : "FAILED") << (detail.empty() ? "" : " (" + detail + ")") << std::endl;
+        return ok;
+    }
+
+    /**
+     * Check a text result (an event timeline) against the expected text; both are shown on a mismatch
+     * @return true if they are equal
+     */
+    bool Expect(bool& passed, const std::string& name, const std::string& actual, const std::string& expected)
+    {
+        bool ok = (actual == expected);
+        return Check(passed, name, ok, ok ? actual : "got \"" + actual + "\", expected \"" + expected + "\"");
+    }
+
+    /**
+     * Printable key code: the letter or digit itself, else hex
+     */
+    std::string KeyName(uint16_t code)
+    {
+        if ((code >= '0' && code <= '9') || (code >= 'A' && code <= 'Z'))
+        {
+            return std::string(1, static_cast<char>(code));
+        }
+        char hex[8];
+        std::snprintf(hex, sizeof(hex), "0x%02X", code);
+        return hex;
+    }
+
+    /**
+     * Render output events as text: "Q+" / "Q-" for keys, "M0+" / "M0-" for mouse buttons,
+     * "move(dx,dy)" for motion, separated by spaces
+     */
+    std::string EventText(const OutputEvent* events, size_t count)
+    {
+        std::string text;
+        for (size_t i = 0; i < count; ++i)
+        {
+            const OutputEvent& event = events[i];
+            std::string item;
+            switch (event.type)
+            {
+            case OutputEventType::KeyDown:
+            case OutputEventType::KeyUp:
+                item = KeyName(event.code) + ((event.type == OutputEventType::KeyDown) ? "+" : "-");
+                break;
+            case OutputEventType::MouseButtonDown:
+            case OutputEventType::MouseButtonUp:
+                item = "M" + std::to_string(event.code) + ((event.type == OutputEventType::MouseButtonDown) ? "+" : "-");
+                break;
+            case OutputEventType::MouseMove:
+                item = "move(" + std::to_string(event.deltaX) + "," + std::to_string(event.deltaY) + ")";
+                break;
+            }
+            text += (text.empty() ? "" : " ") + item;
+        }
+        return text;
+    }
+
+    /**
+     * Keys and mouse buttons held, or that a profile can ever hold
+     */
+    struct OutputSet
+    {
+        bool keys[256];
+        uint8_t mouseButtons;   // Bit n = mouse button n
+    };
+
+    /**
+     * Output sink of every section: tracks what is held and counts events, and
+     * optionally keeps each event with the submission it came in and its time
+     */
+    class RecordingOutputSink : public IOutputSink
+    {
+    public:
+        /**
+         * @param keepEvents Keep the events and submissions (allocates); without, only
+         *                   the held set and the counters are kept
+         */
+        explicit RecordingOutputSink(bool keepEvents = true)
+            : m_keepEvents(keepEvents)
+            , m_clock(nullptr)
+            , m_acceptLimit(SIZE_MAX)
+            , m_held()
+            , m_submitCount(0)
+            , m_keyEventCount(0)
+            , m_downCount(0)
+            , m_upCount(0)
+            , m_motionX(0)
+            , m_motionY(0)
+        {
+        }
+
+        /**
+         * Stamp each submission with the time of a clock (for timelines)
+         */
+        void SetClock(const IMonotonicClock* clock) { m_clock = clock; }
+
+        /**
+         * Deliver at most this many events per Submit(), like a short write
+         */
+        void SetAcceptLimit(size_t limit) { m_acceptLimit = limit; }
+
+        /**
+         * Call a function with the events of every Submit() before they are recorded, on the
+         * submitting thread (to stall like a hung window, or to time the events)
+         */
+        void SetSubmitHook(std::function<void(const OutputEvent*, size_t)> hook) { m_hook = std::move(hook); }
+
+        size_t Submit(const OutputEvent* events, size_t count) override
+        {
+            if (m_hook)
+            {
+                m_hook(events, count);
+            }
+
+            size_t accepted = std::min(count, m_acceptLimit);
+            ++m_submitCount;
+            for (size_t i = 0; i < accepted; ++i)
+            {
+                const OutputEvent& event = events[i];
+                switch (event.type)
+                {
+                case OutputEventType::KeyDown: m_held.keys[event.code & 0xFF] = true; ++m_keyEventCount; ++m_downCount; break;
+                case OutputEventType::KeyUp: m_held.keys[event.code & 0xFF] = false; ++m_keyEventCount; ++m_upCount; break;
+                case OutputEventType::MouseButtonDown: m_held.mouseButtons |= static_cast<uint8_t>(1u << (event.code & 7)); ++m_downCount; break;
+                case OutputEventType::MouseButtonUp: m_held.mouseButtons &= static_cast<uint8_t>(~(1u << (event.code & 7))); ++m_upCount; break;
+                case OutputEventType::MouseMove: m_motionX += event.deltaX; m_motionY += event.deltaY; break;
+                }
+            }
+
+            if (m_keepEvents)
+            {
+                Submission submission = { m_events.size(), accepted, m_clock ? m_clock->NowNanoseconds() : 0 };
+                m_submissions.push_back(submission);
+                m_events.insert(m_events.end(), events, events + accepted);
+            }
+            return accepted;
+        }
+
+        /**
+         * Get every delivered event, in order (kept events only)
+         */
+        const std::vector<OutputEvent>& GetEvents() const { return m_events; }
+
+        /**
+         * Get the number of Submit() calls
+         */
+        uint64_t GetSubmitCount() const { return m_submitCount; }
+
+        /**
+         * Get the events delivered by one Submit() call (kept events only)
+         */
+        const OutputEvent* GetSubmission(size_t index, size_t& count) const
+        {
+            count = m_submissions[index].count;
+            return m_events.data() + m_submissions[index].first;
+        }
+
+        /**
+         * Get one submission as text (see EventText())
+         */
+        std::string GetSubmissionText(size_t index) const
+        {
+            size_t count;
+            const OutputEvent* events = GetSubmission(index, count);
+            return EventText(events, count);
+        }
+
+        /**
+         * Get every submission as text, separated by " | "
+         */
+        std::string GetText() const
+        {
+            std::string text;
+            for (size_t i = 0; i < m_submissions.size(); ++i)
+            {
+                text += (i == 0 ? "" : " | ") + GetSubmissionText(i);
+            }
+            return text;
+        }
+
+        /**
+         * Get the key and mouse button events as "ms:Q+" / "ms:M0-" on the clock set with
+         * SetClock(), submissions separated by " | " (motion left out)
+         */
+        std::string GetTimeline() const
+        {
+            std::string timeline;
+            for (const Submission& submission : m_submissions)
+            {
+                std::string batch;
+                for (size_t i = submission.first; i < submission.first + submission.count; ++i)
+                {
+                    const OutputEvent& event = m_events[i];
+                    if (event.type == OutputEventType::MouseMove)
+                    {
+                        continue;
+                    }
+                    bool down = (event.type == OutputEventType::KeyDown || event.type == OutputEventType::MouseButtonDown);
+                    bool key = (event.type == OutputEventType::KeyDown || event.type == OutputEventType::KeyUp);
+                    batch += " " + std::to_string(submission.timeNs / 1000000ULL) + ":" +
+                             (key ? KeyName(event.code) : "M" + std::to_string(event.code)) + (down ? "+" : "-");
+                }
+                timeline += batch.empty() ? "" : (timeline.empty() ? batch.substr(1) : " |" + batch);
+            }
+            return timeline;
+        }
+
+        /**
+         * Check that two sinks received the same events (kept events only)
+         */
+        bool Matches(const RecordingOutputSink& other) const
+        {
+            if (m_events.size() != other.m_events.size())
+            {
+                return false;
+            }
+            for (size_t i = 0; i < m_events.size(); ++i)
+            {
+                const OutputEvent& a = m_events[i];
+                const OutputEvent& b = other.m_events[i];
+                if (a.type != b.type || a.code != b.code || a.deltaX != b.deltaX || a.deltaY != b.deltaY)
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        /**
+         * Check that everything held down belongs to a set
+         */
+        bool HoldsOnly(const OutputSet& allowed) const
+        {
+            for (int key = 0; key < 256; ++key)
+            {
+                if (m_held.keys[key] && !allowed.keys[key])
+                {
+                    return false;
+                }
+            }
+            return (m_held.mouseButtons & ~allowed.mouseButtons) == 0;
+        }
+
+        bool HoldsAnything() const
+        {
+            OutputSet none = {};
+            return !HoldsOnly(none);
+        }
+
+        uint64_t GetKeyEventCount() const { return m_keyEventCount; }
+        uint64_t GetDownCount() const { return m_downCount; }
+        uint64_t GetUpCount() const { return m_upCount; }
+        int64_t GetMotionX() const { return m_motionX; }
+        int64_t GetMotionY() const { return m_motionY; }
+
+    private:
+        struct Submission
+        {
+            size_t first;       // Index of its first event in m_events
+            size_t count;
+            uint64_t timeNs;
+        };
+
+        bool m_keepEvents;
+        const IMonotonicClock* m_clock;
+        size_t m_acceptLimit;
+        std::function<void(const OutputEvent*, size_t)> m_hook;
+
+        OutputSet m_held;
+        uint64_t m_submitCount;
+        uint64_t m_keyEventCount;
+        uint64_t m_downCount;
+        uint64_t m_upCount;
+        int64_t m_motionX;
+        int64_t m_motionY;
+
+        std::vector<OutputEvent> m_events;
+        std::vector<Submission> m_submissions;
+    };
+
+    /**
+     * Deterministic stick positions covering the whole square range
+     */
+    std::vector<StickSample> MakeSamples()
+    {
+        std::vector<StickSample> samples(SAMPLE_COUNT);
+        uint32_t seed = 12345;
+        for (StickSample& sample : samples)
+        {
+            seed = seed * 1103515245u + 12345u;
+            sample.x = static_cast<int16_t>(seed >> 16);
+            seed = seed * 1103515245u + 12345u;
+            sample.y = static_cast<int16_t>(seed >> 16);
+        }
+        return samples;
+    }
+
+    /**
+     * The mapper's stick path before StickProcessor: square per-axis dead zone
+     * without rescaling, then a float multiply per axis
+     */
+    int16_t LegacyDeadZone(int16_t value)
+    {
+        const int16_t deadZone = 7849;
+        if (value > deadZone)
+        {
+            return static_cast<int16_t>(value - deadZone);
+        }
+        else if (value < -deadZone)
+        {
+            return static_cast<int16_t>(value + deadZone);
+        }
+        return 0;
+    }
+
+    /**
+     * Run a stick kernel over the samples and report ns per stick
+     */
+    template <typename Kernel>
+    void TimeKernel(const char* name, const std::vector<StickSample>& samples, uint32_t iterations, Kernel kernel)
+    {
+        int64_t checksum = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < iterations; ++i)
+        {
+            for (const StickSample& sample : samples)
+            {
+                checksum += kernel(sample);
+            }
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        double sticks = static_cast<double>(iterations) * static_cast<double>(samples.size());
+
+        std::cout << "  " << name << ": " << (seconds * 1e9 / sticks) << " ns/stick"
+                  << " (checksum " << checksum << ")" << std::endl;
+    }
+
+    StickSettings MakeCurve(ResponseCurve curve, float exponent)
+    {
+        StickSettings settings = StickSettings::Default();
+        settings.curve = curve;
+        settings.exponent = exponent;
+        if (curve == ResponseCurve::Custom)
+        {
+            // Slow first half for aiming, fast second half for turning
+            settings.outerDeadZone = 31000;
+            settings.pointCount = 2;
+            settings.pointsX[0] = 0.5f;
+            settings.pointsY[0] = 0.2f;
+            settings.pointsX[1] = 0.8f;
+            settings.pointsY[1] = 0.6f;
+        }
+        return settings;
+    }
+
+    /**
+     * Compare the baked table against the float reference over a grid of stick positions
+     * @return Largest per-axis error in output units
+     */
+    double MeasureAccuracy(const StickSettings& settings, double& meanError)
+    {
+        StickProcessor processor;
+        processor.Configure(settings);
+
+        double maxError = 0.0;
+        double totalError = 0.0;
+        uint64_t count = 0;
+        for (int32_t x = -32768; x <= 32767; x += 97)
+        {
+            for (int32_t y = -32768; y <= 32767; y += 89)
+            {
+                int16_t outX;
+                int16_t outY;
+                float refX;
+                float refY;
+                processor.Process(static_cast<int16_t>(x), static_cast<int16_t>(y), outX, outY);
+                StickProcessor::ProcessReference(settings, static_cast<int16_t>(x), static_cast<int16_t>(y), refX, refY);
+
+                double errorX = std::fabs(outX - refX);
+                double errorY = std::fabs(outY - refY);
+                maxError = (errorX > maxError) ? errorX : maxError;
+                maxError = (errorY > maxError) ? errorY : maxError;
+                totalError += errorX + errorY;
+                count += 2;
+            }
+        }
+        meanError = totalError / static_cast<double>(count);
+        return maxError;
+    }
+
+    /**
+     * Stick shaping: legacy float path vs. baked table vs. float reference, plus table accuracy
+     * @return false if a table deviates from its reference curve by more than the tolerance
+     */
+    bool BenchSticks(uint32_t iterations)
+    {
+        std::vector<StickSample> samples = MakeSamples();
+
+        StickProcessor processor;
+        processor.Configure(MakeCurve(ResponseCurve::Power, 2.0f));
+        StickSettings reference = processor.GetSettings();
+
+        std::cout << "Stick shaping (" << iterations << " x " << samples.size() << " sticks):" << std::endl;
+        TimeKernel("legacy square dead zone + float scale", samples, iterations, [](const StickSample& s)
+        {
+            const float sensitivity = 0.0015f;
+            return static_cast<int>(LegacyDeadZone(s.x) * sensitivity) + static_cast<int>(-LegacyDeadZone(s.y) * sensitivity);
+        });
+        TimeKernel("baked radial table (power 2)", samples, iterations, [&processor](const StickSample& s)
+        {
+            int16_t x;
+            int16_t y;
+            processor.Process(s.x, s.y, x, y);
+            return x + y;
+        });
+        TimeKernel("float reference (sqrt + pow)", samples, iterations, [&reference](const StickSample& s)
+        {
+            float x;
+            float y;
+            StickProcessor::ProcessReference(reference, s.x, s.y, x, y);
+            return static_cast<int>(x) + static_cast<int>(y);
+        });
+
+        // A bucket is ~33 raw units wide at the dead zone; allow 0.25% of full scale.
+        // Exponents below 1 have an unbounded slope at the dead zone, which no
+        // table of this size follows within one bucket, so they are not checked.
+        const double tolerance = StickProcessor::OUTPUT_MAX * 0.0025;
+        const struct { const char* name; ResponseCurve curve; float exponent; bool checked; } curves[] =
+        {
+            { "linear", ResponseCurve::Linear, 1.0f, true },
+            { "power 2", ResponseCurve::Power, 2.0f, true },
+            { "power 0.5", ResponseCurve::Power, 0.5f, false },
+            { "s-curve 2", ResponseCurve::SCurve, 2.0f, true },
+            { "custom 3-segment", ResponseCurve::Custom, 1.0f, true },
+        };
+
+        bool passed = true;
+        std::cout << "Table accuracy vs. reference curve (max / mean error, output units of 32767):" << std::endl;
+        for (const auto& entry : curves)
+        {
+            double meanError = 0.0;
+            double maxError = MeasureAccuracy(MakeCurve(entry.curve, entry.exponent), meanError);
+            bool ok = !entry.checked || maxError <= tolerance;
+            passed = passed && ok;
+            std::cout << "  " << entry.name << ": " << maxError << " / " << meanError
+                      << (ok ? (entry.checked ? "" : "  (not checked)") : "  FAILED") << std::endl;
+        }
+        return passed;
+    }
+
+    /**
+     * Pad state with every stick and trigger value random, the extremes included
+     */
+    PadSnapshot MakeRandomPad(uint32_t& seed, uint32_t packet)
+    {
+        int16_t values[6];
+        for (int16_t& value : values)
+        {
+            seed = seed * 1103515245u + 12345u;
+            uint32_t pick = seed >> 16;
+            value = (pick % 17 == 0) ? -32768 : static_cast<int16_t>(pick);
+        }
+
+        PadSnapshot snapshot = {};
+        snapshot.packetNumber = packet;
+        snapshot.connected = (packet % 11 == 0) ? 0 : 1;
+        snapshot.pad.thumbLX = values[0];
+        snapshot.pad.thumbLY = values[1];
+        snapshot.pad.thumbRX = values[2];
+        snapshot.pad.thumbRY = values[3];
+        snapshot.pad.leftTrigger = static_cast<uint8_t>(values[4]);
+        snapshot.pad.rightTrigger = static_cast<uint8_t>(values[5]);
+        return snapshot;
+    }
+
+    /**
+     * Four pads: per-getter scalar shaping (what each Mapper does alone) vs. one AxisKernel pass
+     * @return false if the kernel output differs from the per-getter path
+     */
+    bool BenchPads(uint32_t iterations)
+    {
+        const int pads = AxisKernel::MAX_PADS;
+        const size_t frames = 1024;
+
+        StickSettings left = StickSettings::Default();
+        StickSettings right = MakeCurve(ResponseCurve::SCurve, 2.0f);
+        StickProcessor leftStick;
+        StickProcessor rightStick;
+        leftStick.Configure(left);
+        rightStick.Configure(right);
+        AxisKernel kernel;
+        kernel.Configure(left, right);
+
+        // Pre-generated frames of four pad states each
+        std::vector<PadSnapshot> states(frames * pads);
+        uint32_t seed = 777;
+        for (size_t i = 0; i < states.size(); ++i)
+        {
+            states[i] = MakeRandomPad(seed, static_cast<uint32_t>(i + 1));
+        }
+        PadDevice devices[pads];
+
+        // Correctness first: every frame, every pad, both kernel paths
+        bool passed = true;
+        size_t mismatches = 0;
+        for (size_t frame = 0; frame < frames; ++frame)
+        {
+            const PadState* padStates[pads];
+            for (int pad = 0; pad < pads; ++pad)
+            {
+                devices[pad].ApplySnapshot(states[frame * pads + pad]);
+                padStates[pad] = devices[pad].IsConnected() ? &devices[pad].GetState() : nullptr;
+            }
+            kernel.Run(padStates, pads);
+            PadAxes vectorAxes[pads];
+            for (int pad = 0; pad < pads; ++pad)
+            {
+                vectorAxes[pad] = kernel.GetAxes(pad);
+            }
+            kernel.RunScalar(padStates, pads);
+
+            for (int pad = 0; pad < pads; ++pad)
+            {
+                const PadDevice& device = devices[pad];
+                PadAxes expected = {};
+                leftStick.Process(device.GetLeftStickX(), device.GetLeftStickY(), expected.leftX, expected.leftY);
+                rightStick.Process(device.GetRightStickX(), device.GetRightStickY(), expected.rightX, expected.rightY);
+                expected.leftTrigger = device.GetLeftTrigger();
+                expected.rightTrigger = device.GetRightTrigger();
+
+                const PadAxes* results[] = { &vectorAxes[pad], &kernel.GetAxes(pad) };
+                for (const PadAxes* actual : results)
+                {
+                    if (actual->leftX != expected.leftX || actual->leftY != expected.leftY ||
+                        actual->rightX != expected.rightX || actual->rightY != expected.rightY ||
+                        actual->leftTrigger != expected.leftTrigger || actual->rightTrigger != expected.rightTrigger)
+                    {
+                        ++mismatches;
+                    }
+                }
+            }
+        }
+        passed = (mismatches == 0);
+
+        std::cout << "Pad axes, " << pads << " pads (" << iterations << " x " << frames << " frames, kernel: "
+                  << AxisKernel::GetImplementationName() << "):" << std::endl;
+
+        auto timeFrames = [&](const char* name, auto shapeFrame)
+        {
+            int64_t checksum = 0;
+            auto start = std::chrono::steady_clock::now();
+            for (uint32_t i = 0; i < iterations; ++i)
+            {
+                for (size_t frame = 0; frame < frames; ++frame)
+                {
+                    checksum += shapeFrame(&states[frame * pads]);
+                }
+            }
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            double total = static_cast<double>(iterations) * static_cast<double>(frames);
+            std::cout << "  " << name << ": " << (seconds * 1e9 / total) << " ns/frame"
+                      << " (checksum " << checksum << ")" << std::endl;
+        };
+
+        timeFrames("per-getter scalar", [&](const PadSnapshot* frame)
+        {
+            int64_t sum = 0;
+            for (int pad = 0; pad < pads; ++pad)
+            {
+                devices[pad].ApplySnapshot(frame[pad]);
+                const PadDevice& device = devices[pad];
+                int16_t lx, ly, rx, ry;
+                leftStick.Process(device.GetLeftStickX(), device.GetLeftStickY(), lx, ly);
+                rightStick.Process(device.GetRightStickX(), device.GetRightStickY(), rx, ry);
+                sum += lx + ly + rx + ry + device.GetLeftTrigger() + device.GetRightTrigger();
+            }
+            return sum;
+        });
+        timeFrames("AxisKernel::RunScalar", [&](const PadSnapshot* frame)
+        {
+            const PadState* padStates[pads];
+            for (int pad = 0; pad < pads; ++pad)
+            {
+                devices[pad].ApplySnapshot(frame[pad]);
+                padStates[pad] = devices[pad].IsConnected() ? &devices[pad].GetState() : nullptr;
+            }
+            kernel.RunScalar(padStates, pads);
+            int64_t sum = 0;
+            for (int pad = 0; pad < pads; ++pad)
+            {
+                const PadAxes& axes = kernel.GetAxes(pad);
+                sum += axes.leftX + axes.leftY + axes.rightX + axes.rightY + axes.leftTrigger + axes.rightTrigger;
+            }
+            return sum;
+        });
+        timeFrames("AxisKernel::Run", [&](const PadSnapshot* frame)
+        {
+            const PadState* padStates[pads];
+            for (int pad = 0; pad < pads; ++pad)
+            {
+                devices[pad].ApplySnapshot(frame[pad]);
+                padStates[pad] = devices[pad].IsConnected() ? &devices[pad].GetState() : nullptr;
+            }
+            kernel.Run(padStates, pads);
+            int64_t sum = 0;
+            for (int pad = 0; pad < pads; ++pad)
+            {
+                const PadAxes& axes = kernel.GetAxes(pad);
+                sum += axes.leftX + axes.leftY + axes.rightX + axes.rightY + axes.leftTrigger + axes.rightTrigger;
+            }
+            return sum;
+        });
+
+        std::cout << "  kernel vs. per-getter mismatches: " << mismatches << (passed ? "" : "  FAILED") << std::endl;
+        return passed;
+    }
+
+    /**
+     * Noisy synthetic trace at 1 kHz: the left stick and left trigger rest on their
+     * press thresholds (first quarter light noise, second quarter noise wider than
+     * the hysteresis band), then both sweep slowly across them and back (real
+     * transitions, light noise), while the right trigger is pulled once a second
+     */
+    std::vector<PadSnapshot> MakeNoisyTrace(uint32_t seconds)
+    {
+        const uint64_t periodNs = 1000000;      // 1 ms
+        const uint32_t samples = seconds * 1000;
+
+        // Raw stick value at which the shaped axis reaches the press threshold
+        StickSettings stick = StickSettings::Default();
+        ThresholdSettings stickKeys = ThresholdSettings::DefaultStick();
+        double stickCenter = stick.innerDeadZone +
+            static_cast<double>(stickKeys.pressThreshold) * (stick.outerDeadZone - stick.innerDeadZone) / StickProcessor::OUTPUT_MAX;
+        double triggerCenter = ThresholdSettings::DefaultTrigger().pressThreshold;
+
+        std::vector<PadSnapshot> trace(samples);
+        uint32_t seed = 4242;
+        auto noise = [&seed](int amplitude)
+        {
+            seed = seed * 1103515245u + 12345u;
+            return static_cast<int>((seed >> 16) % (2 * amplitude + 1)) - amplitude;
+        };
+
+        for (uint32_t i = 0; i < samples; ++i)
+        {
+            // First half resting, second half a slow sweep of +-40% around the threshold
+            double phase = static_cast<double>(i) / samples;
+            double sweep = (phase < 0.5) ? 0.0 : std::sin((phase - 0.5) * 4.0 * 3.14159265358979);
+            int stickNoise = (phase >= 0.25 && phase < 0.5) ? 2000 : 600;
+            int triggerNoise = (phase >= 0.25 && phase < 0.5) ? 40 : 12;
+
+            PadSnapshot& snapshot = trace[i];
+            snapshot.timestampNs = (i + 1) * periodNs;
+            snapshot.packetNumber = i + 1;
+            snapshot.connected = 1;
+            snapshot.pad.thumbLY = static_cast<int16_t>(stickCenter * (1.0 + 0.4 * sweep) + noise(stickNoise));
+            snapshot.pad.thumbLX = static_cast<int16_t>(noise(600));
+            snapshot.pad.leftTrigger = static_cast<uint8_t>(triggerCenter * (1.0 + 0.4 * sweep) + noise(triggerNoise));
+            snapshot.pad.rightTrigger = static_cast<uint8_t>((i / 500) % 2 == 0 ? noise(5) + 5 : 250 + noise(5));
+        }
+        return trace;
+    }
+
+    struct ChatterResult
+    {
+        uint64_t keyEvents;
+        uint64_t batches;
+        unsigned long long suppressed;
+    };
+
+    /**
+     * Replay a trace through a Mapper with the given thresholds
+     */
+    ChatterResult ReplayThroughMapper(const std::vector<PadSnapshot>& trace, const ThresholdSettings& stick, const ThresholdSettings& trigger)
+    {
+        RecordingOutputSink sink(false);
+        PadDevice pad;
+        Mapper mapper;
+        mapper.Initialize(&pad, &sink);
+        mapper.SetThresholdSettings(stick, trigger);
+
+        for (const PadSnapshot& snapshot : trace)
+        {
+            pad.ApplySnapshot(snapshot);
+            mapper.Update(snapshot.timestampNs);
+        }
+        mapper.ReleaseAllOutputs();
+
+        ChatterResult result = { sink.GetKeyEventCount(), sink.GetSubmitCount(), mapper.GetSuppressedTransitionCount() };
+        return result;
+    }
+
+    /**
+     * Key event rate of noisy analog input with a single threshold vs. hysteresis
+     * @return false if hysteresis does not cut the event rate or loses the real presses
+     */
+    bool BenchChatter()
+    {
+        const uint32_t seconds = 20;
+        std::vector<PadSnapshot> trace = MakeNoisyTrace(seconds);
+
+        ThresholdSettings plainStick = ThresholdSettings::DefaultStick();
+        plainStick.releaseThreshold = plainStick.pressThreshold;
+        ThresholdSettings plainTrigger = ThresholdSettings::DefaultTrigger();
+        plainTrigger.releaseThreshold = plainTrigger.pressThreshold;
+
+        ThresholdSettings heldStick = ThresholdSettings::DefaultStick();
+        heldStick.minHoldNs = 30000000;     // 30 ms
+        ThresholdSettings heldTrigger = ThresholdSettings::DefaultTrigger();
+        heldTrigger.minHoldNs = 30000000;
+
+        ChatterResult plain = ReplayThroughMapper(trace, plainStick, plainTrigger);
+        ChatterResult hysteresis = ReplayThroughMapper(trace, ThresholdSettings::DefaultStick(), ThresholdSettings::DefaultTrigger());
+        ChatterResult held = ReplayThroughMapper(trace, heldStick, heldTrigger);
+
+        std::cout << "Threshold chatter (" << seconds << " s noisy trace at 1 kHz, key events per second):" << std::endl;
+        auto report = [seconds](const char* name, const ChatterResult& result)
+        {
+            std::cout << "  " << name << ": " << (static_cast<double>(result.keyEvents) / seconds) << " key events/s, "
+                      << result.batches << " batches, " << result.suppressed << " suppressed transitions" << std::endl;
+        };
+        report("single threshold", plain);
+        report("hysteresis", hysteresis);
+        report("hysteresis + 30 ms hold", held);
+
+        // The right-trigger pulls (one per second) are real presses: each must still
+        // produce a key down and up
+        const uint64_t realTransitions = 2 * seconds;
+        bool passed = hysteresis.keyEvents < plain.keyEvents && held.keyEvents <= hysteresis.keyEvents &&
+                      held.keyEvents >= realTransitions;
+        if (!passed)
+        {
+            std::cout << "  FAILED: hysteresis did not reduce the event rate, or dropped real presses" << std::endl;
+        }
+        return passed;
+    }
+
+    /**
+     * Key and mouse button events of one dispatched frame, in a fixed array
+     */
+    struct DispatchLog
+    {
+        enum Kind : uint8_t { KeyDown, KeyUp, MouseDown, MouseUp };
+
+        static const int CAPACITY = 64;
+        uint32_t events[CAPACITY];     // Kind << 16 | code
+        int count;
+
+        void Add(Kind kind, uint16_t code)
+        {
+            if (count < CAPACITY)
+            {
+                events[count++] = (static_cast<uint32_t>(kind) << 16) | code;
+            }
+        }
+    };
+
+    /**
+     * The Witcher button bindings before BindingTable: one hand-written branch per
+     * button, each testing its own press and release edge (sequences tap on press)
+     */
+    void LegacyDispatch(uint16_t previous, uint16_t current, DispatchLog& log)
+    {
+        auto pressed = [previous, current](uint16_t button) { return (current & button) && !(previous & button); };
+        auto released = [previous, current](uint16_t button) { return !(current & button) && (previous & button); };
+        auto key = [&](uint16_t button, uint16_t keyCode)
+        {
+            if (pressed(button))
+            {
+                log.Add(DispatchLog::KeyDown, keyCode);
+            }
+            else if (released(button))
+            {
+                log.Add(DispatchLog::KeyUp, keyCode);
+            }
+        };
+        auto mouse = [&](uint16_t button, uint16_t mouseButton)
+        {
+            if (pressed(button))
+            {
+                log.Add(DispatchLog::MouseDown, mouseButton);
+            }
+            else if (released(button))
+            {
+                log.Add(DispatchLog::MouseUp, mouseButton);
+            }
+        };
+        auto taps = [&](uint16_t button, uint16_t first, uint16_t second)
+        {
+            if (pressed(button))
+            {
+                log.Add(DispatchLog::KeyDown, first);
+                log.Add(DispatchLog::KeyUp, first);
+                log.Add(DispatchLog::KeyDown, second);
+                log.Add(DispatchLog::KeyUp, second);
+            }
+        };
+
+        key(PadButton::A, KeyCode::Space);
+        key(PadButton::B, KeyCode::Escape);
+        mouse(PadButton::X, MouseButton::Left);
+        mouse(PadButton::Y, MouseButton::Right);
+        key(PadButton::RightThumb, KeyCode::Tab);
+        taps(PadButton::LeftShoulder, '1', '6');
+        taps(PadButton::RightShoulder, '2', '7');
+        key(PadButton::DPadUp, KeyCode::Minus);
+        key(PadButton::DPadDown, KeyCode::Equals);
+        key(PadButton::DPadLeft, KeyCode::LeftBracket);
+        key(PadButton::DPadRight, KeyCode::RightBracket);
+        key(PadButton::Start, 'H');
+        key(PadButton::Back, 'I');
+    }
+
+    /**
+     * The same bindings through a BindingTable: only the changed bits of the bound masks are visited
+     */
+    void TableDispatch(const BindingTable& bindings, uint16_t previous, uint16_t current, DispatchLog& log)
+    {
+        uint32_t changed = static_cast<uint32_t>(previous ^ current);
+        for (uint32_t held = changed & bindings.GetHeldMask(); held; held &= held - 1)
+        {
+            int bit = BindingTable::LowestSetBit(held);
+            const BindingAction& action = bindings.GetAction(bit);
+            bool down = (current & (1u << bit)) != 0;
+            if (action.type == BindingActionType::Key)
+            {
+                log.Add(down ? DispatchLog::KeyDown : DispatchLog::KeyUp, action.codes[0]);
+            }
+            else
+            {
+                log.Add(down ? DispatchLog::MouseDown : DispatchLog::MouseUp, action.codes[0]);
+            }
+        }
+        for (uint32_t pressed = changed & current & bindings.GetSequenceMask(); pressed; pressed &= pressed - 1)
+        {
+            const BindingAction& action = bindings.GetAction(BindingTable::LowestSetBit(pressed));
+            for (int i = 0; i < action.count; ++i)
+            {
+                log.Add(DispatchLog::KeyDown, action.codes[i]);
+                log.Add(DispatchLog::KeyUp, action.codes[i]);
+            }
+        }
+    }
+
+    /**
+     * Button dispatch: the binding table against the if/else chain it replaced
+     * @return false if the two dispatch different events for any frame
+     */
+    bool BenchDispatch(uint32_t iterations)
+    {
+        BindingTable bindings;
+        bindings.BindKey(PadButton::A, KeyCode::Space);
+        bindings.BindKey(PadButton::B, KeyCode::Escape);
+        bindings.BindMouseButton(PadButton::X, MouseButton::Left);
+        bindings.BindMouseButton(PadButton::Y, MouseButton::Right);
+        bindings.BindKey(PadButton::RightThumb, KeyCode::Tab);
+        bindings.BindKeySequence(PadButton::LeftShoulder, { '1', '6' });
+        bindings.BindKeySequence(PadButton::RightShoulder, { '2', '7' });
+        bindings.BindKey(PadButton::DPadUp, KeyCode::Minus);
+        bindings.BindKey(PadButton::DPadDown, KeyCode::Equals);
+        bindings.BindKey(PadButton::DPadLeft, KeyCode::LeftBracket);
+        bindings.BindKey(PadButton::DPadRight, KeyCode::RightBracket);
+        bindings.BindKey(PadButton::Start, 'H');
+        bindings.BindKey(PadButton::Back, 'I');
+
+        // Button states as a pad reports them: mostly unchanged, sometimes one button, now and then many
+        std::vector<uint16_t> states(SAMPLE_COUNT);
+        uint32_t seed = 99;
+        uint16_t buttons = 0;
+        for (uint16_t& state : states)
+        {
+            seed = seed * 1103515245u + 12345u;
+            uint32_t roll = (seed >> 16) % 8;
+            if (roll == 0)
+            {
+                buttons ^= static_cast<uint16_t>(1u << ((seed >> 8) % PadButton::COUNT));
+            }
+            else if (roll == 1)
+            {
+                buttons = static_cast<uint16_t>(seed >> 12);
+            }
+            state = buttons;
+        }
+
+        // Same events for every frame (the chain and the table visit buttons in different orders)
+        size_t mismatches = 0;
+        uint64_t events = 0;
+        for (size_t i = 1; i < states.size(); ++i)
+        {
+            DispatchLog legacy = {};
+            DispatchLog table = {};
+            LegacyDispatch(states[i - 1], states[i], legacy);
+            TableDispatch(bindings, states[i - 1], states[i], table);
+            std::sort(legacy.events, legacy.events + legacy.count);
+            std::sort(table.events, table.events + table.count);
+            bool same = legacy.count == table.count && std::equal(legacy.events, legacy.events + legacy.count, table.events);
+            mismatches += same ? 0 : 1;
+            events += static_cast<uint64_t>(table.count);
+        }
+
+        std::cout << "Button dispatch (" << iterations << " x " << states.size() << " frames):" << std::endl;
+        auto time = [&](const char* name, auto dispatch)
+        {
+            int64_t checksum = 0;
+            auto start = std::chrono::steady_clock::now();
+            for (uint32_t pass = 0; pass < iterations; ++pass)
+            {
+                for (size_t i = 1; i < states.size(); ++i)
+                {
+                    DispatchLog log;
+                    log.count = 0;
+                    dispatch(states[i - 1], states[i], log);
+                    checksum += log.count > 0 ? static_cast<int64_t>(log.events[0]) : 0;
+                }
+            }
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            std::cout << "  " << name << ": " << (seconds * 1e9 / (static_cast<double>(iterations) * static_cast<double>(states.size() - 1)))
+                      << " ns/frame (checksum " << checksum << ")" << std::endl;
+        };
+        time("if/else chain", [](uint16_t previous, uint16_t current, DispatchLog& log) { LegacyDispatch(previous, current, log); });
+        time("binding table", [&bindings](uint16_t previous, uint16_t current, DispatchLog& log) { TableDispatch(bindings, previous, current, log); });
+
+        bool passed = mismatches == 0 && events > 0;
+        std::cout << "  table == chain: " << (passed ? "ok" : "FAILED") << " (" << events << " events, " << mismatches << " frames differ)" << std::endl;
+        return passed;
+    }
+
+    /**
+     * Fake clock: time only moves when the benchmark sleeps
+     */
+    class ManualClock : public IMonotonicClock
+    {
+    public:
+        ManualClock() : m_nowNs(0) {}
+
+        uint64_t NowNanoseconds() const override { return m_nowNs; }
+        void SleepUntil(uint64_t deadlineNs) override { m_nowNs = (deadlineNs > m_nowNs) ? deadlineNs : m_nowNs; }
+        uint64_t GetSleepSlackNanoseconds() const override { return 0; }
+
+    private:
+        uint64_t m_nowNs;
+    };
+
+    /**
+     * Fake clock for FrameScheduler: sleeps wake a fixed time late, each spin step
+     * advances a fixed time, and frame work advances time explicitly
+     */
+    class PacingClock : public IMonotonicClock
+    {
+    public:
+        PacingClock(uint64_t startNs, uint64_t slackNs, uint64_t oversleepNs, uint64_t relaxStepNs)
+            : m_nowNs(startNs), m_slackNs(slackNs), m_oversleepNs(oversleepNs), m_relaxStepNs(relaxStepNs)
+            , m_sleepCount(0), m_relaxCount(0)
+        {
+        }
+
+        uint64_t NowNanoseconds() const override { return m_nowNs; }
+        void SleepUntil(uint64_t deadlineNs) override
+        {
+            ++m_sleepCount;
+            m_nowNs = (deadlineNs > m_nowNs ? deadlineNs : m_nowNs) + m_oversleepNs;
+        }
+        void Relax() override
+        {
+            ++m_relaxCount;
+            m_nowNs += m_relaxStepNs;
+        }
+        uint64_t GetSleepSlackNanoseconds() const override { return m_slackNs; }
+
+        void Work(uint64_t durationNs) { m_nowNs += durationNs; }
+        uint64_t GetSleepCount() const { return m_sleepCount; }
+        uint64_t GetRelaxCount() const { return m_relaxCount; }
+
+    private:
+        uint64_t m_nowNs;
+        uint64_t m_slackNs;
+        uint64_t m_oversleepNs;
+        uint64_t m_relaxStepNs;
+        uint64_t m_sleepCount;
+        uint64_t m_relaxCount;
+    };
+
+    /**
+     * FrameScheduler on a fake clock: deadline grid, hybrid sleep/spin, overrun policies, rate clamping
+     * @return false if any check fails
+     */
+    bool BenchScheduler()
+    {
+        bool passed = true;
+        std::cout << "Frame scheduler:" << std::endl;
+
+        const uint64_t periodNs = 5000000;     // 200 Hz
+        const uint64_t startNs = 1000000000;
+
+        // Work shorter than a period: every frame starts on its deadline, and the grid does not drift
+        {
+            PacingClock clock(startNs, 0, 0, 0);
+            FrameScheduler scheduler(clock);
+            scheduler.Initialize(200);
+            scheduler.Start();
+            uint64_t offGrid = 0;
+            uint64_t maxLateness = 0;
+            for (uint64_t frame = 1; frame <= 1000; ++frame)
+            {
+                uint64_t lateness = scheduler.WaitForNextFrame();
+                offGrid += (clock.NowNanoseconds() != startNs + frame * periodNs) ? 1 : 0;
+                maxLateness = (lateness > maxLateness) ? lateness : maxLateness;
+                clock.Work(1000000 + (frame % 7) * 300000);
+            }
+            Check(passed, "frames start on the grid", offGrid == 0 && maxLateness == 0 && scheduler.GetMissedDeadlineCount() == 0,
+                  std::to_string(offGrid) + " of 1000 frames off the grid");
+        }
+
+        // Hybrid wait: sleep until the slack before the deadline, then spin the tail exactly onto it
+        {
+            PacingClock clock(startNs, 2000000, 1500000, 1000);
+            FrameScheduler scheduler(clock);
+            scheduler.Initialize(200);
+            scheduler.Start();
+            uint64_t maxLateness = 0;
+            for (int frame = 0; frame < 100; ++frame)
+            {
+                uint64_t lateness = scheduler.WaitForNextFrame();
+                maxLateness = (lateness > maxLateness) ? lateness : maxLateness;
+                clock.Work(500000);
+            }
+            Check(passed, "sleep, then spin to the deadline", maxLateness == 0 && clock.GetSleepCount() == 100 && clock.GetRelaxCount() == 100 * 500,
+                  std::to_string(clock.GetSleepCount()) + " sleeps, " + std::to_string(clock.GetRelaxCount()) + " spin steps");
+        }
+
+        // Skip: a frame that ran 3.5 periods drops the missed slots and realigns to the grid
+        {
+            PacingClock clock(startNs, 0, 0, 0);
+            FrameScheduler scheduler(clock);
+            scheduler.Initialize(200, OverrunPolicy::Skip);
+            scheduler.Start();
+            scheduler.WaitForNextFrame();
+            clock.Work(periodNs * 7 / 2);
+            uint64_t lateness = scheduler.WaitForNextFrame();
+            bool realigned = (scheduler.GetNextDeadline() - startNs) % periodNs == 0 && scheduler.GetNextDeadline() > clock.NowNanoseconds();
+            scheduler.WaitForNextFrame();
+            Check(passed, "skip drops missed frames and realigns", lateness == periodNs / 2 && realigned && scheduler.GetSkippedFrameCount() == 2 &&
+                  scheduler.GetOverrunCount() == 1 && scheduler.GetMissedDeadlineCount() == 1 && clock.NowNanoseconds() == startNs + 5 * periodNs,
+                  std::to_string(scheduler.GetSkippedFrameCount()) + " skipped, lateness " + std::to_string(lateness) + " ns");
+        }
+
+        // CatchUp: a short backlog runs back to back without sleeping; a long one is skipped
+        {
+            PacingClock clock(startNs, 0, 0, 0);
+            FrameScheduler scheduler(clock);
+            scheduler.Initialize(200, OverrunPolicy::CatchUp, 4);
+            scheduler.Start();
+            scheduler.WaitForNextFrame();
+            clock.Work(periodNs * 5 / 2);
+            uint64_t sleepsBefore = clock.GetSleepCount();
+            uint64_t now = clock.NowNanoseconds();
+            scheduler.WaitForNextFrame();
+            scheduler.WaitForNextFrame();
+            bool backToBack = clock.GetSleepCount() == sleepsBefore && clock.NowNanoseconds() == now;
+            scheduler.WaitForNextFrame();
+            bool resumed = clock.NowNanoseconds() == startNs + 4 * periodNs && scheduler.GetSkippedFrameCount() == 0;
+
+            clock.Work(periodNs * 10);
+            scheduler.WaitForNextFrame();
+            Check(passed, "catch-up replays a short backlog, skips a long one", backToBack && resumed && scheduler.GetSkippedFrameCount() == 9,
+                  std::to_string(scheduler.GetSkippedFrameCount()) + " skipped");
+        }
+
+        // Rate clamping
+        {
+            PacingClock clock(startNs, 0, 0, 0);
+            FrameScheduler scheduler(clock);
+            scheduler.Initialize(5000);
+            uint64_t fastest = scheduler.GetPeriodNanoseconds();
+            scheduler.Initialize(0);
+            uint64_t slowest = scheduler.GetPeriodNanoseconds();
+            Check(passed, "rate clamped to 1..1000 Hz", fastest == 1000000 && slowest == 1000000000, "");
+        }
+        return passed;
+    }
+
+    /**
+     * A button held from pressMs until releaseMs
+     */
+    struct ButtonPress
+    {
+        uint16_t button;
+        uint64_t pressMs;
+        uint64_t releaseMs;
+    };
+
+    /**
+     * Run a mapper on a fake clock at a fixed frame period, pressing buttons as scripted
+     * @param setup Called with the mapper before the first frame, to give it bindings
+     * @return Key/mouse button timeline ("ms:key+" / "ms:key-", batches separated by " | ")
+     */
+    template <typename Setup>
+    std::string RunTimeline(Setup setup, std::initializer_list<ButtonPress> presses, uint64_t frameMs, uint64_t endMs)
+    {
+        ManualClock clock;
+        RecordingOutputSink sink;
+        sink.SetClock(&clock);
+        PadDevice pad;
+        Mapper mapper;
+        mapper.Initialize(&pad, &sink);
+        setup(mapper);
+
+        PadSnapshot snapshot = {};
+        snapshot.connected = 1;
+        for (uint64_t frame = 0; frame * frameMs <= endMs; ++frame)
+        {
+            clock.SleepUntil(frame * frameMs * 1000000ULL);
+            uint64_t nowMs = frame * frameMs;
+            uint16_t buttons = 0;
+            for (const ButtonPress& press : presses)
+            {
+                buttons |= (nowMs >= press.pressMs && nowMs < press.releaseMs) ? press.button : 0;
+            }
+            if (frame == 0 || buttons != snapshot.pad.buttons)
+            {
+                snapshot.pad.buttons = buttons;
+                snapshot.timestampNs = clock.NowNanoseconds();
+                ++snapshot.packetNumber;
+                pad.ApplySnapshot(snapshot);
+            }
+            else
+            {
+                pad.MarkUnchanged();
+            }
+            mapper.Update(clock.NowNanoseconds());
+        }
+        return sink.GetTimeline();
+    }
+
+    /**
+     * Run a mapper with a binding table on a fake clock, pressing buttons as scripted
+     */
+    std::string RunTimeline(const BindingTable& bindings, std::initializer_list<ButtonPress> presses,
+                            uint64_t frameMs, uint64_t endMs)
+    {
+        return RunTimeline([&bindings](Mapper& mapper) { mapper.SetBindings(bindings); }, presses, frameMs, endMs);
+    }
+
+    /**
+     * Compare the wheel against a plain list of due times under random schedules and cancels
+     * @return Number of timers that fired early, late, twice, or after being cancelled
+     */
+    uint64_t CheckTimerWheel(uint32_t rounds)
+    {
+        const uint64_t tickNs = 1000000;
+        TimerWheel wheel(tickNs);
+        ManualClock clock;
+
+        struct Expected
+        {
+            uint32_t handle;
+            uint64_t dueNs;
+            bool live;
+        };
+        std::vector<Expected> timers;
+        uint64_t errors = 0;
+        uint32_t seed = 99;
+        auto next = [&seed]() { seed = seed * 1103515245u + 12345u; return seed >> 16; };
+        auto dueTick = [tickNs](const Expected& timer) { return (timer.dueNs + tickNs - 1) / tickNs; };
+
+        for (uint32_t round = 0; round < rounds; ++round)
+        {
+            // Schedule a few timers over every level of the wheel, cancel a few
+            uint32_t action = next() % 4;
+            if (action < 2 && wheel.GetPendingCount() < TimerWheel::MAX_TIMERS)
+            {
+                uint32_t scale = next() % 4;
+                uint64_t delayNs = (static_cast<uint64_t>(next()) << (scale * 5)) * 1000ULL;
+                Expected timer = { 0, clock.NowNanoseconds() + delayNs, true };
+                timer.handle = wheel.Schedule(timer.dueNs, static_cast<uint32_t>(timers.size()));
+                timers.push_back(timer);
+            }
+            else if (action == 2 && !timers.empty())
+            {
+                Expected& timer = timers[next() % timers.size()];
+                wheel.Cancel(timer.handle);
+                timer.live = false;
+            }
+
+            // Frames of uneven length, sometimes a long stall
+            uint64_t previousNs = clock.NowNanoseconds();
+            uint64_t stepNs = (next() % 50 == 0) ? (next() % 5000) * tickNs : (next() % 20000) * 1000ULL;
+            clock.SleepUntil(previousNs + stepNs);
+            uint64_t nowNs = clock.NowNanoseconds();
+            wheel.Advance(nowNs, [&](uint32_t cookie)
+            {
+                // Early: before its due time. Late: its tick had already passed at the previous Advance().
+                Expected& timer = timers[cookie];
+                if (!timer.live || nowNs < timer.dueNs || dueTick(timer) <= previousNs / tickNs)
+                {
+                    ++errors;
+                }
+                timer.live = false;
+            });
+        }
+
+        // Every timer still live must be due after the last tick fired
+        for (const Expected& timer : timers)
+        {
+            if (timer.live && dueTick(timer) <= clock.NowNanoseconds() / tickNs)
+            {
+                ++errors;
+            }
+        }
+        return errors;
+    }
+
+    /**
+     * Timed macros on a fake clock: exact event timelines, cancellation, and the timer wheel
+     * @return false if any timeline or wheel check fails
+     */
+    bool BenchMacros(uint32_t iterations)
+    {
+        bool passed = true;
+        std::cout << "Macros (fake clock):" << std::endl;
+
+        // Witcher profile: a 5 ms tap of LB at 200 Hz still plays 1 and 6 in full
+        BindingTable witcher = BindingTable::CreateWitcherProfile();
+        Expect(passed, "LB tap, 200 Hz", RunTimeline(witcher, { { PadButton::LeftShoulder, 10, 15 } }, 5, 200),
+              "10:1+ | 40:1- | 60:6+ | 90:6-");
+
+        // 60 Hz frames: each phase lasts at least its time, started from the frame that serviced it
+        Expect(passed, "LB tap, 60 Hz", RunTimeline(witcher, { { PadButton::LeftShoulder, 16, 33 } }, 16, 300),
+              "16:1+ | 48:1- | 80:6+ | 112:6-");
+
+        // Cancelled on release: the held key is released with the button, the rest never plays
+        BindingTable cancelling;
+        cancelling.BindMacro(PadButton::A, { MacroStep::Key('Q', 50, 10), MacroStep::Mouse(MouseButton::Left, 20, 0) }, true);
+        Expect(passed, "cancel on release", RunTimeline(cancelling, { { PadButton::A, 0, 25 } }, 5, 200), "0:Q+ | 25:Q-");
+        Expect(passed, "held to the end", RunTimeline(cancelling, { { PadButton::A, 0, 150 } }, 5, 200), "0:Q+ | 50:Q- | 60:M0+ | 80:M0-");
+
+        uint64_t wheelErrors = CheckTimerWheel(iterations * 100);
+        passed = passed && (wheelErrors == 0);
+        std::cout << "  timer wheel vs. due times (" << iterations * 100 << " random steps): " << wheelErrors
+                  << " errors" << (wheelErrors == 0 ? "" : "  FAILED") << std::endl;
+
+        // Service cost: a full wheel advanced one tick at a time
+        TimerWheel wheel(1000000);
+        uint64_t fired = 0;
+        uint64_t ticks = static_cast<uint64_t>(iterations) * 1000;
+        auto start = std::chrono::steady_clock::now();
+        for (uint64_t tick = 1; tick <= ticks; ++tick)
+        {
+            while (wheel.GetPendingCount() < TimerWheel::MAX_TIMERS)
+            {
+                wheel.Schedule((tick + (fired * 7919 + wheel.GetPendingCount() * 104729) % 5000) * 1000000ULL, 0);
+            }
+            wheel.Advance(tick * 1000000ULL, [&fired](uint32_t) { ++fired; });
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "  wheel service, " << TimerWheel::MAX_TIMERS << " timers pending: "
+                  << (seconds * 1e9 / static_cast<double>(ticks)) << " ns/tick (" << fired << " fired)" << std::endl;
+        return passed;
+    }
+
+    /**
+     * Gesture bindings on a fake clock: each gesture's timeline, and plain bindings unaffected
+     * @return false if any timeline differs
+     */
+    bool BenchGestures()
+    {
+        bool passed = true;
+        std::cout << "Gestures (fake clock, 200 Hz):" << std::endl;
+
+        // Witcher profile: B taps Escape on release, holds Alt past 200 ms
+        BindingTable witcher = BindingTable::CreateWitcherProfile();
+        Expect(passed, "B tap", RunTimeline(witcher, { { PadButton::B, 0, 50 } }, 5, 400), "50:0x1B+ | 80:0x1B-");
+        Expect(passed, "B hold", RunTimeline(witcher, { { PadButton::B, 0, 500 } }, 5, 600), "200:0x12+ | 500:0x12-");
+
+        // D-pad: a single tap waits out the 180 ms double-tap window, a double tap fires on the second press
+        Expect(passed, "D-pad tap", RunTimeline(witcher, { { PadButton::DPadRight, 0, 40 } }, 5, 400), "220:0xDD+ | 250:0xDD-");
+        Expect(passed, "D-pad double tap", RunTimeline(witcher, { { PadButton::DPadRight, 0, 40 }, { PadButton::DPadRight, 100, 140 } }, 5, 400),
+              "100:0xDD+ | 130:0xDD- | 150:0xDD+ | 180:0xDD-");
+        Expect(passed, "D-pad slow second tap", RunTimeline(witcher, { { PadButton::DPadRight, 0, 40 }, { PadButton::DPadRight, 250, 290 } }, 5, 700),
+              "220:0xDD+ | 250:0xDD- | 470:0xDD+ | 500:0xDD-");
+
+        // Plain bindings keep their one-frame path, even while a gesture is pending
+        Expect(passed, "A (plain) during B hold", RunTimeline(witcher, { { PadButton::B, 0, 300 }, { PadButton::A, 100, 150 } }, 5, 400),
+              "100:0x20+ | 150:0x20- | 200:0x12+ | 300:0x12-");
+
+        // All four gestures on one button
+        BindingTable all;
+        all.BindGesture(PadButton::X, GestureDefinition::Create(150, 120, 600)
+            .Set(GestureKind::Tap, MacroStep::Key('T', 20, 10))
+            .Set(GestureKind::Hold, MacroStep::Mouse(MouseButton::Right, 0, 0))
+            .Set(GestureKind::DoubleTap, MacroStep::Key('D', 20, 10))
+            .Set(GestureKind::LongPress, MacroStep::Key('L', 20, 10)));
+        Expect(passed, "tap", RunTimeline(all, { { PadButton::X, 0, 60 } }, 5, 400), "180:T+ | 200:T-");
+        Expect(passed, "double tap", RunTimeline(all, { { PadButton::X, 0, 60 }, { PadButton::X, 100, 130 } }, 5, 400), "100:D+ | 120:D-");
+        Expect(passed, "hold", RunTimeline(all, { { PadButton::X, 0, 300 } }, 5, 400), "150:M1+ | 300:M1-");
+        Expect(passed, "long press", RunTimeline(all, { { PadButton::X, 0, 800 } }, 5, 900), "150:M1+ | 600:L+ | 620:L- | 800:M1-");
+        return passed;
+    }
+
+    /**
+     * Map random buttons, sticks and triggers on a fake 200 Hz clock
+     * @param setup Called with the mapper before the first frame, to give it a profile
+     */
+    template <typename Setup>
+    void MapRandomPads(Setup setup, uint32_t frames, RecordingOutputSink& sink)
+    {
+        ManualClock clock;
+        PadDevice pad;
+        Mapper mapper;
+        mapper.Initialize(&pad, &sink);
+        setup(mapper);
+
+        uint32_t seed = 7;
+        uint16_t buttons = 0;
+        for (uint32_t frame = 0; frame < frames; ++frame)
+        {
+            clock.SleepUntil(static_cast<uint64_t>(frame) * 5000000ULL);
+            PadSnapshot snapshot = MakeRandomPad(seed, frame + 1);
+
+            // Buttons change every few frames, so taps, holds and double taps all occur
+            if (frame % 7 == 0)
+            {
+                seed = seed * 1103515245u + 12345u;
+                buttons = static_cast<uint16_t>(seed >> 16);
+            }
+            snapshot.connected = 1;
+            snapshot.pad.buttons = buttons;
+            snapshot.timestampNs = clock.NowNanoseconds();
+            pad.ApplySnapshot(snapshot);
+            mapper.Update(clock.NowNanoseconds());
+        }
+        mapper.ReleaseAllOutputs();
+    }
+
+    /**
+     * Map random buttons, sticks and triggers through a profile on a fake 200 Hz clock
+     */
+    void MapRandomPads(const Profile& profile, uint32_t frames, RecordingOutputSink& sink)
+    {
+        MapRandomPads([&profile](Mapper& mapper) { mapper.SetProfile(profile); }, frames, sink);
+    }
+
+    bool ReadFile(const std::string& path, std::string& text)
+    {
+        std::ifstream file(path, std::ios::binary);
+        text.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        return file.good() || file.eof();
+    }
+
+    bool WriteFile(const std::string& path, const std::string& text)
+    {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file << text;
+        return file.good();
+    }
+
+    std::string Banner(const Profile& profile)
+    {
+        std::ostringstream banner;
+        profile.PrintBanner(banner);
+        return banner.str();
+    }
+
+    /**
+     * Text profiles: the shipped profile against the built-in one, the image cache, and compile errors
+     * @return false if any check fails
+     */
+    bool BenchProfile(uint32_t iterations)
+    {
+        bool passed = true;
+        std::cout << "Profiles:" << std::endl;
+
+        // The shipped witcher.ini is the built-in profile: same banner, same output for the same input
+        std::string shippedPath = std::string(GAMEPADMAPPER_PROFILE_DIR) + "/witcher.ini";
+        std::string witcherText;
+        if (!ReadFile(shippedPath, witcherText) || witcherText.empty())
+        {
+            Check(passed, "read " + shippedPath, false, "");
+            return false;
+        }
+
+        ProfileCompiler compiler;
+        Profile compiled;
+        bool compiledOk = compiler.Compile(witcherText.data(), witcherText.size(), compiled);
+        Check(passed, "witcher.ini compiles", compiledOk, compiler.GetError());
+        if (!compiledOk)
+        {
+            return false;
+        }
+
+        Profile builtIn = Profile::CreateWitcher();
+        Check(passed, "witcher.ini banner == built-in banner", Banner(compiled) == Banner(builtIn), "");
+
+        RecordingOutputSink builtInEvents;
+        RecordingOutputSink compiledEvents;
+        MapRandomPads(builtIn, iterations * 10, builtInEvents);
+        MapRandomPads(compiled, iterations * 10, compiledEvents);
+        Check(passed, "witcher.ini output == built-in output", compiledEvents.Matches(builtInEvents),
+              std::to_string(builtInEvents.GetEvents().size()) + " events from " + std::to_string(iterations * 10) + " random frames");
+
+        // Every binding kind and setting, read back field by field
+        const char* everything =
+            "[profile]\n"
+            "name = Everything\n"
+            "[buttons]\n"
+            "Y = sequence 1 6 enter\n"
+            "LB = macro cancel Q/50/10 MouseLeft/20\n"
+            "x = gesture holdms=150 doubletapms=120 longpressms=600 tap=T/20/10 hold=MouseRight doubletap=D longpress=L/20/10*3\n"
+            "Back = key 0x70 \"F1; help\"  ; comment\n"
+            "A = none\n"
+            "[sticks]\n"
+            "left.curve = custom 0.5:0.25 0.8:0.6\n"
+            "right.deadzone = 4000 30000\n"
+            "right.curve = power 2\n"
+            "threshold = 12000 9000 15\n"
+            "move = I K J Up?\n";
+        Profile sample;
+        bool sampleOk = !compiler.Compile(everything, std::strlen(everything), sample) &&
+                        compiler.GetError() == "line 14: unknown key 'Up?'";
+        Check(passed, "bad key rejected", sampleOk, compiler.GetError());
+
+        std::string fixed = std::string(everything);
+        fixed.replace(fixed.find("Up?"), 3, "L");
+        sampleOk = compiler.Compile(fixed.data(), fixed.size(), sample);
+        const BindingTable& table = sample.buttons;
+        const BindingAction& sequence = table.GetAction(BindingTable::ButtonToBitIndex(PadButton::Y));
+        const MacroDefinition& macro = table.GetMacro(BindingTable::ButtonToBitIndex(PadButton::LeftShoulder));
+        const GestureDefinition& gesture = table.GetGesture(BindingTable::ButtonToBitIndex(PadButton::X));
+        const BindingAction& back = table.GetAction(BindingTable::ButtonToBitIndex(PadButton::Back));
+        sampleOk = sampleOk && std::strcmp(sample.name, "Everything") == 0 &&
+                   sequence.type == BindingActionType::KeySequence && sequence.count == 3 && sequence.codes[2] == KeyCode::Enter &&
+                   macro.cancelOnRelease && macro.stepCount == 2 && macro.steps[1].type == MacroOutputType::MouseButton &&
+                   macro.steps[1].holdMs == 20 && macro.steps[1].gapMs == 0 &&
+                   gesture.boundMask == 0xF && gesture.longPressMs == 600 && gesture.repeats[3] == 3 &&
+                   gesture.actions[1].code == MouseButton::Right && gesture.actions[2].holdMs == 0 &&
+                   back.codes[0] == 0x70 && std::strcmp(sample.buttonLabels[BindingTable::ButtonToBitIndex(PadButton::Back)], "F1; help") == 0 &&
+                   (table.GetBoundMask() & PadButton::A) == 0 &&
+                   sample.leftStick.curve == ResponseCurve::Custom && sample.leftStick.pointCount == 2 &&
+                   sample.leftStick.pointsY[1] == 0.6f && sample.leftStick.innerDeadZone == 7849 &&
+                   sample.rightStick.innerDeadZone == 4000 && sample.rightStick.curve == ResponseCurve::Power &&
+                   sample.rightStick.exponent == 2.0f &&
+                   sample.stickThresholds.pressThreshold == 12000 && sample.stickThresholds.minHoldNs == 15000000ULL &&
+                   sample.GetAnalogKey(AnalogKey::MoveRight) == 'L' && sample.GetAnalogKey(AnalogKey::BothTriggers) == 0 &&
+                   sample.triggerThresholds.pressThreshold == 128;
+        Check(passed, "every binding kind and setting", sampleOk, compiler.GetError());
+
+        // Each validation error names its line
+        struct BadProfile
+        {
+            const char* text;
+            const char* error;
+        };
+        const BadProfile badProfiles[] =
+        {
+            { "A = key Space\n", "line 1: setting 'A' outside a section" },
+            { "[buttons]\nA = key Space\n\na = mouse Left\n", "line 4: button a is bound twice" },
+            { "[buttons]\nA = key\n", "line 2: 'key' takes one key" },
+            { "[buttons]\nLB = macro 1/30/20*2\n", "line 2: only tap, doubletap and longpress steps take a *<count>" },
+            { "[buttons]\nB = gesture holdms=200 tap=Escape longpress=Alt\n", "line 2: longpress needs longpressms=<ms> above holdms" },
+            { "[buttons]\nB = gesture tap=Escape doubletap=Escape\n", "line 2: doubletap needs doubletapms=<ms>" },
+            { "[sticks]\nleft.deadzone = 9000 8000\n", "line 2: the outer dead zone must be above the inner one" },
+            { "[sticks]\nleft.curve = custom 0.5:0.5 0.4:0.6\n", "line 2: curve points need ascending x between 0 and 1" },
+            { "[sticks]\nthreshold = 10322 8258 \"fast\"\n", "line 2: 'threshold' takes no label" },
+            { "[triggers]\nthreshold = 96 128\n", "line 2: the release threshold must not be above the press threshold" },
+            { "[triggers]\nthreshold = 300 96\n", "line 2: 300 is out of range (0 to 255)" },
+            { "[trigers]\n", "line 1: unknown section [trigers]" },
+            { "[combos]\ncombo = X macro 6\n", "line 2: 'combo' takes 2 to 8 presses, then 'macro' and its steps" },
+            { "[combos]\ncombo = X/100 Y macro 6\n", "line 2: the first press of a combo takes no window" },
+            { "[combos]\ncombo = X Y macro cancel 6\n", "line 2: a combo macro cannot be cancelled on release" },
+            { "[layer signs]\nX = key 5\n[buttons]\n", "line 3: layer signs has no 'activate' setting" },
+            { "[buttons]\nLB = key Q\n[layer signs]\nactivate = LB hold\n", "line 4: button LB is bound and cannot activate a layer" },
+            { "[layer signs]\nactivate = LB hold\nLB = key Q\n", "line 3: button LB activates a layer and cannot be bound" },
+            { "[layer signs]\nactivate = LB press\n", "line 2: unknown layer mode 'press' (hold, toggle)" },
+            { "[layer a]\nactivate = LB hold\n[layer A]\n", "line 3: layer A is defined twice" },
+        };
+        int errorsMatched = 0;
+        for (const BadProfile& bad : badProfiles)
+        {
+            Profile rejected;
+            if (!compiler.Compile(bad.text, std::strlen(bad.text), rejected) && compiler.GetError() == bad.error)
+            {
+                ++errorsMatched;
+            }
+            else
+            {
+                std::cout << "    expected \"" << bad.error << "\", got \"" << compiler.GetError() << "\"" << std::endl;
+            }
+        }
+        int badCount = static_cast<int>(sizeof(badProfiles) / sizeof(badProfiles[0]));
+        Check(passed, "invalid profiles rejected", errorsMatched == badCount,
+              std::to_string(errorsMatched) + "/" + std::to_string(badCount) + " with the expected message");
+
+        // Image cache: compile once, then map; recompile only on a text change or a damaged image
+        const std::string sourcePath = "GamepadBench-profile.ini";
+        const std::string imagePath = ProfileCache::GetImagePath(sourcePath.c_str());
+        std::remove(imagePath.c_str());
+        WriteFile(sourcePath, witcherText);
+        {
+            ProfileCache cache;
+            bool first = cache.Load(sourcePath.c_str(), imagePath.c_str()) && cache.WasCompiled() && cache.IsMapped();
+            Check(passed, "first load compiles and maps the image", first, cache.GetError());
+        }
+        {
+            ProfileCache cache;
+            bool cached = cache.Load(sourcePath.c_str(), imagePath.c_str()) && !cache.WasCompiled() && cache.IsMapped() &&
+                          Banner(cache.GetProfile()) == Banner(builtIn);
+            Check(passed, "unchanged text maps the image without compiling", cached, cache.GetError());
+
+            // A mapper runs straight from the mapped image
+            RecordingOutputSink mappedEvents;
+            MapRandomPads(cache.GetProfile(), iterations * 10, mappedEvents);
+            Check(passed, "mapped image output == built-in output", mappedEvents.Matches(builtInEvents), "");
+        }
+        {
+            WriteFile(sourcePath, witcherText + "\n; edited\n");
+            ProfileCache cache;
+            bool edited = cache.Load(sourcePath.c_str(), imagePath.c_str()) && cache.WasCompiled();
+            Check(passed, "edited text recompiles", edited, cache.GetError());
+        }
+        {
+            // Flip one payload byte: the checksum no longer matches
+            std::fstream image(imagePath, std::ios::in | std::ios::out | std::ios::binary);
+            image.seekp(sizeof(ProfileImage::Header) + 100);
+            image.put('\x5A');
+            image.close();
+            ProfileCache damaged;
+            Check(passed, "damaged image rejected", !damaged.Open(imagePath.c_str()), "");
+            ProfileCache cache;
+            bool repaired = cache.Load(sourcePath.c_str(), imagePath.c_str()) && cache.WasCompiled();
+            Check(passed, "damaged image recompiled", repaired, cache.GetError());
+        }
+        {
+            // Well-formed images (valid header and checksum, current source hash) whose
+            // profile holds counts or labels out of range
+            std::string text;
+            ReadFile(sourcePath, text);
+            const uint64_t sourceHash = ProfileImage::Hash(text.data(), text.size());
+            ProfileCache valid;
+            valid.Load(sourcePath.c_str(), imagePath.c_str());
+            const Profile good = valid.GetProfile();
+            valid.Close();
+
+            std::vector<std::pair<std::string, Profile>> broken(6, std::make_pair(std::string(), good));
+            broken[0].first = "layer count";
+            broken[0].second.layerCount = Profile::MAX_LAYERS + 1;
+            broken[1].first = "combo count";
+            broken[1].second.comboCount = Profile::MAX_COMBOS + 1;
+            broken[2].first = "combo steps";
+            broken[2].second.comboCount = 1;
+            broken[2].second.combos[0].pressCount = 1;
+            broken[2].second.combos[0].action.stepCount = MacroDefinition::MAX_STEPS + 1;
+            broken[3].first = "combo presses";
+            broken[3].second.comboCount = 1;
+            broken[3].second.combos[0].pressCount = ComboDefinition::MAX_PRESSES + 1;
+            broken[3].second.combos[0].action.stepCount = 1;
+            broken[4].first = "name";
+            std::memset(broken[4].second.name, 'x', sizeof(broken[4].second.name));
+            broken[5].first = "button label";
+            std::memset(broken[5].second.buttonLabels[3], 'x', sizeof(broken[5].second.buttonLabels[3]));
+
+            std::string failures;
+            for (const std::pair<std::string, Profile>& image : broken)
+            {
+                ProfileCache cache;
+                bool rejected = image.second.IsValid() == false &&
+                                ProfileCache::WriteImage(imagePath.c_str(), image.second, sourceHash) &&
+                                !cache.Open(imagePath.c_str());
+                bool recompiled = cache.Load(sourcePath.c_str(), imagePath.c_str()) && cache.WasCompiled() &&
+                                  Banner(cache.GetProfile()) == Banner(good);
+                failures += (rejected && recompiled) ? "" : " " + image.first;
+            }
+            Check(passed, "out-of-range images recompiled", good.IsValid() && failures.empty(), failures.empty() ? "" : "failed:" + failures);
+        }
+        {
+            WriteFile(sourcePath, "[buttons]\nA = key Sapce\n");
+            ProfileCache cache;
+            bool failed = !cache.Load(sourcePath.c_str(), imagePath.c_str()) &&
+                          cache.GetError() == sourcePath + ": line 2: unknown key 'Sapce'";
+            Check(passed, "compile error reported with its line", failed, cache.GetError());
+        }
+
+        // Startup cost: compiling the text vs. mapping the cached image
+        WriteFile(sourcePath, witcherText);
+        ProfileCache warm;
+        warm.Load(sourcePath.c_str(), imagePath.c_str());
+        warm.Close();
+
+        uint32_t rounds = iterations;
+        auto start = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < rounds; ++i)
+        {
+            compiler.Compile(witcherText.data(), witcherText.size(), compiled);
+        }
+        double compileSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        start = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < rounds; ++i)
+        {
+            warm.Load(sourcePath.c_str(), imagePath.c_str());
+        }
+        double loadSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        Check(passed, "cached loads skip the compiler", !warm.WasCompiled() && warm.IsMapped(), "");
+
+        std::cout << "  compile witcher.ini: " << (compileSeconds * 1e6 / rounds) << " us, load from image (read + hash + map + checksum): "
+                  << (loadSeconds * 1e6 / rounds) << " us, image " << sizeof(ProfileImage::Header) + sizeof(Profile) << " bytes" << std::endl;
+
+        warm.Close();
+        std::remove(sourcePath.c_str());
+        std::remove(imagePath.c_str());
+        return passed;
+    }
+
+    OutputSet CollectOutputs(const Profile& profile)
+    {
+        OutputSet set = {};
+        auto addStep = [&set](const MacroStep& step)
+        {
+            if (step.type == MacroOutputType::Key)
+            {
+                set.keys[step.code & 0xFF] = true;
+            }
+            else
+            {
+                set.mouseButtons |= static_cast<uint8_t>(1 << step.code);
+            }
+        };
+
+        const BindingTable& table = profile.buttons;
+        for (int bit = 0; bit < 16; ++bit)
+        {
+            const BindingAction& action = table.GetAction(bit);
+            switch (action.type)
+            {
+            case BindingActionType::Key:
+            case BindingActionType::KeySequence:
+                for (int i = 0; i < action.count; ++i)
+                {
+                    set.keys[action.codes[i] & 0xFF] = true;
+                }
+                break;
+            case BindingActionType::MouseButton:
+                set.mouseButtons |= static_cast<uint8_t>(1 << action.codes[0]);
+                break;
+            case BindingActionType::Macro:
+                for (int step = 0; step < table.GetMacro(bit).stepCount; ++step)
+                {
+                    addStep(table.GetMacro(bit).steps[step]);
+                }
+                break;
+            case BindingActionType::Gesture:
+                for (int kind = 0; kind < GestureDefinition::KIND_COUNT; ++kind)
+                {
+                    if (table.GetGesture(bit).boundMask & (1 << kind))
+                    {
+                        addStep(table.GetGesture(bit).actions[kind]);
+                    }
+                }
+                break;
+            default:
+                break;
+            }
+        }
+        for (int key = 0; key < Profile::ANALOG_KEY_COUNT; ++key)
+        {
+            if (profile.analogKeys[key] != 0)
+            {
+                set.keys[profile.analogKeys[key] & 0xFF] = true;
+            }
+        }
+        return set;
+    }
+
+    /**
+     * Hot reload under load: one thread rewrites and reloads the profile over and
+     * over while another maps random pad frames through the published snapshots
+     * @return false if a key of an old profile stays held, the mapping thread
+     *         allocates, or a replaced snapshot is never freed
+     */
+    bool BenchReload(uint32_t reloads)
+    {
+        bool passed = true;
+        std::cout << "Profile hot reload:" << std::endl;
+
+        // Two profiles with no key or mouse button in common: any output of the
+        // other one still held after a switch is a stuck key
+        std::string witcherText;
+        if (!ReadFile(std::string(GAMEPADMAPPER_PROFILE_DIR) + "/witcher.ini", witcherText) || witcherText.empty())
+        {
+            Check(passed, "read witcher.ini", false, "");
+            return false;
+        }
+        const std::string remappedText =
+            "[profile]\n"
+            "name = Remapped\n"
+            "[buttons]\n"
+            "A = key J\n"
+            "B = gesture holdms=150 tap=K/30/20 hold=Shift\n"
+            "X = key Q\n"
+            "Y = mouse Middle\n"
+            "RightThumb = key E\n"
+            "LB = macro 3/30/20 8/30/20\n"
+            "RB = macro cancel 4/40/20 9/40/20\n"
+            "DPadUp = key R\n"
+            "DPadDown = key F\n"
+            "DPadLeft = sequence T Y\n"
+            "DPadRight = key G\n"
+            "Start = key Enter\n"
+            "Back = key Control\n"
+            "[sticks]\n"
+            "left.curve = power 2\n"
+            "right.deadzone = 4000 30000\n"
+            "threshold = 9000 6000\n"
+            "move = O L N M\n"
+            "[triggers]\n"
+            "threshold = 100 60\n"
+            "left = V\n"
+            "right = B\n"
+            "both = P\n";
+
+        ProfileCompiler compiler;
+        Profile witcher;
+        Profile remapped;
+        if (!compiler.Compile(witcherText.data(), witcherText.size(), witcher) ||
+            !compiler.Compile(remappedText.data(), remappedText.size(), remapped))
+        {
+            Check(passed, "profiles compile", false, compiler.GetError());
+            return false;
+        }
+        const OutputSet witcherOutputs = CollectOutputs(witcher);
+        const OutputSet remappedOutputs = CollectOutputs(remapped);
+        bool disjoint = (witcherOutputs.mouseButtons & remappedOutputs.mouseButtons) == 0;
+        for (int key = 0; key < 256; ++key)
+        {
+            disjoint = disjoint && !(witcherOutputs.keys[key] && remappedOutputs.keys[key]);
+        }
+        Check(passed, "test profiles share no output", disjoint, "");
+        const uint64_t remappedHash = ProfileImage::Hash(remappedText.data(), remappedText.size());
+
+        std::string sourcePath = "GamepadBench-reload.ini";
+        std::string imagePath = ProfileCache::GetImagePath(sourcePath.c_str());
+        WriteFile(sourcePath, witcherText);
+
+        ManualClock clock;
+        ProfileReloader reloader(clock);
+        if (!reloader.Load(sourcePath.c_str()))
+        {
+            Check(passed, "initial load", false, reloader.GetError());
+            return false;
+        }
+
+        // A replayed session: random sticks and triggers, buttons changing every few frames
+        std::vector<PadSnapshot> frames;
+        uint32_t seed = 11;
+        uint16_t buttons = 0;
+        for (uint32_t frame = 0; frame < 4096; ++frame)
+        {
+            PadSnapshot snapshot = MakeRandomPad(seed, frame + 1);
+            if (frame % 7 == 0)
+            {
+                seed = seed * 1103515245u + 12345u;
+                buttons = static_cast<uint16_t>(seed >> 16);
+            }
+            snapshot.connected = 1;
+            snapshot.pad.buttons = buttons;
+            frames.push_back(snapshot);
+        }
+
+        RecordingOutputSink sink(false);
+        PadDevice pad;
+        Mapper mapper;
+        mapper.Initialize(&pad, &sink);
+        reloader.Apply(mapper);
+        const OutputSet* allowed = &witcherOutputs;
+
+        // Writer: rewrite the text and reload it, alternating the two profiles
+        std::atomic<bool> writerDone(false);
+        uint64_t writerNs = 0;
+        size_t maxRetired = 0;
+        std::thread writer([&]()
+        {
+            auto start = std::chrono::steady_clock::now();
+            for (uint32_t i = 0; i < reloads; ++i)
+            {
+                WriteFile(sourcePath, (i % 2 == 0) ? remappedText : witcherText);
+                reloader.Poll();
+                maxRetired = std::max(maxRetired, reloader.GetRetiredCount());
+            }
+            writerNs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - start).count());
+            writerDone.store(true);
+        });
+
+        // Reader: the mapping loop, switching between frames whenever a new snapshot is out
+        uint64_t frameCount = 0;
+        uint64_t switches = 0;
+        uint64_t switchesWhileHeld = 0;
+        uint64_t stuckFrames = 0;
+        uint64_t allocations = 0;
+        while (!writerDone.load())
+        {
+            const PadSnapshot& frame = frames[frameCount % frames.size()];
+            uint64_t timestampNs = (frameCount + 1) * 5000000ULL;
+            uint64_t allocationsBefore = GetThreadAllocationCount();
+
+            bool held = sink.HoldsAnything();
+            if (reloader.Apply(mapper))
+            {
+                ++switches;
+                switchesWhileHeld += held ? 1 : 0;
+                allowed = (reloader.GetApplied()->sourceHash == remappedHash) ? &remappedOutputs : &witcherOutputs;
+            }
+
+            PadSnapshot snapshot = frame;
+            snapshot.timestampNs = timestampNs;
+            pad.ApplySnapshot(snapshot);
+            mapper.Update(timestampNs);
+
+            allocations += GetThreadAllocationCount() - allocationsBefore;
+            stuckFrames += sink.HoldsOnly(*allowed) ? 0 : 1;
+            ++frameCount;
+        }
+        writer.join();
+
+        Check(passed, "reloads published", reloader.GetReloadCount() == reloads && reloader.GetFailedReloadCount() == 0,
+              std::to_string(reloader.GetReloadCount()) + " of " + std::to_string(reloads));
+        Check(passed, "mapping thread switched profiles", switches > 0,
+              std::to_string(switches) + " switches in " + std::to_string(frameCount) + " frames, " +
+              std::to_string(switchesWhileHeld) + " with outputs held");
+        Check(passed, "no output of a replaced profile stays held", stuckFrames == 0, std::to_string(stuckFrames) + " frames");
+        Check(passed, "mapping thread never allocates", allocations == 0, std::to_string(allocations) + " allocations");
+
+        // Once the reader is on the newest snapshot every replaced one is freed
+        reloader.Apply(mapper);
+        reloader.Poll();
+        Check(passed, "replaced snapshots reclaimed", reloader.GetRetiredCount() == 0 && reloader.GetReclaimedCount() == reloader.GetVersion() - 1,
+              std::to_string(reloader.GetReclaimedCount()) + " freed, at most " + std::to_string(maxRetired) + " waiting at once");
+
+        // A broken edit is reported and the running profile stays
+        uint64_t version = reloader.GetVersion();
+        WriteFile(sourcePath, witcherText + "bogus\n");
+        bool rejected = !reloader.Poll() && !reloader.Poll() && reloader.GetVersion() == version &&
+                        reloader.GetFailedReloadCount() == 1 && !reloader.Apply(mapper);
+        Check(passed, "broken edit keeps the running profile", rejected, reloader.GetError());
+
+        // Switch cost alone, on one thread (on a single core the concurrent run above also times preemption)
+        uint64_t switchNs = 0;
+        const uint32_t rounds = 1000;
+        for (uint32_t i = 0; i < rounds; ++i)
+        {
+            reloader.Publish((i % 2 == 0) ? remapped : witcher, 0);
+            auto start = std::chrono::steady_clock::now();
+            reloader.Apply(mapper);
+            switchNs += static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - start).count());
+            mapper.Update((frameCount + i + 1) * 5000000ULL);
+        }
+
+        mapper.ReleaseAllOutputs();
+        Check(passed, "all outputs released at exit", !sink.HoldsAnything() && sink.GetDownCount() == sink.GetUpCount(),
+              std::to_string(sink.GetDownCount()) + " presses");
+
+        std::cout << "  reload (read + compile + write image + bake + publish): " << (writerNs / 1000.0 / reloads)
+                  << " us on the watcher thread, switch on the mapping thread: "
+                  << (switchNs / 1000.0 / rounds) << " us" << std::endl;
+
+        std::remove(sourcePath.c_str());
+        std::remove(imagePath.c_str());
+        return passed;
+    }
+
+    /**
+     * Replay recorded frames through a mapper set up by setup, fastest of a few passes
+     * @return Nanoseconds per frame (ApplySnapshot + Update)
+     */
+    template <typename Setup>
+    double TimeReplay(Setup setup, const std::vector<PadSnapshot>& frames, uint64_t& keyEvents)
+    {
+        double best = 0.0;
+        for (int pass = 0; pass < 3; ++pass)
+        {
+            RecordingOutputSink sink(false);
+            PadDevice pad;
+            Mapper mapper;
+            mapper.Initialize(&pad, &sink);
+            setup(mapper);
+
+            auto start = std::chrono::steady_clock::now();
+            for (const PadSnapshot& snapshot : frames)
+            {
+                pad.ApplySnapshot(snapshot);
+                mapper.Update(snapshot.timestampNs);
+            }
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            mapper.ReleaseAllOutputs();
+
+            double perFrame = seconds * 1e9 / static_cast<double>(frames.size());
+            best = (pass == 0 || perFrame < best) ? perFrame : best;
+            keyEvents = sink.GetKeyEventCount();
+        }
+        return best;
+    }
+
+    /**
+     * Built-in profile: the compile-time generated button stage against the table-driven one
+     * @return false if they produce different output
+     */
+    bool BenchStatic(uint32_t iterations)
+    {
+        bool passed = true;
+        std::cout << "Built-in profile, static vs. table-driven stage:" << std::endl;
+
+        Profile witcher = Profile::CreateWitcher();
+        auto useStatic = [](Mapper& mapper) { mapper.SetStaticProfile<WitcherProfile>(); };
+        auto useTable = [&witcher](Mapper& mapper) { mapper.SetProfile(witcher); };
+
+        Mapper mapper;
+        bool defaultStatic = mapper.IsStaticProfile();
+        mapper.SetBindings(witcher.buttons);
+        bool tableAfterBindings = !mapper.IsStaticProfile();
+        mapper.SetStaticProfile<WitcherProfile>();
+        Check(passed, "static stage by default, table stage after SetBindings", defaultStatic && tableAfterBindings && mapper.IsStaticProfile(), "");
+
+        RecordingOutputSink staticEvents;
+        RecordingOutputSink tableEvents;
+        MapRandomPads(useStatic, iterations * 10, staticEvents);
+        MapRandomPads(useTable, iterations * 10, tableEvents);
+        Check(passed, "static output == table-driven output", staticEvents.Matches(tableEvents),
+              std::to_string(tableEvents.GetEvents().size()) + " events from " + std::to_string(iterations * 10) + " random frames");
+
+        // Recorded 1 kHz input: random sticks and triggers, buttons changing every frame;
+        // then the same buttons with the sticks and triggers at rest, so the button stage dominates
+        std::vector<PadSnapshot> frames(static_cast<size_t>(iterations) * 50);
+        uint32_t seed = 11;
+        for (size_t i = 0; i < frames.size(); ++i)
+        {
+            frames[i] = MakeRandomPad(seed, static_cast<uint32_t>(i + 1));
+            seed = seed * 1103515245u + 12345u;
+            frames[i].connected = 1;
+            frames[i].pad.buttons = static_cast<uint16_t>(seed >> 16);
+            frames[i].timestampNs = static_cast<uint64_t>(i) * 1000000ULL;
+        }
+        std::vector<PadSnapshot> buttonFrames = frames;
+        for (PadSnapshot& snapshot : buttonFrames)
+        {
+            uint16_t buttons = snapshot.pad.buttons;
+            snapshot.pad = PadState();
+            snapshot.pad.buttons = buttons;
+        }
+
+        const std::pair<const char*, const std::vector<PadSnapshot>*> traces[] =
+        {
+            { "random pads", &frames },
+            { "buttons only", &buttonFrames },
+        };
+        for (const auto& trace : traces)
+        {
+            uint64_t staticKeys = 0;
+            uint64_t tableKeys = 0;
+            double staticNs = TimeReplay(useStatic, *trace.second, staticKeys);
+            double tableNs = TimeReplay(useTable, *trace.second, tableKeys);
+            std::cout << "  " << trace.first << ", " << trace.second->size() << " frames: table " << tableNs
+                      << " ns/frame, static " << staticNs << " ns/frame (" << (tableNs / staticNs) << "x)" << std::endl;
+            Check(passed, std::string(trace.first) + " key events equal", staticKeys == tableKeys, std::to_string(tableKeys) + " key events");
+        }
+        return passed;
+    }
+
+    /**
+     * Synthetic gameplay at 1 kHz, one input moving per packet: walking with
+     * the left stick, panning the camera, trigger pulls, button presses, and a
+     * pad disconnect two thirds in
+     */
+    std::vector<PadSnapshot> MakeGameplayTrace(size_t frames)
+    {
+        std::vector<PadSnapshot> trace(frames);
+        uint32_t seed = 23;
+        PadState pad = {};
+        for (size_t i = 0; i < frames; ++i)
+        {
+            seed = seed * 1103515245u + 12345u;
+            uint32_t pick = (seed >> 16) % 100;
+            int32_t step = static_cast<int32_t>((seed >> 8) % 2001) - 1000;
+            auto move = [step](int16_t& axis)
+            {
+                int32_t value = axis + step * 8;
+                axis = static_cast<int16_t>(value > 32767 ? 32767 : (value < -32768 ? -32768 : value));
+            };
+
+            if (pick < 45)
+            {
+                move((pick & 1) ? pad.thumbLX : pad.thumbLY);
+            }
+            else if (pick < 80)
+            {
+                move((pick & 1) ? pad.thumbRX : pad.thumbRY);
+            }
+            else if (pick < 90)
+            {
+                uint8_t& trigger = (pick & 1) ? pad.leftTrigger : pad.rightTrigger;
+                trigger = static_cast<uint8_t>(trigger > 128 ? trigger - (seed >> 24) / 2 : trigger + (seed >> 24) / 2);
+            }
+            else
+            {
+                pad.buttons ^= static_cast<uint16_t>(1u << ((seed >> 20) % PadButton::COUNT));
+            }
+
+            trace[i].timestampNs = static_cast<uint64_t>(i) * 1000000ULL;
+            trace[i].packetNumber = static_cast<uint32_t>(i + 1);
+            trace[i].connected = (i == frames * 2 / 3) ? 0 : 1;
+            trace[i].pad = pad;
+        }
+        return trace;
+    }
+
+    /**
+     * Map a trace like GamepadReplay does (outputs released while the pad is disconnected)
+     * @param incremental Mapper::SetIncrementalEvaluation()
+     * @param profile Table-driven profile, or nullptr for the built-in static one
+     * @param evaluatedPerFrame Receives the bindings evaluated per frame that ran the stages
+     * @return Nanoseconds per snapshot
+     */
+    double MapTrace(const std::vector<PadSnapshot>& trace, bool incremental, const Profile* profile,
+                    IOutputSink& sink, double& evaluatedPerFrame, int& indexed)
+    {
+        PadDevice pad;
+        Mapper mapper;
+        mapper.Initialize(&pad, &sink);
+        if (profile)
+        {
+            mapper.SetProfile(*profile);
+        }
+        mapper.SetIncrementalEvaluation(incremental);
+
+        auto start = std::chrono::steady_clock::now();
+        for (const PadSnapshot& snapshot : trace)
+        {
+            bool wasConnected = pad.IsConnected();
+            pad.ApplySnapshot(snapshot);
+            if (!pad.IsConnected())
+            {
+                if (wasConnected)
+                {
+                    mapper.ReleaseAllOutputs();
+                }
+                continue;
+            }
+            mapper.Update(snapshot.timestampNs);
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        mapper.ReleaseAllOutputs();
+
+        unsigned long long mapped = mapper.GetFrameCount() - mapper.GetSkippedFrameCount();
+        evaluatedPerFrame = mapped ? static_cast<double>(mapper.GetEvaluatedBindingCount()) / static_cast<double>(mapped) : 0.0;
+        indexed = mapper.GetIndexedBindingCount();
+        return seconds * 1e9 / static_cast<double>(trace.size());
+    }
+
+    /**
+     * Read a recorded trace (--record) into snapshots
+     */
+    bool ReadTrace(const std::string& path, std::vector<PadSnapshot>& trace)
+    {
+        TraceReader reader;
+        if (!reader.Open(path.c_str()))
+        {
+            return false;
+        }
+        trace.resize(reader.GetRecordCount());
+        for (size_t i = 0; i < trace.size(); ++i)
+        {
+            const PadTrace::Record& record = reader.GetRecord(i);
+            trace[i].timestampNs = record.timestampNs;
+            trace[i].packetNumber = record.packetNumber;
+            trace[i].connected = record.connected;
+            trace[i].pad.buttons = record.buttons;
+            trace[i].pad.leftTrigger = record.leftTrigger;
+            trace[i].pad.rightTrigger = record.rightTrigger;
+            trace[i].pad.thumbLX = record.thumbLX;
+            trace[i].pad.thumbLY = record.thumbLY;
+            trace[i].pad.thumbRX = record.thumbRX;
+            trace[i].pad.thumbRY = record.thumbRY;
+        }
+        return true;
+    }
+
+    /**
+     * Incremental binding evaluation against evaluating every binding, on gameplay traces
+     * @param tracePaths Recorded traces to replay as well (--trace)
+     * @return false if the two produce different output
+     */
+    bool BenchIncremental(uint32_t iterations, const std::vector<std::string>& tracePaths)
+    {
+        bool passed = true;
+        std::cout << "Incremental binding evaluation:" << std::endl;
+
+        // Random pads change every input every frame: the same output, nothing to skip
+        Profile witcher = Profile::CreateWitcher();
+        RecordingOutputSink fullRandom;
+        RecordingOutputSink incrementalRandom;
+        MapRandomPads([&witcher](Mapper& mapper) { mapper.SetProfile(witcher); mapper.SetIncrementalEvaluation(false); },
+                      iterations * 10, fullRandom);
+        MapRandomPads([&witcher](Mapper& mapper) { mapper.SetProfile(witcher); }, iterations * 10, incrementalRandom);
+        Check(passed, "random pads, incremental output == full output", incrementalRandom.Matches(fullRandom),
+              std::to_string(fullRandom.GetEvents().size()) + " events");
+
+        std::vector<std::pair<std::string, std::vector<PadSnapshot>>> traces;
+        traces.emplace_back("synthetic gameplay", MakeGameplayTrace(static_cast<size_t>(iterations) * 30));
+        for (const std::string& path : tracePaths)
+        {
+            traces.emplace_back(path, std::vector<PadSnapshot>());
+            if (!ReadTrace(path, traces.back().second) || traces.back().second.empty())
+            {
+                Check(passed, "read " + path, false, "");
+                traces.pop_back();
+            }
+        }
+
+        for (const auto& trace : traces)
+        {
+            for (const Profile* profile : { static_cast<const Profile*>(nullptr), static_cast<const Profile*>(&witcher) })
+            {
+                const char* stage = profile ? "table" : "static";
+                RecordingOutputSink fullEvents;
+                RecordingOutputSink incrementalEvents;
+                double fullPerFrame = 0.0;
+                double incrementalPerFrame = 0.0;
+                int indexed = 0;
+                MapTrace(trace.second, false, profile, fullEvents, fullPerFrame, indexed);
+                MapTrace(trace.second, true, profile, incrementalEvents, incrementalPerFrame, indexed);
+                Check(passed, trace.first + " (" + stage + "), incremental output == full output", incrementalEvents.Matches(fullEvents),
+                      std::to_string(fullEvents.GetEvents().size()) + " events from " + std::to_string(trace.second.size()) + " snapshots");
+
+                // Time without the event log
+                RecordingOutputSink fullSink(false);
+                RecordingOutputSink incrementalSink(false);
+                double fullNs = MapTrace(trace.second, false, profile, fullSink, fullPerFrame, indexed);
+                double incrementalNs = MapTrace(trace.second, true, profile, incrementalSink, incrementalPerFrame, indexed);
+                std::cout << "    bindings evaluated per mapped frame: " << fullPerFrame << " full, " << incrementalPerFrame
+                          << " incremental (" << indexed << " indexed); " << fullNs << " vs " << incrementalNs << " ns/snapshot" << std::endl;
+            }
+        }
+        return passed;
+    }
+
+    /**
+     * Reference combo matcher: every combo against the presses since the last completed combo
+     * Same rules as ComboRecognizer: the longest combo wins, then the first defined,
+     * and a completed combo consumes its presses.
+     */
+    class NaiveComboMatcher
+    {
+    public:
+        explicit NaiveComboMatcher(const std::vector<ComboDefinition>& combos) : m_combos(combos) {}
+
+        int Press(int button, uint64_t timestampNs)
+        {
+            if (m_presses.size() == static_cast<size_t>(ComboDefinition::MAX_PRESSES))
+            {
+                m_presses.erase(m_presses.begin());
+            }
+            m_presses.push_back(InputHistory::Press{ timestampNs, static_cast<uint8_t>(button) });
+
+            int best = ComboRecognizer::NO_COMBO;
+            for (size_t i = 0; i < m_combos.size(); ++i)
+            {
+                const ComboDefinition& combo = m_combos[i];
+                if (combo.pressCount > m_presses.size() ||
+                    (best != ComboRecognizer::NO_COMBO && combo.pressCount <= m_combos[best].pressCount))
+                {
+                    continue;
+                }
+                size_t first = m_presses.size() - combo.pressCount;
+                bool matched = true;
+                for (int press = 0; matched && press < combo.pressCount; ++press)
+                {
+                    const InputHistory::Press& current = m_presses[first + press];
+                    matched = current.button == combo.buttons[press] &&
+                              (press == 0 || current.timestampNs - m_presses[first + press - 1].timestampNs <=
+                                             combo.windowMs[press] * 1000000ULL);
+                }
+                best = matched ? static_cast<int>(i) : best;
+            }
+            if (best != ComboRecognizer::NO_COMBO)
+            {
+                m_presses.clear();
+            }
+            return best;
+        }
+
+    private:
+        const std::vector<ComboDefinition>& m_combos;
+        std::vector<InputHistory::Press> m_presses;
+    };
+
+    /**
+     * Random combos of 2 to 6 presses over six buttons, so they share prefixes and suffixes
+     */
+    std::vector<ComboDefinition> MakeRandomCombos(size_t count, uint32_t& seed)
+    {
+        const uint8_t buttons[] = { 0, 1, 2, 3, 12, 14 };   // D-pad up/down/left/right, A, X
+        std::vector<ComboDefinition> combos(count);
+        for (ComboDefinition& combo : combos)
+        {
+            seed = seed * 1103515245u + 12345u;
+            combo = ComboDefinition();
+            combo.pressCount = static_cast<uint8_t>(2 + (seed >> 16) % 5);
+            for (int press = 0; press < combo.pressCount; ++press)
+            {
+                seed = seed * 1103515245u + 12345u;
+                combo.buttons[press] = buttons[(seed >> 16) % 6];
+                combo.windowMs[press] = (press > 0) ? static_cast<uint16_t>(100 + (seed >> 8) % 300) : 0;
+            }
+            combo.action.stepCount = 1;
+            combo.action.steps[0] = MacroStep::Key('K', 30, 20);
+        }
+        return combos;
+    }
+
+    /**
+     * Random press edges over the same six buttons: mostly quick presses, some slow ones,
+     * and every fifth run a combo played within its windows
+     */
+    std::vector<InputHistory::Press> MakeRandomPresses(const std::vector<ComboDefinition>& combos, size_t count, uint32_t& seed)
+    {
+        const uint8_t buttons[] = { 0, 1, 2, 3, 12, 14 };
+        std::vector<InputHistory::Press> presses;
+        presses.reserve(count + ComboDefinition::MAX_PRESSES);
+        uint64_t nowNs = 0;
+        while (presses.size() < count)
+        {
+            seed = seed * 1103515245u + 12345u;
+            if ((seed >> 16) % 5 == 0)
+            {
+                const ComboDefinition& combo = combos[(seed >> 8) % combos.size()];
+                for (int press = 0; press < combo.pressCount; ++press)
+                {
+                    seed = seed * 1103515245u + 12345u;
+                    nowNs += (press == 0 ? 500 : (seed >> 16) % (combo.windowMs[press] + 1u)) * 1000000ULL;
+                    presses.push_back(InputHistory::Press{ nowNs, combo.buttons[press] });
+                }
+                continue;
+            }
+            seed = seed * 1103515245u + 12345u;
+            uint32_t gapMs = ((seed >> 16) % 10 < 7) ? (seed >> 8) % 250 : 250 + (seed >> 8) % 750;
+            nowNs += gapMs * 1000000ULL;
+            presses.push_back(InputHistory::Press{ nowNs, buttons[(seed >> 20) % 6] });
+        }
+        return presses;
+    }
+
+    /**
+     * Combos: the automaton against a naive matcher on random press streams, the cost per
+     * press edge against the number of combos, and the shipped sign combos through the mapper
+     * @return false if the automaton and the naive matcher disagree or a timeline differs
+     */
+    bool BenchCombos(uint32_t iterations)
+    {
+        bool passed = true;
+        std::cout << "Combos:" << std::endl;
+
+        uint32_t seed = 11;
+        for (size_t comboCount : { static_cast<size_t>(16), static_cast<size_t>(128), static_cast<size_t>(512) })
+        {
+            std::vector<ComboDefinition> combos = MakeRandomCombos(comboCount, seed);
+            std::vector<InputHistory::Press> presses = MakeRandomPresses(combos, static_cast<size_t>(iterations) * 100, seed);
+            ComboAutomaton automaton;
+            automaton.Compile(combos.data(), combos.size());
+
+            // Same combo on every press edge, and no allocation while matching
+            ComboRecognizer recognizer;
+            NaiveComboMatcher naive(combos);
+            size_t mismatches = 0;
+            size_t completed = 0;
+            uint64_t allocations = 0;
+            for (const InputHistory::Press& press : presses)
+            {
+                uint64_t allocationsBefore = GetThreadAllocationCount();
+                int combo = recognizer.Press(automaton, press.button, press.timestampNs);
+                allocations += GetThreadAllocationCount() - allocationsBefore;
+                mismatches += (combo != naive.Press(press.button, press.timestampNs)) ? 1 : 0;
+                completed += (combo != ComboRecognizer::NO_COMBO) ? 1 : 0;
+            }
+            Check(passed, std::to_string(comboCount) + " combos, automaton == naive matcher", mismatches == 0 && completed > 0,
+                  std::to_string(presses.size()) + " presses, " + std::to_string(completed) + " combos completed, " +
+                  std::to_string(mismatches) + " mismatches");
+            Check(passed, std::to_string(comboCount) + " combos, no allocation per press", allocations == 0, "");
+
+            // Time without the checks
+            ComboRecognizer timedRecognizer;
+            int64_t checksum = 0;
+            auto start = std::chrono::steady_clock::now();
+            for (const InputHistory::Press& press : presses)
+            {
+                checksum += timedRecognizer.Press(automaton, press.button, press.timestampNs);
+            }
+            double automatonNs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() * 1e9 /
+                                 static_cast<double>(presses.size());
+
+            NaiveComboMatcher timedNaive(combos);
+            start = std::chrono::steady_clock::now();
+            for (const InputHistory::Press& press : presses)
+            {
+                checksum += timedNaive.Press(press.button, press.timestampNs);
+            }
+            double naiveNs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() * 1e9 /
+                             static_cast<double>(presses.size());
+            std::cout << "    " << automaton.GetStateCount() << " states; " << automatonNs << " ns/press automaton, "
+                      << naiveNs << " ns/press naive (checksum " << checksum << ")" << std::endl;
+        }
+
+        // Shipped sign combos on a fake 200 Hz clock: D-pad down, down, X within 300 ms selects Igni (6) and casts
+        std::string signsText;
+        Profile signs;
+        ProfileCompiler compiler;
+        bool compiled = ReadFile(std::string(GAMEPADMAPPER_PROFILE_DIR) + "/witcher-signs.ini", signsText) &&
+                        compiler.Compile(signsText.data(), signsText.size(), signs);
+        Check(passed, "witcher-signs.ini compiles", compiled && signs.comboCount == 5, compiler.GetError());
+        Check(passed, "banner lists the combos",
+              Banner(signs).find("  D-Pad Down, D-Pad Down, X -> 6, Right Mouse Button (Igni)") != std::string::npos, "");
+
+        auto withSigns = [&signs](Mapper& mapper) { mapper.SetProfile(signs); };
+        Expect(passed, "Igni", RunTimeline(withSigns, { { PadButton::DPadDown, 0, 40 }, { PadButton::DPadDown, 100, 140 }, { PadButton::X, 200, 240 } }, 5, 400),
+                 "0:0xBB+ | 40:0xBB- | 100:0xBB+ | 140:0xBB- | 200:6+ 200:M0+ | 230:6- | 240:M0- | 250:M1+ | 280:M1-");
+        Expect(passed, "Igni too slow", RunTimeline(withSigns, { { PadButton::DPadDown, 0, 40 }, { PadButton::DPadDown, 100, 140 }, { PadButton::X, 450, 490 } }, 5, 600),
+                 "0:0xBB+ | 40:0xBB- | 100:0xBB+ | 140:0xBB- | 450:M0+ | 490:M0-");
+        Expect(passed, "Axii (longest combo wins)",
+                 RunTimeline(withSigns, { { PadButton::DPadUp, 0, 40 }, { PadButton::DPadUp, 100, 140 }, { PadButton::DPadUp, 200, 240 },
+                                          { PadButton::X, 300, 340 } }, 5, 500),
+                 "0:0xBD+ | 40:0xBD- | 100:0xBD+ | 140:0xBD- | 200:0xBD+ | 240:0xBD- | 300:9+ 300:M0+ | 330:9- | 340:M0- | 350:M1+ | 380:M1-");
+        Expect(passed, "Aard (Axii's last window missed)",
+                 RunTimeline(withSigns, { { PadButton::DPadUp, 0, 40 }, { PadButton::DPadUp, 100, 140 }, { PadButton::DPadUp, 200, 240 },
+                                          { PadButton::X, 400, 440 } }, 5, 600),
+                 "0:0xBD+ | 40:0xBD- | 100:0xBD+ | 140:0xBD- | 200:0xBD+ | 240:0xBD- | 400:5+ 400:M0+ | 430:5- | 440:M0- | 450:M1+ | 480:M1-");
+        return passed;
+    }
+
+    /**
+     * Binding layers: the shipped layer profile's timelines on a fake clock, keys held
+     * across layer switches, allocation, and the cost of a switch
+     * @return false if any check fails
+     */
+    bool BenchLayers(uint32_t iterations)
+    {
+        bool passed = true;
+        std::cout << "Layers:" << std::endl;
+
+        std::string layersText;
+        Profile layers;
+        ProfileCompiler compiler;
+        bool compiled = ReadFile(std::string(GAMEPADMAPPER_PROFILE_DIR) + "/witcher-layers.ini", layersText) &&
+                        compiler.Compile(layersText.data(), layersText.size(), layers);
+        Check(passed, "witcher-layers.ini compiles", compiled && layers.layerCount == 2, compiler.GetError());
+        std::string banner = Banner(layers);
+        Check(passed, "banner lists the layers", banner.find("  Layer signs (hold LB):\n    A -> 5, Right Mouse Button (Aard)") != std::string::npos &&
+                                         banner.find("  Layer menu (toggle Back):\n") != std::string::npos &&
+                                         banner.find("    RB -> Nothing") != std::string::npos, "");
+
+        // Fake 200 Hz clock; Space = 0x20, Escape = 0x1B, Alt = 0x12
+        auto withLayers = [&layers](Mapper& mapper) { mapper.SetProfile(layers); };
+        Expect(passed, "A", RunTimeline(withLayers, { { PadButton::A, 100, 140 } }, 5, 300),
+                 "100:0x20+ | 140:0x20-");
+        Expect(passed, "LB held: A casts Aard",
+                 RunTimeline(withLayers, { { PadButton::LeftShoulder, 0, 300 }, { PadButton::A, 100, 140 } }, 5, 400),
+                 "100:5+ | 130:5- | 150:M1+ | 180:M1-");
+        Expect(passed, "Back toggles the menu on and off",
+                 RunTimeline(withLayers, { { PadButton::Back, 0, 40 }, { PadButton::A, 100, 140 }, { PadButton::Back, 200, 240 },
+                                           { PadButton::A, 300, 340 } }, 5, 400),
+                 "100:I+ | 140:I- | 300:0x20+ | 340:0x20-");
+        Expect(passed, "key held as the menu turns off",
+                 RunTimeline(withLayers, { { PadButton::Back, 0, 40 }, { PadButton::A, 100, 300 }, { PadButton::Back, 200, 240 } }, 5, 400),
+                 "100:I+ | 200:I- 200:0x20+ | 300:0x20-");
+        Expect(passed, "gesture hold ended by the menu",
+                 RunTimeline(withLayers, { { PadButton::B, 0, 500 }, { PadButton::Back, 300, 340 } }, 5, 600),
+                 "200:0x12+ | 300:0x12- 300:0x1B+ | 500:0x1B-");
+
+        // Random presses of every button, LB and Back included, each burst followed by a
+        // second with nothing pressed: then nothing may be held, whatever the layers did
+        ManualClock clock;
+        RecordingOutputSink sink(false);
+        PadDevice pad;
+        Mapper mapper;
+        mapper.Initialize(&pad, &sink);
+        mapper.SetProfile(layers);
+        PadSnapshot snapshot = {};
+        snapshot.connected = 1;
+        uint32_t seed = 23;
+        uint64_t frame = 0;
+        uint64_t stuckRounds = 0;
+        uint64_t allocations = 0;
+        for (uint32_t round = 0; round < iterations; ++round)
+        {
+            for (uint32_t step = 0; step < 230; ++step, ++frame)
+            {
+                clock.SleepUntil(frame * 5000000ULL);
+                if (step < 30 && step % 3 == 0)
+                {
+                    seed = seed * 1103515245u + 12345u;
+                    snapshot.pad.buttons = static_cast<uint16_t>(seed >> 16);
+                }
+                else if (step == 30)
+                {
+                    snapshot.pad.buttons = 0;
+                }
+                snapshot.timestampNs = clock.NowNanoseconds();
+                ++snapshot.packetNumber;
+
+                uint64_t allocationsBefore = GetThreadAllocationCount();
+                pad.ApplySnapshot(snapshot);
+                mapper.Update(clock.NowNanoseconds());
+                allocations += GetThreadAllocationCount() - allocationsBefore;
+            }
+            stuckRounds += sink.HoldsAnything() ? 1 : 0;
+        }
+        Check(passed, "nothing held after release", stuckRounds == 0,
+              std::to_string(mapper.GetLayerSwitchCount()) + " layer switches, " + std::to_string(stuckRounds) + " of " +
+              std::to_string(iterations) + " rounds stuck");
+        Check(passed, "no allocation per frame", allocations == 0, "");
+
+        // Random pads through the layers: the incremental path re-evaluates the rebound buttons
+        RecordingOutputSink fullRandom;
+        RecordingOutputSink incrementalRandom;
+        MapRandomPads([&layers](Mapper& m) { m.SetProfile(layers); m.SetIncrementalEvaluation(false); }, iterations * 10, fullRandom);
+        MapRandomPads(layers, iterations * 10, incrementalRandom);
+        Check(passed, "random pads, incremental output == full output", incrementalRandom.Matches(fullRandom),
+              std::to_string(fullRandom.GetEvents().size()) + " events");
+
+        // A switch recomposes only the rebound buttons; a frame without an activator edge costs one mask test
+        LayerStack stack;
+        stack.Configure(layers);
+        uint64_t rebound = 0;
+        uint32_t switches = iterations * 500;
+        auto start = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < switches; ++i)
+        {
+            uint32_t previous = (i & 1) ? PadButton::LeftShoulder : 0u;
+            for (uint32_t bits = stack.Update(previous, previous ^ PadButton::LeftShoulder); bits; bits &= bits - 1)
+            {
+                ++rebound;
+            }
+        }
+        double switchNs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() * 1e9 / switches;
+        std::cout << "    " << switchNs << " ns/switch, " << static_cast<double>(rebound) / switches << " buttons rebound per switch" << std::endl;
+        return passed;
+    }
+
+    /**
+     * Output reconciliation: desired states diffed into events, a limited event buffer,
+     * releasing everything, and keys held across a profile switch
+     * @return false if any check fails
+     */
+    bool BenchReconciler()
+    {
+        bool passed = true;
+        std::cout << "Reconciler:" << std::endl;
+
+        {
+            OutputReconciler reconciler;
+            OutputEvent events[16];
+            auto reconcile = [&reconciler, &events](OutputState& desired, size_t capacity)
+            {
+                return EventText(events, reconciler.Reconcile(desired, events, capacity));
+            };
+
+            OutputState desired;
+            desired.SetKey('Q');
+            desired.SetMouseButton(0);
+            Expect(passed, "first frame presses", reconcile(desired, 16), "Q+ M0+");
+            Expect(passed, "unchanged state emits nothing", reconcile(desired, 16), "");
+
+            // Ups go out before downs, taps after both, motion last
+            desired.Reset();
+            desired.SetKey('W');
+            desired.SetMouseButton(1);
+            desired.AddTap('E');
+            desired.AddMouseDelta(3, -2);
+            Expect(passed, "ups, downs, taps, motion", reconcile(desired, 16), "Q- M0- W+ M1+ E+ E- move(3,-2)");
+
+            desired.Reset();
+            desired.SetKey('W');
+            desired.SetMouseButton(1);
+            desired.AddTap('W');
+            Expect(passed, "tap of a held key skipped", reconcile(desired, 16), "");
+
+            // With room for two events per call, what did not fit goes out on the next calls
+            desired.Reset();
+            desired.SetKey('A');
+            desired.SetKey('B');
+            desired.SetKey('C');
+            std::string limited = reconcile(desired, 2);
+            limited += " | " + reconcile(desired, 2);
+            limited += " | " + reconcile(desired, 2);
+            limited += " | " + reconcile(desired, 2);
+            Expect(passed, "limited buffer resumes", limited, "W- M1- | A+ B+ | C+ | ");
+
+            Expect(passed, "release all", EventText(events, reconciler.ReleaseAll(events, 16)), "A- B- C-");
+            Expect(passed, "nothing left to release", EventText(events, reconciler.ReleaseAll(events, 16)), "");
+
+            // Events the sink did not take are produced again, taps and motion included
+            desired.Reset();
+            desired.SetKey('W');
+            desired.AddTap('E');
+            desired.AddMouseDelta(3, -2);
+            size_t count = reconciler.Reconcile(desired, events, 16);
+            reconciler.Rollback(desired, events, count, 1);
+            Expect(passed, "undelivered events resent", reconcile(desired, 16), "E+ E- move(3,-2)");
+
+            desired.AddTap('R');
+            desired.AddMouseDelta(1, 1);
+            count = reconciler.Reconcile(desired, events, 16);
+            reconciler.Rollback(desired, events, count, 1);
+            Expect(passed, "tap cut after its down released", reconcile(desired, 16), "R- move(1,1)");
+            reconcile(desired, 16);
+            reconciler.ReleaseAll(events, 16);
+
+            OutputState buttons;
+            bool lastAccepted = buttons.SetMouseButton(OutputState::MOUSE_BUTTON_COUNT - 1);
+            bool pastRejected = !buttons.SetMouseButton(OutputState::MOUSE_BUTTON_COUNT);
+            bool farRejected = !buttons.SetMouseButton(40);
+            Check(passed, "mouse button out of range rejected", lastAccepted && pastRejected && farRejected &&
+                  buttons.mouseButtons == (1u << (OutputState::MOUSE_BUTTON_COUNT - 1)), "");
+        }
+
+        // A key held under the old profile is released when the new profile maps the
+        // button to another key; the new key goes down in the same batch
+        {
+            Profile first = Profile::CreateEmpty();
+            first.buttons.BindKey(PadButton::A, 'Q');
+            first.buttons.BindMouseButton(PadButton::B, 0);
+            Profile second = Profile::CreateEmpty();
+            second.buttons.BindKey(PadButton::A, 'W');
+
+            PadDevice pad;
+            RecordingOutputSink sink;
+            Mapper mapper;
+            mapper.Initialize(&pad, &sink);
+            mapper.SetProfile(first);
+
+            size_t logged = 0;
+            auto newEvents = [&sink, &logged]()
+            {
+                const std::vector<OutputEvent>& events = sink.GetEvents();
+                std::string text = EventText(events.data() + logged, events.size() - logged);
+                logged = events.size();
+                return text;
+            };
+
+            PadSnapshot snapshot = {};
+            snapshot.connected = 1;
+            snapshot.pad.buttons = PadButton::A | PadButton::B;
+            snapshot.packetNumber = 1;
+            pad.ApplySnapshot(snapshot);
+            mapper.Update(5000000);
+            Expect(passed, "held under the first profile", newEvents(), "Q+ M0+");
+
+            mapper.SetProfile(second);
+            pad.MarkUnchanged();
+            mapper.Update(10000000);
+            std::string switched = newEvents();
+            Expect(passed, "released after the switch", switched, "Q- M0- W+");
+
+            snapshot.pad.buttons = 0;
+            snapshot.packetNumber = 2;
+            pad.ApplySnapshot(snapshot);
+            mapper.Update(15000000);
+            Expect(passed, "new key released with the button", newEvents(), "W-");
+
+            // A release the sink drops goes out again on the next frame, even with the pad unchanged
+            snapshot.pad.buttons = PadButton::A;
+            snapshot.packetNumber = 3;
+            pad.ApplySnapshot(snapshot);
+            mapper.Update(20000000);
+            newEvents();
+            sink.SetAcceptLimit(0);
+            snapshot.pad.buttons = 0;
+            snapshot.packetNumber = 4;
+            pad.ApplySnapshot(snapshot);
+            mapper.Update(25000000);
+            std::string dropped = newEvents();
+            sink.SetAcceptLimit(SIZE_MAX);
+            pad.MarkUnchanged();
+            mapper.Update(30000000);
+            Expect(passed, "dropped release resent", dropped + " | " + newEvents(), " | W-");
+        }
+        return passed;
+    }
+
+    /**
+     * Frame batching: one submission per frame in enqueue order, early flushes of a full
+     * buffer, short writes, and the order of a mapper frame that changes everything at once
+     * @return false if any check fails
+     */
+    bool BenchBatch()
+    {
+        bool passed = true;
+        std::cout << "Batch:" << std::endl;
+
+        {
+            RecordingOutputSink sink;
+            OutputBatch batch;
+            batch.SetSink(&sink);
+            batch.BeginFrame();
+            batch.Enqueue(OutputEvent::KeyUp('Q'));
+            batch.Enqueue(OutputEvent::KeyDown('W'));
+            batch.Enqueue(OutputEvent::MouseMove(4, -1));
+            bool flushed = batch.Flush();
+            Check(passed, "one frame, one submission", flushed && batch.GetSubmitCount() == 1, "");
+            Expect(passed, "enqueue order kept", sink.GetText(), "Q- W+ move(4,-1)");
+
+            batch.BeginFrame();
+            flushed = batch.Flush();
+            Check(passed, "empty frame submits nothing", flushed && batch.GetSubmitCount() == 1, "");
+        }
+
+        {
+            // A full buffer goes out early; the rest follows in the same order
+            RecordingOutputSink sink;
+            OutputBatch batch;
+            batch.SetSink(&sink);
+            batch.BeginFrame();
+            const uint16_t eventCount = OutputBatch::CAPACITY + 6;
+            for (uint16_t i = 0; i < eventCount; ++i)
+            {
+                batch.Enqueue(OutputEvent::KeyDown(i));
+            }
+            batch.Flush();
+
+            bool inOrder = true;
+            uint16_t next = 0;
+            for (const OutputEvent& event : sink.GetEvents())
+            {
+                inOrder = inOrder && event.code == next++;
+            }
+            size_t firstSize = 0;
+            sink.GetSubmission(0, firstSize);
+            Check(passed, "full buffer flushed early", sink.GetSubmitCount() == 2 && firstSize == OutputBatch::CAPACITY &&
+                  inOrder && next == eventCount,
+                  std::to_string(sink.GetSubmitCount()) + " submissions, " + std::to_string(next) + " events");
+        }
+
+        {
+            RecordingOutputSink sink;
+            sink.SetAcceptLimit(1);
+            OutputBatch batch;
+            batch.SetSink(&sink);
+            batch.BeginFrame();
+            batch.Enqueue(OutputEvent::KeyDown('Q'));
+            batch.Enqueue(OutputEvent::KeyDown('W'));
+            bool shortFailed = !batch.Flush();
+            batch.BeginFrame();
+            batch.Enqueue(OutputEvent::KeyUp('Q'));
+            bool nextOk = batch.Flush();
+            Check(passed, "short write reported once", shortFailed && nextOk, "");
+        }
+
+        // The frame of the request that motivated batching: buttons released and pressed,
+        // the left stick diagonal, the right stick turning and LB tapping a key, all at once
+        {
+            Profile profile = Profile::CreateEmpty();
+            profile.buttons.BindKey(PadButton::A, 'Q');
+            profile.buttons.BindMouseButton(PadButton::X, 0);
+            profile.buttons.BindKey(PadButton::B, 'E');
+            profile.buttons.BindMouseButton(PadButton::Y, 1);
+            profile.buttons.BindKeySequence(PadButton::LeftShoulder, {'T'});
+            profile.analogKeys[static_cast<int>(AnalogKey::MoveForward)] = 'W';
+            profile.analogKeys[static_cast<int>(AnalogKey::MoveRight)] = 'D';
+
+            PadDevice pad;
+            RecordingOutputSink sink;
+            Mapper mapper;
+            mapper.Initialize(&pad, &sink);
+            mapper.SetProfile(profile);
+
+            PadSnapshot snapshot = {};
+            snapshot.connected = 1;
+            snapshot.pad.buttons = PadButton::A | PadButton::X;
+            snapshot.pad.thumbRX = 30000;
+            snapshot.timestampNs = 5000000;
+            snapshot.packetNumber = 1;
+            pad.ApplySnapshot(snapshot);
+            mapper.Update(snapshot.timestampNs);
+
+            snapshot.pad.buttons = PadButton::B | PadButton::Y | PadButton::LeftShoulder;
+            snapshot.pad.thumbLX = 30000;
+            snapshot.pad.thumbLY = 30000;
+            snapshot.timestampNs = 10000000;
+            snapshot.packetNumber = 2;
+            pad.ApplySnapshot(snapshot);
+            mapper.Update(snapshot.timestampNs);
+
+            bool twoBatches = (sink.GetSubmitCount() == 2);
+            std::string frame = twoBatches ? sink.GetSubmissionText(1) : sink.GetText();
+            const std::string expected = "Q- M0- D+ E+ W+ M1+ T+ T- move(";
+            const OutputEvent& last = sink.GetEvents().back();
+            bool ordered = twoBatches && frame.compare(0, expected.size(), expected) == 0 &&
+                           last.type == OutputEventType::MouseMove && last.deltaX > 0;
+            Check(passed, "ups, downs, taps, motion in one batch", ordered, frame);
+        }
+        return passed;
+    }
+
+    /**
+     * Injection backend in which each target window accepts a chosen set of methods;
+     * every attempt is logged and takes a fixed time per method on a fake clock
+     */
+    class FakeInjectionBackend : public IInjectionBackend
+    {
+    public:
+        static const int TARGET_COUNT = 4;
+
+        explicit FakeInjectionBackend(ManualClock& clock) : m_clock(clock), m_accepted() {}
+
+        /**
+         * Set the methods a target accepts (bit n: InjectionMethod n)
+         */
+        void Accept(uintptr_t target, uint32_t methods) { m_accepted[target % TARGET_COUNT] = methods; }
+
+        bool Inject(InjectionMethod method, uintptr_t target, uint16_t, bool) override
+        {
+            static const char names[] = "SVWK";
+            m_log += names[static_cast<int>(method)];
+            m_clock.SleepUntil(m_clock.NowNanoseconds() + LatencyNs(method));
+            return (m_accepted[target % TARGET_COUNT] & (1u << static_cast<int>(method))) != 0;
+        }
+
+        /**
+         * Get the methods tried since the last call ("S"can code, "V"irtual key, "W"indow messages, "K"eybd_event)
+         */
+        std::string TakeLog()
+        {
+            std::string log;
+            log.swap(m_log);
+            return log;
+        }
+
+        static uint64_t LatencyNs(InjectionMethod method) { return 1000ULL * (static_cast<int>(method) + 1); }
+
+    private:
+        ManualClock& m_clock;
+        uint32_t m_accepted[TARGET_COUNT];
+        std::string m_log;
+    };
+
+    /**
+     * Key injection method selection on a fake backend: probing order, caching per
+     * window, re-probing on failure, which methods may be batched, and the counters
+     * @return false if any check fails
+     */
+    bool BenchInjection()
+    {
+        bool passed = true;
+        std::cout << "Injection:" << std::endl;
+
+        const uint32_t virtualKey = 1u << static_cast<int>(InjectionMethod::VirtualKeyInput);
+        const uint32_t messages = 1u << static_cast<int>(InjectionMethod::WindowMessage);
+        const uint32_t keybdEvent = 1u << static_cast<int>(InjectionMethod::KeybdEvent);
+
+        ManualClock clock;
+        FakeInjectionBackend backend(clock);
+        InjectionStrategySelector selector(backend, clock);
+        backend.Accept(1, virtualKey | messages);
+        backend.Accept(2, messages);
+
+        Check(passed, "nothing cached before the first key", selector.GetMethodFor(1) == InjectionMethod::Count &&
+              !InjectionStrategySelector::IsSendInputMethod(selector.GetMethodFor(1)), "");
+
+        bool sent = selector.SendKey(1, 'Q', true);
+        std::string log = backend.TakeLog();
+        Check(passed, "probe stops at the first working method", sent && log == "SV" &&
+              selector.GetSelectedMethod() == InjectionMethod::VirtualKeyInput && selector.GetProbeCount() == 1, log);
+
+        sent = selector.SendKey(1, 'Q', false) && selector.SendKey(1, 'W', true) && selector.SendKey(1, 'W', false);
+        log = backend.TakeLog();
+        Check(passed, "cached method used alone", sent && log == "VVV" && selector.GetProbeCount() == 1, log);
+        Check(passed, "SendInput method batched", InjectionStrategySelector::IsSendInputMethod(selector.GetMethodFor(1)), "");
+
+        // Another window forgets the cache; window messages must not be batched
+        InjectionMethod other = selector.GetMethodFor(2);
+        sent = selector.SendKey(2, 'Q', true);
+        log = backend.TakeLog();
+        Check(passed, "new window probes again", other == InjectionMethod::Count && sent && log == "SVW" &&
+              selector.GetSelectedMethod() == InjectionMethod::WindowMessage && selector.GetProbeCount() == 2, log);
+        Check(passed, "window messages not batched", !InjectionStrategySelector::IsSendInputMethod(selector.GetMethodFor(2)), "");
+
+        // The cached method fails once: that event probes, and the next one uses the new method
+        backend.Accept(2, keybdEvent);
+        sent = selector.SendKey(2, 'Q', false) && selector.SendKey(2, 'W', true);
+        log = backend.TakeLog();
+        Check(passed, "failure re-probes", sent && log == "WSVWKK" &&
+              selector.GetSelectedMethod() == InjectionMethod::KeybdEvent && selector.GetProbeCount() == 3, log);
+
+        backend.Accept(2, 0);
+        sent = selector.SendKey(2, 'W', false);
+        log = backend.TakeLog();
+        Check(passed, "nothing works", !sent && log == "KSVWK" && !selector.HasSelection(), log);
+
+        selector.Invalidate();
+        Check(passed, "invalidate", selector.GetMethodFor(2) == InjectionMethod::Count, "");
+
+        const InjectionMethodStats& stats = selector.GetStats(InjectionMethod::VirtualKeyInput);
+        uint64_t latencyNs = FakeInjectionBackend::LatencyNs(InjectionMethod::VirtualKeyInput);
+        Check(passed, "counters", stats.attempts == 7 && stats.successes == 4 && stats.failures == 3 &&
+              stats.totalLatencyNs == 7 * latencyNs && stats.maxLatencyNs == latencyNs,
+              std::to_string(stats.attempts) + " attempts, " + std::to_string(stats.successes) + " successes");
+        return passed;
+    }
+
+    /**
+     * Closed until Open(): Wait() blocks the calling thread, like a window that stops answering
+     */
+    class Gate
+    {
+    public:
+        Gate() : m_open(false) {}
+
+        void Wait()
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_changed.wait(lock, [this]() { return m_open; });
+        }
+
+        void Open()
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_open = true;
+            }
+            m_changed.notify_all();
+        }
+
+    private:
+        std::mutex m_mutex;
+        std::condition_variable m_changed;
+        bool m_open;
+    };
+
+    /**
+     * Output thread: a frame loop submits through AsyncOutputSink while the target is
+     * blocked; every edge must arrive in order once it answers, motion must add up,
+     * short writes must be sent again, and Stop() must give up on a target that never answers
+     * Submission and stop times are reported, not checked.
+     * @return false if any check fails
+     */
+    bool BenchAsync()
+    {
+        bool passed = true;
+        std::cout << "Async output:" << std::endl;
+        auto toUs = [](std::chrono::steady_clock::duration duration)
+        {
+            return std::chrono::duration<double, std::micro>(duration).count();
+        };
+
+        const int frames = 100;
+        const int edgesPerFrame = 6;
+        auto submitFrames = [](AsyncOutputSink& async, bool withMotion, std::chrono::steady_clock::duration& slowest)
+        {
+            uint16_t code = 0;
+            for (int frame = 0; frame < frames; ++frame)
+            {
+                OutputEvent events[edgesPerFrame + 1];
+                for (int i = 0; i < edgesPerFrame; ++i)
+                {
+                    events[i] = OutputEvent::KeyDown(code++);
+                }
+                events[edgesPerFrame] = OutputEvent::MouseMove(1, -1);
+
+                auto start = std::chrono::steady_clock::now();
+                async.Submit(events, withMotion ? edgesPerFrame + 1 : edgesPerFrame);
+                slowest = std::max(slowest, std::chrono::steady_clock::now() - start);
+            }
+        };
+
+        // The target blocks in its first Submit() until every frame is submitted: the queue
+        // fills and the edges spill into the overflow list, and the frame loop never waits
+        {
+            Gate gate;
+            RecordingOutputSink target;
+            target.SetSubmitHook([&gate](const OutputEvent*, size_t) { gate.Wait(); });
+            AsyncOutputSink async(target);
+            async.SetStopTimeout(10000);
+            async.Start();
+
+            std::chrono::steady_clock::duration slowest(0);
+            submitFrames(async, true, slowest);
+            bool whileBlocked = (target.GetSubmitCount() == 0);
+            std::cout << "    submit while the target hangs: " << toUs(slowest) << " us slowest" << std::endl;
+            Check(passed, "frame loop runs while the target hangs", whileBlocked && async.GetOverflowedEventCount() > 0,
+                  std::to_string(async.GetOverflowedEventCount()) + " deferred, high water " + std::to_string(async.GetOverflowHighWater()));
+            gate.Open();
+            bool stopped = async.Stop();
+
+            bool inOrder = true;
+            uint16_t next = 0;
+            for (const OutputEvent& event : target.GetEvents())
+            {
+                if (event.type != OutputEventType::MouseMove)
+                {
+                    inOrder = inOrder && event.type == OutputEventType::KeyDown && event.code == next++;
+                }
+            }
+            Check(passed, "edges delivered in order", stopped && inOrder && next == frames * edgesPerFrame, std::to_string(next) + " edges");
+            Check(passed, "motion coalesced, not lost", target.GetMotionX() == frames && target.GetMotionY() == -frames &&
+                  async.GetCoalescedMoveCount() > 0, std::to_string(async.GetCoalescedMoveCount()) + " moves merged");
+            Check(passed, "nothing resent or discarded", async.GetShortWriteCount() == 0 && async.GetDiscardedEventCount() == 0 &&
+                  async.GetDeliveredEventCount() == target.GetEvents().size(), "");
+        }
+
+        // Queued before the worker starts, so they reach the target as one batch; what it
+        // does not take goes out again, alone, before anything newer
+        {
+            RecordingOutputSink partial;
+            partial.SetAcceptLimit(1);
+            AsyncOutputSink shortAsync(partial);
+            OutputEvent events[] = { OutputEvent::KeyDown('Q'), OutputEvent::KeyUp('Q'), OutputEvent::KeyDown('W'), OutputEvent::KeyUp('W') };
+            shortAsync.Submit(events, 4);
+            shortAsync.Start();
+            shortAsync.Stop();
+            Expect(passed, "short writes sent again", partial.GetText(), "Q+ | Q- | W+ | W-");
+            Check(passed, "short writes counted", shortAsync.GetShortWriteCount() == 3 && shortAsync.GetDeliveredEventCount() == 4 &&
+                  shortAsync.GetDiscardedEventCount() == 0, std::to_string(shortAsync.GetShortWriteCount()) + " short writes");
+        }
+
+        // A target that takes nothing for two calls, then recovers
+        {
+            RecordingOutputSink stalled;
+            stalled.SetAcceptLimit(0);
+            int calls = 0;
+            stalled.SetSubmitHook([&stalled, &calls](const OutputEvent*, size_t)
+            {
+                if (++calls == 3)
+                {
+                    stalled.SetAcceptLimit(SIZE_MAX);
+                }
+            });
+            AsyncOutputSink stalledAsync(stalled);
+            OutputEvent events[] = { OutputEvent::KeyDown('Q'), OutputEvent::KeyUp('Q') };
+            stalledAsync.Submit(events, 2);
+            stalledAsync.Start();
+            stalledAsync.Stop();
+            Expect(passed, "retried after the target recovers", EventText(stalled.GetEvents().data(), stalled.GetEvents().size()), "Q+ Q-");
+        }
+
+        // A target that never answers: Stop() gives up after its timeout, and everything
+        // it did not take is discarded once it returns
+        {
+            Gate gate;
+            RecordingOutputSink target;
+            target.SetSubmitHook([&gate](const OutputEvent*, size_t) { gate.Wait(); });
+            AsyncOutputSink async(target);
+            std::chrono::steady_clock::duration slowest(0);
+            submitFrames(async, false, slowest);
+            async.SetStopTimeout(50);
+            async.Start();
+
+            auto start = std::chrono::steady_clock::now();
+            bool stopped = async.Stop();
+            std::cout << "    stop with the target hung: " << toUs(std::chrono::steady_clock::now() - start) / 1000 << " ms (timeout 50 ms)" << std::endl;
+            Check(passed, "stop gives up on a hung target", !stopped, "");
+
+            gate.Open();
+            async.SetStopTimeout(10000);
+            stopped = async.Stop();
+            uint64_t submitted = frames * edgesPerFrame;
+            Check(passed, "rest discarded once it returns", stopped && async.GetDeliveredEventCount() > 0 &&
+                  async.GetDeliveredEventCount() + async.GetDiscardedEventCount() == submitted,
+                  std::to_string(async.GetDeliveredEventCount()) + " delivered, " + std::to_string(async.GetDiscardedEventCount()) + " discarded");
+        }
+        return passed;
+    }
+
+    /**
+     * Polled pad whose A button flips every togglePeriodNs of real time, so the
+     * moment each edge happened is known without asking the reader
+     */
+    class TogglingInputSource : public IInputSource
+    {
+    public:
+        explicit TogglingInputSource(uint64_t togglePeriodNs) : m_togglePeriodNs(togglePeriodNs), m_pressed(false), m_packetNumber(0) {}
+
+        bool Read(uint64_t timestampNs, PadSnapshot& snapshot) override
+        {
+            bool pressed = ((timestampNs / m_togglePeriodNs) & 1) != 0;
+            bool changed = (pressed != m_pressed) || m_packetNumber == 0;
+            m_pressed = pressed;
+            m_packetNumber += changed ? 1 : 0;
+
+            snapshot = PadSnapshot();
+            snapshot.timestampNs = timestampNs;
+            snapshot.packetNumber = m_packetNumber;
+            snapshot.connected = 1;
+            snapshot.pad.buttons = pressed ? PadButton::A : 0;
+            return changed;
+        }
+
+        /**
+         * Get the time of the edge a key event stands for: the last press (odd period)
+         * or release (even period) at or before nowNs
+         */
+        uint64_t GetEdgeTime(uint64_t nowNs, bool pressed) const
+        {
+            uint64_t period = nowNs / m_togglePeriodNs;
+            if (((period & 1) != 0) != pressed)
+            {
+                --period;
+            }
+            return period * m_togglePeriodNs;
+        }
+
+    private:
+        uint64_t m_togglePeriodNs;
+        bool m_pressed;
+        uint32_t m_packetNumber;
+    };
+
+    /**
+     * Poll-to-emit latency: a 1 kHz loop maps a pad whose button flips every 20 ms while a
+     * forwarding stage takes 8 ms per frame, once polling, mapping and forwarding in series
+     * (the old main loop) and once as main.cpp runs it: a poll thread, the snapshot ring, and a
+     * forwarder thread that takes the newest snapshot
+     * Latency percentiles are reported; only the edge counts are checked.
+     * @return false if any check fails
+     */
+    bool BenchLatency()
+    {
+        bool passed = true;
+        std::cout << "Latency:" << std::endl;
+
+        const uint32_t rateHz = 1000;
+        const uint64_t togglePeriodNs = 20000000;
+        const std::chrono::microseconds forwardTime(8000);
+        const uint64_t runNs = 2000000000;
+
+        Profile profile = Profile::CreateEmpty();
+        profile.buttons.BindKey(PadButton::A, 'Q');
+
+        auto report = [](const char* name, const LatencyHistogram& histogram)
+        {
+            std::cout << "    " << name << ": " << histogram.GetCount() << " edges, p50 " << histogram.GetPercentile(50) / 1000
+                      << " us, p90 " << histogram.GetPercentile(90) / 1000 << " us, p99 " << histogram.GetPercentile(99) / 1000
+                      << " us, max " << histogram.GetMax() / 1000 << " us" << std::endl;
+        };
+
+        // Serial: the next poll waits for the forwarder of the previous frame
+        LatencyHistogram serial;
+        {
+            SystemClock clock;
+            TogglingInputSource source(togglePeriodNs);
+            RecordingOutputSink sink(false);
+            sink.SetSubmitHook([&clock, &source, &serial](const OutputEvent* events, size_t count)
+            {
+                uint64_t nowNs = clock.NowNanoseconds();
+                for (size_t i = 0; i < count; ++i)
+                {
+                    if (events[i].type == OutputEventType::KeyDown || events[i].type == OutputEventType::KeyUp)
+                    {
+                        serial.Record(nowNs - source.GetEdgeTime(nowNs, events[i].type == OutputEventType::KeyDown));
+                    }
+                }
+            });
+            PadDevice pad;
+            Mapper mapper;
+            mapper.Initialize(&pad, &sink);
+            mapper.SetProfile(profile);
+
+            FrameScheduler scheduler(clock);
+            scheduler.Initialize(rateHz, OverrunPolicy::Skip);
+            scheduler.Start();
+            uint64_t endNs = clock.NowNanoseconds() + runNs;
+            while (clock.NowNanoseconds() < endNs)
+            {
+                PadSnapshot snapshot;
+                if (source.Read(clock.NowNanoseconds(), snapshot))
+                {
+                    pad.ApplySnapshot(snapshot);
+                }
+                else
+                {
+                    pad.MarkUnchanged();
+                }
+                mapper.Update(clock.NowNanoseconds());
+                std::this_thread::sleep_for(forwardTime);
+                scheduler.WaitForNextFrame();
+            }
+        }
+        report("serial", serial);
+
+        // Split: the poll thread publishes on its own schedule, the mapping loop walks the
+        // ring, and the forwarder reads the newest snapshot on a thread of its own
+        LatencyHistogram split;
+        {
+            SystemClock clock;
+            TogglingInputSource source(togglePeriodNs);
+            RecordingOutputSink sink(false);
+            sink.SetSubmitHook([&clock, &source, &split](const OutputEvent* events, size_t count)
+            {
+                uint64_t nowNs = clock.NowNanoseconds();
+                for (size_t i = 0; i < count; ++i)
+                {
+                    if (events[i].type == OutputEventType::KeyDown || events[i].type == OutputEventType::KeyUp)
+                    {
+                        split.Record(nowNs - source.GetEdgeTime(nowNs, events[i].type == OutputEventType::KeyDown));
+                    }
+                }
+            });
+            PadDevice pad;
+            Mapper mapper;
+            mapper.Initialize(&pad, &sink);
+            mapper.SetProfile(profile);
+
+            PadSnapshotRing ring;
+            PadSnapshotRing::Reader reader(ring);
+            InputPoller poller(ring, source);
+            std::atomic<bool> running(true);
+            std::thread forwarder([&ring, &running, forwardTime]()
+            {
+                PadSnapshot latest;
+                while (running.load())
+                {
+                    ring.ReadLatest(latest);
+                    std::this_thread::sleep_for(forwardTime);
+                }
+            });
+
+            poller.Start(rateHz);
+            FrameScheduler scheduler(clock);
+            scheduler.Initialize(rateHz, OverrunPolicy::Skip);
+            scheduler.Start();
+            uint64_t endNs = clock.NowNanoseconds() + runNs;
+            while (clock.NowNanoseconds() < endNs)
+            {
+                PadSnapshot snapshot;
+                bool received = false;
+                while (reader.Next(snapshot))
+                {
+                    received = true;
+                    pad.ApplySnapshot(snapshot);
+                    mapper.Update(snapshot.timestampNs);
+                }
+                if (!received)
+                {
+                    pad.MarkUnchanged();
+                    mapper.Update(clock.NowNanoseconds());
+                }
+                scheduler.WaitForNextFrame();
+            }
+            poller.Stop();
+            running.store(false);
+            forwarder.join();
+        }
+        report("split", split);
+
+        // Each run sees about one edge per toggle period. The percentiles depend on the
+        // machine's scheduling, so they are reported, not checked.
+        uint64_t expectedEdges = runNs / togglePeriodNs;
+        Check(passed, "edges mapped, serial", serial.GetCount() >= expectedEdges / 2,
+              std::to_string(serial.GetCount()) + " of ~" + std::to_string(expectedEdges));
+        Check(passed, "edges mapped, split", split.GetCount() >= expectedEdges / 2,
+              std::to_string(split.GetCount()) + " of ~" + std::to_string(expectedEdges));
+        std::cout << "    split p50/p90 vs. serial: " << split.GetPercentile(50) / 1000 << "/" << split.GetPercentile(90) / 1000
+                  << " us vs. " << serial.GetPercentile(50) / 1000 << "/" << serial.GetPercentile(90) / 1000 << " us" << std::endl;
+        return passed;
+    }
+
+    /**
+     * Pad slot whose connection and buttons are scripted; logs when it was read
+     */
+    class ScriptedPadSource : public IInputSource
+    {
+    public:
+        ScriptedPadSource() : m_connected(false), m_buttons(0), m_packetNumber(1) {}
+
+        void SetConnected(bool connected) { m_connected = connected; ++m_packetNumber; }
+        void SetButtons(uint16_t buttons) { m_buttons = buttons; ++m_packetNumber; }
+
+        bool Read(uint64_t timestampNs, PadSnapshot& snapshot) override
+        {
+            m_readTimes.push_back(timestampNs);
+            snapshot = PadSnapshot();
+            snapshot.timestampNs = timestampNs;
+            snapshot.packetNumber = m_packetNumber;
+            snapshot.connected = m_connected ? 1 : 0;
+            snapshot.pad.buttons = m_buttons;
+            return true;
+        }
+
+        /**
+         * Get the read times (ms) from fromMs on, separated by spaces
+         */
+        std::string GetReadTimes(uint64_t fromMs = 0) const
+        {
+            std::string text;
+            for (uint64_t timeNs : m_readTimes)
+            {
+                if (timeNs >= fromMs * 1000000ULL)
+                {
+                    text += (text.empty() ? "" : " ") + std::to_string(timeNs / 1000000ULL);
+                }
+            }
+            return text;
+        }
+
+        size_t GetReadCount() const { return m_readTimes.size(); }
+
+    private:
+        bool m_connected;
+        uint16_t m_buttons;
+        uint32_t m_packetNumber;
+        std::vector<uint64_t> m_readTimes;
+    };
+
+    /**
+     * Hotplug on a fake clock: DeviceWatcher probes four scripted slots the way its thread
+     * does, while a 200 Hz loop reads HotplugInputSource into a mapper the way main.cpp
+     * does. A pad plugs into slot 2, is claimed, disconnects with a key held and comes back.
+     * @return false if any check fails
+     */
+    bool BenchHotplug()
+    {
+        bool passed = true;
+        std::cout << "Hotplug (fake clock):" << std::endl;
+
+        ManualClock clock;
+        DeviceWatcher watcher(clock);
+        ScriptedPadSource slots[DeviceWatcher::MAX_SLOTS];
+        for (int i = 0; i < DeviceWatcher::MAX_SLOTS; ++i)
+        {
+            watcher.SetSlot(i, &slots[i]);
+        }
+        HotplugInputSource padSource(watcher);
+
+        Profile profile = Profile::CreateEmpty();
+        profile.buttons.BindKey(PadButton::A, 'Q');
+        PadDevice pad;
+        RecordingOutputSink sink;
+        Mapper mapper;
+        mapper.Initialize(&pad, &sink);
+        mapper.SetProfile(profile);
+
+        const uint64_t frameNs = 5000000ULL;
+        const uint64_t watcherIdleNs = 50000000ULL;    // Longest sleep of the watcher thread
+        uint64_t watcherWakeNs = 0;
+        bool padConnected = false;
+        uint64_t foundMs = 0;
+        int activeAfterProbe = -2;
+        int activeAfterRead = -2;
+        auto runUntil = [&](uint64_t endMs)
+        {
+            while (clock.NowNanoseconds() < endMs * 1000000ULL)
+            {
+                uint64_t now = clock.NowNanoseconds();
+
+                // Watcher thread: probe, then sleep until the next due probe
+                if (now >= watcherWakeNs)
+                {
+                    uint64_t due = watcher.Probe();
+                    watcherWakeNs = (due != 0 && due < now + watcherIdleNs) ? due : now + watcherIdleNs;
+                    if (due == 0 && !padConnected)
+                    {
+                        foundMs = now / 1000000ULL;
+                        activeAfterProbe = watcher.GetActiveSlot();
+                    }
+                }
+
+                // Main loop
+                PadSnapshot snapshot;
+                if (padSource.Read(now, snapshot))
+                {
+                    pad.ApplySnapshot(snapshot);
+                }
+                else
+                {
+                    pad.MarkUnchanged();
+                }
+                if (pad.IsConnected() != padConnected)
+                {
+                    padConnected = pad.IsConnected();
+                    activeAfterRead = watcher.GetActiveSlot();
+                    if (!padConnected)
+                    {
+                        mapper.ReleaseAllOutputs();
+                    }
+                }
+                if (padConnected)
+                {
+                    mapper.Update(now);
+                }
+
+                clock.SleepUntil(now + frameNs);
+            }
+        };
+        auto onlyProbed = [&](int slot)
+        {
+            return slots[slot].GetReadCount() == watcher.GetProbeCount(slot);
+        };
+
+        // Nothing plugged in: every slot is probed at 0, 50, 150, 350 ... ms, backing off to 2 s
+        runUntil(10000);
+        bool backoff = true;
+        for (int i = 0; i < DeviceWatcher::MAX_SLOTS; ++i)
+        {
+            backoff = backoff && slots[i].GetReadTimes() == "0 50 150 350 750 1550 3150 5150 7150 9150";
+        }
+        Check(passed, "empty slots back off 50 ms to 2 s", backoff && watcher.GetBackoffNanoseconds(0) == DeviceWatcher::MAX_BACKOFF_NS,
+              slots[0].GetReadTimes());
+        Check(passed, "main loop never probes an empty slot", !padConnected && padSource.GetSlot() == -1 &&
+              onlyProbed(0) && onlyProbed(1) && onlyProbed(2) && onlyProbed(3), "");
+
+        // Plugged in at 10 s: the next probe of slot 2 finds it, the main loop claims it in the same frame
+        slots[2].SetConnected(true);
+        runUntil(12000);
+        Check(passed, "found by the next probe", foundMs == 11150, std::to_string(foundMs) + " ms");
+        Check(passed, "searching, found, then active", activeAfterProbe == -1 && activeAfterRead == 2 &&
+              watcher.GetActiveSlot() == 2 && padSource.GetSlot() == 2,
+              "active " + std::to_string(activeAfterProbe) + " after the probe, " + std::to_string(activeAfterRead) + " after the claim");
+
+        // In use: slot 2 is read every frame, the empty slots are left alone
+        size_t emptyReads = slots[0].GetReadCount() + slots[1].GetReadCount() + slots[3].GetReadCount();
+        size_t padReads = slots[2].GetReadCount();
+        slots[2].SetButtons(PadButton::A);
+        runUntil(13000);
+        Check(passed, "no probing while a pad is active",
+              slots[0].GetReadCount() + slots[1].GetReadCount() + slots[3].GetReadCount() == emptyReads &&
+              slots[2].GetReadCount() == padReads + 200,
+              std::to_string(slots[2].GetReadCount() - padReads) + " reads of slot 2 in 1 s");
+        Expect(passed, "mapped while active", sink.GetText(), "Q+");
+
+        // Unplugged with A held: everything is released and the search restarts with the backoff reset
+        slots[2].SetConnected(false);
+        runUntil(13500);
+        Expect(passed, "released on disconnect", sink.GetText(), "Q+ | Q-");
+        Check(passed, "slot given back", !padConnected && watcher.GetActiveSlot() == -1 && padSource.GetSlot() == -1, "");
+        Expect(passed, "backoff reset on disconnect", slots[0].GetReadTimes(13000), "13050 13100 13200 13400");
+
+        // Back in with A still held: claimed again and mapping resumes
+        slots[2].SetConnected(true);
+        runUntil(15000);
+        Check(passed, "claimed again", padConnected && foundMs == 13800 && watcher.GetActiveSlot() == 2,
+              "found at " + std::to_string(foundMs) + " ms");
+        Expect(passed, "mapping resumes on reconnect", sink.GetText(), "Q+ | Q- | Q+");
+        Check(passed, "empty slots still only probed", onlyProbed(0) && onlyProbed(1) && onlyProbed(3), "");
+        return passed;
+    }
+
+    /**
+     * Right-stick segment of a synthetic camera trace
+     */
+    struct StickSegment
+    {
+        int16_t rightX;
+        int16_t rightY;
+        const char* name;
+    };
+
+    /**
+     * Replay a right-stick trace through a mapper at a frame rate, each segment held
+     * 250 ms (a whole number of frames at every rate the motion section uses)
+     * @return Total camera displacement
+     */
+    std::pair<int64_t, int64_t> ReplayCameraTrace(const StickSegment* segments, size_t count, uint32_t rateHz)
+    {
+        const uint64_t segmentNs = 250000000ULL;
+        PadDevice pad;
+        RecordingOutputSink sink(false);
+        Mapper mapper;
+        mapper.Initialize(&pad, &sink);
+
+        PadSnapshot snapshot = {};
+        snapshot.connected = 1;
+        uint64_t frames = count * segmentNs * rateHz / 1000000000ULL;
+        for (uint64_t frame = 0; frame <= frames; ++frame)
+        {
+            // 64 Hz is 15.625 ms: stamp frames exactly, never accumulate a rounded period
+            uint64_t now = frame * 1000000000ULL / rateHz;
+            size_t segment = static_cast<size_t>(now / segmentNs);
+            segment = (segment < count) ? segment : count - 1;
+            if (snapshot.packetNumber != segment + 1)
+            {
+                snapshot.timestampNs = now;
+                snapshot.packetNumber = static_cast<uint32_t>(segment + 1);
+                snapshot.pad.thumbRX = segments[segment].rightX;
+                snapshot.pad.thumbRY = segments[segment].rightY;
+                pad.ApplySnapshot(snapshot);
+            }
+            else
+            {
+                pad.MarkUnchanged();
+            }
+            mapper.Update(now);
+        }
+        return std::make_pair(sink.GetMotionX(), sink.GetMotionY());
+    }
+
+    /**
+     * Camera motion: one right-stick trace, slow sub-pixel deflections included, replayed at
+     * 64, 200, 500 and 1000 Hz must pan the camera by exactly the same number of pixels
+     * @return false if any check fails
+     */
+    bool BenchMotion()
+    {
+        bool passed = true;
+        std::cout << "Camera motion:" << std::endl;
+
+        // Slow segments sit just outside the dead zone: under a pixel per frame even at 64 Hz
+        const StickSegment trace[] =
+        {
+            { 0, 0, "centered" },
+            { 32767, 0, "full right" },
+            { 8300, 0, "slow right" },
+            { -20000, 12000, "up left" },
+            { 0, -8300, "slow down" },
+            { -5900, -5900, "slow down left" },
+            { 0, 0, "centered" },
+            { 24000, -24000, "down right" },
+            { 5900, 5900, "slow up right" },
+            { 0, 0, "centered" },
+        };
+        const size_t traceLength = sizeof(trace) / sizeof(trace[0]);
+        const uint32_t rates[] = { 64, 200, 500, 1000 };
+
+        std::pair<int64_t, int64_t> reference = ReplayCameraTrace(trace, traceLength, rates[0]);
+        for (uint32_t rateHz : rates)
+        {
+            std::pair<int64_t, int64_t> total = ReplayCameraTrace(trace, traceLength, rateHz);
+            Check(passed, "same displacement at " + std::to_string(rateHz) + " Hz", total == reference,
+                  std::to_string(total.first) + ", " + std::to_string(total.second));
+        }
+
+        // Each slow segment alone still pans in the stick's direction, by less than a pixel per 64 Hz frame
+        for (size_t i = 0; i < traceLength; ++i)
+        {
+            int32_t signX = (trace[i].rightX > 0) - (trace[i].rightX < 0);
+            int32_t signY = (trace[i].rightY < 0) - (trace[i].rightY > 0);   // Y is inverted
+            if (std::abs(trace[i].rightX) > 9000 || std::abs(trace[i].rightY) > 9000 || (signX == 0 && signY == 0))
+            {
+                continue;
+            }
+
+            const StickSegment alone[] = { trace[i], trace[i], trace[i], trace[i] };
+            std::pair<int64_t, int64_t> slow = ReplayCameraTrace(alone, 4, 64);
+            bool panned = (signX == 0 ? slow.first == 0 : slow.first * signX > 0) &&
+                          (signY == 0 ? slow.second == 0 : slow.second * signY > 0);
+            bool subPixel = std::abs(slow.first) < 64 && std::abs(slow.second) < 64;
+            Check(passed, std::string(trace[i].name) + " pans, under a pixel per frame", panned && subPixel,
+                  std::to_string(slow.first) + ", " + std::to_string(slow.second) + " in 64 frames");
+        }
+        return passed;
+    }
+
+#ifdef __linux__
+    input_event InputEvent(uint16_t type, uint16_t code, int32_t value)
+    {
+        input_event event = {};
+        event.type = type;
+        event.code = code;
+        event.value = value;
+        return event;
+    }
+
+    /**
+     * Write input_event records into a pipe
+     */
+    bool WriteInputEvents(int fd, std::initializer_list<input_event> events)
+    {
+        std::vector<input_event> records(events);
+        ssize_t bytes = static_cast<ssize_t>(records.size() * sizeof(input_event));
+        return write(fd, records.data(), records.size() * sizeof(input_event)) == bytes;
+    }
+
+    /**
+     * Evdev backend fed through a pipe: one snapshot per SYN_REPORT, D-pad hats,
+     * axis normalization, SYN_DROPPED resync, records split across reads, and the
+     * writer going away
+     * @return false if any check fails
+     */
+    bool BenchEvdev()
+    {
+        bool passed = true;
+        std::cout << "Evdev (pipe):" << std::endl;
+
+        int fds[2];
+        if (pipe(fds) != 0)
+        {
+            Check(passed, "pipe", false, std::strerror(errno));
+            return false;
+        }
+        EvdevInputSource source;
+        if (!source.OpenFd(fds[0]))
+        {
+            close(fds[1]);
+            Check(passed, "attach the pipe", false, "");
+            return false;
+        }
+
+        PadSnapshot snapshot;
+        Check(passed, "initial state reported", source.Read(1, snapshot) && snapshot.connected && snapshot.pad.buttons == 0, "");
+
+        // A press and its release in one read are two reports, seen by two Read() calls
+        const input_event syn = InputEvent(EV_SYN, SYN_REPORT, 0);
+        WriteInputEvents(fds[1], { InputEvent(EV_KEY, BTN_A, 1), syn, InputEvent(EV_KEY, BTN_A, 0), syn });
+        bool pressed = source.Read(2, snapshot) && snapshot.pad.buttons == PadButton::A;
+        uint32_t pressPacket = snapshot.packetNumber;
+        bool released = source.Read(3, snapshot) && snapshot.pad.buttons == 0 && snapshot.packetNumber == pressPacket + 1;
+        bool drained = !source.Read(4, snapshot);
+        Check(passed, "press and release in one read", pressed && released && drained, "");
+
+        // Events between two reports are one snapshot
+        WriteInputEvents(fds[1], { InputEvent(EV_KEY, BTN_B, 1), InputEvent(EV_KEY, BTN_X, 1), syn });
+        bool together = source.Read(5, snapshot) && snapshot.pad.buttons == (PadButton::B | PadButton::X) && !source.Read(6, snapshot);
+        WriteInputEvents(fds[1], { InputEvent(EV_KEY, BTN_B, 0), InputEvent(EV_KEY, BTN_X, 0), syn });
+        together = together && source.Read(7, snapshot) && snapshot.pad.buttons == 0;
+        Check(passed, "one snapshot per SYN_REPORT", together, "");
+
+        WriteInputEvents(fds[1], { InputEvent(EV_ABS, ABS_HAT0X, -1), InputEvent(EV_ABS, ABS_HAT0Y, 1), syn,
+                                   InputEvent(EV_ABS, ABS_HAT0X, 1), InputEvent(EV_ABS, ABS_HAT0Y, -1), syn,
+                                   InputEvent(EV_ABS, ABS_HAT0X, 0), InputEvent(EV_ABS, ABS_HAT0Y, 0), syn });
+        bool hats = source.Read(8, snapshot) && snapshot.pad.buttons == (PadButton::DPadLeft | PadButton::DPadDown);
+        hats = hats && source.Read(9, snapshot) && snapshot.pad.buttons == (PadButton::DPadRight | PadButton::DPadUp);
+        hats = hats && source.Read(10, snapshot) && snapshot.pad.buttons == 0;
+        Check(passed, "hat axes to D-pad bits", hats, "");
+
+        // evdev Y grows downwards; triggers scale to 0..255
+        WriteInputEvents(fds[1], { InputEvent(EV_ABS, ABS_Y, -32768), InputEvent(EV_ABS, ABS_RY, 32767), InputEvent(EV_ABS, ABS_X, 32767),
+                                   InputEvent(EV_ABS, ABS_Z, 255), InputEvent(EV_ABS, ABS_RZ, 128), syn });
+        bool axes = source.Read(11, snapshot) && snapshot.pad.thumbLY == 32767 && snapshot.pad.thumbRY == -32768 &&
+                    snapshot.pad.thumbLX == 32767 && snapshot.pad.leftTrigger == 255 && snapshot.pad.rightTrigger == 128;
+        Check(passed, "Y inverted, triggers normalized", axes,
+              "LY " + std::to_string(snapshot.pad.thumbLY) + ", RY " + std::to_string(snapshot.pad.thumbRY) +
+              ", LT " + std::to_string(snapshot.pad.leftTrigger) + ", RT " + std::to_string(snapshot.pad.rightTrigger));
+        WriteInputEvents(fds[1], { InputEvent(EV_ABS, ABS_Y, 0), InputEvent(EV_ABS, ABS_RY, 0), InputEvent(EV_ABS, ABS_X, 0),
+                                   InputEvent(EV_ABS, ABS_Z, 0), InputEvent(EV_ABS, ABS_RZ, 0), syn });
+        source.Read(12, snapshot);
+
+        // After SYN_DROPPED everything up to the next report is incomplete and ignored
+        WriteInputEvents(fds[1], { InputEvent(EV_KEY, BTN_A, 1), syn, InputEvent(EV_SYN, SYN_DROPPED, 0), InputEvent(EV_KEY, BTN_B, 1), syn,
+                                   InputEvent(EV_KEY, BTN_Y, 1), syn });
+        bool resync = source.Read(13, snapshot) && snapshot.pad.buttons == PadButton::A;
+        resync = resync && source.Read(14, snapshot) && snapshot.pad.buttons == (PadButton::A | PadButton::Y) && !source.Read(15, snapshot);
+        Check(passed, "SYN_DROPPED resync", resync && source.GetDroppedReportCount() == 1,
+              std::to_string(source.GetDroppedReportCount()) + " dropped reports");
+
+        // A record split across two reads
+        std::vector<input_event> release = { InputEvent(EV_KEY, BTN_A, 0), InputEvent(EV_KEY, BTN_Y, 0), syn };
+        const char* bytes = reinterpret_cast<const char*>(release.data());
+        const ssize_t total = static_cast<ssize_t>(release.size() * sizeof(input_event));
+        const ssize_t half = static_cast<ssize_t>(sizeof(input_event) + sizeof(input_event) / 2);
+        bool waiting = write(fds[1], bytes, half) == half && !source.Read(16, snapshot);
+        bool completed = write(fds[1], bytes + half, total - half) == total - half && source.Read(17, snapshot) && snapshot.pad.buttons == 0;
+        Check(passed, "record split across reads", waiting && completed, "");
+
+        // The writer goes away: reported once as a disconnect
+        close(fds[1]);
+        bool disconnected = source.Read(18, snapshot) && !snapshot.connected && !source.Read(19, snapshot);
+        Check(passed, "writer closed -> disconnected", disconnected, "");
+        return passed;
+    }
+    /**
+     * Read every input_event record waiting in a non-blocking pipe
+     */
+    std::vector<input_event> ReadInputEvents(int fd)
+    {
+        std::vector<input_event> records;
+        input_event buffer[64];
+        ssize_t bytes;
+        while ((bytes = read(fd, buffer, sizeof(buffer))) > 0)
+        {
+            records.insert(records.end(), buffer, buffer + static_cast<size_t>(bytes) / sizeof(input_event));
+        }
+        return records;
+    }
+
+    /**
+     * Render input_event records as "type:code=value", SYN_REPORT as "|"
+     */
+    std::string InputEventText(const std::vector<input_event>& records)
+    {
+        std::string text;
+        for (const input_event& record : records)
+        {
+            std::string item = (record.type == EV_SYN && record.code == SYN_REPORT) ? "|" :
+                std::to_string(record.type) + ":" + std::to_string(record.code) + "=" + std::to_string(record.value);
+            text += (text.empty() ? "" : " ") + item;
+        }
+        return text;
+    }
+
+    /**
+     * uinput encoding on a capture pipe: one write() per batch, virtual keys translated
+     * to evdev codes, a SYN_REPORT between two changes of one code, every batch ending
+     * in SYN_REPORT, and keys without an evdev code counted instead of resent
+     * @return false if any check fails
+     */
+    bool BenchUinput()
+    {
+        bool passed = true;
+        std::cout << "Uinput (capture pipe):" << std::endl;
+
+        int fds[2];
+        if (pipe(fds) != 0 || fcntl(fds[0], F_SETFL, O_NONBLOCK) != 0)
+        {
+            Check(passed, "pipe", false, std::strerror(errno));
+            return false;
+        }
+        UinputOutputSink sink;
+        sink.OpenCaptureFd(fds[1]);
+
+        // A tap of Q, motion, a mouse button, Escape, and F1 (no evdev code)
+        OutputEvent events[] = { OutputEvent::KeyDown('Q'), OutputEvent::KeyUp('Q'), OutputEvent::MouseMove(3, -2),
+                                 OutputEvent::MouseButtonDown(MouseButton::Left), OutputEvent::KeyDown(KeyCode::Escape),
+                                 OutputEvent::KeyDown(0x70) };
+        size_t delivered = sink.Submit(events, 6);
+        std::vector<input_event> records = ReadInputEvents(fds[0]);
+        std::vector<input_event> expected = { InputEvent(EV_KEY, KEY_Q, 1), InputEvent(EV_SYN, SYN_REPORT, 0), InputEvent(EV_KEY, KEY_Q, 0),
+                                              InputEvent(EV_REL, REL_X, 3), InputEvent(EV_REL, REL_Y, -2), InputEvent(EV_KEY, BTN_LEFT, 1),
+                                              InputEvent(EV_KEY, KEY_ESC, 1), InputEvent(EV_SYN, SYN_REPORT, 0) };
+        Check(passed, "one write per batch", sink.GetWriteCount() == 1, std::to_string(sink.GetWriteCount()) + " writes");
+        Expect(passed, "evdev codes, tap split by SYN_REPORT", InputEventText(records), InputEventText(expected));
+        Check(passed, "untranslatable key counted, not resent", delivered == 6 && sink.GetUntranslatedCount() == 1,
+              std::to_string(delivered) + " delivered, " + std::to_string(sink.GetUntranslatedCount()) + " untranslated");
+
+        // Two moves in one batch are two reports; a batch of only untranslatable keys writes nothing
+        OutputEvent moves[] = { OutputEvent::MouseMove(1, 0), OutputEvent::MouseMove(1, 0), OutputEvent::KeyUp(KeyCode::Escape) };
+        sink.Submit(moves, 3);
+        records = ReadInputEvents(fds[0]);
+        expected = { InputEvent(EV_REL, REL_X, 1), InputEvent(EV_SYN, SYN_REPORT, 0), InputEvent(EV_REL, REL_X, 1),
+                     InputEvent(EV_KEY, KEY_ESC, 0), InputEvent(EV_SYN, SYN_REPORT, 0) };
+        Expect(passed, "repeated code starts a new report", InputEventText(records), InputEventText(expected));
+        OutputEvent unknown = OutputEvent::KeyDown(0x71);
+        bool consumed = sink.Submit(&unknown, 1) == 1 && ReadInputEvents(fds[0]).empty();
+        Check(passed, "nothing to write, nothing written", consumed && sink.GetWriteCount() == 2 && sink.GetUntranslatedCount() == 2, "");
+
+        // More than one write's worth: every write ends in SYN_REPORT
+        std::vector<OutputEvent> many;
+        for (int i = 0; i < 100; ++i)
+        {
+            many.push_back(OutputEvent::KeyDown(static_cast<uint16_t>('A' + i % 26)));
+            many.push_back(OutputEvent::KeyUp(static_cast<uint16_t>('A' + i % 26)));
+        }
+        uint64_t writesBefore = sink.GetWriteCount();
+        delivered = sink.Submit(many.data(), many.size());
+        records = ReadInputEvents(fds[0]);
+        uint64_t writes = sink.GetWriteCount() - writesBefore;
+        size_t keys = 0;
+        for (const input_event& record : records)
+        {
+            keys += (record.type == EV_KEY) ? 1 : 0;
+        }
+        bool ends = !records.empty() && records.back().type == EV_SYN && records.back().code == SYN_REPORT;
+        Check(passed, "large batch split into writes ending in SYN_REPORT", delivered == many.size() && keys == many.size() &&
+              writes == (many.size() + 63) / 64 && ends, std::to_string(writes) + " writes, " + std::to_string(keys) + " key records");
+
+        close(fds[0]);
+        return passed;
+    }
+
+#endif
+
+    void PrintUsage()
+    {
+        std::cout << "Usage: GamepadBench [sticks] [pads] [chatter] [macros] [gestures] [profile] [reload] [static] [incremental] [combos] [layers] [scheduler] [dispatch] [reconciler] [batch] [injection] [async] [latency] [evdev] [uinput] [hotplug] [motion] [--iterations=<n>] [--trace=<file.gpt>]" << std::endl;
+        std::cout << "  sticks           Stick shaping cost and lookup table accuracy" << std::endl;
+        std::cout << "  pads             Four-pad axis kernel vs. per-getter shaping" << std::endl;
+        std::cout << "  chatter          Key event rate of noisy sticks/triggers with and without hysteresis" << std::endl;
+        std::cout << "  macros           Timed macro timelines and timer wheel checks on a fake clock" << std::endl;
+        std::cout << "  gestures         Tap/hold/double-tap/long-press timelines on a fake clock" << std::endl;
+        std::cout << "  profile          Text profile compiler, image cache, and witcher.ini vs. the built-in profile" << std::endl;
+        std::cout << "  reload           Profile hot reload (<n> reloads) while another thread maps pad frames" << std::endl;
+        std::cout << "  static           Built-in profile: compile-time generated button stage vs. the binding table" << std::endl;
+        std::cout << "  incremental      Bindings re-evaluated per frame, incremental vs. full, on gameplay traces" << std::endl;
+        std::cout << "  combos           Combo automaton vs. a naive matcher on random press streams, and the sign combos" << std::endl;
+        std::cout << "  layers           Binding layer timelines, keys held across switches, and the cost of a switch" << std::endl;
+        std::cout << "  scheduler        Frame scheduler pacing and overrun policies on a fake clock" << std::endl;
+        std::cout << "  dispatch         Button dispatch through the binding table vs. the old if/else chain" << std::endl;
+        std::cout << "  reconciler       Desired output states diffed into events, and keys held across a profile switch" << std::endl;
+        std::cout << "  batch            Frame batches on a capture sink: one submission per frame and the event order" << std::endl;
+        std::cout << "  injection        Key injection method probing and caching on a fake backend" << std::endl;
+        std::cout << "  async            Output thread in front of a blocked, short-writing or hung sink" << std::endl;
+        std::cout << "  latency          Poll-to-emit latency percentiles, serial vs. the poll and forwarder threads (report only)" << std::endl;
+        std::cout << "  evdev            Evdev backend fed through a pipe: reports, hats, axes, resync (Linux)" << std::endl;
+        std::cout << "  uinput           uinput encoding decoded from a capture pipe (Linux)" << std::endl;
+        std::cout << "  hotplug          Device watcher backoff and hotplug handover on a fake clock" << std::endl;
+        std::cout << "  motion           Camera motion of one stick trace at 64 to 1000 Hz" << std::endl;
+        std::cout << "  --iterations=<n> Passes over the sample set (default 2000)" << std::endl;
+        std::cout << "  --trace=<f>      Also replay a recorded trace in incremental (repeatable)" << std::endl;
+    }
+}
+
+/**
+ * GamepadBench - Micro-benchmarks for the per-frame mapping kernels
+ *
+ * Runs without a pad. Each benchmark also checks its fast path against a
+ * straightforward reference and exits with status 1 if they disagree.
+ */
+int main(int argc, char* argv[])
+{
+    uint32_t iterations = 2000;
+    bool selected = false;
+    bool runSticks = false;
+    bool runPads = false;
+    bool runChatter = false;
+    bool runMacros = false;
+    bool runGestures = false;
+    bool runProfile = false;
+    bool runReload = false;
+    bool runStatic = false;
+    bool runIncremental = false;
+    bool runCombos = false;
+    bool runLayers = false;
+    bool runScheduler = false;
+    bool runDispatch = false;
+    bool runReconciler = false;
+    bool runBatch = false;
+    bool runInjection = false;
+    bool runAsync = false;
+    bool runLatency = false;
+#ifdef __linux__
+    bool runEvdev = false;
+#endif
+#ifdef __linux__
+    bool runUinput = false;
+#endif
+    bool runHotplug = false;
+    bool runMotion = false;
+    std::vector<std::string> tracePaths;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "sticks") == 0)
+        {
+            runSticks = selected = true;
+        }
+        else if (std::strcmp(argv[i], "pads") == 0)
+        {
+            runPads = selected = true;
+        }
+        else if (std::strcmp(argv[i], "chatter") == 0)
+        {
+            runChatter = selected = true;
+        }
+        else if (std::strcmp(argv[i], "macros") == 0)
+        {
+            runMacros = selected = true;
+        }
+        else if (std::strcmp(argv[i], "gestures") == 0)
+        {
+            runGestures = selected = true;
+        }
+        else if (std::strcmp(argv[i], "profile") == 0)
+        {
+            runProfile = selected = true;
+        }
+        else if (std::strcmp(argv[i], "reload") == 0)
+        {
+            runReload = selected = true;
+        }
+        else if (std::strcmp(argv[i], "static") == 0)
+        {
+            runStatic = selected = true;
+        }
+        else if (std::strcmp(argv[i], "incremental") == 0)
+        {
+            runIncremental = selected = true;
+        }
+        else if (std::strcmp(argv[i], "combos") == 0)
+        {
+            runCombos = selected = true;
+        }
+        else if (std::strcmp(argv[i], "layers") == 0)
+        {
+            runLayers = selected = true;
+        }
+        else if (std::strcmp(argv[i], "scheduler") == 0)
+        {
+            runScheduler = selected = true;
+        }
+        else if (std::strcmp(argv[i], "dispatch") == 0)
+        {
+            runDispatch = selected = true;
+        }
+        else if (std::strcmp(argv[i], "reconciler") == 0)
+        {
+            runReconciler = selected = true;
+        }
+        else if (std::strcmp(argv[i], "batch") == 0)
+        {
+            runBatch = selected = true;
+        }
+        else if (std::strcmp(argv[i], "injection") == 0)
+        {
+            runInjection = selected = true;
+        }
+        else if (std::strcmp(argv[i], "async") == 0)
+        {
+            runAsync = selected = true;
+        }
+        else if (std::strcmp(argv[i], "latency") == 0)
+        {
+            runLatency = selected = true;
+        }
+#ifdef __linux__
+        else if (std::strcmp(argv[i], "evdev") == 0)
+        {
+            runEvdev = selected = true;
+        }
+#endif
+#ifdef __linux__
+        else if (std::strcmp(argv[i], "uinput") == 0)
+        {
+            runUinput = selected = true;
+        }
+#endif
+        else if (std::strcmp(argv[i], "hotplug") == 0)
+        {
+            runHotplug = selected = true;
+        }
+        else if (std::strcmp(argv[i], "motion") == 0)
+        {
+            runMotion = selected = true;
+        }
+        else if (std::strncmp(argv[i], "--trace=", 8) == 0)
+        {
+            tracePaths.push_back(argv[i] + 8);
+        }
+        else if (std::strncmp(argv[i], "--iterations=", 13) == 0)
+        {
+            iterations = static_cast<uint32_t>(std::strtoul(argv[i] + 13, nullptr, 10));
+        }
+        else
+        {
+            PrintUsage();
+            return 2;
+        }
+    }
+
+    // No benchmark named: run them all
+    if (!selected)
+    {
+        runSticks = true;
+        runPads = true;
+        runChatter = true;
+        runMacros = true;
+        runGestures = true;
+        runProfile = true;
+        runReload = true;
+        runStatic = true;
+        runIncremental = true;
+        runCombos = true;
+        runLayers = true;
+        runScheduler = true;
+        runDispatch = true;
+        runReconciler = true;
+        runBatch = true;
+        runInjection = true;
+        runAsync = true;
+        runLatency = true;
+#ifdef __linux__
+        runEvdev = true;
+#endif
+#ifdef __linux__
+        runUinput = true;
+#endif
+        runHotplug = true;
+        runMotion = true;
+    }
+
+    bool passed = true;
+    if (runSticks)
+    {
+        passed = BenchSticks(iterations) && passed;
+    }
+    if (runPads)
+    {
+        passed = BenchPads(iterations) && passed;
+    }
+    if (runChatter)
+    {
+        passed = BenchChatter() && passed;
+    }
+    if (runMacros)
+    {
+        passed = BenchMacros(iterations) && passed;
+    }
+    if (runGestures)
+    {
+        passed = BenchGestures() && passed;
+    }
+    if (runProfile)
+    {
+        passed = BenchProfile(iterations) && passed;
+    }
+    if (runReload)
+    {
+        passed = BenchReload(iterations) && passed;
+    }
+    if (runStatic)
+    {
+        passed = BenchStatic(iterations) && passed;
+    }
+    if (runIncremental)
+    {
+        passed = BenchIncremental(iterations, tracePaths) && passed;
+    }
+    if (runCombos)
+    {
+        passed = BenchCombos(iterations) && passed;
+    }
+    if (runLayers)
+    {
+        passed = BenchLayers(iterations) && passed;
+    }
+    if (runScheduler)
+    {
+        passed = BenchScheduler() && passed;
+    }
+    if (runDispatch)
+    {
+        passed = BenchDispatch(iterations) && passed;
+    }
+    if (runReconciler)
+    {
+        passed = BenchReconciler() && passed;
+    }
+    if (runBatch)
+    {
+        passed = BenchBatch() && passed;
+    }
+    if (runInjection)
+    {
+        passed = BenchInjection() && passed;
+    }
+    if (runAsync)
+    {
+        passed = BenchAsync() && passed;
+    }
+    if (runLatency)
+    {
+        passed = BenchLatency() && passed;
+    }
+#ifdef __linux__
+    if (runEvdev)
+    {
+        passed = BenchEvdev() && passed;
+    }
+#endif
+#ifdef __linux__
+    if (runUinput)
+    {
+        passed = BenchUinput() && passed;
+    }
+#endif
+    if (runHotplug)
+    {
+        passed = BenchHotplug() && passed;
+    }
+    if (runMotion)
+    {
+        passed = BenchMotion() && passed;
+    }
+
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,203 @@
+#include "BindingTable.h"
+#include "WitcherProfile.h"
+#include <cstring>
+
+BindingTable::BindingTable()
+{
+    Clear();
+}
+
+void BindingTable::Clear()
+{
+    std::memset(m_actions, 0, sizeof(m_actions));
+    std::memset(m_macros, 0, sizeof(m_macros));
+    std::memset(m_gestures, 0, sizeof(m_gestures));
+    m_boundMask = 0;
+    m_heldMask = 0;
+    m_sequenceMask = 0;
+    m_macroMask = 0;
+    m_gestureMask = 0;
+}
+
+int BindingTable::ButtonToBitIndex(uint16_t button)
+{
+    if (button == 0 || (button & (button - 1)) != 0)
+    {
+        return -1;
+    }
+    return LowestSetBit(button);
+}
+
+bool BindingTable::Bind(uint16_t button, const BindingAction& action)
+{
+    int bit = ButtonToBitIndex(button);
+    if (bit < 0)
+    {
+        return false;
+    }
+
+    m_actions[bit] = action;
+
+    m_boundMask &= ~button;
+    m_heldMask &= ~button;
+    m_sequenceMask &= ~button;
+    m_macroMask &= ~button;
+    m_gestureMask &= ~button;
+
+    switch (action.type)
+    {
+    case BindingActionType::Key:
+    case BindingActionType::MouseButton:
+        m_heldMask |= button;
+        m_boundMask |= button;
+        break;
+    case BindingActionType::KeySequence:
+        m_sequenceMask |= button;
+        m_boundMask |= button;
+        break;
+    case BindingActionType::Macro:
+        m_macroMask |= button;
+        m_boundMask |= button;
+        break;
+    case BindingActionType::Gesture:
+        m_gestureMask |= button;
+        m_boundMask |= button;
+        break;
+    case BindingActionType::None:
+        break;
+    }
+    return true;
+}
+
+bool BindingTable::BindKey(uint16_t button, uint16_t keyCode)
+{
+    BindingAction action = {};
+    action.type = BindingActionType::Key;
+    action.count = 1;
+    action.codes[0] = keyCode;
+    return Bind(button, action);
+}
+
+bool BindingTable::BindMouseButton(uint16_t button, uint16_t mouseButton)
+{
+    BindingAction action = {};
+    action.type = BindingActionType::MouseButton;
+    action.count = 1;
+    action.codes[0] = mouseButton;
+    return Bind(button, action);
+}
+
+bool BindingTable::BindKeySequence(uint16_t button, std::initializer_list<uint16_t> keyCodes)
+{
+    return BindKeySequence(button, keyCodes.begin(), keyCodes.size());
+}
+
+bool BindingTable::BindKeySequence(uint16_t button, const uint16_t* keyCodes, size_t count)
+{
+    if (count == 0 || count > BindingAction::MAX_SEQUENCE_KEYS)
+    {
+        return false;
+    }
+
+    BindingAction action = {};
+    action.type = BindingActionType::KeySequence;
+    for (size_t i = 0; i < count; ++i)
+    {
+        action.codes[action.count++] = keyCodes[i];
+    }
+    return Bind(button, action);
+}
+
+bool BindingTable::BindMacro(uint16_t button, std::initializer_list<MacroStep> steps, bool cancelOnRelease)
+{
+    if (steps.size() == 0 || steps.size() > MacroDefinition::MAX_STEPS)
+    {
+        return false;
+    }
+
+    MacroDefinition macro;
+    std::memset(&macro, 0, sizeof(macro));
+    macro.cancelOnRelease = cancelOnRelease;
+    for (const MacroStep& step : steps)
+    {
+        macro.steps[macro.stepCount++] = step;
+    }
+    return BindMacro(button, macro);
+}
+
+bool BindingTable::BindMacro(uint16_t button, const MacroDefinition& macro)
+{
+    int bit = ButtonToBitIndex(button);
+    if (bit < 0 || macro.stepCount == 0 || macro.stepCount > MacroDefinition::MAX_STEPS)
+    {
+        return false;
+    }
+
+    m_macros[bit] = macro;
+
+    BindingAction action = {};
+    action.type = BindingActionType::Macro;
+    return Bind(button, action);
+}
+
+bool BindingTable::BindGesture(uint16_t button, const GestureDefinition& gesture)
+{
+    int bit = ButtonToBitIndex(button);
+    if (bit < 0 || gesture.boundMask == 0)
+    {
+        return false;
+    }
+
+    m_gestures[bit] = gesture;
+
+    BindingAction action = {};
+    action.type = BindingActionType::Gesture;
+    return Bind(button, action);
+}
+
+void BindingTable::Unbind(uint16_t button)
+{
+    BindingAction action = {};
+    Bind(button, action);
+}
+
+void BindingTable::CopyBinding(const BindingTable& source, int bitIndex)
+{
+    m_macros[bitIndex] = source.m_macros[bitIndex];
+    m_gestures[bitIndex] = source.m_gestures[bitIndex];
+    Bind(static_cast<uint16_t>(1u << bitIndex), source.m_actions[bitIndex]);
+}
+
+bool BindingTable::IsValid() const
+{
+    for (int bit = 0; bit < PadButton::COUNT; ++bit)
+    {
+        const BindingAction& action = m_actions[bit];
+        if (action.type > BindingActionType::Gesture || action.count > BindingAction::MAX_SEQUENCE_KEYS)
+        {
+            return false;
+        }
+
+        const MacroDefinition& macro = m_macros[bit];
+        if (action.type == BindingActionType::Macro &&
+            (macro.stepCount == 0 || macro.stepCount > MacroDefinition::MAX_STEPS))
+        {
+            return false;
+        }
+
+        const GestureDefinition& gesture = m_gestures[bit];
+        for (int kind = 0; action.type == BindingActionType::Gesture && kind < GestureDefinition::KIND_COUNT; ++kind)
+        {
+            if (gesture.repeats[kind] > MacroDefinition::MAX_STEPS)
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+BindingTable BindingTable::CreateWitcherProfile()
+{
+    return StaticProfile<WitcherProfile>::BuildBindings();
+}
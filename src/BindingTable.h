@@ -0,0 +1,321 @@
+#pragma once
+
+#include "InputCodes.h"
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+/**
+ * Kind of output a button binding produces
+ */
+enum class BindingActionType : uint8_t
+{
+    None,           // Button is unbound
+    Key,            // Key down on press, key up on release
+    MouseButton,    // Mouse button down on press, up on release
+    KeySequence,    // Tap (down + up) each key in order on press; nothing on release
+    Macro,          // Start a timed MacroDefinition on press (optionally cancelled on release)
+    Gesture         // Tap / hold / double-tap / long-press, recognized by GestureRecognizer
+};
+
+/**
+ * Output a macro step holds
+ */
+enum class MacroOutputType : uint8_t
+{
+    Key,
+    MouseButton
+};
+
+/**
+ * MacroStep - Hold one key or mouse button for a while, then wait before the next step
+ */
+struct MacroStep
+{
+    MacroOutputType type;
+    uint16_t code;      // Key code, or the mouse button index
+    uint16_t holdMs;    // How long the output is held (at least one wheel tick)
+    uint16_t gapMs;     // Pause after the release before the next step (at least one tick)
+
+    static constexpr MacroStep Key(uint16_t keyCode, uint16_t holdMs, uint16_t gapMs) { return { MacroOutputType::Key, keyCode, holdMs, gapMs }; }
+    static constexpr MacroStep Mouse(uint16_t button, uint16_t holdMs, uint16_t gapMs) { return { MacroOutputType::MouseButton, button, holdMs, gapMs }; }
+};
+
+/**
+ * MacroDefinition - Timed sequence a Macro binding plays (fixed size, no heap)
+ */
+struct MacroDefinition
+{
+    static const int MAX_STEPS = 8;
+
+    uint8_t stepCount;
+    bool cancelOnRelease;       // Releasing the button stops the macro and releases its output
+    MacroStep steps[MAX_STEPS];
+};
+
+/**
+ * BindingAction - One entry of the binding table (fixed size, no heap)
+ */
+struct BindingAction
+{
+    static const int MAX_SEQUENCE_KEYS = 4;
+
+    BindingActionType type;
+    uint8_t count;                      // Number of valid entries in codes
+    uint16_t codes[MAX_SEQUENCE_KEYS];  // Key codes, or the mouse button index for MouseButton
+};
+
+/**
+ * Gestures a button can be bound to
+ */
+enum class GestureKind : uint8_t
+{
+    Tap,        // Released before holdMs (and, with DoubleTap bound, not pressed again in time)
+    Hold,       // Held past holdMs: the action's output is held until the button is released
+    DoubleTap,  // Pressed again within doubleTapMs of a tap's release (fires on the second press)
+    LongPress   // Held past longPressMs (fires once)
+};
+
+/**
+ * GestureDefinition - Gesture actions of one button and their timing windows (fixed size, no heap)
+ *
+ * Tap, DoubleTap and LongPress play their step as a timed press, repeated
+ * `repeats` times; Hold holds the step's key or mouse button.
+ */
+struct GestureDefinition
+{
+    static const int KIND_COUNT = 4;
+
+    uint8_t boundMask;                  // Bit n = GestureKind n is bound
+    uint8_t repeats[KIND_COUNT];
+    MacroStep actions[KIND_COUNT];
+    uint16_t holdMs;                    // Tap/hold boundary
+    uint16_t doubleTapMs;               // Window for the second press after a tap's release
+    uint16_t longPressMs;               // From the press; should be longer than holdMs
+
+    /**
+     * No gestures bound yet, with the given timing windows
+     */
+    static constexpr GestureDefinition Create(uint16_t holdMs, uint16_t doubleTapMs, uint16_t longPressMs)
+    {
+        GestureDefinition gesture = {};
+        gesture.holdMs = holdMs;
+        gesture.doubleTapMs = doubleTapMs;
+        gesture.longPressMs = longPressMs;
+        return gesture;
+    }
+
+    /**
+     * Bind one gesture
+     * @param count Number of presses of the step for one-shot gestures (ignored for Hold)
+     */
+    constexpr GestureDefinition& Set(GestureKind kind, const MacroStep& action, uint8_t count = 1)
+    {
+        int index = static_cast<int>(kind);
+        actions[index] = action;
+        count = (count == 0) ? 1 : count;
+        repeats[index] = (count > MacroDefinition::MAX_STEPS) ? MacroDefinition::MAX_STEPS : count;
+        boundMask |= static_cast<uint8_t>(1u << index);
+        return *this;
+    }
+
+    constexpr bool Has(GestureKind kind) const { return (boundMask & (1u << static_cast<int>(kind))) != 0; }
+};
+
+/**
+ * ComboDefinition - Timed button press sequence that plays a macro (fixed size, no heap)
+ *
+ * Each press after the first must follow the one before it within its
+ * window, with no other button pressed in between (see ComboAutomaton).
+ */
+struct ComboDefinition
+{
+    static const int MAX_PRESSES = 8;
+    static const uint16_t DEFAULT_WINDOW_MS = 300;
+
+    uint8_t pressCount;
+    uint8_t buttons[MAX_PRESSES];       // Button bit index per press
+    uint16_t windowMs[MAX_PRESSES];     // Longest time since the press before (windowMs[0] unused)
+    MacroDefinition action;             // Played when the last press completes the combo
+};
+
+/**
+ * BindingTable - Compiled button -> action table
+ *
+ * One flat array indexed by button bit (0-15 of XINPUT_GAMEPAD::wButtons).
+ * The mapper computes pressed/released masks once per frame and looks up only
+ * the bits that changed, so unchanged buttons cost nothing.
+ */
+class BindingTable
+{
+public:
+    BindingTable();
+
+    /**
+     * Remove all bindings
+     */
+    void Clear();
+
+    /**
+     * Bind a button to a held key
+     * @param button Single button flag (e.g., PadButton::A)
+     * @param keyCode Key code (Win32 virtual key value)
+     * @return false if button is not a single bit
+     */
+    bool BindKey(uint16_t button, uint16_t keyCode);
+
+    /**
+     * Bind a button to a held mouse button
+     * @param button Single button flag
+     * @param mouseButton Mouse button (0=left, 1=right, 2=middle)
+     * @return false if button is not a single bit
+     */
+    bool BindMouseButton(uint16_t button, uint16_t mouseButton);
+
+    /**
+     * Bind a button to a sequence of key taps fired on press
+     * @param button Single button flag
+     * @param keyCodes Keys to tap in order (at most BindingAction::MAX_SEQUENCE_KEYS)
+     * @return false if button is not a single bit or the sequence is too long/empty
+     */
+    bool BindKeySequence(uint16_t button, std::initializer_list<uint16_t> keyCodes);
+
+    /**
+     * Bind a button to a sequence of key taps fired on press
+     * @param button Single button flag
+     * @param keyCodes Keys to tap in order
+     * @param count Number of keys (1 to BindingAction::MAX_SEQUENCE_KEYS)
+     * @return false if button is not a single bit or the count is out of range
+     */
+    bool BindKeySequence(uint16_t button, const uint16_t* keyCodes, size_t count);
+
+    /**
+     * Bind a button to a timed macro started on press
+     * @param button Single button flag
+     * @param steps Steps in order (at most MacroDefinition::MAX_STEPS)
+     * @param cancelOnRelease Stop the macro when the button is released before it finishes
+     * @return false if button is not a single bit or the macro is too long/empty
+     */
+    bool BindMacro(uint16_t button, std::initializer_list<MacroStep> steps, bool cancelOnRelease);
+
+    /**
+     * Bind a button to a timed macro started on press
+     * @param button Single button flag
+     * @param macro Steps and release behavior (copied)
+     * @return false if button is not a single bit or the macro is empty/too long
+     */
+    bool BindMacro(uint16_t button, const MacroDefinition& macro);
+
+    /**
+     * Bind a button to gestures (only these buttons go through GestureRecognizer)
+     * @param button Single button flag
+     * @param gesture Gesture actions and timing windows
+     * @return false if button is not a single bit or no gesture is bound
+     */
+    bool BindGesture(uint16_t button, const GestureDefinition& gesture);
+
+    /**
+     * Remove the binding of a button
+     * @param button Single button flag
+     */
+    void Unbind(uint16_t button);
+
+    /**
+     * Replace the binding of a button bit with that of another table (macro and gestures included)
+     * @param source Table to copy from
+     * @param bitIndex Bit index (0-15)
+     */
+    void CopyBinding(const BindingTable& source, int bitIndex);
+
+    /**
+     * Check that every kind, count and step count is in range (a table read from a file)
+     * @return false if some binding would index past its fixed arrays
+     */
+    bool IsValid() const;
+
+    /**
+     * Get the action bound to a button bit
+     * @param bitIndex Bit index (0-15)
+     * @return Binding (type None if unbound)
+     */
+    const BindingAction& GetAction(int bitIndex) const { return m_actions[bitIndex]; }
+
+    /**
+     * Get the macro bound to a button bit (valid for Macro bindings)
+     * @param bitIndex Bit index (0-15)
+     */
+    const MacroDefinition& GetMacro(int bitIndex) const { return m_macros[bitIndex]; }
+
+    /**
+     * Get the gestures bound to a button bit (valid for Gesture bindings)
+     * @param bitIndex Bit index (0-15)
+     */
+    const GestureDefinition& GetGesture(int bitIndex) const { return m_gestures[bitIndex]; }
+
+    /**
+     * Get the mask of all buttons that have a binding
+     */
+    uint16_t GetBoundMask() const { return m_boundMask; }
+
+    /**
+     * Get the mask of buttons bound to held outputs (Key, MouseButton)
+     */
+    uint16_t GetHeldMask() const { return m_heldMask; }
+
+    /**
+     * Get the mask of buttons bound to press-triggered key sequences
+     */
+    uint16_t GetSequenceMask() const { return m_sequenceMask; }
+
+    /**
+     * Get the mask of buttons bound to macros
+     */
+    uint16_t GetMacroMask() const { return m_macroMask; }
+
+    /**
+     * Get the mask of buttons bound to gestures
+     */
+    uint16_t GetGestureMask() const { return m_gestureMask; }
+
+    /**
+     * Build the default The Witcher 1 profile
+     * @return Table with the built-in button bindings
+     */
+    static BindingTable CreateWitcherProfile();
+
+    /**
+     * Index of the lowest set bit (mask must be non-zero)
+     */
+    static int LowestSetBit(uint32_t mask)
+    {
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanForward(&index, mask);
+        return static_cast<int>(index);
+#else
+        return __builtin_ctz(mask);
+#endif
+    }
+
+    /**
+     * Convert a single-bit button flag to its bit index
+     * @return Bit index, or -1 if button is zero or has several bits set
+     */
+    static int ButtonToBitIndex(uint16_t button);
+
+private:
+    bool Bind(uint16_t button, const BindingAction& action);
+
+    BindingAction m_actions[PadButton::COUNT];
+    MacroDefinition m_macros[PadButton::COUNT];
+    GestureDefinition m_gestures[PadButton::COUNT];
+    uint16_t m_boundMask;
+    uint16_t m_heldMask;
+    uint16_t m_sequenceMask;
+    uint16_t m_macroMask;
+    uint16_t m_gestureMask;
+};
@@ -0,0 +1,151 @@
+#include "ComboRecognizer.h"
+#include <algorithm>
+#include <limits>
+
+namespace
+{
+    const uint32_t NO_STATE = std::numeric_limits<uint32_t>::max();
+    const uint64_t NO_WINDOW_LIMIT = std::numeric_limits<uint64_t>::max();
+    const uint64_t NS_PER_MS = 1000000ULL;
+}
+
+ComboAutomaton::ComboAutomaton()
+{
+    Compile(nullptr, 0);
+}
+
+bool ComboAutomaton::Compile(const ComboDefinition* combos, size_t count)
+{
+    bool valid = true;
+    for (size_t i = 0; i < count; ++i)
+    {
+        const ComboDefinition& combo = combos[i];
+        valid = valid && combo.pressCount > 0 && combo.pressCount <= ComboDefinition::MAX_PRESSES;
+        for (int press = 0; valid && press < combo.pressCount; ++press)
+        {
+            valid = combo.buttons[press] < PadButton::COUNT;
+        }
+    }
+    if (!valid)
+    {
+        count = 0;
+    }
+
+    m_combos.assign(combos, combos + count);
+    m_states.assign(1, State{ NO_WINDOW_LIMIT, ROOT, 0, 0 });
+    m_transitions.assign(PadButton::COUNT, NO_STATE);
+    m_matches.clear();
+
+    // Trie of the presses; each state keeps the widest window of the combos through it
+    std::vector<std::vector<uint32_t>> endings(1);
+    for (size_t i = 0; i < m_combos.size(); ++i)
+    {
+        const ComboDefinition& combo = m_combos[i];
+        uint32_t state = ROOT;
+        for (int press = 0; press < combo.pressCount; ++press)
+        {
+            size_t transition = state * PadButton::COUNT + combo.buttons[press];
+            if (m_transitions[transition] == NO_STATE)
+            {
+                m_transitions[transition] = static_cast<uint32_t>(m_states.size());
+                m_states.push_back(State{ press > 0 ? 0 : NO_WINDOW_LIMIT, ROOT, 0, 0 });
+                m_transitions.resize(m_transitions.size() + PadButton::COUNT, NO_STATE);
+                endings.emplace_back();
+            }
+            state = m_transitions[transition];
+            if (press > 0)
+            {
+                uint64_t windowNs = combo.windowMs[press] * NS_PER_MS;
+                m_states[state].windowNs = std::max(m_states[state].windowNs, windowNs);
+            }
+        }
+        endings[state].push_back(static_cast<uint32_t>(i));
+    }
+
+    // Breadth first: failure links, the missing transitions through them, and the
+    // match lists (own combos, then those of the failure state, which are shorter)
+    std::vector<uint32_t> order(1, ROOT);
+    for (size_t head = 0; head < order.size(); ++head)
+    {
+        uint32_t state = order[head];
+        uint32_t fail = m_states[state].fail;
+
+        m_states[state].firstMatch = static_cast<uint32_t>(m_matches.size());
+        m_matches.insert(m_matches.end(), endings[state].begin(), endings[state].end());
+        for (uint32_t i = 0; state != ROOT && i < m_states[fail].matchCount; ++i)
+        {
+            uint32_t inherited = m_matches[m_states[fail].firstMatch + i];
+            m_matches.push_back(inherited);
+        }
+        m_states[state].matchCount = static_cast<uint32_t>(m_matches.size()) - m_states[state].firstMatch;
+
+        for (uint32_t button = 0; button < PadButton::COUNT; ++button)
+        {
+            uint32_t& next = m_transitions[state * PadButton::COUNT + button];
+            uint32_t fallback = (state == ROOT) ? ROOT : m_transitions[fail * PadButton::COUNT + button];
+            if (next == NO_STATE)
+            {
+                next = fallback;
+                continue;
+            }
+            m_states[next].fail = fallback;
+            order.push_back(next);
+        }
+    }
+    return valid;
+}
+
+bool ComboAutomaton::IsInTime(uint32_t combo, const InputHistory& history) const
+{
+    const ComboDefinition& definition = m_combos[combo];
+    for (int press = definition.pressCount - 1; press > 0; --press)
+    {
+        int age = definition.pressCount - 1 - press;
+        uint64_t gapNs = history.Get(age).timestampNs - history.Get(age + 1).timestampNs;
+        if (gapNs > definition.windowMs[press] * NS_PER_MS)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+ComboRecognizer::ComboRecognizer()
+    : m_state(ComboAutomaton::ROOT)
+    , m_completedCount(0)
+{
+}
+
+int ComboRecognizer::Press(const ComboAutomaton& automaton, int button, uint64_t timestampNs)
+{
+    // The first press after a Reset() continues nothing; a press stamped before
+    // the previous one (poll thread raced the frame) counts as simultaneous
+    uint64_t gapNs = NO_WINDOW_LIMIT;
+    if (m_history.GetCount() > 0)
+    {
+        uint64_t previousNs = m_history.Get(0).timestampNs;
+        timestampNs = std::max(timestampNs, previousNs);
+        gapNs = timestampNs - previousNs;
+    }
+    m_history.Push(button, timestampNs);
+    m_state = automaton.Next(m_state, button, gapNs);
+
+    uint32_t count;
+    const uint32_t* matches = automaton.GetMatches(m_state, count);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        if (automaton.IsInTime(matches[i], m_history))
+        {
+            m_state = ComboAutomaton::ROOT;
+            ++m_completedCount;
+            return static_cast<int>(matches[i]);
+        }
+    }
+    return NO_COMBO;
+}
+
+void ComboRecognizer::Reset()
+{
+    m_history.Clear();
+    m_state = ComboAutomaton::ROOT;
+}
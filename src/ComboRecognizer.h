@@ -0,0 +1,151 @@
+#pragma once
+
+#include "BindingTable.h"
+#include "InputHistory.h"
+#include <cstdint>
+#include <vector>
+
+/**
+ * ComboAutomaton - The combos of a profile compiled into one Aho-Corasick automaton
+ *
+ * The states are the press prefixes of all combos (a trie over button bits).
+ * Every state has a transition for every button, filled in through the
+ * failure links at compile time, so a press moves to the longest combo
+ * prefix that ends the press stream with one table lookup, however many
+ * combos there are. A state also lists every combo that ends there or at
+ * one of its suffixes, longest first.
+ *
+ * Timing: each state keeps the widest window any combo through it allows
+ * for its last press. A press that came later than that cannot continue
+ * any of those combos, so the state falls back along its failure links (at
+ * most ComboDefinition::MAX_PRESSES steps). The exact windows of a candidate
+ * combo are then checked against the press history.
+ *
+ * Compiled at profile load (allocates); matching only reads it, so one
+ * automaton can serve any number of recognizers.
+ */
+class ComboAutomaton
+{
+public:
+    static const uint32_t ROOT = 0;    // No press of any combo matched yet
+
+    ComboAutomaton();
+
+    /**
+     * Compile combos, replacing the previous ones
+     * @param combos Combo definitions (copied)
+     * @param count Number of combos
+     * @return false if a combo has no presses, too many, or an unknown button (then none are compiled)
+     */
+    bool Compile(const ComboDefinition* combos, size_t count);
+
+    /**
+     * Follow one press
+     * @param state Current state (ROOT at first)
+     * @param button Button bit index
+     * @param gapNs Time since the previous press
+     * @return New state
+     */
+    uint32_t Next(uint32_t state, int button, uint64_t gapNs) const
+    {
+        uint32_t next = m_transitions[state * PadButton::COUNT + static_cast<uint32_t>(button)];
+        while (gapNs > m_states[next].windowNs)
+        {
+            next = m_states[next].fail;
+        }
+        return next;
+    }
+
+    /**
+     * Get the combos that end at a state, longest first
+     * @param state State returned by Next()
+     * @param count Receives the number of combos
+     * @return Combo indices
+     */
+    const uint32_t* GetMatches(uint32_t state, uint32_t& count) const
+    {
+        count = m_states[state].matchCount;
+        return m_matches.data() + m_states[state].firstMatch;
+    }
+
+    /**
+     * Check a combo's windows against the presses that completed it
+     * @param combo Combo index
+     * @param history Press history whose newest entry is the combo's last press
+     */
+    bool IsInTime(uint32_t combo, const InputHistory& history) const;
+
+    /**
+     * Get a compiled combo
+     */
+    const ComboDefinition& GetCombo(uint32_t combo) const { return m_combos[combo]; }
+
+    /**
+     * Get the number of combos, and of states (trie nodes, including ROOT)
+     */
+    size_t GetComboCount() const { return m_combos.size(); }
+    size_t GetStateCount() const { return m_states.size(); }
+
+private:
+    struct State
+    {
+        uint64_t windowNs;      // Widest window of the last press over the combos through here (no limit for a first press)
+        uint32_t fail;          // Longest proper suffix that is a state
+        uint32_t firstMatch;    // Into m_matches
+        uint32_t matchCount;
+    };
+
+    std::vector<ComboDefinition> m_combos;
+    std::vector<State> m_states;
+    std::vector<uint32_t> m_transitions;    // State * PadButton::COUNT + button -> state
+    std::vector<uint32_t> m_matches;        // Combo indices per state, longest first
+};
+
+/**
+ * ComboRecognizer - Matches press edges against a ComboAutomaton
+ *
+ * The per-pad half of combo matching: the automaton state and the press
+ * history. A press costs one transition, a fallback bounded by
+ * ComboDefinition::MAX_PRESSES, and a window check of the combos ending
+ * there; nothing is allocated. A completed combo consumes its presses, so
+ * matching starts over from the next press. When several combos complete on
+ * the same press, the longest wins (among equals, the first defined).
+ */
+class ComboRecognizer
+{
+public:
+    static const int NO_COMBO = -1;
+
+    static_assert(InputHistory::CAPACITY >= ComboDefinition::MAX_PRESSES, "history too short for the longest combo");
+
+    ComboRecognizer();
+
+    /**
+     * Feed one press edge (presses of one frame in button bit order)
+     * @param automaton Compiled combos
+     * @param button Button bit index
+     * @param timestampNs Time of the press
+     * @return Index of the combo this press completes, or NO_COMBO
+     */
+    int Press(const ComboAutomaton& automaton, int button, uint64_t timestampNs);
+
+    /**
+     * Forget the presses so far (outputs released, combos replaced)
+     */
+    void Reset();
+
+    /**
+     * Get the presses seen since the last Reset()
+     */
+    const InputHistory& GetHistory() const { return m_history; }
+
+    /**
+     * Get the number of combos completed since construction
+     */
+    uint64_t GetCompletedCount() const { return m_completedCount; }
+
+private:
+    InputHistory m_history;
+    uint32_t m_state;
+    uint64_t m_completedCount;
+};
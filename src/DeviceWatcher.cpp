@@ -0,0 +1,199 @@
+#include "DeviceWatcher.h"
+
+DeviceWatcher::DeviceWatcher(IMonotonicClock& clock)
+    : m_clock(clock)
+    , m_handover(SEARCHING)
+    , m_searching(false)
+    , m_running(false)
+{
+    for (int i = 0; i < MAX_SLOTS; ++i)
+    {
+        m_slots[i].source = nullptr;
+        m_slots[i].nextProbeNs = 0;
+        m_slots[i].backoffNs = MIN_BACKOFF_NS;
+        m_slots[i].probeCount.store(0, std::memory_order_relaxed);
+    }
+}
+
+DeviceWatcher::~DeviceWatcher()
+{
+    Stop();
+}
+
+void DeviceWatcher::SetSlot(int slot, IInputSource* source)
+{
+    if (slot >= 0 && slot < MAX_SLOTS)
+    {
+        m_slots[slot].source = source;
+    }
+}
+
+void DeviceWatcher::Start()
+{
+    if (m_running.load())
+    {
+        return;
+    }
+
+    m_running.store(true);
+    m_thread = std::thread(&DeviceWatcher::ThreadLoop, this);
+}
+
+void DeviceWatcher::Stop()
+{
+    m_running.store(false);
+    if (m_thread.joinable())
+    {
+        m_thread.join();
+    }
+}
+
+uint64_t DeviceWatcher::Probe()
+{
+    if (m_handover.load(std::memory_order_acquire) != SEARCHING)
+    {
+        // A pad is waiting to be claimed or in use; empty slots are left alone
+        m_searching = false;
+        return 0;
+    }
+
+    uint64_t now = m_clock.NowNanoseconds();
+    if (!m_searching)
+    {
+        // Search (re)starts: the lost pad is likely to come back soon, so probe eagerly again
+        m_searching = true;
+        ResetBackoff(now);
+    }
+
+    uint64_t nextDue = 0;
+    for (int i = 0; i < MAX_SLOTS; ++i)
+    {
+        Slot& slot = m_slots[i];
+        if (!slot.source)
+        {
+            continue;
+        }
+
+        if (now >= slot.nextProbeNs)
+        {
+            PadSnapshot snapshot;
+            slot.source->Read(now, snapshot);
+            slot.probeCount.fetch_add(1, std::memory_order_relaxed);
+
+            if (snapshot.connected)
+            {
+                // Offer the pad; release publishes the source state the probe just read
+                m_handover.store(i, std::memory_order_release);
+                m_searching = false;
+                slot.backoffNs = MIN_BACKOFF_NS;
+                return 0;
+            }
+
+            slot.nextProbeNs = now + slot.backoffNs;
+            slot.backoffNs = (slot.backoffNs * 2 > MAX_BACKOFF_NS) ? MAX_BACKOFF_NS : slot.backoffNs * 2;
+        }
+
+        if (nextDue == 0 || slot.nextProbeNs < nextDue)
+        {
+            nextDue = slot.nextProbeNs;
+        }
+    }
+    return nextDue;
+}
+
+int DeviceWatcher::TakeConnectedSlot()
+{
+    int state = m_handover.load(std::memory_order_acquire);
+    if (state < 0 || state >= ACTIVE_BASE)
+    {
+        return -1;
+    }
+
+    // Only this thread moves a found slot to active, so the exchange cannot race
+    m_handover.store(ACTIVE_BASE + state, std::memory_order_relaxed);
+    return state;
+}
+
+void DeviceWatcher::ReportLost(int slot)
+{
+    if (m_handover.load(std::memory_order_relaxed) == ACTIVE_BASE + slot)
+    {
+        // Release: the watcher sees the source exactly as this thread left it
+        m_handover.store(SEARCHING, std::memory_order_release);
+    }
+}
+
+int DeviceWatcher::GetActiveSlot() const
+{
+    int state = m_handover.load(std::memory_order_relaxed);
+    return (state >= ACTIVE_BASE) ? state - ACTIVE_BASE : -1;
+}
+
+void DeviceWatcher::ResetBackoff(uint64_t now)
+{
+    for (int i = 0; i < MAX_SLOTS; ++i)
+    {
+        m_slots[i].nextProbeNs = now;
+        m_slots[i].backoffNs = MIN_BACKOFF_NS;
+    }
+}
+
+void DeviceWatcher::ThreadLoop()
+{
+    while (m_running.load(std::memory_order_relaxed))
+    {
+        uint64_t nextDue = Probe();
+
+        uint64_t now = m_clock.NowNanoseconds();
+        uint64_t wake = now + IDLE_SLEEP_NS;
+        if (nextDue != 0 && nextDue < wake)
+        {
+            wake = nextDue;
+        }
+        m_clock.SleepUntil(wake);
+    }
+}
+
+HotplugInputSource::HotplugInputSource(DeviceWatcher& watcher)
+    : m_watcher(watcher)
+    , m_slot(-1)
+    , m_last()
+    , m_reportedPacket(0)
+    , m_reportedConnected(false)
+    , m_reportedAny(false)
+{
+}
+
+bool HotplugInputSource::Read(uint64_t timestampNs, PadSnapshot& snapshot)
+{
+    if (m_slot < 0)
+    {
+        m_slot = m_watcher.TakeConnectedSlot();
+    }
+
+    if (m_slot >= 0)
+    {
+        m_watcher.GetSlot(m_slot)->Read(timestampNs, m_last);
+        if (!m_last.connected)
+        {
+            m_watcher.ReportLost(m_slot);
+            m_slot = -1;
+        }
+    }
+    else
+    {
+        // Keep the last pad state; only the connection is reported
+        m_last.timestampNs = timestampNs;
+        m_last.connected = 0;
+    }
+
+    snapshot = m_last;
+
+    // A switch to another slot always passes through disconnected, so it is never missed
+    bool connected = m_last.connected != 0;
+    bool changed = !m_reportedAny || connected != m_reportedConnected || m_last.packetNumber != m_reportedPacket;
+    m_reportedAny = true;
+    m_reportedConnected = connected;
+    m_reportedPacket = m_last.packetNumber;
+    return changed;
+}
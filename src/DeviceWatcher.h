@@ -0,0 +1,163 @@
+#pragma once
+
+#include "IInputSource.h"
+#include "MonotonicClock.h"
+#include "PadState.h"
+#include <atomic>
+#include <cstdint>
+#include <thread>
+
+/**
+ * DeviceWatcher - Finds a connected pad in the background and hands it over
+ *
+ * While no pad is in use, a watcher thread probes every slot (XInput user
+ * index 0-3). Reading an empty XInput slot is slow, so each slot is probed
+ * with exponential backoff (MIN_BACKOFF_NS doubling up to MAX_BACKOFF_NS)
+ * instead of every frame. Once a slot reports a pad, probing stops and the
+ * slot is offered to the reading thread (HotplugInputSource), which claims
+ * it with TakeConnectedSlot() and gives it back with ReportLost() when the
+ * pad disconnects; probing then resumes with the backoff reset.
+ *
+ * A slot's source is only ever touched by one thread at a time: the watcher
+ * while searching, the reader after claiming it. Probe() can be driven
+ * directly (without Start) with a fake clock and scripted sources.
+ */
+class DeviceWatcher
+{
+public:
+    static const int MAX_SLOTS = 4;
+    static const uint64_t MIN_BACKOFF_NS = 50000000ULL;     // 50 ms
+    static const uint64_t MAX_BACKOFF_NS = 2000000000ULL;   // 2 s
+
+    /**
+     * @param clock Clock for probe scheduling (must outlive the watcher; once started, the
+     *              watcher thread sleeps on it, so no other thread may sleep on it too)
+     */
+    explicit DeviceWatcher(IMonotonicClock& clock);
+    ~DeviceWatcher();
+
+    DeviceWatcher(const DeviceWatcher&) = delete;
+    DeviceWatcher& operator=(const DeviceWatcher&) = delete;
+
+    /**
+     * Register the source of a slot (before Start)
+     * @param slot Slot index (0 to MAX_SLOTS-1)
+     * @param source Slot backend (must outlive the watcher), or nullptr for an unused slot
+     */
+    void SetSlot(int slot, IInputSource* source);
+
+    /**
+     * Get the source of a slot
+     */
+    IInputSource* GetSlot(int slot) const { return m_slots[slot].source; }
+
+    /**
+     * Start the watcher thread
+     */
+    void Start();
+
+    /**
+     * Stop the watcher thread
+     */
+    void Stop();
+
+    /**
+     * Run one probing pass: probe every slot whose backoff has expired
+     * Called by the watcher thread; tests may call it directly instead of Start().
+     * @return Time of the next due probe (0 if not searching)
+     */
+    uint64_t Probe();
+
+    /**
+     * Claim the pad the watcher found (reading thread)
+     * @return Slot index, or -1 if no pad is waiting
+     */
+    int TakeConnectedSlot();
+
+    /**
+     * Give a claimed slot back after its pad disconnected (reading thread)
+     */
+    void ReportLost(int slot);
+
+    /**
+     * Get the slot currently claimed by the reader (any thread)
+     * @return Slot index, or -1 if none
+     */
+    int GetActiveSlot() const;
+
+    /**
+     * Get the current backoff of a slot
+     */
+    uint64_t GetBackoffNanoseconds(int slot) const { return m_slots[slot].backoffNs; }
+
+    /**
+     * Get the number of probes made on a slot
+     */
+    uint64_t GetProbeCount(int slot) const { return m_slots[slot].probeCount.load(std::memory_order_relaxed); }
+
+private:
+    // Handover states: SEARCHING, a found slot (0..3), or ACTIVE_BASE + claimed slot
+    static const int SEARCHING = -1;
+    static const int ACTIVE_BASE = 16;
+
+    // Longest the watcher thread sleeps, so Stop() and ReportLost() are noticed promptly
+    static const uint64_t IDLE_SLEEP_NS = 50000000ULL;
+
+    struct Slot
+    {
+        IInputSource* source;
+        uint64_t nextProbeNs;   // Watcher thread only
+        uint64_t backoffNs;     // Watcher thread only
+        std::atomic<uint64_t> probeCount;
+    };
+
+    /**
+     * Watcher thread body
+     */
+    void ThreadLoop();
+
+    /**
+     * Make every slot due now with the minimum backoff (search starts or restarts)
+     */
+    void ResetBackoff(uint64_t now);
+
+    IMonotonicClock& m_clock;
+    Slot m_slots[MAX_SLOTS];
+    std::atomic<int> m_handover;
+    bool m_searching;       // Watcher thread's view of the last pass (detects search restarts)
+
+    std::thread m_thread;
+    std::atomic<bool> m_running;
+};
+
+/**
+ * HotplugInputSource - IInputSource that follows whichever pad DeviceWatcher finds
+ *
+ * Reports disconnected while no pad is claimed, switches to a newly found pad
+ * on the next Read(), and hands the slot back when its pad disconnects. Never
+ * touches an empty slot itself, so the polling thread stays cheap.
+ */
+class HotplugInputSource : public IInputSource
+{
+public:
+    /**
+     * @param watcher Watcher providing pads (must outlive the source)
+     */
+    explicit HotplugInputSource(DeviceWatcher& watcher);
+
+    bool Read(uint64_t timestampNs, PadSnapshot& snapshot) override;
+
+    /**
+     * Get the slot being read (reading thread)
+     * @return Slot index, or -1 while disconnected
+     */
+    int GetSlot() const { return m_slot; }
+
+private:
+    DeviceWatcher& m_watcher;
+    int m_slot;
+    PadSnapshot m_last;
+    uint32_t m_reportedPacket;
+    bool m_reportedConnected;
+    bool m_reportedAny;
+};
@@ -0,0 +1,430 @@
+#include "EvdevInputSource.h"
+#include "InputCodes.h"
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <chrono>
+#include <thread>
+#include <fcntl.h>
+#include <linux/input.h>
+#include <sys/epoll.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+namespace
+{
+    const int MAX_EVENT_NODES = 64;
+
+    const size_t KEY_BITS_BYTES = (KEY_MAX + 8) / 8;
+    const size_t ABS_BITS_BYTES = (ABS_MAX + 8) / 8;
+
+    bool TestBit(const unsigned char* bits, int bit)
+    {
+        return (bits[bit / 8] & (1 << (bit % 8))) != 0;
+    }
+
+    // Evdev key code -> PadButton bit (0 if unmapped)
+    uint16_t MapButton(uint16_t code)
+    {
+        switch (code)
+        {
+        case BTN_A: return PadButton::A;
+        case BTN_B: return PadButton::B;
+        case BTN_X: return PadButton::X;
+        case BTN_Y: return PadButton::Y;
+        case BTN_TL: return PadButton::LeftShoulder;
+        case BTN_TR: return PadButton::RightShoulder;
+        case BTN_SELECT: return PadButton::Back;
+        case BTN_START: return PadButton::Start;
+        case BTN_THUMBL: return PadButton::LeftThumb;
+        case BTN_THUMBR: return PadButton::RightThumb;
+        case BTN_DPAD_UP: return PadButton::DPadUp;
+        case BTN_DPAD_DOWN: return PadButton::DPadDown;
+        case BTN_DPAD_LEFT: return PadButton::DPadLeft;
+        case BTN_DPAD_RIGHT: return PadButton::DPadRight;
+        default: return 0;
+        }
+    }
+
+    int32_t Clamp(int32_t value, int32_t minimum, int32_t maximum)
+    {
+        return value < minimum ? minimum : (value > maximum ? maximum : value);
+    }
+}
+
+EvdevInputSource::EvdevInputSource()
+    : m_fd(-1)
+    , m_epoll(-1)
+    , m_connected(false)
+    , m_reportedConnected(false)
+    , m_dropping(false)
+    , m_packetNumber(0)
+    , m_reportedPacket(0)
+    , m_pending()
+    , m_state()
+    , m_droppedReports(0)
+    , m_bufferCount(0)
+    , m_bufferIndex(0)
+    , m_partialBytes(0)
+{
+    // xpad defaults; replaced by EVIOCGABS on real devices
+    for (int i = 0; i < AXIS_COUNT; ++i)
+    {
+        m_ranges[i].minimum = -32768;
+        m_ranges[i].maximum = 32767;
+    }
+    m_ranges[AXIS_LT].minimum = 0;
+    m_ranges[AXIS_LT].maximum = 255;
+    m_ranges[AXIS_RT].minimum = 0;
+    m_ranges[AXIS_RT].maximum = 255;
+}
+
+EvdevInputSource::~EvdevInputSource()
+{
+    Close();
+}
+
+bool EvdevInputSource::Open(const char* path)
+{
+    int fd = open(path, O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0)
+    {
+        return false;
+    }
+    return OpenFd(fd);
+}
+
+bool EvdevInputSource::OpenFd(int fd)
+{
+    Close();
+
+    m_fd = fd;
+
+    // Read() drains until EAGAIN, so the fd must not block
+    int flags = fcntl(m_fd, F_GETFL);
+    if (flags < 0 || fcntl(m_fd, F_SETFL, flags | O_NONBLOCK) < 0)
+    {
+        Close();
+        return false;
+    }
+
+    m_epoll = epoll_create1(EPOLL_CLOEXEC);
+    if (m_epoll < 0)
+    {
+        Close();
+        return false;
+    }
+
+    epoll_event watch = {};
+    watch.events = EPOLLIN;
+    watch.data.fd = m_fd;
+    if (epoll_ctl(m_epoll, EPOLL_CTL_ADD, m_fd, &watch) < 0)
+    {
+        Close();
+        return false;
+    }
+
+    m_pending = PadState();
+    m_dropping = false;
+    m_bufferCount = 0;
+    m_bufferIndex = 0;
+    m_partialBytes = 0;
+    QueryDevice();
+
+    // The first Read() reports the initial state as a change
+    m_state = m_pending;
+    m_connected = true;
+    ++m_packetNumber;
+    return true;
+}
+
+void EvdevInputSource::Close()
+{
+    if (m_epoll >= 0)
+    {
+        close(m_epoll);
+        m_epoll = -1;
+    }
+    if (m_fd >= 0)
+    {
+        close(m_fd);
+        m_fd = -1;
+    }
+    m_connected = false;
+}
+
+std::string EvdevInputSource::FindGamepad()
+{
+    for (int i = 0; i < MAX_EVENT_NODES; ++i)
+    {
+        char path[32];
+        std::snprintf(path, sizeof(path), "/dev/input/event%d", i);
+
+        int fd = open(path, O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+        if (fd < 0)
+        {
+            continue;
+        }
+
+        unsigned char keyBits[KEY_BITS_BYTES] = {};
+        unsigned char absBits[ABS_BITS_BYTES] = {};
+        bool isGamepad = ioctl(fd, EVIOCGBIT(EV_KEY, sizeof(keyBits)), keyBits) >= 0 &&
+                         ioctl(fd, EVIOCGBIT(EV_ABS, sizeof(absBits)), absBits) >= 0 &&
+                         TestBit(keyBits, BTN_GAMEPAD) && TestBit(absBits, ABS_X);
+        close(fd);
+
+        if (isGamepad)
+        {
+            return path;
+        }
+    }
+    return std::string();
+}
+
+bool EvdevInputSource::WaitForInput(uint64_t timeoutNs)
+{
+    if (!m_connected)
+    {
+        // Nothing to wait on; behave like an idle poll interval
+        std::this_thread::sleep_for(std::chrono::nanoseconds(timeoutNs));
+        return false;
+    }
+
+    // epoll_wait takes milliseconds; round up so a short timeout does not become a busy loop
+    int timeoutMs = static_cast<int>((timeoutNs + 999999ULL) / 1000000ULL);
+    epoll_event ready;
+    int count = epoll_wait(m_epoll, &ready, 1, timeoutMs);
+    return count > 0;
+}
+
+bool EvdevInputSource::Read(uint64_t timestampNs, PadSnapshot& snapshot)
+{
+    while (true)
+    {
+        if (m_bufferIndex == m_bufferCount && !FillBuffer())
+        {
+            break;
+        }
+
+        const input_event& event = m_buffer[m_bufferIndex++];
+        if (HandleEvent(event.type, event.code, event.value))
+        {
+            // One report per Read(); the rest stays buffered for the next call
+            break;
+        }
+    }
+
+    snapshot = PadSnapshot();
+    snapshot.timestampNs = timestampNs;
+    snapshot.packetNumber = m_packetNumber;
+    snapshot.connected = m_connected ? 1 : 0;
+    snapshot.pad = m_state;
+
+    bool changed = (m_packetNumber != m_reportedPacket) || (m_connected != m_reportedConnected);
+    m_reportedPacket = m_packetNumber;
+    m_reportedConnected = m_connected;
+    return changed;
+}
+
+bool EvdevInputSource::FillBuffer()
+{
+    // A record cut off by the last read moves to the front; this read completes it
+    unsigned char* data = reinterpret_cast<unsigned char*>(m_buffer);
+    if (m_partialBytes > 0)
+    {
+        std::memmove(data, data + m_bufferCount * sizeof(input_event), m_partialBytes);
+    }
+    m_bufferCount = 0;
+    m_bufferIndex = 0;
+
+    while (m_connected)
+    {
+        ssize_t bytes = read(m_fd, data + m_partialBytes, sizeof(m_buffer) - m_partialBytes);
+        if (bytes < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK)
+            {
+                // ENODEV: the pad was unplugged
+                m_connected = false;
+            }
+            return false;
+        }
+        if (bytes == 0)
+        {
+            // Writer side of a pipe closed
+            m_connected = false;
+            return false;
+        }
+
+        size_t total = m_partialBytes + static_cast<size_t>(bytes);
+        m_bufferCount = total / sizeof(input_event);
+        m_partialBytes = total % sizeof(input_event);
+        if (m_bufferCount > 0)
+        {
+            return true;
+        }
+        // Only part of a record so far (a pipe can split one); read on until EAGAIN
+    }
+    return false;
+}
+
+bool EvdevInputSource::HandleEvent(uint16_t type, uint16_t code, int32_t value)
+{
+    if (type == EV_SYN)
+    {
+        if (code == SYN_DROPPED)
+        {
+            // The kernel buffer overflowed; events up to the next report are incomplete
+            m_dropping = true;
+            ++m_droppedReports;
+        }
+        else if (code == SYN_REPORT)
+        {
+            if (m_dropping)
+            {
+                m_dropping = false;
+                QueryDevice();
+            }
+
+            // PadState has no padding, so a byte compare is exact
+            if (std::memcmp(&m_pending, &m_state, sizeof(PadState)) != 0)
+            {
+                m_state = m_pending;
+                ++m_packetNumber;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    if (m_dropping)
+    {
+        return false;
+    }
+
+    if (type == EV_KEY)
+    {
+        // value 2 is autorepeat; still held
+        bool pressed = value != 0;
+        if (code == BTN_TL2)
+        {
+            m_pending.leftTrigger = pressed ? 255 : 0;
+        }
+        else if (code == BTN_TR2)
+        {
+            m_pending.rightTrigger = pressed ? 255 : 0;
+        }
+        else
+        {
+            SetButton(MapButton(code), pressed);
+        }
+    }
+    else if (type == EV_ABS)
+    {
+        switch (code)
+        {
+        case ABS_X: m_pending.thumbLX = static_cast<int16_t>(Normalize(AXIS_LX, value)); break;
+        case ABS_Y: m_pending.thumbLY = static_cast<int16_t>(Normalize(AXIS_LY, value)); break;
+        case ABS_RX: m_pending.thumbRX = static_cast<int16_t>(Normalize(AXIS_RX, value)); break;
+        case ABS_RY: m_pending.thumbRY = static_cast<int16_t>(Normalize(AXIS_RY, value)); break;
+        case ABS_Z:
+        case ABS_BRAKE:
+            m_pending.leftTrigger = static_cast<uint8_t>(Normalize(AXIS_LT, value));
+            break;
+        case ABS_RZ:
+        case ABS_GAS:
+            m_pending.rightTrigger = static_cast<uint8_t>(Normalize(AXIS_RT, value));
+            break;
+        case ABS_HAT0X:
+            SetButton(PadButton::DPadLeft, value < 0);
+            SetButton(PadButton::DPadRight, value > 0);
+            break;
+        case ABS_HAT0Y:
+            SetButton(PadButton::DPadUp, value < 0);
+            SetButton(PadButton::DPadDown, value > 0);
+            break;
+        default:
+            break;
+        }
+    }
+    return false;
+}
+
+void EvdevInputSource::QueryDevice()
+{
+    static const uint16_t AXIS_CODES[AXIS_COUNT] = { ABS_X, ABS_Y, ABS_RX, ABS_RY, ABS_Z, ABS_RZ };
+
+    input_absinfo info;
+    for (int axis = 0; axis < AXIS_COUNT; ++axis)
+    {
+        if (ioctl(m_fd, EVIOCGABS(AXIS_CODES[axis]), &info) < 0)
+        {
+            // Not an evdev node (pipe, socket): keep the defaults
+            return;
+        }
+        if (info.maximum > info.minimum)
+        {
+            m_ranges[axis].minimum = info.minimum;
+            m_ranges[axis].maximum = info.maximum;
+        }
+        HandleEvent(EV_ABS, AXIS_CODES[axis], info.value);
+    }
+
+    if (ioctl(m_fd, EVIOCGABS(ABS_HAT0X), &info) >= 0)
+    {
+        HandleEvent(EV_ABS, ABS_HAT0X, info.value);
+    }
+    if (ioctl(m_fd, EVIOCGABS(ABS_HAT0Y), &info) >= 0)
+    {
+        HandleEvent(EV_ABS, ABS_HAT0Y, info.value);
+    }
+
+    unsigned char keyState[KEY_BITS_BYTES] = {};
+    if (ioctl(m_fd, EVIOCGKEY(sizeof(keyState)), keyState) >= 0)
+    {
+        for (int code = BTN_MISC; code < BTN_TRIGGER_HAPPY; ++code)
+        {
+            if (MapButton(static_cast<uint16_t>(code)) != 0)
+            {
+                SetButton(MapButton(static_cast<uint16_t>(code)), TestBit(keyState, code));
+            }
+        }
+    }
+}
+
+int32_t EvdevInputSource::Normalize(Axis axis, int32_t value) const
+{
+    const AxisRange& range = m_ranges[axis];
+    int64_t span = static_cast<int64_t>(range.maximum) - range.minimum;
+    int64_t offset = static_cast<int64_t>(Clamp(value, range.minimum, range.maximum)) - range.minimum;
+
+    if (axis == AXIS_LT || axis == AXIS_RT)
+    {
+        return static_cast<int32_t>(offset * 255 / span);
+    }
+
+    int32_t scaled = static_cast<int32_t>(offset * 65535 / span) - 32768;
+
+    // evdev Y grows downwards, XInput Y grows upwards
+    if (axis == AXIS_LY || axis == AXIS_RY)
+    {
+        scaled = -scaled - 1;
+    }
+    return scaled;
+}
+
+void EvdevInputSource::SetButton(uint16_t button, bool pressed)
+{
+    if (pressed)
+    {
+        m_pending.buttons |= button;
+    }
+    else
+    {
+        m_pending.buttons &= static_cast<uint16_t>(~button);
+    }
+}
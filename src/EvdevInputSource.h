@@ -0,0 +1,137 @@
+#pragma once
+
+#include "IInputSource.h"
+#include "PadState.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <linux/input.h>
+
+/**
+ * EvdevInputSource - Linux gamepad backend reading /dev/input/event*
+ *
+ * Event-driven: the device fd is registered with epoll and WaitForInput()
+ * blocks until the kernel delivers events, so a state change is seen as soon
+ * as it arrives instead of on the next poll tick. Events are accumulated into
+ * a pending state and committed on each SYN_REPORT, so a snapshot is never
+ * half of one hardware report. Read() returns at most one committed report;
+ * call it until it returns false to see every report, so a press and release
+ * delivered in the same wakeup are both observed. Values are normalized to XInput ranges and
+ * PadButton bits (Xbox layout as exposed by xpad/xone/hid-microsoft).
+ *
+ * Any readable fd carrying struct input_event records can be attached with
+ * OpenFd(), e.g. the read end of a pipe, to drive the backend without a pad.
+ * A record split across two reads is completed by the second one.
+ */
+class EvdevInputSource : public IInputSource
+{
+public:
+    EvdevInputSource();
+    ~EvdevInputSource() override;
+
+    EvdevInputSource(const EvdevInputSource&) = delete;
+    EvdevInputSource& operator=(const EvdevInputSource&) = delete;
+
+    /**
+     * Open an evdev device node
+     * @param path Device path (e.g. /dev/input/event5)
+     * @return false if the device cannot be opened
+     */
+    bool Open(const char* path);
+
+    /**
+     * Attach an already open fd (takes ownership)
+     * Axis ranges are queried with EVIOCGABS; fds that are not evdev devices
+     * (pipes) keep the default xpad ranges.
+     * @param fd Readable file descriptor delivering struct input_event records
+     * @return false if the fd cannot be watched
+     */
+    bool OpenFd(int fd);
+
+    /**
+     * Stop watching and close the device
+     */
+    void Close();
+
+    /**
+     * Find the first /dev/input/event* node that looks like a gamepad
+     * @return Device path, or an empty string if none was found
+     */
+    static std::string FindGamepad();
+
+    /**
+     * IInputSource: apply buffered events up to the next report that changes the state
+     */
+    bool Read(uint64_t timestampNs, PadSnapshot& snapshot) override;
+    bool IsEventDriven() const override { return true; }
+    bool WaitForInput(uint64_t timeoutNs) override;
+
+    /**
+     * Get the number of SYN_DROPPED reports (kernel buffer overruns)
+     */
+    uint64_t GetDroppedReportCount() const { return m_droppedReports; }
+
+private:
+    /**
+     * Input range of one absolute axis
+     */
+    struct AxisRange
+    {
+        int32_t minimum;
+        int32_t maximum;
+    };
+
+    enum Axis
+    {
+        AXIS_LX,
+        AXIS_LY,
+        AXIS_RX,
+        AXIS_RY,
+        AXIS_LT,
+        AXIS_RT,
+        AXIS_COUNT
+    };
+
+    static const size_t READ_BATCH = 64;
+
+    /**
+     * Refill the event buffer from the fd
+     * @return false if nothing was available (or the device went away)
+     */
+    bool FillBuffer();
+
+    /**
+     * Apply one input event to the pending state
+     * @return true if the event committed a report that changed the state
+     */
+    bool HandleEvent(uint16_t type, uint16_t code, int32_t value);
+
+    /**
+     * Query axis ranges and the current key/axis state from the device (no-op on non-evdev fds)
+     */
+    void QueryDevice();
+
+    /**
+     * Convert a raw axis value to the XInput range of that axis
+     */
+    int32_t Normalize(Axis axis, int32_t value) const;
+
+    void SetButton(uint16_t button, bool pressed);
+
+    int m_fd;
+    int m_epoll;
+    bool m_connected;
+    bool m_reportedConnected;   // Connection state returned by the last Read()
+    bool m_dropping;            // Inside a SYN_DROPPED gap; ignore events until the next SYN_REPORT
+    uint32_t m_packetNumber;    // Incremented per committed report that changed the state
+    uint32_t m_reportedPacket;  // Packet number returned by the last Read()
+    PadState m_pending;         // Accumulates events of the current report
+    PadState m_state;           // Last committed report
+    AxisRange m_ranges[AXIS_COUNT];
+    uint64_t m_droppedReports;
+
+    input_event m_buffer[READ_BATCH];   // Events read from the fd but not applied yet
+    size_t m_bufferCount;
+    size_t m_bufferIndex;
+    size_t m_partialBytes;              // Bytes of an incomplete record after the m_bufferCount whole ones
+};
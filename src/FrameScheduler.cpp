@@ -0,0 +1,92 @@
+#include "FrameScheduler.h"
+
+FrameScheduler::FrameScheduler(IMonotonicClock& clock)
+    : m_clock(clock)
+    , m_periodNs(0)
+    , m_nextDeadline(0)
+    , m_policy(OverrunPolicy::Skip)
+    , m_maxCatchUpFrames(0)
+    , m_frameCount(0)
+    , m_overrunCount(0)
+    , m_missedDeadlineCount(0)
+    , m_skippedFrameCount(0)
+    , m_maxLatenessNs(0)
+{
+    Initialize(200);
+}
+
+void FrameScheduler::Initialize(uint32_t rateHz, OverrunPolicy policy, uint32_t maxCatchUpFrames)
+{
+    if (rateHz == 0)
+    {
+        rateHz = 1;
+    }
+    else if (rateHz > MAX_RATE_HZ)
+    {
+        rateHz = MAX_RATE_HZ;
+    }
+
+    m_periodNs = 1000000000ULL / rateHz;
+    m_policy = policy;
+    m_maxCatchUpFrames = maxCatchUpFrames;
+}
+
+void FrameScheduler::Start()
+{
+    m_nextDeadline = m_clock.NowNanoseconds() + m_periodNs;
+    m_frameCount = 0;
+    m_overrunCount = 0;
+    m_missedDeadlineCount = 0;
+    m_skippedFrameCount = 0;
+    m_maxLatenessNs = 0;
+}
+
+uint64_t FrameScheduler::WaitForNextFrame()
+{
+    uint64_t now = m_clock.NowNanoseconds();
+
+    if (now < m_nextDeadline)
+    {
+        // Coarse sleep until just before the deadline, then spin the tail
+        uint64_t slack = m_clock.GetSleepSlackNanoseconds();
+        if (m_nextDeadline - now > slack)
+        {
+            m_clock.SleepUntil(m_nextDeadline - slack);
+        }
+
+        now = m_clock.NowNanoseconds();
+        while (now < m_nextDeadline)
+        {
+            m_clock.Relax();
+            now = m_clock.NowNanoseconds();
+        }
+    }
+    else
+    {
+        // The previous frame's work ran past this deadline; count whole periods missed
+        ++m_missedDeadlineCount;
+        uint64_t missedFrames = (now - m_nextDeadline) / m_periodNs;
+        if (missedFrames > 0)
+        {
+            ++m_overrunCount;
+
+            if (m_policy == OverrunPolicy::Skip || missedFrames > m_maxCatchUpFrames)
+            {
+                // Realign to the grid; CatchUp leaves the backlog so the next calls return immediately
+                m_nextDeadline += missedFrames * m_periodNs;
+                m_skippedFrameCount += missedFrames;
+            }
+        }
+    }
+
+    uint64_t lateness = now - m_nextDeadline;
+    if (lateness > m_maxLatenessNs)
+    {
+        m_maxLatenessNs = lateness;
+    }
+
+    m_nextDeadline += m_periodNs;
+    ++m_frameCount;
+
+    return lateness;
+}
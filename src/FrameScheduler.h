@@ -0,0 +1,103 @@
+#pragma once
+
+#include "MonotonicClock.h"
+#include <cstdint>
+
+/**
+ * What to do when a frame takes longer than its period
+ */
+enum class OverrunPolicy
+{
+    Skip,       // Drop the missed frames and realign to the next deadline on the grid
+    CatchUp     // Run the missed frames back-to-back (bounded by maxCatchUpFrames), then resume
+};
+
+/**
+ * FrameScheduler - Paces the main loop on absolute deadlines
+ *
+ * Deadlines sit on a fixed grid (start + n * period), so time spent doing the
+ * frame's work never accumulates as drift. Waiting is hybrid: the thread sleeps
+ * until shortly before the deadline, then spins the remaining tail to hit it
+ * precisely. The clock is injected so pacing can be driven by a fake clock.
+ */
+class FrameScheduler
+{
+public:
+    static const uint32_t MAX_RATE_HZ = 1000;
+
+    /**
+     * @param clock Monotonic clock used for timing and sleeping (must outlive the scheduler)
+     */
+    explicit FrameScheduler(IMonotonicClock& clock);
+
+    /**
+     * Configure the scheduler
+     * @param rateHz Target frame rate (1 to MAX_RATE_HZ, clamped)
+     * @param policy Overrun handling policy
+     * @param maxCatchUpFrames Largest backlog that CatchUp will replay before skipping
+     */
+    void Initialize(uint32_t rateHz, OverrunPolicy policy = OverrunPolicy::Skip, uint32_t maxCatchUpFrames = 4);
+
+    /**
+     * Anchor the deadline grid at the current time
+     * Call once right before entering the loop
+     */
+    void Start();
+
+    /**
+     * Wait until the next frame deadline, then advance the deadline by one period
+     * @return How late the frame starts relative to its deadline, in nanoseconds
+     */
+    uint64_t WaitForNextFrame();
+
+    /**
+     * Get the frame period
+     * @return Period in nanoseconds
+     */
+    uint64_t GetPeriodNanoseconds() const { return m_periodNs; }
+
+    /**
+     * Get the deadline the next WaitForNextFrame() call will wait for
+     * @return Absolute time in nanoseconds
+     */
+    uint64_t GetNextDeadline() const { return m_nextDeadline; }
+
+    /**
+     * Get the number of frames started since Start()
+     */
+    uint64_t GetFrameCount() const { return m_frameCount; }
+
+    /**
+     * Get the number of times a frame ran past a whole period
+     */
+    uint64_t GetOverrunCount() const { return m_overrunCount; }
+
+    /**
+     * Get the number of frames whose work was still running when their deadline passed
+     */
+    uint64_t GetMissedDeadlineCount() const { return m_missedDeadlineCount; }
+
+    /**
+     * Get the number of frame slots dropped by the overrun policy
+     */
+    uint64_t GetSkippedFrameCount() const { return m_skippedFrameCount; }
+
+    /**
+     * Get the worst observed lateness
+     * @return Lateness in nanoseconds
+     */
+    uint64_t GetMaxLatenessNanoseconds() const { return m_maxLatenessNs; }
+
+private:
+    IMonotonicClock& m_clock;
+    uint64_t m_periodNs;
+    uint64_t m_nextDeadline;
+    OverrunPolicy m_policy;
+    uint32_t m_maxCatchUpFrames;
+
+    uint64_t m_frameCount;
+    uint64_t m_overrunCount;
+    uint64_t m_missedDeadlineCount;
+    uint64_t m_skippedFrameCount;
+    uint64_t m_maxLatenessNs;
+};
@@ -0,0 +1,195 @@
+#include "GestureRecognizer.h"
+
+namespace
+{
+    uint64_t Milliseconds(uint16_t ms)
+    {
+        return static_cast<uint64_t>(ms) * 1000000ULL;
+    }
+}
+
+GestureRecognizer::GestureRecognizer()
+{
+    Reset();
+}
+
+void GestureRecognizer::Reset()
+{
+    for (ButtonState& state : m_states)
+    {
+        state.pressNs = 0;
+        state.deadlineNs = 0;
+        state.phase = Phase::Idle;
+    }
+    m_pendingMask = 0;
+    m_holdingMask = 0;
+}
+
+void GestureRecognizer::Reset(uint32_t buttons)
+{
+    for (uint32_t remaining = buttons; remaining; remaining &= remaining - 1)
+    {
+        m_states[BindingTable::LowestSetBit(remaining)].phase = Phase::Idle;
+    }
+    m_pendingMask &= ~buttons;
+    m_holdingMask &= ~buttons;
+}
+
+bool GestureRecognizer::Expire(uint64_t nowNs, const BindingTable& bindings, Fired* fired, int& count)
+{
+    bool changed = false;
+    uint32_t pending = m_pendingMask;
+    while (pending)
+    {
+        int bit = BindingTable::LowestSetBit(pending);
+        pending &= pending - 1;
+
+        // A long stall can close several windows of one button at once
+        const GestureDefinition& gesture = bindings.GetGesture(bit);
+        ButtonState& state = m_states[bit];
+        while ((m_pendingMask & (1u << bit)) && state.deadlineNs <= nowNs)
+        {
+            changed = true;
+            switch (state.phase)
+            {
+            case Phase::Pressed:
+                EnterHeld(bit, gesture);
+                break;
+
+            case Phase::Held:
+                state.phase = Phase::LongPressed;
+                ClearDeadline(bit);
+                Emit(bit, GestureKind::LongPress, gesture, fired, count);
+                break;
+
+            case Phase::Released:
+                // No second press in time: it was a plain tap
+                state.phase = Phase::Idle;
+                ClearDeadline(bit);
+                Emit(bit, GestureKind::Tap, gesture, fired, count);
+                break;
+
+            default:
+                ClearDeadline(bit);
+                break;
+            }
+        }
+    }
+    return changed;
+}
+
+void GestureRecognizer::Update(uint32_t pressed, uint32_t released, uint64_t nowNs, const BindingTable& bindings,
+                               Fired* fired, int& count)
+{
+    while (released)
+    {
+        int bit = BindingTable::LowestSetBit(released);
+        released &= released - 1;
+        Release(bit, bindings.GetGesture(bit), nowNs, fired, count);
+    }
+
+    while (pressed)
+    {
+        int bit = BindingTable::LowestSetBit(pressed);
+        pressed &= pressed - 1;
+        Press(bit, bindings.GetGesture(bit), nowNs, fired, count);
+    }
+}
+
+void GestureRecognizer::Press(int bit, const GestureDefinition& gesture, uint64_t nowNs, Fired* fired, int& count)
+{
+    ButtonState& state = m_states[bit];
+    if (state.phase == Phase::Released)
+    {
+        // Second press inside the window: fire now rather than on the release
+        state.phase = Phase::SecondPress;
+        ClearDeadline(bit);
+        Emit(bit, GestureKind::DoubleTap, gesture, fired, count);
+        return;
+    }
+
+    state.phase = Phase::Pressed;
+    state.pressNs = nowNs;
+    if (gesture.Has(GestureKind::Hold) || gesture.Has(GestureKind::LongPress))
+    {
+        SetDeadline(bit, nowNs + Milliseconds(gesture.holdMs));
+    }
+    else
+    {
+        // Nothing competes with the tap, so the press length does not matter
+        ClearDeadline(bit);
+    }
+}
+
+void GestureRecognizer::Release(int bit, const GestureDefinition& gesture, uint64_t nowNs, Fired* fired, int& count)
+{
+    ButtonState& state = m_states[bit];
+    switch (state.phase)
+    {
+    case Phase::Pressed:
+        if (gesture.Has(GestureKind::DoubleTap))
+        {
+            state.phase = Phase::Released;
+            SetDeadline(bit, nowNs + Milliseconds(gesture.doubleTapMs));
+        }
+        else
+        {
+            state.phase = Phase::Idle;
+            ClearDeadline(bit);
+            Emit(bit, GestureKind::Tap, gesture, fired, count);
+        }
+        break;
+
+    case Phase::Held:
+    case Phase::LongPressed:
+    case Phase::SecondPress:
+        state.phase = Phase::Idle;
+        ClearDeadline(bit);
+        m_holdingMask &= ~(1u << bit);
+        break;
+
+    default:
+        break;
+    }
+}
+
+void GestureRecognizer::EnterHeld(int bit, const GestureDefinition& gesture)
+{
+    ButtonState& state = m_states[bit];
+    state.phase = Phase::Held;
+    if (gesture.Has(GestureKind::Hold))
+    {
+        m_holdingMask |= (1u << bit);
+    }
+
+    if (gesture.Has(GestureKind::LongPress))
+    {
+        SetDeadline(bit, state.pressNs + Milliseconds(gesture.longPressMs));
+    }
+    else
+    {
+        ClearDeadline(bit);
+    }
+}
+
+void GestureRecognizer::SetDeadline(int bit, uint64_t deadlineNs)
+{
+    m_states[bit].deadlineNs = deadlineNs;
+    m_pendingMask |= (1u << bit);
+}
+
+void GestureRecognizer::ClearDeadline(int bit)
+{
+    m_pendingMask &= ~(1u << bit);
+}
+
+void GestureRecognizer::Emit(int bit, GestureKind kind, const GestureDefinition& gesture, Fired* fired, int& count)
+{
+    if (!gesture.Has(kind) || count >= MAX_FIRED)
+    {
+        return;
+    }
+    fired[count].button = static_cast<uint8_t>(bit);
+    fired[count].kind = kind;
+    ++count;
+}
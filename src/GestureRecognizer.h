@@ -0,0 +1,106 @@
+#pragma once
+
+#include "BindingTable.h"
+#include <cstdint>
+
+/**
+ * GestureRecognizer - Per-button tap / hold / double-tap / long-press state machines
+ *
+ * Only buttons with a Gesture binding are fed in; every other binding keeps
+ * its one-frame path through the mapper. The per-button state is one small
+ * array entry, and between edges only the buttons with a pending window
+ * (m_pendingMask) are looked at, so idle buttons cost nothing.
+ *
+ * Results are one-shot gestures (Tap, DoubleTap, LongPress) written to a
+ * caller array, and the mask of buttons whose Hold gesture is active.
+ */
+class GestureRecognizer
+{
+public:
+    /**
+     * A recognized one-shot gesture
+     */
+    struct Fired
+    {
+        uint8_t button;     // Button bit index
+        GestureKind kind;
+    };
+
+    // Enough for every button to finish a gesture and start another in one call
+    static const int MAX_FIRED = 2 * PadButton::COUNT;
+
+    GestureRecognizer();
+
+    /**
+     * Close the windows that ran out by now
+     * @param nowNs Current time
+     * @param bindings Gesture definitions
+     * @param fired Receives up to MAX_FIRED gestures
+     * @param count Number of entries in fired; incremented per gesture
+     * @return True if anything changed (a gesture fired or a hold began)
+     */
+    bool Expire(uint64_t nowNs, const BindingTable& bindings, Fired* fired, int& count);
+
+    /**
+     * Feed button edges (call Expire() first for the same time)
+     * @param pressed Gesture buttons that went down
+     * @param released Gesture buttons that went up
+     * @param nowNs Time of the edges
+     * @param bindings Gesture definitions
+     * @param fired Receives up to MAX_FIRED gestures
+     * @param count Number of entries in fired; incremented per gesture
+     */
+    void Update(uint32_t pressed, uint32_t released, uint64_t nowNs, const BindingTable& bindings, Fired* fired, int& count);
+
+    /**
+     * Get the buttons whose Hold gesture is active
+     */
+    uint32_t GetHoldingMask() const { return m_holdingMask; }
+
+    /**
+     * Check if any button waits for a window to close
+     */
+    bool HasPending() const { return m_pendingMask != 0; }
+
+    /**
+     * Forget all buttons (outputs released, bindings replaced)
+     */
+    void Reset();
+
+    /**
+     * Forget some buttons (their binding changed, e.g. a layer switch)
+     * A hold they were in ends; a release that follows is ignored.
+     * @param buttons Button bits to forget
+     */
+    void Reset(uint32_t buttons);
+
+private:
+    enum class Phase : uint8_t
+    {
+        Idle,
+        Pressed,        // Down, shorter than holdMs so far
+        Held,           // Down past holdMs, long press not reached
+        LongPressed,    // Long press fired, waiting for the release
+        Released,       // Tapped, waiting to see whether a second press follows
+        SecondPress     // Double tap fired, waiting for the release
+    };
+
+    struct ButtonState
+    {
+        uint64_t pressNs;       // Time of the last press
+        uint64_t deadlineNs;    // When the current window closes (valid while pending)
+        Phase phase;
+    };
+
+    void Press(int bit, const GestureDefinition& gesture, uint64_t nowNs, Fired* fired, int& count);
+    void Release(int bit, const GestureDefinition& gesture, uint64_t nowNs, Fired* fired, int& count);
+    void EnterHeld(int bit, const GestureDefinition& gesture);
+    void SetDeadline(int bit, uint64_t deadlineNs);
+    void ClearDeadline(int bit);
+
+    static void Emit(int bit, GestureKind kind, const GestureDefinition& gesture, Fired* fired, int& count);
+
+    ButtonState m_states[PadButton::COUNT];
+    uint32_t m_pendingMask;
+    uint32_t m_holdingMask;
+};
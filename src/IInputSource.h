@@ -0,0 +1,41 @@
+#pragma once
+
+#include "PadState.h"
+#include <cstdint>
+
+/**
+ * IInputSource - Producer of normalized pad state
+ *
+ * Backends translate their native state (XINPUT_STATE, evdev events) into a
+ * PadState with XInput value ranges and PadButton bits. Polled sources
+ * (XInput) are read on a fixed schedule; event-driven sources (evdev) can
+ * block in WaitForInput() until the kernel delivers new input.
+ *
+ * A source is used by one thread at a time (normally the InputPoller thread).
+ */
+class IInputSource
+{
+public:
+    virtual ~IInputSource() = default;
+
+    /**
+     * Read the newest state
+     * @param timestampNs Monotonic time to stamp the snapshot with
+     * @param snapshot Receives the current state
+     * @return true if the state or the connection changed since the previous Read()
+     */
+    virtual bool Read(uint64_t timestampNs, PadSnapshot& snapshot) = 0;
+
+    /**
+     * Check whether WaitForInput() blocks until input arrives
+     * @return false for polled sources, which the caller must pace itself
+     */
+    virtual bool IsEventDriven() const { return false; }
+
+    /**
+     * Block until new input may be available (event-driven sources only)
+     * @param timeoutNs Longest time to wait
+     * @return true if input is ready to Read(), false on timeout
+     */
+    virtual bool WaitForInput(uint64_t timeoutNs) { (void)timeoutNs; return false; }
+};
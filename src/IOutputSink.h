@@ -0,0 +1,24 @@
+#pragma once
+
+#include "OutputEvent.h"
+#include <cstddef>
+
+/**
+ * IOutputSink - Destination for batches of keyboard/mouse events
+ *
+ * Implementations must deliver events in the given order. KeyboardMouse is
+ * the Win32 implementation (one SendInput call per batch).
+ */
+class IOutputSink
+{
+public:
+    virtual ~IOutputSink() = default;
+
+    /**
+     * Deliver a batch of events
+     * @param events Events in emission order
+     * @param count Number of events
+     * @return Number of events delivered successfully
+     */
+    virtual size_t Submit(const OutputEvent* events, size_t count) = 0;
+};
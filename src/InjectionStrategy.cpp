@@ -0,0 +1,94 @@
+#include "InjectionStrategy.h"
+#include <cstring>
+
+InjectionStrategySelector::InjectionStrategySelector(IInjectionBackend& backend, IMonotonicClock& clock)
+    : m_backend(backend)
+    , m_clock(clock)
+    , m_target(0)
+    , m_selected(InjectionMethod::Count)
+    , m_probeCount(0)
+{
+    std::memset(m_stats, 0, sizeof(m_stats));
+}
+
+bool InjectionStrategySelector::SendKey(uintptr_t target, uint16_t keyCode, bool keyDown)
+{
+    if (GetMethodFor(target) != InjectionMethod::Count)
+    {
+        if (Attempt(m_selected, target, keyCode, keyDown))
+        {
+            return true;
+        }
+
+        // The cached method stopped working; fall through to a fresh probe
+        m_selected = InjectionMethod::Count;
+    }
+
+    ++m_probeCount;
+    for (int i = 0; i < static_cast<int>(InjectionMethod::Count); ++i)
+    {
+        InjectionMethod method = static_cast<InjectionMethod>(i);
+        if (Attempt(method, target, keyCode, keyDown))
+        {
+            m_selected = method;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+InjectionMethod InjectionStrategySelector::GetMethodFor(uintptr_t target)
+{
+    // A different window may accept different methods
+    if (target != m_target)
+    {
+        m_target = target;
+        m_selected = InjectionMethod::Count;
+    }
+    return m_selected;
+}
+
+void InjectionStrategySelector::Invalidate()
+{
+    m_selected = InjectionMethod::Count;
+}
+
+bool InjectionStrategySelector::Attempt(InjectionMethod method, uintptr_t target, uint16_t keyCode, bool keyDown)
+{
+    InjectionMethodStats& stats = m_stats[static_cast<int>(method)];
+
+    uint64_t start = m_clock.NowNanoseconds();
+    bool ok = m_backend.Inject(method, target, keyCode, keyDown);
+    uint64_t latency = m_clock.NowNanoseconds() - start;
+
+    ++stats.attempts;
+    if (ok)
+    {
+        ++stats.successes;
+    }
+    else
+    {
+        ++stats.failures;
+    }
+    stats.totalLatencyNs += latency;
+    if (latency > stats.maxLatencyNs)
+    {
+        stats.maxLatencyNs = latency;
+    }
+
+    return ok;
+}
+
+const char* InjectionStrategySelector::GetMethodName(InjectionMethod method)
+{
+    switch (method)
+    {
+    case InjectionMethod::ScanCodeInput: return "SendInput (scan code)";
+    case InjectionMethod::VirtualKeyInput: return "SendInput (virtual key)";
+    case InjectionMethod::WindowMessage: return "Window messages";
+    case InjectionMethod::KeybdEvent: return "keybd_event";
+    case InjectionMethod::Count: break;
+    }
+    return "none";
+}
@@ -0,0 +1,136 @@
+#pragma once
+
+#include "MonotonicClock.h"
+#include <cstdint>
+
+/**
+ * Ways of injecting a key event, in probing order
+ */
+enum class InjectionMethod : uint8_t
+{
+    ScanCodeInput,      // SendInput with KEYEVENTF_SCANCODE
+    VirtualKeyInput,    // SendInput with a virtual key
+    WindowMessage,      // WM_KEYDOWN/WM_KEYUP posted to the target window
+    KeybdEvent,         // Legacy keybd_event
+    Count
+};
+
+/**
+ * IInjectionBackend - Performs one key injection with a specific method
+ */
+class IInjectionBackend
+{
+public:
+    virtual ~IInjectionBackend() = default;
+
+    /**
+     * Inject a key event
+     * @param method Injection method to use
+     * @param target Opaque target window identity (0 = none)
+     * @param keyCode Key code (Win32 virtual key value)
+     * @param keyDown true for key down, false for key up
+     * @return true if the method reports success
+     */
+    virtual bool Inject(InjectionMethod method, uintptr_t target, uint16_t keyCode, bool keyDown) = 0;
+};
+
+/**
+ * Per-method counters
+ */
+struct InjectionMethodStats
+{
+    uint64_t attempts;
+    uint64_t successes;
+    uint64_t failures;
+    uint64_t totalLatencyNs;
+    uint64_t maxLatencyNs;
+};
+
+/**
+ * InjectionStrategySelector - Picks and caches the injection method that works
+ *
+ * The first event for a target window probes the methods in order and keeps
+ * the first one that succeeds. Later events use only that method. The cache is
+ * dropped when the target window changes or the cached method fails, and the
+ * next event probes again. Platform-neutral; the real work is done by the backend.
+ */
+class InjectionStrategySelector
+{
+public:
+    /**
+     * @param backend Injection backend (must outlive the selector)
+     * @param clock Clock used for latency counters (must outlive the selector)
+     */
+    InjectionStrategySelector(IInjectionBackend& backend, IMonotonicClock& clock);
+
+    /**
+     * Inject a key event, probing methods if none is cached for this target
+     * @param target Opaque target window identity
+     * @param keyCode Key code
+     * @param keyDown true for key down, false for key up
+     * @return true if some method succeeded
+     */
+    bool SendKey(uintptr_t target, uint16_t keyCode, bool keyDown);
+
+    /**
+     * Get the method cached for a target, forgetting it first if the target changed
+     * @param target Opaque target window identity
+     * @return Cached method, or InjectionMethod::Count if the next key event probes
+     */
+    InjectionMethod GetMethodFor(uintptr_t target);
+
+    /**
+     * Forget the cached method (next event probes again)
+     */
+    void Invalidate();
+
+    /**
+     * Check if a method is cached
+     */
+    bool HasSelection() const { return m_selected != InjectionMethod::Count; }
+
+    /**
+     * Get the cached method (InjectionMethod::Count if none)
+     */
+    InjectionMethod GetSelectedMethod() const { return m_selected; }
+
+    /**
+     * Get the number of probe runs (initial, target change, or failure)
+     */
+    uint64_t GetProbeCount() const { return m_probeCount; }
+
+    /**
+     * Get counters for one method
+     */
+    const InjectionMethodStats& GetStats(InjectionMethod method) const
+    {
+        return m_stats[static_cast<int>(method)];
+    }
+
+    /**
+     * Get a printable name for a method
+     */
+    static const char* GetMethodName(InjectionMethod method);
+
+    /**
+     * Check if a method injects through SendInput, so its key events can share a batch with mouse input
+     */
+    static bool IsSendInputMethod(InjectionMethod method)
+    {
+        return method == InjectionMethod::ScanCodeInput || method == InjectionMethod::VirtualKeyInput;
+    }
+
+private:
+    /**
+     * Run one method and record its counters
+     */
+    bool Attempt(InjectionMethod method, uintptr_t target, uint16_t keyCode, bool keyDown);
+
+    IInjectionBackend& m_backend;
+    IMonotonicClock& m_clock;
+
+    uintptr_t m_target;
+    InjectionMethod m_selected;
+    uint64_t m_probeCount;
+    InjectionMethodStats m_stats[static_cast<int>(InjectionMethod::Count)];
+};
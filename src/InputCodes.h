@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstdint>
+
+/**
+ * Platform-neutral input codes
+ *
+ * Values are identical to the XInput button flags and Win32 virtual-key codes,
+ * so they can be passed straight to XInput/SendInput on Windows while the
+ * mapping logic stays free of <windows.h>.
+ */
+
+/**
+ * Gamepad button bits (same values as XINPUT_GAMEPAD_*)
+ */
+namespace PadButton
+{
+    const uint16_t DPadUp = 0x0001;
+    const uint16_t DPadDown = 0x0002;
+    const uint16_t DPadLeft = 0x0004;
+    const uint16_t DPadRight = 0x0008;
+    const uint16_t Start = 0x0010;
+    const uint16_t Back = 0x0020;
+    const uint16_t LeftThumb = 0x0040;
+    const uint16_t RightThumb = 0x0080;
+    const uint16_t LeftShoulder = 0x0100;
+    const uint16_t RightShoulder = 0x0200;
+    const uint16_t A = 0x1000;
+    const uint16_t B = 0x2000;
+    const uint16_t X = 0x4000;
+    const uint16_t Y = 0x8000;
+
+    const int COUNT = 16; // Number of bits in wButtons
+}
+
+/**
+ * Keyboard key codes (same values as Win32 VK_* codes)
+ * Letters and digits use their ASCII uppercase values ('A'..'Z', '0'..'9').
+ */
+namespace KeyCode
+{
+    const uint16_t Tab = 0x09;
+    const uint16_t Enter = 0x0D;
+    const uint16_t Shift = 0x10;
+    const uint16_t Control = 0x11;
+    const uint16_t Alt = 0x12;
+    const uint16_t Escape = 0x1B;
+    const uint16_t Space = 0x20;
+    const uint16_t Minus = 0xBD;        // VK_OEM_MINUS
+    const uint16_t Equals = 0xBB;       // VK_OEM_PLUS ('=' / '+' key)
+    const uint16_t LeftBracket = 0xDB;  // VK_OEM_4
+    const uint16_t RightBracket = 0xDD; // VK_OEM_6
+}
+
+/**
+ * Mouse button indices (as used by KeyboardMouse::SendMouseButtonDown/Up)
+ */
+namespace MouseButton
+{
+    const uint16_t Left = 0;
+    const uint16_t Right = 1;
+    const uint16_t Middle = 2;
+}
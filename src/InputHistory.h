@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstdint>
+
+/**
+ * InputHistory - The most recent button presses, in a fixed ring
+ *
+ * Keeps the last CAPACITY press edges with their times, so a recognizer can
+ * look back at the gaps between them. A push overwrites the oldest entry;
+ * nothing is allocated.
+ */
+class InputHistory
+{
+public:
+    static const int CAPACITY = 16;     // Power of two
+
+    /**
+     * A press edge
+     */
+    struct Press
+    {
+        uint64_t timestampNs;
+        uint8_t button;         // Button bit index
+    };
+
+    InputHistory()
+        : m_next(0)
+        , m_count(0)
+    {
+    }
+
+    /**
+     * Record a press (the newest entry from now on)
+     */
+    void Push(int button, uint64_t timestampNs)
+    {
+        Press& press = m_entries[m_next & (CAPACITY - 1)];
+        press.timestampNs = timestampNs;
+        press.button = static_cast<uint8_t>(button);
+        ++m_next;
+        m_count = (m_count < CAPACITY) ? m_count + 1 : CAPACITY;
+    }
+
+    /**
+     * Get a recorded press
+     * @param age 0 for the newest, up to GetCount() - 1 for the oldest kept
+     */
+    const Press& Get(int age) const { return m_entries[(m_next - 1 - static_cast<uint32_t>(age)) & (CAPACITY - 1)]; }
+
+    /**
+     * Get the number of presses kept (at most CAPACITY)
+     */
+    int GetCount() const { return m_count; }
+
+    /**
+     * Forget every press
+     */
+    void Clear()
+    {
+        m_next = 0;
+        m_count = 0;
+    }
+
+private:
+    static_assert((CAPACITY & (CAPACITY - 1)) == 0, "CAPACITY must be a power of two");
+
+    Press m_entries[CAPACITY];
+    uint32_t m_next;    // Slot of the next push (wraps)
+    int m_count;
+};
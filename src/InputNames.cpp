@@ -0,0 +1,182 @@
+#include "InputNames.h"
+#include "InputCodes.h"
+#include <cstdlib>
+
+namespace
+{
+    struct ButtonEntry
+    {
+        const char* name;
+        const char* displayName;
+    };
+
+    // Indexed by button bit; bits 10 and 11 are not used by XInput
+    const ButtonEntry BUTTONS[PadButton::COUNT] =
+    {
+        { "DPadUp", "D-Pad Up" },
+        { "DPadDown", "D-Pad Down" },
+        { "DPadLeft", "D-Pad Left" },
+        { "DPadRight", "D-Pad Right" },
+        { "Start", "Start" },
+        { "Back", "Back" },
+        { "LeftThumb", "Left Stick Click" },
+        { "RightThumb", "Right Stick Click" },
+        { "LB", "LB" },
+        { "RB", "RB" },
+        { nullptr, nullptr },
+        { nullptr, nullptr },
+        { "A", "A" },
+        { "B", "B" },
+        { "X", "X" },
+        { "Y", "Y" },
+    };
+
+    struct KeyEntry
+    {
+        uint16_t code;
+        const char* name;
+    };
+
+    // Keys other than letters and digits (those are named by their character)
+    const KeyEntry KEYS[] =
+    {
+        { KeyCode::Tab, "Tab" },
+        { KeyCode::Enter, "Enter" },
+        { KeyCode::Shift, "Shift" },
+        { KeyCode::Control, "Control" },
+        { KeyCode::Alt, "Alt" },
+        { KeyCode::Escape, "Escape" },
+        { KeyCode::Space, "Space" },
+        { KeyCode::Minus, "Minus" },
+        { KeyCode::Equals, "Equals" },
+        { KeyCode::LeftBracket, "LeftBracket" },
+        { KeyCode::RightBracket, "RightBracket" },
+    };
+
+    const char* const MOUSE_BUTTONS[] = { "Left", "Right", "Middle" };
+
+    // Letter and digit names point into this string: "0\0" "1\0" ... "Z\0"
+    const char CHARACTER_NAMES[] =
+        "0\0001\0002\0003\0004\0005\0006\0007\0008\0009\0"
+        "A\0B\0C\0D\0E\0F\0G\0H\0I\0J\0K\0L\0M\0N\0O\0P\0Q\0R\0S\0T\0U\0V\0W\0X\0Y\0Z";
+
+    char ToUpper(char c)
+    {
+        return (c >= 'a' && c <= 'z') ? static_cast<char>(c - 'a' + 'A') : c;
+    }
+
+    /**
+     * Compare a length-delimited name with a table name, ignoring case
+     */
+    bool NameEquals(const char* name, size_t length, const char* tableName)
+    {
+        size_t i = 0;
+        for (; i < length; ++i)
+        {
+            if (tableName[i] == '\0' || ToUpper(name[i]) != ToUpper(tableName[i]))
+            {
+                return false;
+            }
+        }
+        return tableName[i] == '\0';
+    }
+}
+
+namespace InputNames
+{
+    const char* ButtonName(int bitIndex)
+    {
+        return (bitIndex >= 0 && bitIndex < PadButton::COUNT) ? BUTTONS[bitIndex].name : nullptr;
+    }
+
+    const char* ButtonDisplayName(int bitIndex)
+    {
+        return (bitIndex >= 0 && bitIndex < PadButton::COUNT) ? BUTTONS[bitIndex].displayName : nullptr;
+    }
+
+    int ParseButton(const char* name, size_t length)
+    {
+        for (int bit = 0; bit < PadButton::COUNT; ++bit)
+        {
+            if (BUTTONS[bit].name && NameEquals(name, length, BUTTONS[bit].name))
+            {
+                return bit;
+            }
+        }
+        return -1;
+    }
+
+    const char* KeyName(uint16_t keyCode)
+    {
+        if (keyCode >= '0' && keyCode <= '9')
+        {
+            return CHARACTER_NAMES + (keyCode - '0') * 2;
+        }
+        if (keyCode >= 'A' && keyCode <= 'Z')
+        {
+            return CHARACTER_NAMES + (10 + keyCode - 'A') * 2;
+        }
+        for (const KeyEntry& entry : KEYS)
+        {
+            if (entry.code == keyCode)
+            {
+                return entry.name;
+            }
+        }
+        return nullptr;
+    }
+
+    bool ParseKey(const char* name, size_t length, uint16_t& keyCode)
+    {
+        if (length == 1)
+        {
+            char c = ToUpper(name[0]);
+            if ((c >= '0' && c <= '9') || (c >= 'A' && c <= 'Z'))
+            {
+                keyCode = static_cast<uint16_t>(c);
+                return true;
+            }
+        }
+
+        for (const KeyEntry& entry : KEYS)
+        {
+            if (NameEquals(name, length, entry.name))
+            {
+                keyCode = entry.code;
+                return true;
+            }
+        }
+
+        // Any other virtual key as a two-digit hex code
+        if (length == 4 && name[0] == '0' && (name[1] == 'x' || name[1] == 'X'))
+        {
+            char digits[3] = { name[2], name[3], '\0' };
+            char* end = nullptr;
+            unsigned long value = std::strtoul(digits, &end, 16);
+            if (end == digits + 2 && value > 0 && value < 0xFF)
+            {
+                keyCode = static_cast<uint16_t>(value);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    const char* MouseButtonName(uint16_t button)
+    {
+        return (button < sizeof(MOUSE_BUTTONS) / sizeof(MOUSE_BUTTONS[0])) ? MOUSE_BUTTONS[button] : nullptr;
+    }
+
+    bool ParseMouseButton(const char* name, size_t length, uint16_t& button)
+    {
+        for (uint16_t i = 0; i < sizeof(MOUSE_BUTTONS) / sizeof(MOUSE_BUTTONS[0]); ++i)
+        {
+            if (NameEquals(name, length, MOUSE_BUTTONS[i]))
+            {
+                button = i;
+                return true;
+            }
+        }
+        return false;
+    }
+}
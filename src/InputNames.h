@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Names of buttons, keys and mouse buttons as written in profile files
+ *
+ * One table per kind, used both to parse a profile and to print the startup
+ * banner, so the banner shows exactly the names the profile accepts. Lookups
+ * ignore case.
+ */
+namespace InputNames
+{
+    /**
+     * Get the profile name of a button bit ("A", "LB", "DPadUp", ...)
+     * @return Name, or nullptr for the two bits XInput does not use
+     */
+    const char* ButtonName(int bitIndex);
+
+    /**
+     * Get the banner name of a button bit ("A", "LB", "D-Pad Up", ...)
+     * @return Name, or nullptr for the two bits XInput does not use
+     */
+    const char* ButtonDisplayName(int bitIndex);
+
+    /**
+     * Find a button by its profile name
+     * @return Bit index (0-15), or -1 if unknown
+     */
+    int ParseButton(const char* name, size_t length);
+
+    /**
+     * Get the profile name of a key code ("W", "Space", "LeftBracket", ...)
+     * @return Name, or nullptr if the key has none (profiles may still give it as 0xNN)
+     */
+    const char* KeyName(uint16_t keyCode);
+
+    /**
+     * Find a key by its profile name, or by a hex code "0x01".."0xFE"
+     * @return false if unknown
+     */
+    bool ParseKey(const char* name, size_t length, uint16_t& keyCode);
+
+    /**
+     * Get the profile name of a mouse button ("Left", "Right", "Middle")
+     * @return Name, or nullptr if out of range
+     */
+    const char* MouseButtonName(uint16_t button);
+
+    /**
+     * Find a mouse button by its profile name
+     * @return false if unknown
+     */
+    bool ParseMouseButton(const char* name, size_t length, uint16_t& button);
+}
@@ -0,0 +1,110 @@
+#include "InputPoller.h"
+#include "FrameScheduler.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+InputPoller::InputPoller(PadSnapshotRing& ring, IInputSource& source)
+    : m_ring(ring)
+    , m_source(source)
+    , m_rateHz(0)
+    , m_profiler(nullptr)
+    , m_recorder(nullptr)
+    , m_running(false)
+    , m_pollCount(0)
+{
+}
+
+InputPoller::~InputPoller()
+{
+    Stop();
+}
+
+bool InputPoller::Start(uint32_t rateHz)
+{
+    if (m_running.load())
+    {
+        return false;
+    }
+
+    // Consumers start from the current state, connected or not
+    PadSnapshot snapshot;
+    m_source.Read(m_clock.NowNanoseconds(), snapshot);
+    Publish(snapshot);
+
+    m_rateHz = rateHz;
+    m_running.store(true);
+    m_thread = std::thread(&InputPoller::ThreadLoop, this);
+    return true;
+}
+
+void InputPoller::Stop()
+{
+    m_running.store(false);
+    if (m_thread.joinable())
+    {
+        m_thread.join();
+    }
+}
+
+void InputPoller::ThreadLoop()
+{
+#ifdef _WIN32
+    SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_HIGHEST);
+#endif
+
+    bool eventDriven = m_source.IsEventDriven();
+
+    FrameScheduler scheduler(m_clock);
+    scheduler.Initialize(m_rateHz, OverrunPolicy::Skip);
+    scheduler.Start();
+
+    PadSnapshot snapshot;
+    while (m_running.load(std::memory_order_relaxed))
+    {
+        if (eventDriven)
+        {
+            // Sleep in the kernel until the device has something to say
+            if (!m_source.WaitForInput(EVENT_WAIT_TIMEOUT_NS))
+            {
+                continue;
+            }
+
+            // Every report delivered in this wakeup is published, in order
+            while (ReadSource(snapshot))
+            {
+                Publish(snapshot);
+            }
+        }
+        else
+        {
+            if (ReadSource(snapshot))
+            {
+                Publish(snapshot);
+            }
+            scheduler.WaitForNextFrame();
+        }
+    }
+}
+
+bool InputPoller::ReadSource(PadSnapshot& snapshot)
+{
+    m_pollCount.fetch_add(1, std::memory_order_relaxed);
+
+    if (m_profiler)
+    {
+        ScopedStageTimer timer(*m_profiler, ProfileStage::Poll);
+        return m_source.Read(m_clock.NowNanoseconds(), snapshot);
+    }
+    return m_source.Read(m_clock.NowNanoseconds(), snapshot);
+}
+
+void InputPoller::Publish(const PadSnapshot& snapshot)
+{
+    m_ring.Publish(snapshot);
+    if (m_recorder)
+    {
+        m_recorder->Record(snapshot);
+    }
+}
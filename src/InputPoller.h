@@ -0,0 +1,101 @@
+#pragma once
+
+#include "IInputSource.h"
+#include "PadState.h"
+#include "SnapshotRing.h"
+#include "MonotonicClock.h"
+#include "StageProfiler.h"
+#include "TraceRecorder.h"
+#include <atomic>
+#include <cstdint>
+#include <thread>
+
+/**
+ * Ring of pad snapshots shared between the poll thread and its consumers
+ */
+typedef SnapshotRing<PadSnapshot, 256> PadSnapshotRing;
+
+/**
+ * InputPoller - Dedicated thread that reads an input source into a PadSnapshotRing
+ *
+ * Polled sources (XInput) are read on the thread's own deadline schedule,
+ * independent of how long mapping and output take on the consumer side.
+ * Event-driven sources (evdev) are read as soon as the kernel wakes the
+ * thread. A snapshot is published whenever the packet number or the
+ * connection state changes.
+ */
+class InputPoller
+{
+public:
+    /**
+     * @param ring Destination ring (must outlive the poller)
+     * @param source Pad backend, already opened (must outlive the poller; used only by the poll thread once started)
+     */
+    InputPoller(PadSnapshotRing& ring, IInputSource& source);
+    ~InputPoller();
+
+    InputPoller(const InputPoller&) = delete;
+    InputPoller& operator=(const InputPoller&) = delete;
+
+    /**
+     * Time each source read as ProfileStage::Poll
+     * @param profiler Profiler to record into, or nullptr (set before Start)
+     */
+    void SetProfiler(StageProfiler* profiler) { m_profiler = profiler; }
+
+    /**
+     * Record every published snapshot into a trace on the poll thread
+     * @param recorder Recorder to feed, or nullptr (set before Start)
+     */
+    void SetRecorder(TraceRecorder* recorder) { m_recorder = recorder; }
+
+    /**
+     * Publish the current state and start the poll thread
+     * @param rateHz Poll rate for polled sources (up to FrameScheduler::MAX_RATE_HZ)
+     * @return true if the thread was started
+     */
+    bool Start(uint32_t rateHz);
+
+    /**
+     * Stop the poll thread
+     */
+    void Stop();
+
+    /**
+     * Get the number of source reads made
+     */
+    uint64_t GetPollCount() const { return m_pollCount.load(std::memory_order_relaxed); }
+
+private:
+    /**
+     * Longest time an event-driven wait blocks, so Stop() is noticed promptly
+     */
+    static const uint64_t EVENT_WAIT_TIMEOUT_NS = 10000000ULL;
+
+    /**
+     * Poll thread body
+     */
+    void ThreadLoop();
+
+    /**
+     * Read the source once (timed when profiling)
+     * @return true if the state changed
+     */
+    bool ReadSource(PadSnapshot& snapshot);
+
+    /**
+     * Publish a snapshot to the ring (and the trace, if recording)
+     */
+    void Publish(const PadSnapshot& snapshot);
+
+    PadSnapshotRing& m_ring;
+    IInputSource& m_source;
+    SystemClock m_clock;
+    uint32_t m_rateHz;
+    StageProfiler* m_profiler;
+    TraceRecorder* m_recorder;
+
+    std::thread m_thread;
+    std::atomic<bool> m_running;
+    std::atomic<uint64_t> m_pollCount;
+};
@@ -8,7 +8,12 @@
 KeyboardMouse::KeyboardMouse()
     : m_cachedGameWindow(nullptr)
     , m_lastWindowCheckTime(0)
+    , m_injection(*this, m_clock)
 {
+    for (UINT virtualKey = 0; virtualKey < 256; ++virtualKey)
+    {
+        m_scanCodes[virtualKey] = static_cast<WORD>(MapVirtualKey(virtualKey, MAPVK_VK_TO_VSC));
+    }
 }
 
 KeyboardMouse::~KeyboardMouse()
@@ -17,114 +22,66 @@ KeyboardMouse::~KeyboardMouse()
 
 bool KeyboardMouse::SendKeyDown(WORD virtualKey)
 {
-    // Method 1: Try SendInput with scan codes first (most reliable for games)
-    UINT scanCode = MapVirtualKey(virtualKey, MAPVK_VK_TO_VSC);
-    if (scanCode != 0)
-    {
-        INPUT input = { 0 };
-        input.type = INPUT_KEYBOARD;
-        input.ki.wVk = 0; // Use scan code
-        input.ki.wScan = scanCode;
-        input.ki.dwFlags = KEYEVENTF_SCANCODE;
-        input.ki.time = 0;
-        input.ki.dwExtraInfo = 0;
-
-        UINT result = SendInput(1, &input, sizeof(INPUT));
-        if (result == 1)
-        {
-            return true;
-        }
-    }
-
-    // Method 2: Try standard SendInput with virtual key
-    INPUT input2 = { 0 };
-    input2.type = INPUT_KEYBOARD;
-    input2.ki.wVk = virtualKey;
-    input2.ki.dwFlags = 0;
-    input2.ki.time = 0;
-    input2.ki.dwExtraInfo = 0;
+    return m_injection.SendKey(reinterpret_cast<uintptr_t>(GetTargetWindow()), virtualKey, true);
+}
 
-    UINT result2 = SendInput(1, &input2, sizeof(INPUT));
-    if (result2 == 1)
-    {
-        return true;
-    }
+bool KeyboardMouse::SendKeyUp(WORD virtualKey)
+{
+    return m_injection.SendKey(reinterpret_cast<uintptr_t>(GetTargetWindow()), virtualKey, false);
+}
 
-    // Method 3: Try window messages
+HWND KeyboardMouse::GetTargetWindow()
+{
     HWND gameWindow = GetGameWindow();
     if (gameWindow != nullptr)
     {
-        if (SendKeyToWindow(gameWindow, virtualKey, true))
-        {
-            return true;
-        }
+        return gameWindow;
     }
-    
-    // Fallback to foreground window
-    HWND fgWindow = GetForegroundWindow();
-    if (fgWindow != nullptr)
-    {
-        return SendKeyToWindow(fgWindow, virtualKey, true);
-    }
-    
-    // Method 4: Fallback to keybd_event
-    return SendKeyEvent(virtualKey, true);
+    return GetForegroundWindow();
 }
 
-bool KeyboardMouse::SendKeyUp(WORD virtualKey)
+bool KeyboardMouse::Inject(InjectionMethod method, uintptr_t target, uint16_t keyCode, bool keyDown)
 {
-    // Method 1: Try SendInput with scan codes first
-    UINT scanCode = MapVirtualKey(virtualKey, MAPVK_VK_TO_VSC);
-    if (scanCode != 0)
+    switch (method)
     {
+    case InjectionMethod::ScanCodeInput:
+    {
+        WORD scanCode = GetScanCode(keyCode);
+        if (scanCode == 0)
+        {
+            return false;
+        }
+
         INPUT input = { 0 };
         input.type = INPUT_KEYBOARD;
-        input.ki.wVk = 0;
+        input.ki.wVk = 0; // Use scan code
         input.ki.wScan = scanCode;
-        input.ki.dwFlags = KEYEVENTF_SCANCODE | KEYEVENTF_KEYUP;
-        input.ki.time = 0;
-        input.ki.dwExtraInfo = 0;
-
-        UINT result = SendInput(1, &input, sizeof(INPUT));
-        if (result == 1)
-        {
-            return true;
-        }
+        input.ki.dwFlags = KEYEVENTF_SCANCODE | (keyDown ? 0 : KEYEVENTF_KEYUP);
+        return SendInput(1, &input, sizeof(INPUT)) == 1;
     }
-
-    // Method 2: Try standard SendInput
-    INPUT input2 = { 0 };
-    input2.type = INPUT_KEYBOARD;
-    input2.ki.wVk = virtualKey;
-    input2.ki.dwFlags = KEYEVENTF_KEYUP;
-    input2.ki.time = 0;
-    input2.ki.dwExtraInfo = 0;
-
-    UINT result2 = SendInput(1, &input2, sizeof(INPUT));
-    if (result2 == 1)
+    case InjectionMethod::VirtualKeyInput:
     {
-        return true;
+        INPUT input = { 0 };
+        input.type = INPUT_KEYBOARD;
+        input.ki.wVk = keyCode;
+        input.ki.dwFlags = keyDown ? 0 : KEYEVENTF_KEYUP;
+        return SendInput(1, &input, sizeof(INPUT)) == 1;
     }
-
-    // Method 3: Try window messages
-    HWND gameWindow = GetGameWindow();
-    if (gameWindow != nullptr)
+    case InjectionMethod::WindowMessage:
     {
-        if (SendKeyToWindow(gameWindow, virtualKey, false))
+        HWND hWnd = reinterpret_cast<HWND>(target);
+        if (hWnd == nullptr || !IsWindow(hWnd))
         {
-            return true;
+            return false;
         }
+        return SendKeyMessages(hWnd, keyCode, keyDown);
     }
-    
-    // Fallback to foreground window
-    HWND fgWindow = GetForegroundWindow();
-    if (fgWindow != nullptr)
-    {
-        return SendKeyToWindow(fgWindow, virtualKey, false);
+    case InjectionMethod::KeybdEvent:
+        return SendKeyEvent(keyCode, keyDown);
+    case InjectionMethod::Count:
+        break;
     }
-    
-    // Method 4: Fallback to keybd_event
-    return SendKeyEvent(virtualKey, false);
+    return false;
 }
 
 bool KeyboardMouse::SendKeyPress(WORD virtualKey)
@@ -150,19 +107,15 @@ bool KeyboardMouse::SendMouseButtonDown(int button)
 
 bool KeyboardMouse::SendMouseButtonUp(int button)
 {
-    INPUT input = { 0 };
-    input.type = INPUT_MOUSE;
-    
     // Get the corresponding up flag for the button
-    DWORD flag = 0;
-    switch (button)
+    DWORD flag = GetMouseButtonUpFlag(button);
+    if (flag == 0)
     {
-    case 0: flag = MOUSEEVENTF_LEFTUP; break;
-    case 1: flag = MOUSEEVENTF_RIGHTUP; break;
-    case 2: flag = MOUSEEVENTF_MIDDLEUP; break;
-    default: return false;
+        return false;
     }
-    
+
+    INPUT input = { 0 };
+    input.type = INPUT_MOUSE;
     input.mi.dwFlags = flag;
 
     UINT result = SendInput(1, &input, sizeof(INPUT));
@@ -192,53 +145,138 @@ DWORD KeyboardMouse::GetMouseButtonFlag(int button) const
     }
 }
 
-bool KeyboardMouse::SendKeyEvent(WORD virtualKey, bool keyDown)
+DWORD KeyboardMouse::GetMouseButtonUpFlag(int button) const
 {
-    // keybd_event is deprecated but sometimes works when SendInput doesn't
-    // It's less reliable but can bypass some input blocking
-    DWORD flags = keyDown ? 0 : KEYEVENTF_KEYUP;
-    keybd_event(static_cast<BYTE>(virtualKey), 0, flags, 0);
-    return true; // keybd_event doesn't return error codes
+    switch (button)
+    {
+    case 0: return MOUSEEVENTF_LEFTUP;
+    case 1: return MOUSEEVENTF_RIGHTUP;
+    case 2: return MOUSEEVENTF_MIDDLEUP;
+    default: return 0;
+    }
 }
 
-bool KeyboardMouse::SendKeyToWindow(HWND hWnd, WORD virtualKey, bool keyDown)
+size_t KeyboardMouse::Submit(const OutputEvent* events, size_t count)
 {
-    if (hWnd == nullptr)
-    {
-        hWnd = GetForegroundWindow();
-    }
+    size_t delivered = 0;
 
-    if (hWnd == nullptr)
+    // Keys are batched in the form the selector found to work for this window;
+    // before it found one, or if only window messages or keybd_event work, they
+    // end the encoded prefix and go through the selector one by one
+    InjectionMethod keyMethod = m_injection.GetMethodFor(reinterpret_cast<uintptr_t>(GetTargetWindow()));
+
+    while (count > 0)
     {
-        return false;
+        size_t chunk = (count < MAX_BATCH_INPUTS) ? count : MAX_BATCH_INPUTS;
+
+        // Encode the longest prefix SendInput can express
+        size_t encoded = 0;
+        while (encoded < chunk && EncodeInput(events[encoded], keyMethod, m_inputBuffer[encoded]))
+        {
+            ++encoded;
+        }
+
+        // One kernel transition for the whole prefix. SendInput returns how many
+        // records it inserted; the rest were blocked and go through the fallbacks.
+        UINT inserted = 0;
+        if (encoded > 0)
+        {
+            inserted = SendInput(static_cast<UINT>(encoded), m_inputBuffer, sizeof(INPUT));
+        }
+        delivered += inserted;
+
+        size_t consumed = (inserted > 0) ? inserted : 1;
+        if (inserted == 0)
+        {
+            if (SendSingleEvent(events[0]))
+            {
+                ++delivered;
+            }
+
+            // A key sent alone may have probed a new method
+            keyMethod = m_injection.GetSelectedMethod();
+        }
+
+        events += consumed;
+        count -= consumed;
     }
 
-    // Try multiple methods since the game blocks standard input
-    
-    // Method 1: Try SendInput with scan codes (sometimes works when virtual keys don't)
-    UINT scanCode = MapVirtualKey(virtualKey, MAPVK_VK_TO_VSC);
-    if (scanCode != 0)
+    return delivered;
+}
+
+bool KeyboardMouse::EncodeInput(const OutputEvent& event, InjectionMethod keyMethod, INPUT& input) const
+{
+    input = INPUT{};
+
+    switch (event.type)
     {
-        INPUT input = { 0 };
-        input.type = INPUT_KEYBOARD;
-        input.ki.wVk = 0; // Use scan code instead
-        input.ki.wScan = scanCode;
-        input.ki.dwFlags = KEYEVENTF_SCANCODE;
-        if (!keyDown)
+    case OutputEventType::KeyDown:
+    case OutputEventType::KeyUp:
+    {
+        if (!InjectionStrategySelector::IsSendInputMethod(keyMethod))
         {
-            input.ki.dwFlags |= KEYEVENTF_KEYUP;
+            return false;
         }
-        input.ki.time = 0;
-        input.ki.dwExtraInfo = 0;
 
-        UINT result = SendInput(1, &input, sizeof(INPUT));
-        if (result == 1)
+        input.type = INPUT_KEYBOARD;
+        WORD scanCode = GetScanCode(event.code);
+        if (keyMethod == InjectionMethod::ScanCodeInput && scanCode != 0)
+        {
+            input.ki.wScan = scanCode;
+            input.ki.dwFlags = KEYEVENTF_SCANCODE;
+        }
+        else
         {
-            return true;
+            input.ki.wVk = event.code;
         }
+        if (event.type == OutputEventType::KeyUp)
+        {
+            input.ki.dwFlags |= KEYEVENTF_KEYUP;
+        }
+        return true;
     }
+    case OutputEventType::MouseButtonDown:
+        input.type = INPUT_MOUSE;
+        input.mi.dwFlags = GetMouseButtonFlag(event.code);
+        return input.mi.dwFlags != 0;
+    case OutputEventType::MouseButtonUp:
+        input.type = INPUT_MOUSE;
+        input.mi.dwFlags = GetMouseButtonUpFlag(event.code);
+        return input.mi.dwFlags != 0;
+    case OutputEventType::MouseMove:
+        input.type = INPUT_MOUSE;
+        input.mi.dx = event.deltaX;
+        input.mi.dy = event.deltaY;
+        input.mi.dwFlags = MOUSEEVENTF_MOVE;
+        return true;
+    }
+    return false;
+}
 
-    // Method 2: Try window messages with extended key flag
+bool KeyboardMouse::SendSingleEvent(const OutputEvent& event)
+{
+    switch (event.type)
+    {
+    case OutputEventType::KeyDown: return SendKeyDown(event.code);
+    case OutputEventType::KeyUp: return SendKeyUp(event.code);
+    case OutputEventType::MouseButtonDown: return SendMouseButtonDown(event.code);
+    case OutputEventType::MouseButtonUp: return SendMouseButtonUp(event.code);
+    case OutputEventType::MouseMove: return SendMouseMove(event.deltaX, event.deltaY);
+    }
+    return false;
+}
+
+bool KeyboardMouse::SendKeyEvent(WORD virtualKey, bool keyDown)
+{
+    // keybd_event is deprecated but sometimes works when SendInput doesn't
+    // It's less reliable but can bypass some input blocking
+    DWORD flags = keyDown ? 0 : KEYEVENTF_KEYUP;
+    keybd_event(static_cast<BYTE>(virtualKey), 0, flags, 0);
+    return true; // keybd_event doesn't return error codes
+}
+
+bool KeyboardMouse::SendKeyMessages(HWND hWnd, WORD virtualKey, bool keyDown)
+{
     DWORD targetThreadId = GetWindowThreadProcessId(hWnd, nullptr);
     DWORD currentThreadId = GetCurrentThreadId();
     
@@ -248,11 +286,10 @@ bool KeyboardMouse::SendKeyToWindow(HWND hWnd, WORD virtualKey, bool keyDown)
         attached = AttachThreadInput(currentThreadId, targetThreadId, TRUE) != FALSE;
     }
 
-    // Map virtual key to scan code
-    UINT scanCode2 = MapVirtualKey(virtualKey, MAPVK_VK_TO_VSC);
+    UINT scanCode = GetScanCode(virtualKey);
     
     // Create lParam for WM_KEYDOWN/WM_KEYUP with extended key flag
-    LPARAM lParam = (scanCode2 << 16);
+    LPARAM lParam = (scanCode << 16);
     
     // Check if it's an extended key (right alt, ctrl, etc.)
     bool isExtended = (virtualKey == VK_RMENU || virtualKey == VK_RCONTROL || 
@@ -1,21 +1,43 @@
 #pragma once
 
 #include <windows.h>
+#include "IOutputSink.h"
+#include "InjectionStrategy.h"
+#include "MonotonicClock.h"
 
 /**
  * KeyboardMouse - Wrapper for sending keyboard and mouse input using Win32 SendInput API
  * 
  * This class provides methods to send keyboard key events and mouse actions.
  * All input is sent using the SendInput function, which works entirely in user-mode.
+ * As an IOutputSink it accepts whole batches and injects them with a single
+ * SendInput call; key events join the batch only while the cached injection
+ * method (see below) is a SendInput one.
+ *
+ * Single key events go through an InjectionStrategySelector: the injection
+ * method that works for the current game window is probed once and cached,
+ * instead of running the whole fallback cascade on every key.
  */
-class KeyboardMouse
+class KeyboardMouse : public IOutputSink, private IInjectionBackend
 {
 public:
     KeyboardMouse();
-    ~KeyboardMouse();
+    ~KeyboardMouse() override;
 
     /**
-     * Send a keyboard key down event
+     * Inject a batch of events with one SendInput call (order preserved)
+     * Key events are encoded for the cached injection method; while that is not
+     * a SendInput method (or none is cached yet) they are injected one by one
+     * through the selector instead. Events SendInput did not accept fall back to
+     * the per-event methods.
+     * @param events Events in emission order
+     * @param count Number of events
+     * @return Number of events delivered
+     */
+    size_t Submit(const OutputEvent* events, size_t count) override;
+
+    /**
+     * Send a keyboard key down event (using the cached injection method)
      * @param virtualKey Virtual key code (e.g., VK_SPACE, VK_ESCAPE)
      * @return true if successful
      */
@@ -66,22 +88,18 @@ public:
      */
     bool SendKeyEvent(WORD virtualKey, bool keyDown);
 
-    /**
-     * Send keyboard input directly to a window using PostMessage
-     * This bypasses input blocking in some games
-     * @param hWnd Window handle (nullptr = foreground window)
-     * @param virtualKey Virtual key code
-     * @param keyDown true for key down, false for key up
-     * @return true if successful
-     */
-    bool SendKeyToWindow(HWND hWnd, WORD virtualKey, bool keyDown);
-
     /**
      * Get the game window handle (cached for performance)
      * @return Window handle or nullptr if not found
      */
     HWND GetGameWindow();
 
+    /**
+     * Get the key injection method selector (for its counters)
+     * @return Selector
+     */
+    const InjectionStrategySelector& GetInjectionSelector() const { return m_injection; }
+
     /**
      * Find window by title (case-insensitive partial match)
      * Supports both ANSI and Unicode window titles
@@ -91,14 +109,66 @@ public:
     static HWND FindWindowByTitle(const char* titlePart);
 
 private:
+    /**
+     * IInjectionBackend: perform one key injection with the given method
+     */
+    bool Inject(InjectionMethod method, uintptr_t target, uint16_t keyCode, bool keyDown) override;
+
+    /**
+     * Get the window key events are aimed at (game window, else foreground)
+     */
+    HWND GetTargetWindow();
+
+    /**
+     * Send WM_KEYDOWN/WM_KEYUP (and related) messages to a window
+     * @param hWnd Target window
+     * @param virtualKey Virtual key code
+     * @param keyDown true for key down, false for key up
+     * @return true if the messages were sent
+     */
+    bool SendKeyMessages(HWND hWnd, WORD virtualKey, bool keyDown);
+
     /**
      * Helper to convert button index to MOUSEEVENTF flag
      */
     DWORD GetMouseButtonFlag(int button) const;
 
+    /**
+     * Helper to convert button index to the MOUSEEVENTF release flag
+     */
+    DWORD GetMouseButtonUpFlag(int button) const;
+
+    /**
+     * Encode an event as an INPUT record
+     * @param keyMethod Cached key injection method: scan code or virtual key records
+     * @return false if the event cannot be expressed as INPUT (keys under any other method)
+     */
+    bool EncodeInput(const OutputEvent& event, InjectionMethod keyMethod, INPUT& input) const;
+
+    /**
+     * Get the scan code of a virtual key (0 if it has none)
+     */
+    WORD GetScanCode(WORD virtualKey) const { return (virtualKey < 256) ? m_scanCodes[virtualKey] : 0; }
+
+    /**
+     * Deliver one event through the per-event methods (with their fallbacks)
+     */
+    bool SendSingleEvent(const OutputEvent& event);
+
+    // Preallocated SendInput buffer for batches
+    static const size_t MAX_BATCH_INPUTS = 64;
+    INPUT m_inputBuffer[MAX_BATCH_INPUTS];
+
+    // MapVirtualKey results per virtual key, looked up once at construction
+    WORD m_scanCodes[256];
+
     // Cached game window handle to avoid repeated searches
     HWND m_cachedGameWindow;
     DWORD m_lastWindowCheckTime;
     static const DWORD WINDOW_CACHE_TIMEOUT_MS = 5000; // Re-check every 5 seconds
+
+    // Cached key injection method (declared after the clock it uses)
+    SystemClock m_clock;
+    InjectionStrategySelector m_injection;
 };
 
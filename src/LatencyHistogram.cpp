@@ -0,0 +1,106 @@
+#include "LatencyHistogram.h"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace
+{
+    // value must be non-zero
+    int HighestSetBit(uint64_t value)
+    {
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanReverse64(&index, value);
+        return static_cast<int>(index);
+#else
+        return 63 - __builtin_clzll(value);
+#endif
+    }
+}
+
+LatencyHistogram::LatencyHistogram()
+{
+    Reset();
+}
+
+void LatencyHistogram::Reset()
+{
+    for (int i = 0; i < BUCKET_COUNT; ++i)
+    {
+        m_buckets[i].store(0, std::memory_order_relaxed);
+    }
+    m_count.store(0, std::memory_order_relaxed);
+    m_max.store(0, std::memory_order_relaxed);
+}
+
+int LatencyHistogram::BucketIndex(uint64_t valueNs)
+{
+    // Values below SUB_BUCKETS get one bucket each
+    if (valueNs < static_cast<uint64_t>(SUB_BUCKETS))
+    {
+        return static_cast<int>(valueNs);
+    }
+
+    int exponent = HighestSetBit(valueNs);
+    if (exponent > MAX_EXPONENT)
+    {
+        return BUCKET_COUNT - 1;
+    }
+
+    // The top SUB_BUCKET_BITS below the leading bit select the linear sub-bucket
+    int subBucket = static_cast<int>((valueNs >> (exponent - SUB_BUCKET_BITS)) & (SUB_BUCKETS - 1));
+    return (exponent - SUB_BUCKET_BITS + 1) * SUB_BUCKETS + subBucket;
+}
+
+uint64_t LatencyHistogram::BucketLowerBound(int index)
+{
+    if (index < SUB_BUCKETS)
+    {
+        return static_cast<uint64_t>(index);
+    }
+
+    int exponent = index / SUB_BUCKETS + SUB_BUCKET_BITS - 1;
+    uint64_t subBucket = static_cast<uint64_t>(index % SUB_BUCKETS);
+    return (1ULL << exponent) + (subBucket << (exponent - SUB_BUCKET_BITS));
+}
+
+void LatencyHistogram::Record(uint64_t valueNs)
+{
+    // Single writer per histogram: plain load/store pairs avoid locked instructions
+    std::atomic<uint64_t>& bucket = m_buckets[BucketIndex(valueNs)];
+    bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    m_count.store(m_count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+    if (valueNs > m_max.load(std::memory_order_relaxed))
+    {
+        m_max.store(valueNs, std::memory_order_relaxed);
+    }
+}
+
+uint64_t LatencyHistogram::GetPercentile(double percentile) const
+{
+    uint64_t count = GetCount();
+    if (count == 0)
+    {
+        return 0;
+    }
+
+    // Rank of the requested sample (1-based)
+    uint64_t rank = static_cast<uint64_t>(percentile / 100.0 * static_cast<double>(count) + 0.5);
+    if (rank < 1)
+    {
+        rank = 1;
+    }
+
+    uint64_t seen = 0;
+    for (int i = 0; i < BUCKET_COUNT; ++i)
+    {
+        seen += m_buckets[i].load(std::memory_order_relaxed);
+        if (seen >= rank)
+        {
+            return BucketLowerBound(i);
+        }
+    }
+    return GetMax();
+}
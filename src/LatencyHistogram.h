@@ -0,0 +1,59 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+/**
+ * LatencyHistogram - Fixed-size log-linear histogram of nanosecond durations
+ *
+ * Each power-of-two range is split into 16 linear sub-buckets, so any recorded
+ * value is reported within ~6% of its true value, from 1 ns up to ~18 minutes.
+ * Storage is a fixed array; Record() never allocates and is safe to call from one
+ * writer thread while another thread reads percentiles (counts are relaxed atomics).
+ */
+class LatencyHistogram
+{
+public:
+    LatencyHistogram();
+
+    /**
+     * Add one sample
+     * @param valueNs Duration in nanoseconds
+     */
+    void Record(uint64_t valueNs);
+
+    /**
+     * Remove all samples
+     */
+    void Reset();
+
+    /**
+     * Get the number of samples
+     */
+    uint64_t GetCount() const { return m_count.load(std::memory_order_relaxed); }
+
+    /**
+     * Get the largest sample (exact)
+     */
+    uint64_t GetMax() const { return m_max.load(std::memory_order_relaxed); }
+
+    /**
+     * Get the value at a percentile
+     * @param percentile 0 to 100 (e.g. 99.9)
+     * @return Lower bound of the bucket holding that rank, in nanoseconds (0 if empty)
+     */
+    uint64_t GetPercentile(double percentile) const;
+
+private:
+    static const int SUB_BUCKET_BITS = 4;
+    static const int SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+    static const int MAX_EXPONENT = 40;
+    static const int BUCKET_COUNT = (MAX_EXPONENT - SUB_BUCKET_BITS + 2) * SUB_BUCKETS;
+
+    static int BucketIndex(uint64_t valueNs);
+    static uint64_t BucketLowerBound(int index);
+
+    std::atomic<uint64_t> m_buckets[BUCKET_COUNT];
+    std::atomic<uint64_t> m_count;
+    std::atomic<uint64_t> m_max;
+};
@@ -0,0 +1,110 @@
+#include "LayerStack.h"
+
+LayerStack::LayerStack()
+    : m_profile(nullptr)
+    , m_layerCount(0)
+    , m_activatorMask(0)
+    , m_overrideMask(0)
+    , m_toggledMask(0)
+    , m_activeMask(0)
+    , m_resolved()
+    , m_composed(false)
+    , m_bindings(&m_effective)
+    , m_switchCount(0)
+{
+}
+
+void LayerStack::Configure(const Profile& profile)
+{
+    m_profile = &profile;
+    m_layerCount = (profile.layerCount < Profile::MAX_LAYERS) ? profile.layerCount : Profile::MAX_LAYERS;
+    m_activatorMask = 0;
+    m_overrideMask = 0;
+    for (uint32_t i = 0; i < m_layerCount; ++i)
+    {
+        m_activatorMask |= static_cast<uint16_t>(1u << (profile.layers[i].activator % PadButton::COUNT));
+        m_overrideMask |= profile.layers[i].overrideMask;
+    }
+
+    m_toggledMask = 0;
+    m_activeMask = 0;
+    for (uint8_t& resolved : m_resolved)
+    {
+        resolved = BASE;
+    }
+    m_composed = false;
+    m_bindings = &profile.buttons;
+}
+
+uint32_t LayerStack::Reset()
+{
+    m_toggledMask = 0;
+    return m_profile ? Resolve(0) : 0u;
+}
+
+uint32_t LayerStack::Update(uint32_t previous, uint32_t current)
+{
+    uint32_t pressed = (previous ^ current) & current;
+    uint32_t active = 0;
+    for (uint32_t i = 0; i < m_layerCount; ++i)
+    {
+        const BindingLayer& layer = m_profile->layers[i];
+        uint32_t activator = 1u << (layer.activator % PadButton::COUNT);
+        if (layer.mode == LayerMode::Toggle)
+        {
+            m_toggledMask ^= (pressed & activator) ? (1u << i) : 0u;
+            active |= m_toggledMask & (1u << i);
+        }
+        else if (current & activator)
+        {
+            active |= 1u << i;
+        }
+    }
+    return Resolve(active);
+}
+
+uint32_t LayerStack::Resolve(uint32_t activeMask)
+{
+    if (activeMask == m_activeMask)
+    {
+        return 0;
+    }
+    m_activeMask = activeMask;
+    ++m_switchCount;
+
+    // The topmost active layer that overrides a button wins
+    const Profile& profile = *m_profile;
+    uint32_t rebound = 0;
+    for (int bit = 0; bit < PadButton::COUNT; ++bit)
+    {
+        uint8_t resolved = BASE;
+        for (uint32_t i = m_layerCount; i-- > 0;)
+        {
+            if ((activeMask & (1u << i)) && (profile.layers[i].overrideMask & (1u << bit)))
+            {
+                resolved = static_cast<uint8_t>(i + 1);
+                break;
+            }
+        }
+        rebound |= (resolved != m_resolved[bit]) ? (1u << bit) : 0u;
+        m_resolved[bit] = resolved;
+    }
+
+    // Only the rebound buttons change in the effective table; the first
+    // composition after Configure() starts from the base table, which every
+    // button resolved to until now
+    if (!m_composed)
+    {
+        m_effective = profile.buttons;
+        m_composed = true;
+    }
+    for (uint32_t buttons = rebound; buttons; buttons &= buttons - 1)
+    {
+        int bit = BindingTable::LowestSetBit(buttons);
+        uint8_t resolved = m_resolved[bit];
+        m_effective.CopyBinding(resolved == BASE ? profile.buttons : profile.layers[resolved - 1].buttons, bit);
+    }
+
+    m_bindings = (activeMask != 0) ? &m_effective : &profile.buttons;
+    return rebound;
+}
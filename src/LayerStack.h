@@ -0,0 +1,102 @@
+#pragma once
+
+#include "BindingTable.h"
+#include "Profile.h"
+#include <cstdint>
+
+/**
+ * LayerStack - Resolves the button bindings of a profile's base table and its active layers
+ *
+ * Each button resolves to the last active layer that overrides it, or to
+ * the base table. The resolution is precomputed into one effective
+ * BindingTable whenever the set of active layers changes (an activator
+ * edge), copying only the buttons that moved to another table; every other
+ * frame the mapper reads a single table, exactly as it would without
+ * layers. With no layer on, the base table is used in place, so a profile
+ * switch copies nothing.
+ *
+ * Hold layers are on while their activator is down; toggle layers flip on
+ * each press of it. Activators are consumed: the profile binds them in no
+ * table.
+ */
+class LayerStack
+{
+public:
+    static const uint8_t BASE = 0;     // Resolution of a button to the base table; layer i resolves to i + 1
+
+    LayerStack();
+
+    /**
+     * Use the layers of a profile, all off (at profile load)
+     * Nothing is copied; the profile must outlive its use here.
+     */
+    void Configure(const Profile& profile);
+
+    /**
+     * Turn every layer off, toggled ones included (outputs released)
+     * @return Buttons whose binding changed
+     */
+    uint32_t Reset();
+
+    /**
+     * Follow the activators from one pad state to the next
+     * Only needed when an activator changed (see GetActivatorMask()).
+     * @param previous, current Button masks of the two states
+     * @return Buttons whose binding changed (0 if the set of active layers did not)
+     */
+    uint32_t Update(uint32_t previous, uint32_t current);
+
+    /**
+     * Get the bindings in effect: the base table, or the composed one while a layer is on
+     */
+    const BindingTable& GetBindings() const { return *m_bindings; }
+
+    /**
+     * Get the layers that are on (bit i: layer i)
+     */
+    uint32_t GetActiveMask() const { return m_activeMask; }
+
+    /**
+     * Get the buttons that activate a layer
+     */
+    uint16_t GetActivatorMask() const { return m_activatorMask; }
+
+    /**
+     * Get the buttons some layer rebinds
+     */
+    uint16_t GetOverrideMask() const { return m_overrideMask; }
+
+    /**
+     * Get the table a button resolves to
+     * @param bitIndex Bit index (0-15)
+     * @return BASE, or the layer index + 1
+     */
+    uint8_t GetResolution(int bitIndex) const { return m_resolved[bitIndex]; }
+
+    /**
+     * Get the number of changes of the set of active layers since construction
+     */
+    uint64_t GetSwitchCount() const { return m_switchCount; }
+
+private:
+    /**
+     * Resolve every button against a new set of active layers and compose the effective table
+     * @return Buttons whose binding changed
+     */
+    uint32_t Resolve(uint32_t activeMask);
+
+    const Profile* m_profile;
+    uint32_t m_layerCount;
+    uint16_t m_activatorMask;
+    uint16_t m_overrideMask;
+    uint32_t m_toggledMask;     // Toggle layers switched on
+    uint32_t m_activeMask;
+
+    // Per-button resolution, and the table composed from it (only once a layer came on)
+    uint8_t m_resolved[PadButton::COUNT];
+    BindingTable m_effective;
+    bool m_composed;
+    const BindingTable* m_bindings;
+
+    uint64_t m_switchCount;
+};
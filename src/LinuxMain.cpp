@@ -0,0 +1,247 @@
+#include <atomic>
+#include <csignal>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include "EvdevInputSource.h"
+#include "UinputOutputSink.h"
+#include "InputPoller.h"
+#include "PadDevice.h"
+#include "Mapper.h"
+#include "MonotonicClock.h"
+#include "FrameScheduler.h"
+#include "StageProfiler.h"
+#include "ProfileReloader.h"
+
+namespace
+{
+    std::atomic<bool> g_exitRequested(false);
+
+    void RequestExit(int)
+    {
+        g_exitRequested.store(true);
+    }
+}
+
+/**
+ * Linux entry point for GamepadMapper
+ *
+ * Reads the pad through evdev (event-driven poll thread) and emits keyboard/
+ * mouse output through a uinput virtual device, with the same Mapper and
+ * Witcher bindings as the Windows build. Without access to /dev/uinput the
+ * output is captured to a file instead (--capture=<file> forces this).
+ *
+ * Options: --device=<path> (default: first gamepad in /dev/input),
+ * --rate=<hz>, --capture=<file>, --profile=<file.ini> (reloaded when the file
+ * changes; default: the built-in Witcher profile), --stats. Ctrl+C exits and
+ * releases all keys.
+ */
+int main(int argc, char* argv[])
+{
+    std::string devicePath;
+    const char* capturePath = nullptr;
+    uint32_t updateRateHz = 200;
+    bool statsEnabled = false;
+    const char* profilePath = nullptr;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strncmp(argv[i], "--device=", 9) == 0)
+        {
+            devicePath = argv[i] + 9;
+        }
+        else if (std::strncmp(argv[i], "--capture=", 10) == 0)
+        {
+            capturePath = argv[i] + 10;
+        }
+        else if (std::strncmp(argv[i], "--rate=", 7) == 0)
+        {
+            updateRateHz = static_cast<uint32_t>(std::strtoul(argv[i] + 7, nullptr, 10));
+        }
+        else if (std::strcmp(argv[i], "--stats") == 0)
+        {
+            statsEnabled = true;
+        }
+        else if (std::strncmp(argv[i], "--profile=", 10) == 0)
+        {
+            profilePath = argv[i] + 10;
+        }
+    }
+
+    std::cout << "GamepadMapper - The Witcher 1 Controller Support (Linux)" << std::endl;
+    std::cout << "========================================================" << std::endl;
+
+    SystemClock clock;
+
+    // Profile: a --profile text is watched and hot-reloaded; the mapper uses the
+    // reloader's snapshots in place, so the reloader outlives the mapper. Its
+    // watcher thread sleeps on a clock of its own, not on the main loop's.
+    Profile builtInProfile = Profile::CreateWitcher();
+    const Profile* profile = &builtInProfile;
+    SystemClock reloaderClock;
+    ProfileReloader profileReloader(reloaderClock);
+    if (profilePath)
+    {
+        if (!profileReloader.Load(profilePath))
+        {
+            std::cout << "ERROR: " << profileReloader.GetError() << std::endl;
+            return 1;
+        }
+        const ProfileCache& profileCache = profileReloader.GetCache();
+        if (!profileCache.IsMapped())
+        {
+            std::cout << "WARNING: " << profileCache.GetError() << "; using the profile compiled in memory" << std::endl;
+        }
+        std::cout << "Profile: " << profilePath << (profileCache.WasCompiled() ? " (compiled)" : " (cached)")
+                  << ", reloaded when it changes" << std::endl;
+    }
+
+    if (devicePath.empty())
+    {
+        devicePath = EvdevInputSource::FindGamepad();
+    }
+
+    EvdevInputSource source;
+    if (devicePath.empty() || !source.Open(devicePath.c_str()))
+    {
+        std::cout << "ERROR: No gamepad found in /dev/input (try --device=/dev/input/eventN)." << std::endl;
+        return 1;
+    }
+    std::cout << "Gamepad: " << devicePath << std::endl;
+
+    UinputOutputSink output;
+    const char* fallbackPath = capturePath ? capturePath : "gamepadmapper-output.evcap";
+    bool outputOpened = capturePath ? output.OpenCapture(capturePath) : output.OpenWithFallback(fallbackPath);
+    if (!outputOpened)
+    {
+        std::cout << "ERROR: cannot open /dev/uinput or the capture file " << fallbackPath << std::endl;
+        return 1;
+    }
+    if (output.IsCapturing())
+    {
+        std::cout << "WARNING: uinput not used; keyboard/mouse events are captured to " << fallbackPath << std::endl;
+    }
+
+    StageProfiler profiler(clock);
+    profiler.SetEnabled(statsEnabled);
+    ProfiledOutputSink profiledOutput(output, profiler);
+
+    PadDevice pad;
+    Mapper mapper;
+    mapper.Initialize(&pad, &profiledOutput);
+    if (profilePath)
+    {
+        profileReloader.Apply(mapper);
+        profile = &profileReloader.GetApplied()->profile;
+    }
+    else
+    {
+        // The built-in profile maps buttons through its compile-time generated stage
+        mapper.SetStaticProfile<WitcherProfile>();
+    }
+
+    std::cout << "Controller mappings (" << profile->name << "):" << std::endl;
+    profile->PrintBanner(std::cout);
+
+    // From here on the watcher thread may replace the profile (reported on the console)
+    if (profilePath)
+    {
+        profileReloader.SetLog(&std::cout);
+        profileReloader.Start();
+    }
+
+    PadSnapshotRing snapshotRing;
+    PadSnapshotRing::Reader snapshotReader(snapshotRing);
+    InputPoller poller(snapshotRing, source);
+    if (statsEnabled)
+    {
+        poller.SetProfiler(&profiler);
+    }
+
+    std::signal(SIGINT, RequestExit);
+    std::signal(SIGTERM, RequestExit);
+
+    FrameScheduler scheduler(clock);
+    scheduler.Initialize(updateRateHz, OverrunPolicy::Skip);
+    std::cout << "Running at " << (1000000000ULL / scheduler.GetPeriodNanoseconds()) << " Hz... (Press Ctrl+C to exit)" << std::endl;
+
+    poller.Start(updateRateHz);
+    scheduler.Start();
+
+    while (!g_exitRequested.load())
+    {
+        bool connected = true;
+
+        {
+            ScopedStageTimer frameTimer(profiler, ProfileStage::Frame);
+
+            // A reloaded profile takes effect between two frames (one atomic load when unchanged)
+            if (profilePath)
+            {
+                profileReloader.Apply(mapper);
+            }
+
+            // Map every snapshot published since the last frame, so no edge is lost
+            PadSnapshot snapshot;
+            bool received = false;
+            while (snapshotReader.Next(snapshot))
+            {
+                received = true;
+                pad.ApplySnapshot(snapshot);
+                if (!pad.IsConnected())
+                {
+                    connected = false;
+                    break;
+                }
+                ScopedStageTimer mapTimer(profiler, ProfileStage::Map);
+                mapper.Update(snapshot.timestampNs);
+            }
+
+            // Nothing new: still run the time-dependent output (camera motion)
+            if (!received)
+            {
+                pad.MarkUnchanged();
+                ScopedStageTimer mapTimer(profiler, ProfileStage::Map);
+                mapper.Update(clock.NowNanoseconds());
+            }
+        }
+
+        if (!connected)
+        {
+            std::cout << "Controller disconnected. Exiting..." << std::endl;
+            break;
+        }
+
+        uint64_t lateness = scheduler.WaitForNextFrame();
+        if (statsEnabled)
+        {
+            profiler.Record(ProfileStage::FrameLateness, lateness);
+        }
+    }
+
+    poller.Stop();
+    profileReloader.Stop();
+
+    // Cleanup - make sure nothing stays held
+    mapper.ReleaseAllOutputs();
+
+    std::cout << "Frames: " << mapper.GetFrameCount()
+              << ", unchanged (fast path): " << mapper.GetSkippedFrameCount()
+              << ", output writes: " << output.GetWriteCount() << std::endl;
+    if (output.GetUntranslatedCount() > 0)
+    {
+        std::cout << "WARNING: " << output.GetUntranslatedCount() << " key/button events have no evdev code and were not sent" << std::endl;
+    }
+    if (source.GetDroppedReportCount() > 0)
+    {
+        std::cout << "WARNING: " << source.GetDroppedReportCount() << " evdev reports dropped by the kernel" << std::endl;
+    }
+    if (statsEnabled)
+    {
+        profiler.Print(std::cout, scheduler.GetMissedDeadlineCount());
+    }
+
+    std::cout << "Exiting..." << std::endl;
+    return 0;
+}
@@ -0,0 +1,135 @@
+#include "MacroPlayer.h"
+
+// Each running macro has exactly one timer, so the wheel can never run out
+static_assert(TimerWheel::MAX_TIMERS >= MacroPlayer::MAX_MACROS, "timer pool too small for one timer per macro");
+
+MacroPlayer::MacroPlayer()
+    : m_wheel(TICK_NS)
+    , m_instances()
+    , m_activeMask(0)
+    , m_dueMask(0)
+    , m_cancelledCount(0)
+{
+}
+
+void MacroPlayer::Start(int slot, const MacroDefinition& macro, uint64_t nowNs)
+{
+    if (slot < 0 || slot >= MAX_MACROS || macro.stepCount == 0)
+    {
+        return;
+    }
+
+    if (IsRunning(slot))
+    {
+        m_wheel.Cancel(m_instances[slot].timer);
+    }
+
+    Instance& instance = m_instances[slot];
+    instance.macro = macro;
+    instance.step = 0;
+    instance.holding = true;
+    m_activeMask |= (1u << slot);
+    m_dueMask &= ~(1u << slot);
+    Schedule(slot, nowNs, macro.steps[0].holdMs);
+}
+
+void MacroPlayer::Cancel(int slot)
+{
+    if (slot < 0 || slot >= MAX_MACROS || !IsRunning(slot))
+    {
+        return;
+    }
+
+    m_wheel.Cancel(m_instances[slot].timer);
+    m_activeMask &= ~(1u << slot);
+    m_dueMask &= ~(1u << slot);
+    ++m_cancelledCount;
+}
+
+void MacroPlayer::CancelAll()
+{
+    uint32_t active = m_activeMask;
+    while (active)
+    {
+        int slot = BindingTable::LowestSetBit(active);
+        active &= active - 1;
+        Cancel(slot);
+    }
+}
+
+bool MacroPlayer::Advance(uint64_t nowNs)
+{
+    if (m_activeMask == 0)
+    {
+        m_wheel.Advance(nowNs, [](uint32_t) {});
+        return false;
+    }
+
+    m_dueMask = 0;
+    m_wheel.Advance(nowNs, [this](uint32_t slot) { m_dueMask |= (1u << slot); });
+
+    // One phase change per macro per call: the next phase is timed from now
+    uint32_t due = m_dueMask;
+    while (due)
+    {
+        int slot = BindingTable::LowestSetBit(due);
+        due &= due - 1;
+
+        Instance& instance = m_instances[slot];
+        instance.timer = TimerWheel::INVALID_TIMER;
+        const MacroStep& step = instance.macro.steps[instance.step];
+        if (instance.holding)
+        {
+            // Released; wait out the gap (the last step's gap keeps a restart from merging with it)
+            instance.holding = false;
+            Schedule(slot, nowNs, step.gapMs);
+        }
+        else if (instance.step + 1 < instance.macro.stepCount)
+        {
+            ++instance.step;
+            instance.holding = true;
+            Schedule(slot, nowNs, instance.macro.steps[instance.step].holdMs);
+        }
+        else
+        {
+            m_activeMask &= ~(1u << slot);
+        }
+    }
+
+    bool changed = (m_dueMask != 0);
+    m_dueMask = 0;
+    return changed;
+}
+
+void MacroPlayer::ApplyHeld(OutputState& desired) const
+{
+    uint32_t active = m_activeMask;
+    while (active)
+    {
+        int slot = BindingTable::LowestSetBit(active);
+        active &= active - 1;
+
+        const Instance& instance = m_instances[slot];
+        if (!instance.holding)
+        {
+            continue;
+        }
+
+        const MacroStep& step = instance.macro.steps[instance.step];
+        if (step.type == MacroOutputType::Key)
+        {
+            desired.SetKey(step.code);
+        }
+        else
+        {
+            desired.SetMouseButton(step.code);
+        }
+    }
+}
+
+void MacroPlayer::Schedule(int slot, uint64_t nowNs, uint16_t durationMs)
+{
+    // At least one tick, so each phase is seen by at least one frame
+    uint64_t durationNs = (durationMs > 0) ? durationMs * 1000000ULL : TICK_NS;
+    m_instances[slot].timer = m_wheel.Schedule(nowNs + durationNs, static_cast<uint32_t>(slot));
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include "BindingTable.h"
+#include "OutputState.h"
+#include "TimerWheel.h"
+#include <cstdint>
+
+/**
+ * MacroPlayer - Plays timed macros on a timer wheel, driven by the mapper's frames
+ *
+ * One macro can run per button, plus one for combos. A running macro holds
+ * at most one output at a time; its next step waits on the wheel, so no
+ * thread or sleep is needed and an idle player costs nothing. Each phase (hold, gap) lasts at least one
+ * wheel tick and starts from the time it was serviced, so every press and
+ * release shows up in its own frame even when frames arrive late.
+ */
+class MacroPlayer
+{
+public:
+    static const int COMBO_SLOT = PadButton::COUNT;     // Macro of the last completed combo
+    static const int MAX_MACROS = PadButton::COUNT + 1;
+    static const uint64_t TICK_NS = 1000000ULL;         // 1 ms wheel resolution
+
+    MacroPlayer();
+
+    /**
+     * Start (or restart) the macro of a button
+     * @param slot Button bit index the macro belongs to, or COMBO_SLOT
+     * @param macro Steps to play (copied)
+     * @param nowNs Current time
+     */
+    void Start(int slot, const MacroDefinition& macro, uint64_t nowNs);
+
+    /**
+     * Stop the macro of a button and release its output (no effect if not running)
+     */
+    void Cancel(int slot);
+
+    /**
+     * Stop every macro
+     */
+    void CancelAll();
+
+    /**
+     * Run the steps that are due
+     * @param nowNs Current time
+     * @return True if the held outputs changed
+     */
+    bool Advance(uint64_t nowNs);
+
+    /**
+     * Add the outputs the running macros hold to the desired state
+     */
+    void ApplyHeld(OutputState& desired) const;
+
+    /**
+     * Check if any macro is running
+     */
+    bool IsActive() const { return m_activeMask != 0; }
+
+    /**
+     * Check if the macro of a button is running
+     */
+    bool IsRunning(int slot) const { return (m_activeMask & (1u << slot)) != 0; }
+
+    /**
+     * Get the number of macros stopped by Cancel() before their last step
+     */
+    uint64_t GetCancelledCount() const { return m_cancelledCount; }
+
+private:
+    struct Instance
+    {
+        MacroDefinition macro;
+        uint8_t step;       // Current step
+        bool holding;       // Holding the step's output (otherwise waiting in its gap)
+        uint32_t timer;     // End of the current phase
+    };
+
+    void Schedule(int slot, uint64_t nowNs, uint16_t durationMs);
+
+    TimerWheel m_wheel;
+    Instance m_instances[MAX_MACROS];
+    uint32_t m_activeMask;
+    uint32_t m_dueMask;     // Instances whose phase ended in the current Advance()
+    uint64_t m_cancelledCount;
+};
@@ -1,337 +1,731 @@
 #include "Mapper.h"
-#include <XInput.h>
 #include <algorithm>
 #include <iostream>
 
-// Dead zone threshold (about 24% of full range)
-const SHORT DEAD_ZONE = 7849;
+namespace
+{
+    // Sub-pixel units per pixel: stick * MOUSE_PIXELS_PER_SECOND * nanoseconds is
+    // then exact integer motion, so the total does not depend on the step size
+    const int64_t MOUSE_SUBPIXELS = static_cast<int64_t>(StickProcessor::OUTPUT_MAX) * 1000000000LL;
+
+    /**
+     * Move whole pixels out of a sub-pixel accumulator, rounding toward -infinity
+     * @return Pixels to emit; the accumulator keeps the remainder in [0, 1) pixel
+     */
+    int32_t TakeWholePixels(int64_t& accumulator)
+    {
+        int64_t pixels = accumulator / MOUSE_SUBPIXELS;
+        if (accumulator % MOUSE_SUBPIXELS < 0)
+        {
+            --pixels;
+        }
+        accumulator -= pixels * MOUSE_SUBPIXELS;
+        return static_cast<int32_t>(pixels);
+    }
+
+    int CountBits(uint32_t mask)
+    {
+        int count = 0;
+        for (; mask; mask &= mask - 1)
+        {
+            ++count;
+        }
+        return count;
+    }
+}
 
 Mapper::Mapper()
     : m_controller(nullptr)
-    , m_keyboardMouse(nullptr)
-    , m_virtualController(nullptr)
-    , m_wPressed(false)
-    , m_aPressed(false)
-    , m_sPressed(false)
-    , m_dPressed(false)
-    , m_leftTriggerPressed(false)
-    , m_rightTriggerPressed(false)
-    , m_bothTriggersPressed(false)
+    , m_output(nullptr)
+    , m_ownProfile(Profile::CreateWitcher())
+    , m_profile(&m_ownProfile)
+    , m_combos(&m_ownCombos)
+    , m_buttonStage(&Mapper::ProcessStaticButtons<WitcherProfile>)
+    , m_indexedBindingCount(0)
+    , m_incremental(true)
+    , m_staleChannels(ALL_CHANNELS)
+    , m_lastButtons(0)
+    , m_lastLeftX(0)
+    , m_lastLeftY(0)
+    , m_lastRightX(0)
+    , m_lastRightY(0)
+    , m_leftStick(&m_ownLeftStick)
+    , m_rightStick(&m_ownRightStick)
+    , m_axisSource(nullptr)
+    , m_axes()
+    , m_pendingSwitches(0)
+    , m_rebuildPending(false)
+    , m_mouseVelocityX(0)
+    , m_mouseVelocityY(0)
+    , m_mouseRemainderX(0)
+    , m_mouseRemainderY(0)
+    , m_motionTimeNs(0)
+    , m_motionStarted(false)
+    , m_frameCount(0)
+    , m_skippedFrameCount(0)
+    , m_evaluatedBindingCount(0)
 {
+    m_buttonHeld.Reset();
+    m_layers.Configure(m_ownProfile);
+    BuildBindingIndex();
+    SetThresholdSettings(m_profile->stickThresholds, m_profile->triggerThresholds);
 }
 
 Mapper::~Mapper()
 {
 }
 
-void Mapper::Initialize(XInputDevice* controller, KeyboardMouse* keyboardMouse, VirtualController* virtualController)
+void Mapper::Initialize(const PadDevice* controller, IOutputSink* output)
 {
     m_controller = controller;
-    m_keyboardMouse = keyboardMouse;
-    m_virtualController = virtualController;
+    m_output = output;
+    m_batch.SetSink(output);
+}
+
+void Mapper::SetProfile(const Profile& profile)
+{
+    m_profile = &profile;
+    m_buttonStage = &Mapper::ProcessButtonMappings;
+    m_macros.CancelAll();
+    m_gestures.Reset();
+    m_layers.Configure(profile);
+    m_ownCombos.Compile(profile.combos, profile.comboCount);    // None if the profile's are malformed
+    m_combos = &m_ownCombos;
+    m_comboRecognizer.Reset();
+    BuildBindingIndex();
+    SetStickSettings(profile.leftStick, profile.rightStick);
+    SetThresholdSettings(profile.stickThresholds, profile.triggerThresholds);
+}
+
+void Mapper::SetProfile(const Profile& profile, const StickProcessor& leftStick, const StickProcessor& rightStick,
+                        const ComboAutomaton& combos)
+{
+    m_profile = &profile;
+    m_buttonStage = &Mapper::ProcessButtonMappings;
+    m_macros.CancelAll();
+    m_gestures.Reset();
+    m_layers.Configure(profile);
+    m_combos = &combos;
+    m_comboRecognizer.Reset();
+    m_leftStick = &leftStick;
+    m_rightStick = &rightStick;
+    BuildBindingIndex();
+    SetThresholdSettings(profile.stickThresholds, profile.triggerThresholds);
 }
 
-void Mapper::Update()
+void Mapper::SetBindings(const BindingTable& bindings)
 {
-    if (!m_controller || !m_keyboardMouse)
+    // Keep the rest of a caller's profile; only the own copy is written to
+    if (m_profile != &m_ownProfile)
     {
-        return;
+        m_ownProfile = *m_profile;
+        m_profile = &m_ownProfile;
     }
+    m_ownProfile.buttons = bindings;
+    m_buttonStage = &Mapper::ProcessButtonMappings;
+    m_macros.CancelAll();
+    m_gestures.Reset();
+    m_layers.Configure(m_ownProfile);
+    BuildBindingIndex();
+    m_rebuildPending = true;
+}
 
-    // Process all button mappings
-    ProcessButtonMappings();
-
-    // Process analog stick mappings
-    ProcessAnalogSticks();
+void Mapper::SetStickSettings(const StickSettings& left, const StickSettings& right)
+{
+    m_ownLeftStick.Configure(left);
+    m_ownRightStick.Configure(right);
+    m_leftStick = &m_ownLeftStick;
+    m_rightStick = &m_ownRightStick;
+    m_rebuildPending = true;
+}
 
-    // Process trigger mappings
-    ProcessTriggers();
+void Mapper::SetThresholdSettings(const ThresholdSettings& stick, const ThresholdSettings& trigger)
+{
+    for (int i = 0; i < SWITCH_COUNT; ++i)
+    {
+        bool isTrigger = (i == SWITCH_LEFT_TRIGGER || i == SWITCH_RIGHT_TRIGGER);
+        m_switches[i].Configure(isTrigger ? trigger : stick);
+    }
+    m_rebuildPending = true;
+}
 
-    // Forward state to virtual controller if available
-    if (m_virtualController && m_virtualController->IsConnected())
+unsigned long long Mapper::GetSuppressedTransitionCount() const
+{
+    unsigned long long count = 0;
+    for (const ThresholdSwitch& analogSwitch : m_switches)
     {
-        m_virtualController->Update(m_controller->GetState());
+        count += analogSwitch.GetSuppressedCount();
     }
+    return count;
 }
 
-void Mapper::ProcessButtonMappings()
+void Mapper::SetAxisSource(const PadAxes* axes)
 {
-    // A -> Space (Zatrzymanie gry / Pause game)
-    HandleButtonMapping(XINPUT_GAMEPAD_A, VK_SPACE);
+    m_axisSource = axes;
+    m_rebuildPending = true;
+}
+
+void Mapper::SetIncrementalEvaluation(bool enabled)
+{
+    m_incremental = enabled;
+    m_rebuildPending = true;
+}
 
-    // B -> Escape
-    HandleButtonMapping(XINPUT_GAMEPAD_B, VK_ESCAPE);
+void Mapper::BuildBindingIndex()
+{
+    const Profile& profile = *m_profile;
 
-    // X -> Left Mouse Button (Lewa mysz)
-    if (m_controller->IsButtonJustPressed(XINPUT_GAMEPAD_X))
+    // A button bit is read by its own binding (in the base table or a layer), and by the combos if there are any
+    uint16_t bound = profile.buttons.GetBoundMask() | m_layers.GetOverrideMask();
+    uint32_t combos = (m_combos->GetComboCount() > 0) ? BINDING_COMBOS : 0u;
+    for (int bit = 0; bit < PadButton::COUNT; ++bit)
     {
-        m_keyboardMouse->SendMouseButtonDown(0);
+        m_channelBindings[bit] = (bound & (1u << bit)) | combos;
     }
-    else if (m_controller->IsButtonJustReleased(XINPUT_GAMEPAD_X))
+
+    // Each left-stick direction is a switch of its own; the LT + RT chord reads both trigger switches
+    uint32_t moveBindings = 0;
+    for (int i = SWITCH_MOVE_FORWARD; i <= SWITCH_MOVE_RIGHT; ++i)
     {
-        m_keyboardMouse->SendMouseButtonUp(0);
+        AnalogKey key = static_cast<AnalogKey>(static_cast<int>(AnalogKey::MoveForward) + i);
+        moveBindings |= (profile.GetAnalogKey(key) != 0) ? (1u << (BINDING_FIRST_SWITCH + i)) : 0u;
     }
+    bool chord = profile.GetAnalogKey(AnalogKey::BothTriggers) != 0;
+    bool left = chord || profile.GetAnalogKey(AnalogKey::LeftTrigger) != 0;
+    bool right = chord || profile.GetAnalogKey(AnalogKey::RightTrigger) != 0;
 
-    // Y -> Right Mouse Button (Prawa mysz)
-    if (m_controller->IsButtonJustPressed(XINPUT_GAMEPAD_Y))
+    m_channelBindings[PadButton::COUNT] = moveBindings;
+    m_channelBindings[PadButton::COUNT + 1] = BINDING_CAMERA;
+    m_channelBindings[PadButton::COUNT + 2] = left ? (1u << (BINDING_FIRST_SWITCH + SWITCH_LEFT_TRIGGER)) : 0u;
+    m_channelBindings[PadButton::COUNT + 3] = right ? (1u << (BINDING_FIRST_SWITCH + SWITCH_RIGHT_TRIGGER)) : 0u;
+
+    uint32_t all = 0;
+    for (uint32_t bindings : m_channelBindings)
     {
-        m_keyboardMouse->SendMouseButtonDown(1);
+        all |= bindings;
     }
-    else if (m_controller->IsButtonJustReleased(XINPUT_GAMEPAD_Y))
+    m_indexedBindingCount = CountBits(all);
+
+    // Outputs of the old bindings; the next frame evaluates everything again
+    m_buttonHeld.ClearHeld();
+    m_staleChannels = ALL_CHANNELS;
+}
+
+void Mapper::Update(uint64_t timestampNs)
+{
+    if (!m_controller || !m_output)
     {
-        m_keyboardMouse->SendMouseButtonUp(1);
+        return;
     }
 
-    // Right Stick Click -> TAB (Tryb Rozmowy / Conversation mode)
-    HandleButtonMapping(XINPUT_GAMEPAD_RIGHT_THUMB, VK_TAB);
+    ++m_frameCount;
 
-    // LB -> 1 and 6 (Eliksiry szybki dostęp)
-    // Press 1 on press, 6 on release (or just 1 - you can adjust)
-    if (m_controller->IsButtonJustPressed(XINPUT_GAMEPAD_LEFT_SHOULDER))
+    // Camera motion up to now uses the stick position that was in effect until now
+    ProcessMouseMotion(timestampNs);
+
+    // Macro steps that came due since the last frame, then gesture windows that closed
+    bool macrosChanged = m_macros.Advance(timestampNs);
+    bool gesturesChanged = m_gestures.HasPending() && ExpireGestures(timestampNs);
+
+    // Fast path: nothing new from the pad, so the held outputs are unchanged.
+    // Only the time-dependent output (camera motion from a held stick) runs.
+    // A macro step, a gesture, or a threshold switch waiting out its hold time
+    // needs the stages to run again.
+    if (!m_controller->HasStateChanged() && !m_rebuildPending && !m_pendingSwitches && !macrosChanged && !gesturesChanged)
     {
-        m_keyboardMouse->SendKeyDown('1');
-        m_keyboardMouse->SendKeyUp('1');
-        m_keyboardMouse->SendKeyDown('6');
-        m_keyboardMouse->SendKeyUp('6');
+        ++m_skippedFrameCount;
+        EmitOutput();
+        return;
     }
 
-    // RB -> 2 and 7 (Eliksiry szybki dostęp)
-    if (m_controller->IsButtonJustPressed(XINPUT_GAMEPAD_RIGHT_SHOULDER))
+    uint32_t forced = (m_rebuildPending || !m_incremental) ? ALL_CHANNELS : m_staleChannels;
+    m_rebuildPending = false;
+    m_staleChannels = 0;
+
+    // A layer switch rebinds buttons: their channels count as changed
+    forced |= UpdateLayers(forced);
+
+    // Re-evaluate the bindings that read a changed channel, and the switches still
+    // waiting out their hold time; every other binding keeps its output
+    uint32_t changed = ReadChangedChannels(forced);
+    uint32_t bindings = m_pendingSwitches;
+    for (uint32_t channels = changed; channels; channels &= channels - 1)
     {
-        m_keyboardMouse->SendKeyDown('2');
-        m_keyboardMouse->SendKeyUp('2');
-        m_keyboardMouse->SendKeyDown('7');
-        m_keyboardMouse->SendKeyUp('7');
+        bindings |= m_channelBindings[BindingTable::LowestSetBit(channels)];
     }
+    EvaluateBindings(bindings, timestampNs);
 
-    // LT -> X (Styl Szybki / Fast Style) - handled in ProcessTriggers
-    // RT -> Z (Styl Silny / Strong Style) - handled in ProcessTriggers
-    // LT + RT -> C (Styl Grupowy / Group Style) - handled in ProcessTriggers
+    // Every stage re-declares what it wants held
+    ComposeHeldOutputs();
 
-    // D-Pad Up -> - (Następny Znak / Next Sign)
-    HandleButtonMapping(XINPUT_GAMEPAD_DPAD_UP, VK_OEM_MINUS); // - key
+    // Send only what changed since the last frame
+    EmitOutput();
+}
 
-    // D-Pad Down -> = (Poprzedni Znak / Previous Sign)
-    HandleButtonMapping(XINPUT_GAMEPAD_DPAD_DOWN, VK_OEM_PLUS); // = key
+uint32_t Mapper::ReadChangedChannels(uint32_t forced)
+{
+    // Buttons: this frame's edges, and anything that changed since the stages last ran
+    uint16_t buttons = m_controller->GetState().buttons;
+    uint32_t changed = forced | ((m_controller->GetPreviousState().buttons ^ buttons) | (m_lastButtons ^ buttons));
+    m_lastButtons = buttons;
 
-    // D-Pad Left -> [ (Poprzednia broń / Previous weapon)
-    HandleButtonMapping(XINPUT_GAMEPAD_DPAD_LEFT, VK_OEM_4); // [ key
+    if (m_axisSource)
+    {
+        // Shaped elsewhere: compare the results
+        const PadAxes& axes = *m_axisSource;
+        changed |= (axes.leftX != m_axes.leftX || axes.leftY != m_axes.leftY) ? CHANNEL_LEFT_STICK : 0u;
+        changed |= (axes.rightX != m_axes.rightX || axes.rightY != m_axes.rightY) ? CHANNEL_RIGHT_STICK : 0u;
+        changed |= (axes.leftTrigger != m_axes.leftTrigger) ? CHANNEL_LEFT_TRIGGER : 0u;
+        changed |= (axes.rightTrigger != m_axes.rightTrigger) ? CHANNEL_RIGHT_TRIGGER : 0u;
+        m_axes = axes;
+        return changed;
+    }
 
-    // D-Pad Right -> ] (Następna broń / Next weapon)
-    HandleButtonMapping(XINPUT_GAMEPAD_DPAD_RIGHT, VK_OEM_6); // ] key
+    // Shaped here: only the sticks that moved
+    int16_t leftX = m_controller->GetLeftStickX();
+    int16_t leftY = m_controller->GetLeftStickY();
+    if ((changed & CHANNEL_LEFT_STICK) || leftX != m_lastLeftX || leftY != m_lastLeftY)
+    {
+        changed |= CHANNEL_LEFT_STICK;
+        m_lastLeftX = leftX;
+        m_lastLeftY = leftY;
+        m_leftStick->Process(leftX, leftY, m_axes.leftX, m_axes.leftY);
+    }
 
-    // Start (Menu button) -> H (Bohater / Hero)
-    HandleButtonMapping(XINPUT_GAMEPAD_START, 'H');
+    int16_t rightX = m_controller->GetRightStickX();
+    int16_t rightY = m_controller->GetRightStickY();
+    if ((changed & CHANNEL_RIGHT_STICK) || rightX != m_lastRightX || rightY != m_lastRightY)
+    {
+        changed |= CHANNEL_RIGHT_STICK;
+        m_lastRightX = rightX;
+        m_lastRightY = rightY;
+        m_rightStick->Process(rightX, rightY, m_axes.rightX, m_axes.rightY);
+    }
 
-    // Back (View button) -> I (Ekwipunek / Inventory)
-    HandleButtonMapping(XINPUT_GAMEPAD_BACK, 'I');
+    uint8_t leftTrigger = m_controller->GetLeftTrigger();
+    uint8_t rightTrigger = m_controller->GetRightTrigger();
+    changed |= (leftTrigger != m_axes.leftTrigger) ? CHANNEL_LEFT_TRIGGER : 0u;
+    changed |= (rightTrigger != m_axes.rightTrigger) ? CHANNEL_RIGHT_TRIGGER : 0u;
+    m_axes.leftTrigger = leftTrigger;
+    m_axes.rightTrigger = rightTrigger;
+    return changed;
 }
 
-void Mapper::ProcessAnalogSticks()
+void Mapper::EvaluateBindings(uint32_t bindings, uint64_t timestampNs)
 {
-    if (!m_controller || !m_keyboardMouse)
+    m_evaluatedBindingCount += CountBits(bindings);
+
+    // Process all button mappings
+    if (bindings & BINDING_BUTTONS)
     {
-        return;
+        (this->*m_buttonStage)(timestampNs);
     }
 
-    // Left Stick -> WASD movement
-    SHORT leftX = ApplyDeadZone(m_controller->GetLeftStickX());
-    SHORT leftY = ApplyDeadZone(m_controller->GetLeftStickY());
+    // Combos play on top of the bindings of the buttons they are made of
+    if (bindings & BINDING_COMBOS)
+    {
+        ProcessCombos(timestampNs);
+    }
 
-    // Determine movement direction based on stick position
-    // W (forward) - positive Y (inverted from XInput where negative Y is up)
-    // S (backward) - negative Y
-    // A (left) - negative X
-    // D (right) - positive X
+    // Process analog stick mappings
+    ProcessAnalogSticks(bindings, timestampNs);
 
-    bool shouldPressW = (leftY > DEAD_ZONE);  // Inverted: positive Y = forward
-    bool shouldPressS = (leftY < -DEAD_ZONE); // Inverted: negative Y = backward
-    bool shouldPressA = (leftX < -DEAD_ZONE);
-    bool shouldPressD = (leftX > DEAD_ZONE);
+    // Process trigger mappings
+    ProcessTriggers(bindings, timestampNs);
 
-    // Handle W key
-    if (shouldPressW && !m_wPressed)
+    m_pendingSwitches = 0;
+    for (int i = 0; i < SWITCH_COUNT; ++i)
     {
-        m_keyboardMouse->SendKeyDown('W');
-        m_wPressed = true;
+        m_pendingSwitches |= m_switches[i].IsPending() ? (1u << (BINDING_FIRST_SWITCH + i)) : 0u;
     }
-    else if (!shouldPressW && m_wPressed)
+}
+
+void Mapper::ComposeHeldOutputs()
+{
+    m_desired.ClearHeld();
+    m_desired.AddHeld(m_buttonHeld);
+
+    // Gesture holds, then macro steps: both change with time as well as with the pad
+    uint32_t holding = m_gestures.GetHoldingMask();
+    while (holding)
     {
-        m_keyboardMouse->SendKeyUp('W');
-        m_wPressed = false;
+        int bit = BindingTable::LowestSetBit(holding);
+        holding &= holding - 1;
+
+        const MacroStep& action = m_layers.GetBindings().GetGesture(bit).actions[static_cast<int>(GestureKind::Hold)];
+        if (action.type == MacroOutputType::Key)
+        {
+            m_desired.SetKey(action.code);
+        }
+        else
+        {
+            m_desired.SetMouseButton(action.code);
+        }
     }
+    m_macros.ApplyHeld(m_desired);
+
+    HoldAnalogOutputs();
+}
 
-    // Handle S key
-    if (shouldPressS && !m_sPressed)
+void Mapper::ReleaseAllOutputs()
+{
+    if (!m_output)
     {
-        m_keyboardMouse->SendKeyDown('S');
-        m_sPressed = true;
+        return;
     }
-    else if (!shouldPressS && m_sPressed)
+
+    m_desired.Reset();
+
+    m_mouseVelocityX = 0;
+    m_mouseVelocityY = 0;
+    m_mouseRemainderX = 0;
+    m_mouseRemainderY = 0;
+    m_motionStarted = false;
+
+    m_macros.CancelAll();
+    m_gestures.Reset();
+    m_layers.Reset();
+    m_comboRecognizer.Reset();
+
+    for (ThresholdSwitch& analogSwitch : m_switches)
     {
-        m_keyboardMouse->SendKeyUp('S');
-        m_sPressed = false;
+        analogSwitch.Reset();
     }
+    m_pendingSwitches = 0;
+
+    // Everything is evaluated again from the pad state of the next frame that runs the stages
+    m_buttonHeld.ClearHeld();
+    m_staleChannels = ALL_CHANNELS;
 
-    // Handle A key
-    if (shouldPressA && !m_aPressed)
+    // One chunk per submission, so an undelivered suffix can be handed back; a sink
+    // that stops taking events leaves the rest held for the next frame to release
+    size_t count;
+    do
     {
-        m_keyboardMouse->SendKeyDown('A');
-        m_aPressed = true;
+        count = m_reconciler.ReleaseAll(m_events, MAX_EVENTS_PER_FRAME);
+        m_batch.BeginFrame();
+        m_batch.Enqueue(m_events, count);
+        m_batch.Flush();
+        if (m_batch.GetDeliveredCount() < count)
+        {
+            m_reconciler.Rollback(m_desired, m_events, count, m_batch.GetDeliveredCount());
+            return;
+        }
+    } while (count == MAX_EVENTS_PER_FRAME);
+}
+
+void Mapper::ProcessButtonMappings(uint64_t timestampNs)
+{
+    const PadState& previous = m_controller->GetPreviousState();
+    const PadState& current = m_controller->GetState();
+    const BindingTable& bindings = m_layers.GetBindings();
+
+    // Held bindings: visit only the bound buttons that are down
+    m_buttonHeld.ClearHeld();
+    uint32_t held = current.buttons & bindings.GetHeldMask();
+    while (held)
+    {
+        int bit = BindingTable::LowestSetBit(held);
+        held &= held - 1;
+
+        const BindingAction& action = bindings.GetAction(bit);
+        if (action.type == BindingActionType::Key)
+        {
+            m_buttonHeld.SetKey(action.codes[0]);
+        }
+        else
+        {
+            m_buttonHeld.SetMouseButton(action.codes[0]);
+        }
     }
-    else if (!shouldPressA && m_aPressed)
+
+    // Sequence bindings fire once on the press edge
+    uint32_t pressed = (previous.buttons ^ current.buttons) &
+                       current.buttons & bindings.GetSequenceMask();
+    while (pressed)
     {
-        m_keyboardMouse->SendKeyUp('A');
-        m_aPressed = false;
+        int bit = BindingTable::LowestSetBit(pressed);
+        pressed &= pressed - 1;
+
+        const BindingAction& action = bindings.GetAction(bit);
+        for (int i = 0; i < action.count; ++i)
+        {
+            m_desired.AddTap(action.codes[i]);
+        }
     }
 
-    // Handle D key
-    if (shouldPressD && !m_dPressed)
+    // Macro bindings start on the press edge; a release edge cancels those that ask for it
+    uint32_t changed = previous.buttons ^ current.buttons;
+    uint32_t started = changed & current.buttons & bindings.GetMacroMask();
+    while (started)
     {
-        m_keyboardMouse->SendKeyDown('D');
-        m_dPressed = true;
+        int bit = BindingTable::LowestSetBit(started);
+        started &= started - 1;
+        m_macros.Start(bit, bindings.GetMacro(bit), timestampNs);
     }
-    else if (!shouldPressD && m_dPressed)
+
+    uint32_t stopped = changed & previous.buttons & bindings.GetMacroMask();
+    while (stopped)
     {
-        m_keyboardMouse->SendKeyUp('D');
-        m_dPressed = false;
+        int bit = BindingTable::LowestSetBit(stopped);
+        stopped &= stopped - 1;
+        if (bindings.GetMacro(bit).cancelOnRelease)
+        {
+            m_macros.Cancel(bit);
+        }
     }
 
-    // Right Stick -> Mouse movement (Camera)
-    SHORT rightX = ApplyDeadZone(m_controller->GetRightStickX());
-    SHORT rightY = ApplyDeadZone(m_controller->GetRightStickY());
+    ProcessGestures(previous.buttons, current.buttons, bindings.GetGestureMask(), timestampNs);
 
-    // Scale stick movement to mouse movement
-    // XInput range is -32768 to 32767, scale to reasonable mouse delta
-    // Using a lower sensitivity multiplier to reduce fast movement
-    const float mouseSensitivity = 0.0015f; // Extremely low sensitivity for very precise camera control
-    int mouseDeltaX = static_cast<int>(rightX * mouseSensitivity);
-    int mouseDeltaY = static_cast<int>(-rightY * mouseSensitivity); // Invert Y for natural camera movement
+    // Gesture holds and macro steps are held in ComposeHeldOutputs;
+    // LT, RT and the LT + RT chord are handled in ProcessTriggers
+}
 
-    if (mouseDeltaX != 0 || mouseDeltaY != 0)
+void Mapper::ProcessGestures(uint32_t previous, uint32_t current, uint32_t gestureMask, uint64_t timestampNs)
+{
+    // Gesture bindings: only these buttons pay for recognition
+    uint32_t gestureEdges = (previous ^ current) & gestureMask;
+    if (gestureEdges)
     {
-        m_keyboardMouse->SendMouseMove(mouseDeltaX, mouseDeltaY);
+        GestureRecognizer::Fired fired[GestureRecognizer::MAX_FIRED];
+        int count = 0;
+        m_gestures.Update(gestureEdges & current, gestureEdges & previous, timestampNs,
+                          m_layers.GetBindings(), fired, count);
+        PlayGestures(fired, count, timestampNs);
     }
 }
 
-void Mapper::ProcessTriggers()
+uint32_t Mapper::UpdateLayers(uint32_t forced)
 {
-    if (!m_controller || !m_keyboardMouse)
+    // Only an activator edge switches; after a profile change or a release of
+    // all outputs, hold layers also follow activators that are still down
+    uint32_t previous = m_controller->GetPreviousState().buttons;
+    uint32_t current = m_controller->GetState().buttons;
+    if ((((previous ^ current) | forced) & m_layers.GetActivatorMask()) == 0)
     {
-        return;
+        return 0;
     }
 
-    const BYTE triggerThreshold = 128; // 50% threshold
-    
-    BYTE leftTrigger = m_controller->GetLeftTrigger();
-    BYTE rightTrigger = m_controller->GetRightTrigger();
-    
-    bool leftPressed = leftTrigger > triggerThreshold;
-    bool rightPressed = rightTrigger > triggerThreshold;
-    bool bothPressed = leftPressed && rightPressed;
-
-    // Handle LT + RT combination first (Styl Grupowy / Group Style -> C)
-    if (bothPressed && !m_bothTriggersPressed)
+    // Macros of the outgoing bindings that stop on release: their button is down,
+    // and its release will go to another binding
+    const BindingTable& outgoing = m_layers.GetBindings();
+    uint32_t stopping = 0;
+    for (uint32_t macros = current & outgoing.GetMacroMask(); macros; macros &= macros - 1)
     {
-        // Release individual triggers if they were pressed
-        if (m_leftTriggerPressed)
-        {
-            m_keyboardMouse->SendKeyUp('X');
-            m_leftTriggerPressed = false;
-        }
-        if (m_rightTriggerPressed)
-        {
-            m_keyboardMouse->SendKeyUp('Z');
-            m_rightTriggerPressed = false;
-        }
-        
-        // Press C for group style
-        m_keyboardMouse->SendKeyDown('C');
-        m_bothTriggersPressed = true;
+        int bit = BindingTable::LowestSetBit(macros);
+        stopping |= outgoing.GetMacro(bit).cancelOnRelease ? (1u << bit) : 0u;
     }
-    else if (!bothPressed && m_bothTriggersPressed)
+
+    uint32_t rebound = m_layers.Update(previous, current);
+    for (uint32_t cancelled = rebound & stopping; cancelled; cancelled &= cancelled - 1)
     {
-        // Release C
-        m_keyboardMouse->SendKeyUp('C');
-        m_bothTriggersPressed = false;
+        m_macros.Cancel(BindingTable::LowestSetBit(cancelled));
     }
-    
-    // Handle LT alone (Styl Szybki / Fast Style -> X)
-    // Only if both triggers are not pressed
-    if (!bothPressed)
+
+    // Gestures start over; held keys and mouse buttons are declared again by the
+    // button stage, which the rebound channels make run this frame
+    m_gestures.Reset(rebound);
+    return rebound;
+}
+
+void Mapper::ProcessCombos(uint64_t timestampNs)
+{
+    uint32_t previous = m_controller->GetPreviousState().buttons;
+    uint32_t current = m_controller->GetState().buttons;
+    uint32_t pressed = (previous ^ current) & current;
+    while (pressed)
     {
-        if (leftPressed && !m_leftTriggerPressed)
-        {
-            m_keyboardMouse->SendKeyDown('X');
-            m_leftTriggerPressed = true;
-        }
-        else if (!leftPressed && m_leftTriggerPressed)
+        int bit = BindingTable::LowestSetBit(pressed);
+        pressed &= pressed - 1;
+
+        int combo = m_comboRecognizer.Press(*m_combos, bit, timestampNs);
+        if (combo != ComboRecognizer::NO_COMBO)
         {
-            m_keyboardMouse->SendKeyUp('X');
-            m_leftTriggerPressed = false;
+            m_macros.Start(MacroPlayer::COMBO_SLOT, m_combos->GetCombo(static_cast<uint32_t>(combo)).action, timestampNs);
         }
+    }
+}
 
-        // Handle RT alone (Styl Silny / Strong Style -> Z)
-        if (rightPressed && !m_rightTriggerPressed)
+bool Mapper::ExpireGestures(uint64_t timestampNs)
+{
+    GestureRecognizer::Fired fired[GestureRecognizer::MAX_FIRED];
+    int count = 0;
+    bool changed = m_gestures.Expire(timestampNs, m_layers.GetBindings(), fired, count);
+    PlayGestures(fired, count, timestampNs);
+    return changed;
+}
+
+void Mapper::PlayGestures(const GestureRecognizer::Fired* fired, int count, uint64_t timestampNs)
+{
+    for (int i = 0; i < count; ++i)
+    {
+        const GestureDefinition& gesture = m_layers.GetBindings().GetGesture(fired[i].button);
+        int kind = static_cast<int>(fired[i].kind);
+
+        // The button's macro slot is free: a button has either a macro or a gesture binding
+        MacroDefinition press = {};
+        press.stepCount = gesture.repeats[kind];
+        for (int step = 0; step < press.stepCount; ++step)
         {
-            m_keyboardMouse->SendKeyDown('Z');
-            m_rightTriggerPressed = true;
+            press.steps[step] = gesture.actions[kind];
         }
-        else if (!rightPressed && m_rightTriggerPressed)
+        m_macros.Start(fired[i].button, press, timestampNs);
+    }
+}
+
+void Mapper::ProcessAnalogSticks(uint32_t bindings, uint64_t timestampNs)
+{
+    // Left Stick -> WASD movement
+    int32_t leftX = m_axes.leftX;
+    int32_t leftY = m_axes.leftY;
+
+    // Determine movement direction based on stick position
+    // Forward - positive Y (inverted from XInput where negative Y is up)
+    // Back - negative Y
+    // Left - negative X
+    // Right - positive X
+    // Each direction is its own switch, so a stick resting on a threshold does not chatter
+    const int32_t values[] = { leftY, -leftY, -leftX, leftX };     // Inverted: positive Y = forward
+    for (int i = SWITCH_MOVE_FORWARD; i <= SWITCH_MOVE_RIGHT; ++i)
+    {
+        if (bindings & (1u << (BINDING_FIRST_SWITCH + i)))
         {
-            m_keyboardMouse->SendKeyUp('Z');
-            m_rightTriggerPressed = false;
+            m_switches[i].Update(values[i], timestampNs);
         }
     }
+
+    // Right Stick -> Mouse camera velocity, integrated by ProcessMouseMotion from now on
+    if (bindings & BINDING_CAMERA)
+    {
+        m_mouseVelocityX = m_axes.rightX;
+        m_mouseVelocityY = static_cast<int16_t>(-m_axes.rightY); // Invert Y for natural camera movement
+    }
 }
 
-void Mapper::HandleButtonMapping(WORD button, WORD virtualKey)
+void Mapper::ProcessMouseMotion(uint64_t timestampNs)
 {
-    if (!m_controller || !m_keyboardMouse)
+    if (!m_motionStarted)
     {
+        m_motionStarted = true;
+        m_motionTimeNs = timestampNs;
         return;
     }
 
-    // Check if button was just pressed (transition from not pressed to pressed)
-    if (m_controller->IsButtonJustPressed(button))
+    // A snapshot stamped before the last frame (poll thread raced the frame) adds nothing
+    if (timestampNs <= m_motionTimeNs)
     {
-        #ifdef _DEBUG
-        std::cout << "Button pressed: 0x" << std::hex << button << " -> VK 0x" << virtualKey << std::dec << std::endl;
-        #endif
-        bool result = m_keyboardMouse->SendKeyDown(virtualKey);
-        #ifdef _DEBUG
-        if (!result)
-        {
-            std::cerr << "WARNING: SendKeyDown failed for VK 0x" << std::hex << virtualKey << std::dec << std::endl;
-        }
-        #endif
+        return;
     }
-    // Check if button was just released (transition from pressed to not pressed)
-    else if (m_controller->IsButtonJustReleased(button))
+
+    uint64_t elapsedNs = timestampNs - m_motionTimeNs;
+    m_motionTimeNs = timestampNs;
+    if (m_mouseVelocityX == 0 && m_mouseVelocityY == 0)
     {
-        #ifdef _DEBUG
-        std::cout << "Button released: 0x" << std::hex << button << " -> VK 0x" << virtualKey << std::dec << std::endl;
-        #endif
-        bool result = m_keyboardMouse->SendKeyUp(virtualKey);
-        #ifdef _DEBUG
-        if (!result)
-        {
-            std::cerr << "WARNING: SendKeyUp failed for VK 0x" << std::hex << virtualKey << std::dec << std::endl;
-        }
-        #endif
+        return;
+    }
+    if (elapsedNs > MAX_MOUSE_STEP_NS)
+    {
+        elapsedNs = MAX_MOUSE_STEP_NS;
+    }
+
+    int64_t scale = MOUSE_PIXELS_PER_SECOND * static_cast<int64_t>(elapsedNs);
+    m_mouseRemainderX += m_mouseVelocityX * scale;
+    m_mouseRemainderY += m_mouseVelocityY * scale;
+
+    m_desired.AddMouseDelta(TakeWholePixels(m_mouseRemainderX), TakeWholePixels(m_mouseRemainderY));
+}
+
+void Mapper::ProcessTriggers(uint32_t bindings, uint64_t timestampNs)
+{
+    if (bindings & (1u << (BINDING_FIRST_SWITCH + SWITCH_LEFT_TRIGGER)))
+    {
+        m_switches[SWITCH_LEFT_TRIGGER].Update(m_axes.leftTrigger, timestampNs);
+    }
+    if (bindings & (1u << (BINDING_FIRST_SWITCH + SWITCH_RIGHT_TRIGGER)))
+    {
+        m_switches[SWITCH_RIGHT_TRIGGER].Update(m_axes.rightTrigger, timestampNs);
     }
 }
 
-SHORT Mapper::ApplyDeadZone(SHORT value, SHORT deadZone) const
+void Mapper::HoldAnalogOutputs()
 {
-    if (value > deadZone)
+    if (m_switches[SWITCH_MOVE_FORWARD].IsOn())
+    {
+        HoldAnalogKey(AnalogKey::MoveForward);
+    }
+    if (m_switches[SWITCH_MOVE_BACK].IsOn())
+    {
+        HoldAnalogKey(AnalogKey::MoveBack);
+    }
+    if (m_switches[SWITCH_MOVE_LEFT].IsOn())
+    {
+        HoldAnalogKey(AnalogKey::MoveLeft);
+    }
+    if (m_switches[SWITCH_MOVE_RIGHT].IsOn())
+    {
+        HoldAnalogKey(AnalogKey::MoveRight);
+    }
+
+    bool leftPressed = m_switches[SWITCH_LEFT_TRIGGER].IsOn();
+    bool rightPressed = m_switches[SWITCH_RIGHT_TRIGGER].IsOn();
+    if (leftPressed && rightPressed && m_profile->GetAnalogKey(AnalogKey::BothTriggers) != 0)
+    {
+        // LT + RT chord (Witcher: C, Styl Grupowy) replaces the single-trigger keys
+        HoldAnalogKey(AnalogKey::BothTriggers);
+        return;
+    }
+
+    // Witcher: LT -> X (Styl Szybki), RT -> Z (Styl Silny)
+    if (leftPressed)
+    {
+        HoldAnalogKey(AnalogKey::LeftTrigger);
+    }
+    if (rightPressed)
     {
-        return value - deadZone;
+        HoldAnalogKey(AnalogKey::RightTrigger);
     }
-    else if (value < -deadZone)
+}
+
+void Mapper::HoldAnalogKey(AnalogKey key)
+{
+    uint16_t keyCode = m_profile->GetAnalogKey(key);
+    if (keyCode != 0)
     {
-        return value + deadZone;
+        m_desired.SetKey(keyCode);
     }
-    return 0;
 }
 
+void Mapper::EmitOutput()
+{
+    size_t count = m_reconciler.Reconcile(m_desired, m_events, MAX_EVENTS_PER_FRAME);
+    if (count == 0)
+    {
+        return;
+    }
+
+    m_batch.BeginFrame();
+    m_batch.Enqueue(m_events, count);
+    bool result = m_batch.Flush();
+
+    // What the sink did not take is produced again next frame
+    if (!result)
+    {
+        m_reconciler.Rollback(m_desired, m_events, count, m_batch.GetDeliveredCount());
+    }
+
+    #ifdef _DEBUG
+    for (size_t i = 0; i < count; ++i)
+    {
+        const OutputEvent& event = m_events[i];
+        if (event.type == OutputEventType::KeyDown || event.type == OutputEventType::KeyUp)
+        {
+            std::cout << (event.type == OutputEventType::KeyDown ? "Key down" : "Key up")
+                      << " -> VK 0x" << std::hex << event.code << std::dec << std::endl;
+        }
+    }
+    if (!result)
+    {
+        std::cerr << "WARNING: output batch of " << count << " events was not fully delivered" << std::endl;
+    }
+    #endif
+}
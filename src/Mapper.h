@@ -1,18 +1,50 @@
 #pragma once
 
-#include "XInputDevice.h"
-#include "KeyboardMouse.h"
-#include "VirtualController.h"
+#include "PadDevice.h"
+#include "BindingTable.h"
+#include "Profile.h"
+#include "StaticProfile.h"
+#include "WitcherProfile.h"
+#include "MacroPlayer.h"
+#include "GestureRecognizer.h"
+#include "ComboRecognizer.h"
+#include "LayerStack.h"
+#include "StickProcessor.h"
+#include "ThresholdSwitch.h"
+#include "AxisKernel.h"
+#include "IOutputSink.h"
+#include "OutputBatch.h"
+#include "OutputState.h"
+#include "OutputReconciler.h"
 
 /**
  * Mapper - Maps Xbox controller input to keyboard and mouse actions
- * 
+ *
  * This class handles the mapping logic between controller buttons/sticks
- * and keyboard/mouse events. It tracks button state transitions to avoid
- * key spamming and ensures proper key down/up events.
- * 
- * Also forwards input to a virtual Xbox 360 controller for games that
- * can detect it (when ViGEm is configured).
+ * and keyboard/mouse events. Each stage writes what should be held into a
+ * desired OutputState; a single OutputReconciler diffs it against what was
+ * already sent, so only real transitions reach the output sink, batched
+ * into one submission per frame.
+ *
+ * Evaluation is incremental. At profile load the mapper indexes which
+ * bindings read each input channel (a button bit, a stick, a trigger); each
+ * frame it re-evaluates only the bindings of the channels that changed, and
+ * the others keep their outputs. Time-driven work (camera motion, macro
+ * steps, gesture windows, switches waiting out their hold time) runs on
+ * every frame regardless.
+ *
+ * Layers (see LayerStack) rebind buttons while their activator is held or
+ * toggled on. A switch is resolved once into the effective binding table
+ * the button stage reads, and only the rebound buttons are evaluated again:
+ * what their old binding held is released, a macro it ran until release
+ * stops, and its gesture starts over.
+ *
+ * Combos (timed press sequences, see ComboAutomaton) are matched on the
+ * press edges of every button and play their macro on top of the bindings
+ * of the buttons they are made of.
+ *
+ * Forwarding to the virtual Xbox 360 controller is done separately by the
+ * main loop, so it does not wait for mapping.
  */
 class Mapper
 {
@@ -21,65 +53,382 @@ public:
     ~Mapper();
 
     /**
-     * Initialize the mapper with controller, keyboard/mouse, and virtual controller interfaces
-     * @param controller Reference to XInputDevice
-     * @param keyboardMouse Reference to KeyboardMouse
-     * @param virtualController Reference to VirtualController (can be nullptr if not available)
+     * Initialize the mapper with controller and keyboard/mouse output interfaces
+     * @param controller Pad state to map (XInputDevice, or a device fed by trace replay)
+     * @param output Keyboard/mouse output sink (KeyboardMouse)
      */
-    void Initialize(XInputDevice* controller, KeyboardMouse* keyboardMouse, VirtualController* virtualController = nullptr);
+    void Initialize(const PadDevice* controller, IOutputSink* output);
+
+    /**
+     * Use a profile: its button bindings, stick shaping, thresholds and analog keys
+     * (defaults to WitcherProfile, see SetStaticProfile()). The profile is used in place, not
+     * copied, so it can be a mapped image (ProfileCache); it must outlive its use
+     * here. Held outputs of the old profile are released on the next Update().
+     * Bakes the stick tables and compiles the combos, so call it at profile
+     * load, not per frame.
+     * @param profile New profile
+     */
+    void SetProfile(const Profile& profile);
+
+    /**
+     * Use a profile with stick tables already baked and combos already compiled from it
+     * Nothing is baked, copied or allocated, so this can run between two frames
+     * of the loop (hot reload, see ProfileReloader). The profile, both
+     * processors and the automaton are used in place and must outlive their
+     * use here. Held outputs of the old profile are released on the next Update().
+     * @param profile New profile
+     * @param leftStick, rightStick Processors configured with profile.leftStick and profile.rightStick
+     * @param combos Automaton compiled from profile.combos
+     */
+    void SetProfile(const Profile& profile, const StickProcessor& leftStick, const StickProcessor& rightStick,
+                    const ComboAutomaton& combos);
+
+    /**
+     * Use a built-in profile through the button stage generated for it at compile time
+     * (the default is WitcherProfile). Sticks and triggers use the profile like
+     * SetProfile(); SetProfile() and SetBindings() go back to the table-driven stage.
+     * Bakes the stick tables, so call it at profile load, not per frame.
+     * @tparam Definition Constexpr profile definition (see StaticProfile)
+     */
+    template <typename Definition>
+    void SetStaticProfile()
+    {
+        m_ownProfile = StaticProfile<Definition>::Build();
+        SetProfile(m_ownProfile);
+        m_buttonStage = &Mapper::ProcessStaticButtons<Definition>;
+    }
+
+    /**
+     * Check if the buttons go through a compile-time generated stage
+     */
+    bool IsStaticProfile() const { return m_buttonStage != &Mapper::ProcessButtonMappings; }
+
+    /**
+     * Replace only the button binding table of the current profile
+     * Held outputs of the old table are released on the next Update().
+     * @param bindings New binding table (copied)
+     */
+    void SetBindings(const BindingTable& bindings);
+
+    /**
+     * Replace the stick dead zones and response curves (defaults to StickSettings::Default())
+     * Bakes the lookup tables, so call it at profile load, not per frame.
+     * @param left Left stick (movement keys)
+     * @param right Right stick (camera)
+     */
+    void SetStickSettings(const StickSettings& left, const StickSettings& right);
+
+    /**
+     * Replace the press/release thresholds of the analog-to-digital bindings
+     * (defaults to ThresholdSettings::DefaultStick() and DefaultTrigger())
+     * @param stick Left-stick movement keys, in shaped stick units
+     * @param trigger Trigger keys, in raw trigger units
+     */
+    void SetThresholdSettings(const ThresholdSettings& stick, const ThresholdSettings& trigger);
+
+    /**
+     * Take shaped sticks and triggers from a batched AxisKernel instead of shaping them here
+     * The kernel must have run for the current pad state before Update(); the
+     * mapper's own stick settings are then unused.
+     * @param axes This pad's kernel output, or nullptr to shape per pad again
+     */
+    void SetAxisSource(const PadAxes* axes);
+
+    /**
+     * Re-evaluate only the bindings whose inputs changed (the default), or every binding
+     * Off, each frame that runs the stages evaluates all bindings, as a reference
+     * for the incremental path; the output is the same either way.
+     * @param enabled True for incremental evaluation
+     */
+    void SetIncrementalEvaluation(bool enabled);
 
     /**
      * Update the mapper - processes controller input and sends mapped actions
-     * Should be called every frame
+     * Should be called every frame, and once per applied snapshot.
+     * @param timestampNs Time the current pad state applies from: the snapshot
+     *        timestamp, or the current time on frames without a new snapshot.
+     *        Camera motion is integrated over the time between calls, so it
+     *        does not depend on how often Update() runs.
+     */
+    void Update(uint64_t timestampNs);
+
+    /**
+     * Release every key and mouse button the mapper is holding
+     * Call on disconnect or before exiting so nothing stays stuck in the game.
+     * Camera motion stops too and restarts from the next Update().
+     */
+    void ReleaseAllOutputs();
+
+    /**
+     * Get the number of Update() calls
+     * @return Frame count
+     */
+    unsigned long long GetFrameCount() const { return m_frameCount; }
+
+    /**
+     * Get the number of frames that took the unchanged-state fast path
+     * @return Skipped frame count
+     */
+    unsigned long long GetSkippedFrameCount() const { return m_skippedFrameCount; }
+
+    /**
+     * Get the number of stick/trigger key transitions the thresholds suppressed
+     * @return Sum over all analog-to-digital bindings (see ThresholdSwitch)
+     */
+    unsigned long long GetSuppressedTransitionCount() const;
+
+    /**
+     * Get the number of binding evaluations since construction
+     * @return Sum over frames of the bindings re-evaluated (see GetIndexedBindingCount())
+     */
+    unsigned long long GetEvaluatedBindingCount() const { return m_evaluatedBindingCount; }
+
+    /**
+     * Get the number of bindings a frame evaluates when every input changed
+     * @return Bound buttons, bound stick and trigger switches, the camera, and the combos
+     */
+    int GetIndexedBindingCount() const { return m_indexedBindingCount; }
+
+    /**
+     * Get the layers that are on (bit i: layer i of the profile)
+     */
+    uint32_t GetActiveLayerMask() const { return m_layers.GetActiveMask(); }
+
+    /**
+     * Get the number of layer switches since construction
+     */
+    uint64_t GetLayerSwitchCount() const { return m_layers.GetSwitchCount(); }
+
+    /**
+     * Get the number of combos completed since construction
      */
-    void Update();
+    uint64_t GetCompletedComboCount() const { return m_comboRecognizer.GetCompletedCount(); }
 
 private:
+    static const size_t MAX_EVENTS_PER_FRAME = 64;
+
+    // Camera speed at full right-stick deflection (tuned at the original 64 Hz loop)
+    static const int64_t MOUSE_PIXELS_PER_SECOND = 2392;
+
+    // Analog-to-digital bindings, one threshold switch each (keys from the profile's AnalogKey slots)
+    enum AnalogSwitch
+    {
+        SWITCH_MOVE_FORWARD,    // Left stick up
+        SWITCH_MOVE_BACK,       // Left stick down
+        SWITCH_MOVE_LEFT,       // Left stick left
+        SWITCH_MOVE_RIGHT,      // Left stick right
+        SWITCH_LEFT_TRIGGER,
+        SWITCH_RIGHT_TRIGGER,
+        SWITCH_COUNT
+    };
+
+    // Input channels, as bits of a changed-channel mask: button bits 0-15, then the sticks and triggers
+    static const int CHANNEL_COUNT = PadButton::COUNT + 4;
+    static const uint32_t CHANNEL_LEFT_STICK = 1u << PadButton::COUNT;
+    static const uint32_t CHANNEL_RIGHT_STICK = 1u << (PadButton::COUNT + 1);
+    static const uint32_t CHANNEL_LEFT_TRIGGER = 1u << (PadButton::COUNT + 2);
+    static const uint32_t CHANNEL_RIGHT_TRIGGER = 1u << (PadButton::COUNT + 3);
+    static const uint32_t ALL_CHANNELS = (1u << CHANNEL_COUNT) - 1;
+
+    // Bindings of the index, as bits of a binding mask: the button binding of each
+    // bit 0-15, then one per threshold switch (AnalogSwitch order), then the camera,
+    // then the combos (all of them one binding, reading every button)
+    static const uint32_t BINDING_BUTTONS = (1u << PadButton::COUNT) - 1;
+    static const int BINDING_FIRST_SWITCH = PadButton::COUNT;
+    static const uint32_t BINDING_CAMERA = 1u << (PadButton::COUNT + SWITCH_COUNT);
+    static const uint32_t BINDING_COMBOS = 1u << (PadButton::COUNT + SWITCH_COUNT + 1);
+
+    // Longest interval integrated in one step, so a stalled or resumed loop does not jump the camera
+    static const uint64_t MAX_MOUSE_STEP_NS = 100000000ULL;    // 100 ms
+
+    /**
+     * Apply the binding table: held buttons set keys/mouse buttons in
+     * m_buttonHeld, press edges of sequence bindings queue taps, press edges
+     * of macro bindings start their macro (release edges may cancel it), and
+     * gesture bindings feed their edges to the recognizer
+     * Runs only on frames where a bound button changed.
+     */
+    void ProcessButtonMappings(uint64_t timestampNs);
+
+    /**
+     * ProcessButtonMappings() for a built-in profile, unrolled at compile time
+     * Produces the same outputs in the same order as the table-driven stage.
+     */
+    template <typename Definition>
+    void ProcessStaticButtons(uint64_t timestampNs)
+    {
+        uint32_t previous = m_controller->GetPreviousState().buttons;
+        uint32_t current = m_controller->GetState().buttons;
+        uint32_t changed = previous ^ current;
+
+        m_buttonHeld.ClearHeld();
+        StaticProfile<Definition>::ApplyHeld(current, m_buttonHeld);
+        StaticProfile<Definition>::ApplySequences(changed & current, m_desired);
+        StaticProfile<Definition>::ApplyMacros(changed & current, changed & previous, m_macros, timestampNs);
+        if (StaticProfile<Definition>::GESTURE_MASK != 0)
+        {
+            ProcessGestures(previous, current, StaticProfile<Definition>::GESTURE_MASK, timestampNs);
+        }
+    }
+
     /**
-     * Process button mappings according to Requirements.md
+     * Feed the edges of gesture-bound buttons to the recognizer
+     * @param gestureMask Buttons bound to gestures
      */
-    void ProcessButtonMappings();
+    void ProcessGestures(uint32_t previous, uint32_t current, uint32_t gestureMask, uint64_t timestampNs);
+
+    /**
+     * Follow the layer activators and end the outputs of the buttons a switch rebinds
+     * @param forced Channels evaluated again regardless; a forced activator resyncs its hold layer
+     * @return Rebound buttons (their channels must be evaluated again)
+     */
+    uint32_t UpdateLayers(uint32_t forced);
+
+    /**
+     * Feed this frame's press edges to the combo recognizer and start the macro of a completed combo
+     * Presses of one frame go in button bit order.
+     */
+    void ProcessCombos(uint64_t timestampNs);
+
+    /**
+     * Build the input channel -> binding index of the current profile (at profile load)
+     */
+    void BuildBindingIndex();
+
+    /**
+     * Find the input channels that changed since the stages last ran, and shape the sticks that did
+     * @param forced Channels to treat as changed regardless (profile change, outputs released)
+     * @return Changed channels
+     */
+    uint32_t ReadChangedChannels(uint32_t forced);
+
+    /**
+     * Re-evaluate the given bindings against the current pad state
+     * @param bindings Binding mask (BINDING_* bits)
+     */
+    void EvaluateBindings(uint32_t bindings, uint64_t timestampNs);
+
+    /**
+     * Declare everything held this frame: button bindings, gesture holds,
+     * macro steps, and the stick and trigger keys of the switches that are on
+     */
+    void ComposeHeldOutputs();
+
+    /**
+     * Close gesture windows that ran out (only runs while a window is open)
+     * @return True if a gesture fired or a hold began
+     */
+    bool ExpireGestures(uint64_t timestampNs);
+
+    /**
+     * Play recognized one-shot gestures as timed presses
+     */
+    void PlayGestures(const GestureRecognizer::Fired* fired, int count, uint64_t timestampNs);
 
     /**
      * Process analog stick mappings
      * Left Stick -> WASD movement
      * Right Stick -> Mouse camera movement
+     * @param bindings Switches and camera to re-evaluate (BINDING_* bits)
+     */
+    void ProcessAnalogSticks(uint32_t bindings, uint64_t timestampNs);
+
+    /**
+     * Process right stick -> mouse movement
+     * Integrates the stick velocity in effect since the last call up to
+     * timestampNs. Runs on every Update(), including frames where the pad
+     * state did not change, because a held stick keeps moving the camera.
+     * Sub-pixel motion is carried over, so slow pans still move.
      */
-    void ProcessAnalogSticks();
+    void ProcessMouseMotion(uint64_t timestampNs);
 
     /**
      * Process trigger mappings
+     * @param bindings Switches to re-evaluate (BINDING_* bits)
      */
-    void ProcessTriggers();
+    void ProcessTriggers(uint32_t bindings, uint64_t timestampNs);
 
     /**
-     * Handle a button state change
-     * @param button XInput button flag
-     * @param virtualKey Target virtual key code
+     * Hold the stick and trigger keys of the switches that are on
      */
-    void HandleButtonMapping(WORD button, WORD virtualKey);
+    void HoldAnalogOutputs();
 
     /**
-     * Apply dead zone to analog stick value
-     * @param value Raw stick value (-32768 to 32767)
-     * @param deadZone Dead zone threshold (0-32767)
-     * @return Adjusted value or 0 if within dead zone
+     * Hold the key a profile binds to a stick/trigger input (nothing if unbound)
      */
-    SHORT ApplyDeadZone(SHORT value, SHORT deadZone = 7849) const; // ~24% dead zone
+    void HoldAnalogKey(AnalogKey key);
 
-    XInputDevice* m_controller;
-    KeyboardMouse* m_keyboardMouse;
-    VirtualController* m_virtualController;
+    /**
+     * Reconcile the desired state and submit the resulting events as one batch
+     */
+    void EmitOutput();
 
-    // Track currently pressed movement keys to avoid spamming
-    bool m_wPressed;
-    bool m_aPressed;
-    bool m_sPressed;
-    bool m_dPressed;
+    const PadDevice* m_controller;
+    IOutputSink* m_output;
 
-    // Track trigger states
-    bool m_leftTriggerPressed;
-    bool m_rightTriggerPressed;
-    bool m_bothTriggersPressed; // For LT + RT combination
-};
+    // Active profile (m_ownProfile, or one owned by the caller such as a mapped image),
+    // the timed macros its buttons started, and the gesture state of gesture-bound buttons
+    Profile m_ownProfile;
+    const Profile* m_profile;
+    MacroPlayer m_macros;
+    GestureRecognizer m_gestures;
+
+    // The profile's layers, and the button bindings they resolve to (the base table if none is on)
+    LayerStack m_layers;
+
+    // Combos: the own automaton, or one compiled by the caller along with its profile,
+    // and the presses matched against it so far
+    ComboAutomaton m_ownCombos;
+    const ComboAutomaton* m_combos;
+    ComboRecognizer m_comboRecognizer;
+
+    // Button stage: ProcessButtonMappings, or one generated for a built-in profile;
+    // and the keys and mouse buttons its held bindings set the last time it ran
+    void (Mapper::*m_buttonStage)(uint64_t timestampNs);
+    OutputState m_buttonHeld;
 
+    // Input channel -> bindings that read it, and the inputs the stages last evaluated
+    uint32_t m_channelBindings[CHANNEL_COUNT];
+    int m_indexedBindingCount;
+    bool m_incremental;
+    uint32_t m_staleChannels;   // Re-evaluate these on the next frame that runs the stages
+    uint16_t m_lastButtons;
+    int16_t m_lastLeftX;
+    int16_t m_lastLeftY;
+    int16_t m_lastRightX;
+    int16_t m_lastRightY;
+
+    // Stick shaping (radial dead zones and response curves, baked): the own
+    // tables, or tables baked by the caller along with its profile
+    StickProcessor m_ownLeftStick;
+    StickProcessor m_ownRightStick;
+    const StickProcessor* m_leftStick;
+    const StickProcessor* m_rightStick;
+    const PadAxes* m_axisSource;
+    PadAxes m_axes;             // Shaped sticks and raw triggers the bindings last evaluated
+
+    // Stick and trigger keys (hysteresis, minimum hold time)
+    ThresholdSwitch m_switches[SWITCH_COUNT];
+    uint32_t m_pendingSwitches; // Switches waiting for their hold time (BINDING_* bits): evaluated every frame
+
+    // What the stages want held this frame, and what has been sent so far
+    OutputState m_desired;
+    OutputReconciler m_reconciler;
+    OutputEvent m_events[MAX_EVENTS_PER_FRAME];
+    OutputBatch m_batch;
+    bool m_rebuildPending;  // Re-evaluate all stages on the next Update() (bindings changed)
+
+    // Camera motion: shaped right stick in effect since m_motionTimeNs,
+    // and the not yet emitted motion in units of 1/MOUSE_SUBPIXELS pixel (always 0 <= r < 1 px)
+    int16_t m_mouseVelocityX;
+    int16_t m_mouseVelocityY;
+    int64_t m_mouseRemainderX;
+    int64_t m_mouseRemainderY;
+    uint64_t m_motionTimeNs;
+    bool m_motionStarted;
+
+    // Fast-path statistics
+    unsigned long long m_frameCount;
+    unsigned long long m_skippedFrameCount;
+    unsigned long long m_evaluatedBindingCount;
+};
@@ -0,0 +1,143 @@
+#include "MonotonicClock.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <cerrno>
+#include <time.h>
+#endif
+
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+
+namespace
+{
+    const uint64_t NANOSECONDS_PER_SECOND = 1000000000ULL;
+
+#ifdef _WIN32
+    // High-resolution waitable timers wake within ~0.5 ms; Sleep() is bound to the
+    // ~15.6 ms system tick unless someone raised the timer resolution.
+    const uint64_t HIGH_RES_TIMER_SLACK_NS = 1000000ULL;
+    const uint64_t SLEEP_SLACK_NS = 16000000ULL;
+#else
+    const uint64_t NANOSLEEP_SLACK_NS = 200000ULL;
+#endif
+}
+
+#ifdef _WIN32
+
+SystemClock::SystemClock()
+    : m_timer(nullptr)
+    , m_frequency(0)
+{
+    LARGE_INTEGER frequency;
+    QueryPerformanceFrequency(&frequency);
+    m_frequency = frequency.QuadPart;
+
+    m_timer = CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+}
+
+SystemClock::~SystemClock()
+{
+    if (m_timer)
+    {
+        CloseHandle(m_timer);
+        m_timer = nullptr;
+    }
+}
+
+uint64_t SystemClock::NowNanoseconds() const
+{
+    LARGE_INTEGER counter;
+    QueryPerformanceCounter(&counter);
+
+    // Split to avoid overflowing 64 bits on long uptimes
+    uint64_t ticks = static_cast<uint64_t>(counter.QuadPart);
+    uint64_t frequency = static_cast<uint64_t>(m_frequency);
+    uint64_t seconds = ticks / frequency;
+    uint64_t remainder = ticks % frequency;
+    return seconds * NANOSECONDS_PER_SECOND + (remainder * NANOSECONDS_PER_SECOND) / frequency;
+}
+
+void SystemClock::SleepUntil(uint64_t deadlineNs)
+{
+    uint64_t now = NowNanoseconds();
+    if (deadlineNs <= now)
+    {
+        return;
+    }
+
+    uint64_t remainingNs = deadlineNs - now;
+
+    if (m_timer)
+    {
+        // Negative due time = relative, in 100 ns units
+        LARGE_INTEGER dueTime;
+        dueTime.QuadPart = -static_cast<LONGLONG>(remainingNs / 100);
+        if (SetWaitableTimer(m_timer, &dueTime, 0, nullptr, nullptr, FALSE))
+        {
+            WaitForSingleObject(m_timer, INFINITE);
+            return;
+        }
+    }
+
+    DWORD remainingMs = static_cast<DWORD>(remainingNs / 1000000ULL);
+    if (remainingMs > 0)
+    {
+        Sleep(remainingMs);
+    }
+}
+
+void SystemClock::Relax()
+{
+    YieldProcessor();
+}
+
+uint64_t SystemClock::GetSleepSlackNanoseconds() const
+{
+    return m_timer ? HIGH_RES_TIMER_SLACK_NS : SLEEP_SLACK_NS;
+}
+
+#else
+
+SystemClock::SystemClock()
+{
+}
+
+SystemClock::~SystemClock()
+{
+}
+
+uint64_t SystemClock::NowNanoseconds() const
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * NANOSECONDS_PER_SECOND + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+void SystemClock::SleepUntil(uint64_t deadlineNs)
+{
+    timespec deadline;
+    deadline.tv_sec = static_cast<time_t>(deadlineNs / NANOSECONDS_PER_SECOND);
+    deadline.tv_nsec = static_cast<long>(deadlineNs % NANOSECONDS_PER_SECOND);
+
+    // Absolute sleep: restarting after a signal does not accumulate drift
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, nullptr) == EINTR)
+    {
+    }
+}
+
+void SystemClock::Relax()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#endif
+}
+
+uint64_t SystemClock::GetSleepSlackNanoseconds() const
+{
+    return NANOSLEEP_SLACK_NS;
+}
+
+#endif
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstdint>
+
+/**
+ * IMonotonicClock - Injectable monotonic time source used for frame pacing
+ *
+ * All timestamps are nanoseconds from an arbitrary, fixed origin. The clock
+ * never goes backwards. Implementations may be swapped for a fake clock so
+ * that pacing logic can be exercised without real sleeps.
+ */
+class IMonotonicClock
+{
+public:
+    virtual ~IMonotonicClock() = default;
+
+    /**
+     * Get the current time
+     * @return Nanoseconds since an arbitrary fixed origin
+     */
+    virtual uint64_t NowNanoseconds() const = 0;
+
+    /**
+     * Block the calling thread until the given time (coarse, may wake late)
+     * Only one thread may sleep on a clock: SystemClock arms a single waitable timer
+     * on Windows, and two sleepers would re-arm each other's wake-up. Give every
+     * thread that sleeps a clock of its own. NowNanoseconds() may be called from any thread.
+     * @param deadlineNs Absolute wake-up time in nanoseconds
+     */
+    virtual void SleepUntil(uint64_t deadlineNs) = 0;
+
+    /**
+     * Hint to the CPU that we are busy-waiting (called between spin iterations)
+     */
+    virtual void Relax() {}
+
+    /**
+     * Get the worst-case oversleep of SleepUntil
+     * The scheduler stops sleeping this long before a deadline and spins the rest.
+     * @return Slack in nanoseconds
+     */
+    virtual uint64_t GetSleepSlackNanoseconds() const = 0;
+};
+
+/**
+ * SystemClock - Real monotonic clock
+ *
+ * Windows: QueryPerformanceCounter plus a high-resolution waitable timer
+ * (falls back to Sleep() on systems without CREATE_WAITABLE_TIMER_HIGH_RESOLUTION).
+ * Linux: CLOCK_MONOTONIC with clock_nanosleep(TIMER_ABSTIME).
+ */
+class SystemClock : public IMonotonicClock
+{
+public:
+    SystemClock();
+    ~SystemClock() override;
+
+    SystemClock(const SystemClock&) = delete;
+    SystemClock& operator=(const SystemClock&) = delete;
+
+    uint64_t NowNanoseconds() const override;
+    void SleepUntil(uint64_t deadlineNs) override;
+    void Relax() override;
+    uint64_t GetSleepSlackNanoseconds() const override;
+
+private:
+#ifdef _WIN32
+    void* m_timer;          // HANDLE of the high-resolution waitable timer (nullptr if unavailable)
+    int64_t m_frequency;    // QueryPerformanceFrequency ticks per second
+#endif
+};
@@ -0,0 +1,61 @@
+#include "OutputBatch.h"
+
+OutputBatch::OutputBatch()
+    : m_sink(nullptr)
+    , m_count(0)
+    , m_failed(false)
+    , m_delivered(0)
+    , m_submitCount(0)
+    , m_eventCount(0)
+{
+}
+
+void OutputBatch::Enqueue(const OutputEvent& event)
+{
+    if (m_count == CAPACITY)
+    {
+        // Keep ordering: the earlier events must go out before this one
+        SubmitPending();
+    }
+    m_events[m_count++] = event;
+}
+
+void OutputBatch::Enqueue(const OutputEvent* events, size_t count)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        Enqueue(events[i]);
+    }
+}
+
+bool OutputBatch::Flush()
+{
+    SubmitPending();
+
+    bool ok = !m_failed;
+    m_failed = false;
+    return ok;
+}
+
+void OutputBatch::SubmitPending()
+{
+    if (m_count == 0)
+    {
+        return;
+    }
+
+    // After a short write the undelivered events must go out first: drop the rest of the frame
+    if (m_sink && !m_failed)
+    {
+        size_t delivered = m_sink->Submit(m_events, m_count);
+        ++m_submitCount;
+        m_eventCount += m_count;
+        m_delivered += delivered;
+        if (delivered != m_count)
+        {
+            m_failed = true;
+        }
+    }
+
+    m_count = 0;
+}
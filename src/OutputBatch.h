@@ -0,0 +1,87 @@
+#pragma once
+
+#include "IOutputSink.h"
+#include <cstdint>
+
+/**
+ * OutputBatch - Frame-scoped event batch in front of an IOutputSink
+ *
+ * Events enqueued between BeginFrame() and Flush() are collected in a
+ * preallocated buffer and handed to the sink as one contiguous batch, so a
+ * frame costs a single submission instead of one per event. Order is preserved;
+ * if the buffer fills up mid-frame, the collected prefix is flushed early. After
+ * a short write the rest of the frame is not submitted, so what the sink got is
+ * always a prefix of the frame (see GetDeliveredCount()).
+ */
+class OutputBatch
+{
+public:
+    static const size_t CAPACITY = 64;
+
+    OutputBatch();
+
+    /**
+     * Set the sink that receives flushed batches
+     * @param sink Output sink (can be nullptr to discard)
+     */
+    void SetSink(IOutputSink* sink) { m_sink = sink; }
+
+    /**
+     * Start collecting a new frame (drops anything not flushed)
+     */
+    void BeginFrame() { m_count = 0; m_failed = false; m_delivered = 0; }
+
+    /**
+     * Append one event
+     * @param event Event to append
+     */
+    void Enqueue(const OutputEvent& event);
+
+    /**
+     * Append several events in order
+     * @param events Events to append
+     * @param count Number of events
+     */
+    void Enqueue(const OutputEvent* events, size_t count);
+
+    /**
+     * Submit everything collected so far to the sink
+     * @return true if the sink accepted every event
+     */
+    bool Flush();
+
+    /**
+     * Get the number of events of this frame the sink delivered, counted from its first event
+     */
+    size_t GetDeliveredCount() const { return m_delivered; }
+
+    /**
+     * Get the number of events waiting to be flushed
+     */
+    size_t GetPendingCount() const { return m_count; }
+
+    /**
+     * Get the number of Submit() calls made
+     */
+    uint64_t GetSubmitCount() const { return m_submitCount; }
+
+    /**
+     * Get the number of events submitted
+     */
+    uint64_t GetEventCount() const { return m_eventCount; }
+
+private:
+    /**
+     * Hand the collected events to the sink and empty the buffer
+     */
+    void SubmitPending();
+
+    IOutputSink* m_sink;
+    OutputEvent m_events[CAPACITY];
+    size_t m_count;
+    bool m_failed;  // A submission since the last Flush() lost events
+    size_t m_delivered;
+
+    uint64_t m_submitCount;
+    uint64_t m_eventCount;
+};
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstdint>
+
+/**
+ * Kind of keyboard/mouse event
+ */
+enum class OutputEventType : uint8_t
+{
+    KeyDown,
+    KeyUp,
+    MouseButtonDown,
+    MouseButtonUp,
+    MouseMove
+};
+
+/**
+ * OutputEvent - One platform-neutral keyboard/mouse event
+ *
+ * code is a key code (Win32 virtual key value) for key events and a mouse
+ * button index (0=left, 1=right, 2=middle) for mouse button events.
+ * deltaX/deltaY are only used by MouseMove.
+ */
+struct OutputEvent
+{
+    OutputEventType type;
+    uint16_t code;
+    int32_t deltaX;
+    int32_t deltaY;
+
+    static OutputEvent KeyDown(uint16_t keyCode) { return { OutputEventType::KeyDown, keyCode, 0, 0 }; }
+    static OutputEvent KeyUp(uint16_t keyCode) { return { OutputEventType::KeyUp, keyCode, 0, 0 }; }
+    static OutputEvent MouseButtonDown(uint16_t button) { return { OutputEventType::MouseButtonDown, button, 0, 0 }; }
+    static OutputEvent MouseButtonUp(uint16_t button) { return { OutputEventType::MouseButtonUp, button, 0, 0 }; }
+    static OutputEvent MouseMove(int32_t dx, int32_t dy) { return { OutputEventType::MouseMove, 0, dx, dy }; }
+};
@@ -0,0 +1,172 @@
+#include "OutputReconciler.h"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace
+{
+    int LowestSetBit64(uint64_t mask)
+    {
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanForward64(&index, mask);
+        return static_cast<int>(index);
+#else
+        return __builtin_ctzll(mask);
+#endif
+    }
+}
+
+OutputReconciler::OutputReconciler()
+{
+}
+
+size_t OutputReconciler::Reconcile(OutputState& desired, OutputEvent* events, size_t capacity)
+{
+    size_t count = 0;
+
+    // Key ups
+    for (int word = 0; word < 4; ++word)
+    {
+        uint64_t ups = m_emitted.keys[word] & ~desired.keys[word];
+        while (ups && count < capacity)
+        {
+            int bit = LowestSetBit64(ups);
+            ups &= ups - 1;
+            events[count++] = OutputEvent::KeyUp(static_cast<uint16_t>(word * 64 + bit));
+            m_emitted.keys[word] &= ~(1ULL << bit);
+        }
+    }
+
+    // Mouse button ups
+    for (int button = 0; button < OutputState::MOUSE_BUTTON_COUNT && count < capacity; ++button)
+    {
+        uint8_t bit = static_cast<uint8_t>(1u << button);
+        if ((m_emitted.mouseButtons & bit) && !(desired.mouseButtons & bit))
+        {
+            events[count++] = OutputEvent::MouseButtonUp(static_cast<uint16_t>(button));
+            m_emitted.mouseButtons &= static_cast<uint8_t>(~bit);
+        }
+    }
+
+    // Key downs
+    for (int word = 0; word < 4; ++word)
+    {
+        uint64_t downs = desired.keys[word] & ~m_emitted.keys[word];
+        while (downs && count < capacity)
+        {
+            int bit = LowestSetBit64(downs);
+            downs &= downs - 1;
+            events[count++] = OutputEvent::KeyDown(static_cast<uint16_t>(word * 64 + bit));
+            m_emitted.keys[word] |= (1ULL << bit);
+        }
+    }
+
+    // Mouse button downs
+    for (int button = 0; button < OutputState::MOUSE_BUTTON_COUNT && count < capacity; ++button)
+    {
+        uint8_t bit = static_cast<uint8_t>(1u << button);
+        if (!(m_emitted.mouseButtons & bit) && (desired.mouseButtons & bit))
+        {
+            events[count++] = OutputEvent::MouseButtonDown(static_cast<uint16_t>(button));
+            m_emitted.mouseButtons |= bit;
+        }
+    }
+
+    // Taps: down + up pairs. A key that is already held is not tapped (that would release it).
+    int tap = 0;
+    for (; tap < desired.tapCount && count + 2 <= capacity; ++tap)
+    {
+        uint16_t keyCode = desired.taps[tap];
+        if (m_emitted.IsKeyDown(keyCode))
+        {
+            continue;
+        }
+        events[count++] = OutputEvent::KeyDown(keyCode);
+        events[count++] = OutputEvent::KeyUp(keyCode);
+    }
+
+    // Keep taps that did not fit for the next call
+    int remaining = desired.tapCount - tap;
+    for (int i = 0; i < remaining; ++i)
+    {
+        desired.taps[i] = desired.taps[tap + i];
+    }
+    desired.tapCount = static_cast<uint8_t>(remaining);
+
+    // Relative motion
+    if ((desired.mouseDeltaX != 0 || desired.mouseDeltaY != 0) && count < capacity)
+    {
+        events[count++] = OutputEvent::MouseMove(desired.mouseDeltaX, desired.mouseDeltaY);
+        desired.mouseDeltaX = 0;
+        desired.mouseDeltaY = 0;
+    }
+
+    return count;
+}
+
+size_t OutputReconciler::ReleaseAll(OutputEvent* events, size_t capacity)
+{
+    OutputState nothing;
+    return Reconcile(nothing, events, capacity);
+}
+
+void OutputReconciler::Rollback(OutputState& desired, const OutputEvent* events, size_t count, size_t delivered)
+{
+    uint16_t taps[OutputState::MAX_TAPS];
+    int tapCount = 0;
+
+    for (size_t i = delivered; i < count; ++i)
+    {
+        const OutputEvent& event = events[i];
+        uint64_t keyBit = 1ULL << (event.code & 63);
+        uint8_t buttonBit = static_cast<uint8_t>(1u << (event.code & 7));
+        switch (event.type)
+        {
+        case OutputEventType::KeyDown:
+            // A tap is a down directly followed by the up of the same key; it never changed the emitted state
+            if (i + 1 < count && events[i + 1].type == OutputEventType::KeyUp && events[i + 1].code == event.code)
+            {
+                if (tapCount < OutputState::MAX_TAPS)
+                {
+                    taps[tapCount++] = event.code;
+                }
+                ++i;
+                break;
+            }
+            m_emitted.keys[(event.code >> 6) & 3] &= ~keyBit;
+            break;
+        case OutputEventType::KeyUp:
+            // Also the second half of a tap whose down went out: the key is held until released
+            m_emitted.keys[(event.code >> 6) & 3] |= keyBit;
+            break;
+        case OutputEventType::MouseButtonDown:
+            m_emitted.mouseButtons &= static_cast<uint8_t>(~buttonBit);
+            break;
+        case OutputEventType::MouseButtonUp:
+            m_emitted.mouseButtons |= buttonBit;
+            break;
+        case OutputEventType::MouseMove:
+            desired.mouseDeltaX += event.deltaX;
+            desired.mouseDeltaY += event.deltaY;
+            break;
+        }
+    }
+
+    // Undelivered taps go out before the ones that did not fit
+    int kept = desired.tapCount;
+    if (kept + tapCount > OutputState::MAX_TAPS)
+    {
+        kept = OutputState::MAX_TAPS - tapCount;
+    }
+    for (int i = kept - 1; i >= 0; --i)
+    {
+        desired.taps[i + tapCount] = desired.taps[i];
+    }
+    for (int i = 0; i < tapCount; ++i)
+    {
+        desired.taps[i] = taps[i];
+    }
+    desired.tapCount = static_cast<uint8_t>(kept + tapCount);
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "OutputEvent.h"
+#include "OutputState.h"
+#include <cstddef>
+
+/**
+ * OutputReconciler - Turns a desired OutputState into the minimal event list
+ *
+ * Keeps the state that was actually emitted. Each call diffs the desired
+ * state against it and writes only the transitions, in a fixed order:
+ * key ups, mouse button ups, key downs, mouse button downs, taps, motion.
+ * Releasing before pressing lets combos swap keys cleanly (LT+RT: X/Z up, then C down).
+ *
+ * The emitted state is only updated for events that fit in the output buffer,
+ * so anything that does not fit is produced again on the next call. Events the
+ * sink did not deliver are handed back with Rollback(), which undoes them in the
+ * same way. A key can therefore never be left held once the desired state lets go of it.
+ */
+class OutputReconciler
+{
+public:
+    OutputReconciler();
+
+    /**
+     * Diff desired against the emitted state
+     * Consumes the desired mouse delta and taps that were written out.
+     * @param desired State the mapping stages want
+     * @param events Output buffer
+     * @param capacity Size of the output buffer
+     * @return Number of events written
+     */
+    size_t Reconcile(OutputState& desired, OutputEvent* events, size_t capacity);
+
+    /**
+     * Produce key/mouse button ups for everything currently held
+     * @param events Output buffer
+     * @param capacity Size of the output buffer
+     * @return Number of events written
+     */
+    size_t ReleaseAll(OutputEvent* events, size_t capacity);
+
+    /**
+     * Undo the events of the last Reconcile()/ReleaseAll() that the sink did not deliver,
+     * so the next call produces them again
+     * Undelivered taps and motion go back into desired.
+     * @param desired State passed to the last Reconcile()
+     * @param events Events it wrote
+     * @param count Number of events it wrote
+     * @param delivered Number of leading events the sink delivered
+     */
+    void Rollback(OutputState& desired, const OutputEvent* events, size_t count, size_t delivered);
+
+    /**
+     * Get the state that was last emitted
+     */
+    const OutputState& GetEmittedState() const { return m_emitted; }
+
+private:
+    OutputState m_emitted;
+};
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+/**
+ * OutputState - Compact snapshot of keyboard/mouse output
+ *
+ * Mapping stages describe what should be held right now (keys, mouse buttons)
+ * and add the mouse motion for this frame; OutputReconciler turns the difference
+ * to what was last emitted into events.
+ */
+struct OutputState
+{
+    static const int MAX_TAPS = 16;
+    static const int MOUSE_BUTTON_COUNT = 8;
+
+    uint64_t keys[4];           // 256-bit set indexed by key code
+    uint8_t mouseButtons;       // Bit n = mouse button n held
+    int32_t mouseDeltaX;        // Accumulated relative motion (consumed on emit)
+    int32_t mouseDeltaY;
+    uint16_t taps[MAX_TAPS];    // Keys to tap (down + up) this frame, in order
+    uint8_t tapCount;
+
+    OutputState() { Reset(); }
+
+    /**
+     * Clear everything
+     */
+    void Reset()
+    {
+        std::memset(this, 0, sizeof(*this));
+    }
+
+    /**
+     * Clear held keys and mouse buttons (motion and taps are kept)
+     */
+    void ClearHeld()
+    {
+        std::memset(keys, 0, sizeof(keys));
+        mouseButtons = 0;
+    }
+
+    void SetKey(uint16_t keyCode)
+    {
+        keys[(keyCode >> 6) & 3] |= (1ULL << (keyCode & 63));
+    }
+
+    bool IsKeyDown(uint16_t keyCode) const
+    {
+        return (keys[(keyCode >> 6) & 3] & (1ULL << (keyCode & 63))) != 0;
+    }
+
+    /**
+     * Hold a mouse button
+     * @return false if button is not below MOUSE_BUTTON_COUNT (nothing is held)
+     */
+    bool SetMouseButton(uint16_t button)
+    {
+        if (button >= MOUSE_BUTTON_COUNT)
+        {
+            return false;
+        }
+        mouseButtons |= static_cast<uint8_t>(1u << button);
+        return true;
+    }
+
+    /**
+     * Also hold everything another state holds
+     */
+    void AddHeld(const OutputState& other)
+    {
+        for (int i = 0; i < 4; ++i)
+        {
+            keys[i] |= other.keys[i];
+        }
+        mouseButtons |= other.mouseButtons;
+    }
+
+    void AddMouseDelta(int32_t dx, int32_t dy)
+    {
+        mouseDeltaX += dx;
+        mouseDeltaY += dy;
+    }
+
+    /**
+     * Queue a key tap
+     * @return false if the tap list is full
+     */
+    bool AddTap(uint16_t keyCode)
+    {
+        if (tapCount >= MAX_TAPS)
+        {
+            return false;
+        }
+        taps[tapCount++] = keyCode;
+        return true;
+    }
+};
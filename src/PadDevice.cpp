@@ -0,0 +1,85 @@
+#include "PadDevice.h"
+
+PadDevice::PadDevice()
+    : m_currentState()
+    , m_previousState()
+    , m_packetNumber(0)
+    , m_isConnected(false)
+    , m_stateChanged(false)
+{
+}
+
+PadDevice::~PadDevice()
+{
+}
+
+PadSnapshot PadDevice::GetSnapshot(uint64_t timestampNs) const
+{
+    PadSnapshot snapshot = {};
+    snapshot.timestampNs = timestampNs;
+    snapshot.packetNumber = m_packetNumber;
+    snapshot.connected = m_isConnected ? 1 : 0;
+    snapshot.pad = m_currentState;
+    return snapshot;
+}
+
+void PadDevice::ApplySnapshot(const PadSnapshot& snapshot)
+{
+    Advance(snapshot.pad, snapshot.packetNumber, snapshot.connected != 0);
+}
+
+void PadDevice::MarkUnchanged()
+{
+    m_previousState = m_currentState;
+    m_stateChanged = false;
+}
+
+void PadDevice::Advance(const PadState& state, uint32_t packetNumber, bool connected)
+{
+    m_previousState = m_currentState;
+
+    bool wasConnected = m_isConnected;
+    uint32_t previousPacket = m_packetNumber;
+
+    m_currentState = state;
+    m_packetNumber = packetNumber;
+    m_isConnected = connected;
+
+    m_stateChanged = (m_isConnected != wasConnected) || (m_packetNumber != previousPacket);
+}
+
+bool PadDevice::IsButtonPressed(uint16_t button) const
+{
+    if (!m_isConnected)
+    {
+        return false;
+    }
+
+    return (m_currentState.buttons & button) != 0;
+}
+
+bool PadDevice::IsButtonJustPressed(uint16_t button) const
+{
+    if (!m_isConnected)
+    {
+        return false;
+    }
+
+    bool wasPressed = (m_previousState.buttons & button) != 0;
+    bool isPressed = (m_currentState.buttons & button) != 0;
+
+    return !wasPressed && isPressed;
+}
+
+bool PadDevice::IsButtonJustReleased(uint16_t button) const
+{
+    if (!m_isConnected)
+    {
+        return false;
+    }
+
+    bool wasPressed = (m_previousState.buttons & button) != 0;
+    bool isPressed = (m_currentState.buttons & button) != 0;
+
+    return wasPressed && !isPressed;
+}
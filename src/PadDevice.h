@@ -0,0 +1,129 @@
+#pragma once
+
+#include "PadState.h"
+#include <cstdint>
+
+/**
+ * PadDevice - Platform-neutral current/previous pad state with transition queries
+ *
+ * Holds the state the mapper reads. Backends advance it with ApplySnapshot()
+ * (or, for XInputDevice, by reading the hardware in Update()); a trace replay
+ * feeds recorded snapshots the same way.
+ */
+class PadDevice
+{
+public:
+    PadDevice();
+    virtual ~PadDevice();
+
+    /**
+     * Capture the current state as a timestamped snapshot
+     * @param timestampNs Monotonic time of the read
+     * @return Snapshot of the current state
+     */
+    PadSnapshot GetSnapshot(uint64_t timestampNs) const;
+
+    /**
+     * Advance to a snapshot produced elsewhere (poll thread, trace replay)
+     * The current state becomes the previous state.
+     * @param snapshot New state
+     */
+    void ApplySnapshot(const PadSnapshot& snapshot);
+
+    /**
+     * Advance one frame without new input (previous state = current state)
+     */
+    void MarkUnchanged();
+
+    /**
+     * Check if the last advance delivered new input
+     * Based on the packet number, which only changes when the pad state
+     * actually changes. A connect/disconnect also counts as a change.
+     * @return true if the state differs from the previous frame
+     */
+    bool HasStateChanged() const { return m_stateChanged; }
+
+    /**
+     * Check if a button is currently pressed
+     * @param button Button flag (PadButton / XINPUT_GAMEPAD_*)
+     * @return true if button is pressed
+     */
+    bool IsButtonPressed(uint16_t button) const;
+
+    /**
+     * Check if a button was just pressed (transition from not pressed to pressed)
+     * @param button Button flag
+     * @return true if button was just pressed this frame
+     */
+    bool IsButtonJustPressed(uint16_t button) const;
+
+    /**
+     * Check if a button was just released (transition from pressed to not pressed)
+     * @param button Button flag
+     * @return true if button was just released this frame
+     */
+    bool IsButtonJustReleased(uint16_t button) const;
+
+    /**
+     * Get the current pad state
+     */
+    const PadState& GetState() const { return m_currentState; }
+
+    /**
+     * Get the previous pad state (for detecting transitions)
+     */
+    const PadState& GetPreviousState() const { return m_previousState; }
+
+    /**
+     * Get the packet number of the current state
+     */
+    uint32_t GetPacketNumber() const { return m_packetNumber; }
+
+    /**
+     * Check if controller is connected
+     * @return true if connected
+     */
+    bool IsConnected() const { return m_isConnected; }
+
+    /**
+     * Get left thumbstick X position (-32768 to 32767)
+     */
+    int16_t GetLeftStickX() const { return m_isConnected ? m_currentState.thumbLX : 0; }
+
+    /**
+     * Get left thumbstick Y position (-32768 to 32767)
+     */
+    int16_t GetLeftStickY() const { return m_isConnected ? m_currentState.thumbLY : 0; }
+
+    /**
+     * Get right thumbstick X position (-32768 to 32767)
+     */
+    int16_t GetRightStickX() const { return m_isConnected ? m_currentState.thumbRX : 0; }
+
+    /**
+     * Get right thumbstick Y position (-32768 to 32767)
+     */
+    int16_t GetRightStickY() const { return m_isConnected ? m_currentState.thumbRY : 0; }
+
+    /**
+     * Get left trigger value (0 to 255)
+     */
+    uint8_t GetLeftTrigger() const { return m_isConnected ? m_currentState.leftTrigger : 0; }
+
+    /**
+     * Get right trigger value (0 to 255)
+     */
+    uint8_t GetRightTrigger() const { return m_isConnected ? m_currentState.rightTrigger : 0; }
+
+protected:
+    /**
+     * Store a new reading; the current state becomes the previous state
+     */
+    void Advance(const PadState& state, uint32_t packetNumber, bool connected);
+
+    PadState m_currentState;
+    PadState m_previousState;
+    uint32_t m_packetNumber;
+    bool m_isConnected;
+    bool m_stateChanged;
+};
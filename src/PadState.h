@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstdint>
+
+/**
+ * PadState - Platform-neutral gamepad state
+ *
+ * Same layout and value ranges as XINPUT_GAMEPAD: buttons use the PadButton
+ * bits, triggers are 0-255 and sticks are -32768 to 32767.
+ */
+struct PadState
+{
+    uint16_t buttons;
+    uint8_t leftTrigger;
+    uint8_t rightTrigger;
+    int16_t thumbLX;
+    int16_t thumbLY;
+    int16_t thumbRX;
+    int16_t thumbRY;
+};
+
+/**
+ * PadSnapshot - One timestamped reading of a pad
+ */
+struct PadSnapshot
+{
+    uint64_t timestampNs;   // Monotonic time of the read
+    uint32_t packetNumber;  // Source packet counter (changes only when the state changes)
+    uint32_t connected;     // Non-zero if the pad was connected
+    PadState pad;
+};
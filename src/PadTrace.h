@@ -0,0 +1,100 @@
+#pragma once
+
+#include "PadState.h"
+#include <cstdint>
+#include <cstring>
+
+/**
+ * Binary pad trace format (.gpt)
+ *
+ * A 32-byte header followed by fixed-size 32-byte records, one per pad state
+ * change, all little-endian. The record count is not stored: it follows from
+ * the file size, so a trace cut short by a crash is still readable up to the
+ * last complete record.
+ */
+namespace PadTrace
+{
+    const char MAGIC[8] = { 'G', 'P', 'M', 'T', 'R', 'A', 'C', 'E' };
+    const uint32_t VERSION = 1;
+
+    struct Header
+    {
+        char magic[8];          // MAGIC
+        uint32_t version;       // VERSION
+        uint32_t recordSize;    // sizeof(Record)
+        uint64_t startTimestampNs;  // Recorder clock when recording started
+        uint32_t controllerIndex;   // Source controller slot
+        uint32_t reserved;
+    };
+
+    /**
+     * One pad state: timestamp plus the XINPUT_GAMEPAD fields
+     */
+    struct Record
+    {
+        uint64_t timestampNs;   // Recorder clock (same origin as the header)
+        uint32_t packetNumber;
+        uint16_t buttons;
+        uint8_t leftTrigger;
+        uint8_t rightTrigger;
+        int16_t thumbLX;
+        int16_t thumbLY;
+        int16_t thumbRX;
+        int16_t thumbRY;
+        uint32_t connected;
+        uint32_t reserved;
+    };
+
+    static_assert(sizeof(Header) == 32, "PadTrace::Header layout changed");
+    static_assert(sizeof(Record) == 32, "PadTrace::Record layout changed");
+
+    inline Header MakeHeader(uint64_t startTimestampNs, uint32_t controllerIndex)
+    {
+        Header header = {};
+        std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+        header.version = VERSION;
+        header.recordSize = sizeof(Record);
+        header.startTimestampNs = startTimestampNs;
+        header.controllerIndex = controllerIndex;
+        return header;
+    }
+
+    inline bool IsValidHeader(const Header& header)
+    {
+        return std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) == 0 &&
+               header.version == VERSION &&
+               header.recordSize == sizeof(Record);
+    }
+
+    inline Record ToRecord(const PadSnapshot& snapshot)
+    {
+        Record record = {};
+        record.timestampNs = snapshot.timestampNs;
+        record.packetNumber = snapshot.packetNumber;
+        record.buttons = snapshot.pad.buttons;
+        record.leftTrigger = snapshot.pad.leftTrigger;
+        record.rightTrigger = snapshot.pad.rightTrigger;
+        record.thumbLX = snapshot.pad.thumbLX;
+        record.thumbLY = snapshot.pad.thumbLY;
+        record.thumbRX = snapshot.pad.thumbRX;
+        record.thumbRY = snapshot.pad.thumbRY;
+        record.connected = snapshot.connected;
+        return record;
+    }
+
+    inline PadSnapshot ToSnapshot(const Record& record)
+    {
+        PadSnapshot snapshot = {};
+        snapshot.timestampNs = record.timestampNs;
+        snapshot.packetNumber = record.packetNumber;
+        snapshot.connected = record.connected;
+        snapshot.pad.buttons = record.buttons;
+        snapshot.pad.leftTrigger = record.leftTrigger;
+        snapshot.pad.rightTrigger = record.rightTrigger;
+        snapshot.pad.thumbLX = record.thumbLX;
+        snapshot.pad.thumbLY = record.thumbLY;
+        snapshot.pad.thumbRX = record.thumbRX;
+        snapshot.pad.thumbRY = record.thumbRY;
+        return snapshot;
+    }
+}
@@ -0,0 +1,273 @@
+#include "Profile.h"
+#include "InputNames.h"
+#include "WitcherProfile.h"
+#include <cstdio>
+#include <cstring>
+#include <ostream>
+#include <string>
+
+namespace
+{
+    // Banner order: face buttons and shoulders first, like the pad reads
+    const uint16_t BANNER_ORDER[] =
+    {
+        PadButton::A, PadButton::B, PadButton::X, PadButton::Y,
+        PadButton::LeftShoulder, PadButton::RightShoulder,
+        PadButton::LeftThumb, PadButton::RightThumb,
+        PadButton::DPadUp, PadButton::DPadDown, PadButton::DPadLeft, PadButton::DPadRight,
+        PadButton::Start, PadButton::Back,
+    };
+
+    const char* const GESTURE_NAMES[GestureDefinition::KIND_COUNT] = { "tap", "hold", "double-tap", "long press" };
+
+    std::string KeyText(uint16_t keyCode)
+    {
+        const char* name = InputNames::KeyName(keyCode);
+        if (name)
+        {
+            return name;
+        }
+        char hex[8];
+        std::snprintf(hex, sizeof(hex), "0x%02X", keyCode);
+        return hex;
+    }
+
+    std::string MouseText(uint16_t button)
+    {
+        const char* name = InputNames::MouseButtonName(button);
+        return std::string(name ? name : "?") + " Mouse Button";
+    }
+
+    std::string StepText(const MacroStep& step)
+    {
+        return (step.type == MacroOutputType::Key) ? KeyText(step.code) : MouseText(step.code);
+    }
+
+    std::string ActionText(const BindingTable& buttons, int bit)
+    {
+        const BindingAction& action = buttons.GetAction(bit);
+        std::string text;
+        switch (action.type)
+        {
+        case BindingActionType::Key:
+            return KeyText(action.codes[0]);
+
+        case BindingActionType::MouseButton:
+            return MouseText(action.codes[0]);
+
+        case BindingActionType::KeySequence:
+            for (int i = 0; i < action.count; ++i)
+            {
+                text += (i > 0 ? ", " : "") + KeyText(action.codes[i]);
+            }
+            return text;
+
+        case BindingActionType::Macro:
+        {
+            const MacroDefinition& macro = buttons.GetMacro(bit);
+            for (int i = 0; i < macro.stepCount; ++i)
+            {
+                text += (i > 0 ? ", " : "") + StepText(macro.steps[i]);
+            }
+            return text;
+        }
+
+        case BindingActionType::Gesture:
+        {
+            const GestureDefinition& gesture = buttons.GetGesture(bit);
+            for (int kind = 0; kind < GestureDefinition::KIND_COUNT; ++kind)
+            {
+                if (!gesture.Has(static_cast<GestureKind>(kind)))
+                {
+                    continue;
+                }
+                text += std::string(text.empty() ? "" : ", ") + GESTURE_NAMES[kind] + " " + StepText(gesture.actions[kind]);
+                if (kind != static_cast<int>(GestureKind::Hold) && gesture.repeats[kind] > 1)
+                {
+                    text += " x" + std::to_string(gesture.repeats[kind]);
+                }
+            }
+            return text;
+        }
+
+        case BindingActionType::None:
+        default:
+            return text;
+        }
+    }
+
+    void PrintLine(std::ostream& out, const std::string& input, const std::string& output, const char* label)
+    {
+        out << "  " << input << " -> " << output;
+        if (label[0] != '\0')
+        {
+            out << " (" << label << ")";
+        }
+        out << std::endl;
+    }
+}
+
+Profile Profile::CreateEmpty()
+{
+    Profile profile;
+    std::memset(static_cast<void*>(&profile), 0, sizeof(profile));
+    profile.buttons.Clear();
+    for (BindingLayer& layer : profile.layers)
+    {
+        layer.buttons.Clear();
+    }
+    profile.leftStick = StickSettings::Default();
+    profile.rightStick = StickSettings::Default();
+    profile.stickThresholds = ThresholdSettings::DefaultStick();
+    profile.triggerThresholds = ThresholdSettings::DefaultTrigger();
+    return profile;
+}
+
+Profile Profile::CreateWitcher()
+{
+    return StaticProfile<WitcherProfile>::Build();
+}
+
+namespace
+{
+    template <size_t Size>
+    bool IsTerminated(const char (&text)[Size])
+    {
+        return std::memchr(text, '\0', Size) != nullptr;
+    }
+
+    template <size_t Count, size_t Size>
+    bool AreTerminated(const char (&texts)[Count][Size])
+    {
+        for (const char (&text)[Size] : texts)
+        {
+            if (!IsTerminated(text))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+bool Profile::IsValid() const
+{
+    if (layerCount > MAX_LAYERS || comboCount > MAX_COMBOS)
+    {
+        return false;
+    }
+    if (!IsTerminated(name) || !AreTerminated(buttonLabels) || !AreTerminated(analogLabels) ||
+        !AreTerminated(comboLabels) || !buttons.IsValid())
+    {
+        return false;
+    }
+
+    for (uint32_t i = 0; i < layerCount; ++i)
+    {
+        const BindingLayer& layer = layers[i];
+        if (!IsTerminated(layer.name) || !AreTerminated(layerLabels[i]) ||
+            layer.activator >= PadButton::COUNT || !layer.buttons.IsValid())
+        {
+            return false;
+        }
+    }
+
+    for (uint32_t i = 0; i < comboCount; ++i)
+    {
+        const ComboDefinition& combo = combos[i];
+        if (combo.pressCount == 0 || combo.pressCount > ComboDefinition::MAX_PRESSES ||
+            combo.action.stepCount == 0 || combo.action.stepCount > MacroDefinition::MAX_STEPS)
+        {
+            return false;
+        }
+        for (int press = 0; press < combo.pressCount; ++press)
+        {
+            if (combo.buttons[press] >= PadButton::COUNT)
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void Profile::SetLabel(char (&label)[LABEL_SIZE], const char* text)
+{
+    std::memset(label, 0, sizeof(label));
+    std::strncpy(label, text, LABEL_SIZE - 1);
+}
+
+void Profile::PrintBanner(std::ostream& out) const
+{
+    // Left stick keys in forward/back/left/right order, camera on the right stick
+    std::string move;
+    for (int key = static_cast<int>(AnalogKey::MoveForward); key <= static_cast<int>(AnalogKey::MoveRight); ++key)
+    {
+        if (analogKeys[key] != 0)
+        {
+            move += (move.empty() ? "" : "/") + KeyText(analogKeys[key]);
+        }
+    }
+    if (!move.empty())
+    {
+        PrintLine(out, "Left Stick", move, analogLabels[static_cast<int>(AnalogKey::MoveForward)]);
+    }
+    PrintLine(out, "Right Stick", "Mouse", "Camera");
+
+    for (uint16_t button : BANNER_ORDER)
+    {
+        int bit = BindingTable::ButtonToBitIndex(button);
+        if (buttons.GetBoundMask() & button)
+        {
+            PrintLine(out, InputNames::ButtonDisplayName(bit), ActionText(buttons, bit), buttonLabels[bit]);
+        }
+
+        // Triggers read best right after the shoulders
+        if (button == PadButton::RightShoulder)
+        {
+            const char* const triggerNames[] = { "LT", "RT", "LT + RT" };
+            for (int i = 0; i < 3; ++i)
+            {
+                int key = static_cast<int>(AnalogKey::LeftTrigger) + i;
+                if (analogKeys[key] != 0)
+                {
+                    PrintLine(out, triggerNames[i], KeyText(analogKeys[key]), analogLabels[key]);
+                }
+            }
+        }
+    }
+
+    // Layers after the base buttons they replace; a button a layer silences maps to nothing
+    for (uint32_t i = 0; i < layerCount; ++i)
+    {
+        const BindingLayer& layer = layers[i];
+        out << "  Layer " << layer.name << " (" << (layer.mode == LayerMode::Hold ? "hold " : "toggle ")
+            << InputNames::ButtonDisplayName(layer.activator) << "):" << std::endl;
+        for (uint16_t button : BANNER_ORDER)
+        {
+            int bit = BindingTable::ButtonToBitIndex(button);
+            if (layer.overrideMask & button)
+            {
+                std::string output = (layer.buttons.GetBoundMask() & button) ? ActionText(layer.buttons, bit) : "Nothing";
+                PrintLine(out, std::string("  ") + InputNames::ButtonDisplayName(bit), output, layerLabels[i][bit]);
+            }
+        }
+    }
+
+    // Combos after the buttons they are made of
+    for (uint32_t i = 0; i < comboCount; ++i)
+    {
+        const ComboDefinition& combo = combos[i];
+        std::string presses;
+        for (int press = 0; press < combo.pressCount; ++press)
+        {
+            presses += std::string(press > 0 ? ", " : "") + InputNames::ButtonDisplayName(combo.buttons[press]);
+        }
+        std::string steps;
+        for (int step = 0; step < combo.action.stepCount; ++step)
+        {
+            steps += (step > 0 ? ", " : "") + StepText(combo.action.steps[step]);
+        }
+        PrintLine(out, presses, steps, comboLabels[i]);
+    }
+}
@@ -0,0 +1,114 @@
+#pragma once
+
+#include "BindingTable.h"
+#include "StickProcessor.h"
+#include "ThresholdSwitch.h"
+#include <cstdint>
+#include <iosfwd>
+#include <type_traits>
+
+/**
+ * Keys produced by the sticks and triggers
+ */
+enum class AnalogKey : uint8_t
+{
+    MoveForward,    // Left stick up
+    MoveBack,       // Left stick down
+    MoveLeft,       // Left stick left
+    MoveRight,      // Left stick right
+    LeftTrigger,    // LT alone
+    RightTrigger,   // RT alone
+    BothTriggers,   // LT + RT chord; replaces the single-trigger keys while both are pulled
+    Count
+};
+
+/**
+ * How a layer's activator button turns it on
+ */
+enum class LayerMode : uint8_t
+{
+    Hold,       // On while the activator is held
+    Toggle      // Each press of the activator turns it on or off
+};
+
+/**
+ * BindingLayer - Button bindings laid over the base table while the layer is on
+ *
+ * Only the buttons in overrideMask replace their base binding (bound here,
+ * or bound to nothing to silence them); the others fall through. The
+ * activator itself is bound in no table.
+ */
+struct BindingLayer
+{
+    static const int NAME_SIZE = 24;
+
+    char name[NAME_SIZE];       // Shown in the banner
+    uint8_t activator;          // Button bit index
+    LayerMode mode;
+    uint16_t overrideMask;      // Buttons this layer rebinds
+    BindingTable buttons;
+};
+
+/**
+ * Profile - Everything a mapping profile sets, as one flat block
+ *
+ * Button bindings, binding layers, button combos, stick shaping, analog thresholds and the
+ * stick/trigger keys, plus the labels the startup banner shows. Plain data without
+ * pointers, so a compiled profile image can be memory-mapped and used in
+ * place (see ProfileCache); the text form is read by ProfileCompiler.
+ */
+struct Profile
+{
+    static const int NAME_SIZE = 48;
+    static const int LABEL_SIZE = 40;
+    static const int MAX_LAYERS = 4;
+    static const int MAX_COMBOS = 16;
+    static const int ANALOG_KEY_COUNT = static_cast<int>(AnalogKey::Count);
+
+    char name[NAME_SIZE];                               // Shown in the banner
+    BindingTable buttons;
+    StickSettings leftStick;
+    StickSettings rightStick;                           // Camera (always the mouse)
+    ThresholdSettings stickThresholds;                  // Movement keys, shaped stick units
+    ThresholdSettings triggerThresholds;                // Trigger keys, raw trigger units
+    uint16_t analogKeys[ANALOG_KEY_COUNT];              // Key code per AnalogKey, 0 = unbound
+    char buttonLabels[PadButton::COUNT][LABEL_SIZE];    // Optional banner text per button bit
+    char analogLabels[ANALOG_KEY_COUNT][LABEL_SIZE];    // Optional banner text per AnalogKey
+    uint32_t layerCount;
+    BindingLayer layers[MAX_LAYERS];                    // Stacked on the base buttons; later layers win
+    char layerLabels[MAX_LAYERS][PadButton::COUNT][LABEL_SIZE];
+    uint32_t comboCount;
+    ComboDefinition combos[MAX_COMBOS];                 // Matched on top of the button bindings
+    char comboLabels[MAX_COMBOS][LABEL_SIZE];           // Optional banner text per combo
+
+    uint16_t GetAnalogKey(AnalogKey key) const { return analogKeys[static_cast<int>(key)]; }
+
+    /**
+     * No bindings and no labels; default stick shaping and thresholds
+     */
+    static Profile CreateEmpty();
+
+    /**
+     * Built-in The Witcher 1 profile (the same bindings as profiles/witcher.ini)
+     */
+    static Profile CreateWitcher();
+
+    /**
+     * Copy a label, truncated to LABEL_SIZE - 1 bytes
+     */
+    static void SetLabel(char (&label)[LABEL_SIZE], const char* text);
+
+    /**
+     * Print the controller mappings, one line per bound input
+     */
+    void PrintBanner(std::ostream& out) const;
+
+    /**
+     * Check the counts and strings a profile image could have wrong: layer and combo
+     * counts, binding and macro sizes, and NUL-terminated names and labels
+     * @return false if using the profile would read past one of its fixed arrays
+     */
+    bool IsValid() const;
+};
+
+static_assert(std::is_trivially_copyable<Profile>::value, "Profile is mapped from disk and must stay plain data");
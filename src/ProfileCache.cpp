@@ -0,0 +1,252 @@
+#include "ProfileCache.h"
+#include "ProfileCompiler.h"
+#include <cstdio>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+ProfileCache::ProfileCache()
+    : m_data(nullptr)
+    , m_size(0)
+    , m_profile(nullptr)
+    , m_sourceHash(0)
+    , m_compiled(false)
+    , m_compiledProfile(Profile::CreateEmpty())
+#ifdef _WIN32
+    , m_file(INVALID_HANDLE_VALUE)
+    , m_mapping(nullptr)
+#else
+    , m_fd(-1)
+#endif
+{
+}
+
+ProfileCache::~ProfileCache()
+{
+    Close();
+}
+
+bool ProfileCache::ReadSource(const char* sourcePath, std::string& text)
+{
+    std::FILE* file = std::fopen(sourcePath, "rb");
+    if (!file)
+    {
+        return false;
+    }
+
+    text.clear();
+    char buffer[4096];
+    size_t count;
+    while ((count = std::fread(buffer, 1, sizeof(buffer), file)) > 0)
+    {
+        text.append(buffer, count);
+    }
+    bool ok = std::ferror(file) == 0;
+    std::fclose(file);
+    return ok;
+}
+
+std::string ProfileCache::GetImagePath(const char* sourcePath)
+{
+    return std::string(sourcePath) + ".bin";
+}
+
+bool ProfileCache::Load(const char* sourcePath, const char* imagePath)
+{
+    Close();
+    m_error.clear();
+    m_compiled = false;
+
+    std::string text;
+    if (!ReadSource(sourcePath, text))
+    {
+        m_error = std::string("cannot read ") + sourcePath;
+        return false;
+    }
+
+    // Unchanged text: the image is the profile
+    uint64_t sourceHash = ProfileImage::Hash(text.data(), text.size());
+    if (Open(imagePath) && m_sourceHash == sourceHash)
+    {
+        return true;
+    }
+    Close();
+
+    ProfileCompiler compiler;
+    if (!compiler.Compile(text.data(), text.size(), m_compiledProfile))
+    {
+        m_error = std::string(sourcePath) + ": " + compiler.GetError();
+        return false;
+    }
+    m_compiled = true;
+
+    if (WriteImage(imagePath, m_compiledProfile, sourceHash) && Open(imagePath))
+    {
+        return true;
+    }
+
+    Close();
+    m_error = std::string("cannot write ") + imagePath;
+    m_profile = &m_compiledProfile;
+    m_sourceHash = sourceHash;
+    return true;
+}
+
+bool ProfileCache::Open(const char* imagePath)
+{
+    Close();
+
+    if (!Map(imagePath) || m_size < sizeof(ProfileImage::Header) + sizeof(Profile))
+    {
+        Close();
+        return false;
+    }
+
+    const ProfileImage::Header& header = *reinterpret_cast<const ProfileImage::Header*>(m_data);
+    const unsigned char* payload = m_data + sizeof(ProfileImage::Header);
+    if (!ProfileImage::IsValidHeader(header) || ProfileImage::Hash(payload, sizeof(Profile)) != header.checksum)
+    {
+        Close();
+        return false;
+    }
+
+    // A well-formed image can still hold counts or labels that would send the
+    // mapper or the banner past a fixed array; treat it as stale and recompile
+    if (!reinterpret_cast<const Profile*>(payload)->IsValid())
+    {
+        Close();
+        return false;
+    }
+
+    m_profile = reinterpret_cast<const Profile*>(payload);
+    m_sourceHash = header.sourceHash;
+    return true;
+}
+
+bool ProfileCache::WriteImage(const char* imagePath, const Profile& profile, uint64_t sourceHash)
+{
+    std::string temporaryPath = std::string(imagePath) + ".tmp";
+    std::FILE* file = std::fopen(temporaryPath.c_str(), "wb");
+    if (!file)
+    {
+        return false;
+    }
+
+    ProfileImage::Header header = ProfileImage::MakeHeader(profile, sourceHash);
+    bool written = std::fwrite(&header, sizeof(header), 1, file) == 1 &&
+                   std::fwrite(&profile, sizeof(profile), 1, file) == 1;
+    written = (std::fclose(file) == 0) && written;
+
+    if (!written || !ReplaceImage(temporaryPath.c_str(), imagePath))
+    {
+        std::remove(temporaryPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+#ifdef _WIN32
+
+bool ProfileCache::Map(const char* path)
+{
+    m_file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (m_file == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(m_file, &size) || size.QuadPart < static_cast<LONGLONG>(sizeof(ProfileImage::Header)))
+    {
+        return false;
+    }
+    m_size = static_cast<size_t>(size.QuadPart);
+
+    m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!m_mapping)
+    {
+        return false;
+    }
+
+    m_data = static_cast<const unsigned char*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+    return m_data != nullptr;
+}
+
+bool ProfileCache::ReplaceImage(const char* from, const char* to)
+{
+    return MoveFileExA(from, to, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+}
+
+#else
+
+bool ProfileCache::Map(const char* path)
+{
+    m_fd = open(path, O_RDONLY);
+    if (m_fd < 0)
+    {
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(m_fd, &info) != 0 || info.st_size < static_cast<off_t>(sizeof(ProfileImage::Header)))
+    {
+        return false;
+    }
+    m_size = static_cast<size_t>(info.st_size);
+
+    void* data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, m_fd, 0);
+    if (data == MAP_FAILED)
+    {
+        return false;
+    }
+    m_data = static_cast<const unsigned char*>(data);
+    return true;
+}
+
+bool ProfileCache::ReplaceImage(const char* from, const char* to)
+{
+    // Atomic on POSIX; a mapping of the old image stays valid
+    return std::rename(from, to) == 0;
+}
+
+#endif
+
+void ProfileCache::Close()
+{
+#ifdef _WIN32
+    if (m_data)
+    {
+        UnmapViewOfFile(m_data);
+    }
+    if (m_mapping)
+    {
+        CloseHandle(m_mapping);
+        m_mapping = nullptr;
+    }
+    if (m_file != INVALID_HANDLE_VALUE)
+    {
+        CloseHandle(m_file);
+        m_file = INVALID_HANDLE_VALUE;
+    }
+#else
+    if (m_data)
+    {
+        munmap(const_cast<unsigned char*>(m_data), m_size);
+    }
+    if (m_fd >= 0)
+    {
+        close(m_fd);
+        m_fd = -1;
+    }
+#endif
+
+    m_data = nullptr;
+    m_size = 0;
+    m_profile = nullptr;
+}
@@ -0,0 +1,119 @@
+#pragma once
+
+#include "Profile.h"
+#include "ProfileImage.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * ProfileCache - Loads a text profile through its compiled, memory-mapped image
+ *
+ * Load() hashes the profile text and maps the image next to it. If the image
+ * was compiled from the same text, its Profile is used in place: no parsing,
+ * no copy, no allocation per binding. Otherwise the text is compiled once and
+ * the image rewritten (temporary file, then rename, so a crash never leaves a
+ * half-written image behind). If the image cannot be written the compiled
+ * profile is still used, from memory.
+ *
+ * Uses CreateFileMapping on Windows and mmap elsewhere, like TraceReader.
+ */
+class ProfileCache
+{
+public:
+    ProfileCache();
+    ~ProfileCache();
+
+    ProfileCache(const ProfileCache&) = delete;
+    ProfileCache& operator=(const ProfileCache&) = delete;
+
+    /**
+     * Load a text profile, recompiling its image only if the text changed
+     * @param sourcePath Profile text (.ini)
+     * @param imagePath Compiled image, created or replaced as needed
+     * @return false if the text cannot be read or does not compile (see GetError())
+     */
+    bool Load(const char* sourcePath, const char* imagePath);
+
+    /**
+     * Map a compiled image and validate its header, checksum and profile (Profile::IsValid())
+     * @param imagePath Compiled image
+     * @return false if the file cannot be mapped or is not a valid image for this build
+     */
+    bool Open(const char* imagePath);
+
+    /**
+     * Unmap the image (the profile reference becomes invalid)
+     */
+    void Close();
+
+    bool IsOpen() const { return m_profile != nullptr; }
+
+    /**
+     * Get the loaded profile (valid while open; must outlive every Mapper using it)
+     */
+    const Profile& GetProfile() const { return *m_profile; }
+
+    /**
+     * Get the hash of the text the profile was compiled from
+     */
+    uint64_t GetSourceHash() const { return m_sourceHash; }
+
+    /**
+     * Check if the last Load() had to compile the text
+     */
+    bool WasCompiled() const { return m_compiled; }
+
+    /**
+     * Check if the profile is used from the mapped image (false: compiled into memory only)
+     */
+    bool IsMapped() const { return m_data != nullptr; }
+
+    /**
+     * Get what went wrong in the last Load(), or why the image was not written
+     */
+    const std::string& GetError() const { return m_error; }
+
+    /**
+     * Read a whole profile text
+     * @return false if the file cannot be read
+     */
+    static bool ReadSource(const char* sourcePath, std::string& text);
+
+    /**
+     * Default image path for a profile: the text path with ".bin" appended
+     */
+    static std::string GetImagePath(const char* sourcePath);
+
+    /**
+     * Write a compiled image (temporary file, then rename over imagePath)
+     * @return false if the file cannot be written
+     */
+    static bool WriteImage(const char* imagePath, const Profile& profile, uint64_t sourceHash);
+
+private:
+    /**
+     * Open and map the whole file (platform specific)
+     */
+    bool Map(const char* path);
+
+    /**
+     * Replace a file with another (platform specific)
+     */
+    static bool ReplaceImage(const char* from, const char* to);
+
+    const unsigned char* m_data;
+    size_t m_size;
+    const Profile* m_profile;
+    uint64_t m_sourceHash;
+    bool m_compiled;
+    std::string m_error;
+    Profile m_compiledProfile;  // Used when the image cannot be written
+
+#ifdef _WIN32
+    void* m_file;       // HANDLE
+    void* m_mapping;    // HANDLE
+#else
+    int m_fd;
+#endif
+};
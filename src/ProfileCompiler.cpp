@@ -0,0 +1,993 @@
+#include "ProfileCompiler.h"
+#include "InputNames.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace
+{
+    const long MAX_STICK_VALUE = 32767;
+    const long MAX_TRIGGER_VALUE = 255;
+    const long MAX_DURATION_MS = 60000;
+    const float MAX_EXPONENT = 16.0f;
+
+    bool IsSpace(char c)
+    {
+        return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+    }
+
+    char ToLower(char c)
+    {
+        return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+    }
+
+    /**
+     * Compare a token with a keyword, ignoring case
+     */
+    bool Equals(const char* text, size_t length, const char* keyword)
+    {
+        size_t i = 0;
+        for (; i < length; ++i)
+        {
+            if (keyword[i] == '\0' || ToLower(text[i]) != ToLower(keyword[i]))
+            {
+                return false;
+            }
+        }
+        return keyword[i] == '\0';
+    }
+
+    void Trim(const char*& text, size_t& length)
+    {
+        while (length > 0 && IsSpace(text[0]))
+        {
+            ++text;
+            --length;
+        }
+        while (length > 0 && IsSpace(text[length - 1]))
+        {
+            --length;
+        }
+    }
+}
+
+ProfileCompiler::ProfileCompiler()
+    : m_errorLine(0)
+    , m_line(0)
+    , m_section(Section::None)
+    , m_boundButtons(0)
+    , m_activators(0)
+    , m_layerActivated(false)
+    , m_label()
+    , m_labelUsed(false)
+{
+}
+
+bool ProfileCompiler::Compile(const char* text, size_t length, Profile& profile)
+{
+    profile = Profile::CreateEmpty();
+    m_error.clear();
+    m_errorLine = 0;
+    m_line = 0;
+    m_section = Section::None;
+    m_boundButtons = 0;
+    m_activators = 0;
+    m_layerActivated = false;
+
+    size_t position = 0;
+    while (position < length)
+    {
+        const char* line = text + position;
+        const void* newline = std::memchr(line, '\n', length - position);
+        size_t lineLength = newline ? static_cast<size_t>(static_cast<const char*>(newline) - line) : length - position;
+        position += lineLength + 1;
+
+        ++m_line;
+        if (!ParseLine(line, lineLength, profile))
+        {
+            return false;
+        }
+    }
+    return EndLayer(profile);
+}
+
+bool ProfileCompiler::ParseLine(const char* line, size_t length, Profile& profile)
+{
+    // A comment starts at ';' or '#' at the line start or after a space, outside quotes
+    bool quoted = false;
+    for (size_t i = 0; i < length; ++i)
+    {
+        if (line[i] == '"')
+        {
+            quoted = !quoted;
+        }
+        else if (!quoted && (line[i] == ';' || line[i] == '#') && (i == 0 || IsSpace(line[i - 1])))
+        {
+            length = i;
+            break;
+        }
+    }
+
+    Trim(line, length);
+    if (length == 0)
+    {
+        return true;
+    }
+
+    if (line[0] == '[')
+    {
+        if (line[length - 1] != ']')
+        {
+            return Fail("expected ']' after the section name");
+        }
+        const char* name = line + 1;
+        size_t nameLength = length - 2;
+        Trim(name, nameLength);
+        if (!EndLayer(profile))
+        {
+            return false;
+        }
+        if (nameLength > 5 && Equals(name, 5, "layer") && IsSpace(name[5]))
+        {
+            return BeginLayer(name + 5, nameLength - 5, profile);
+        }
+        if (Equals(name, nameLength, "profile"))
+        {
+            m_section = Section::Profile;
+        }
+        else if (Equals(name, nameLength, "buttons"))
+        {
+            m_section = Section::Buttons;
+        }
+        else if (Equals(name, nameLength, "sticks"))
+        {
+            m_section = Section::Sticks;
+        }
+        else if (Equals(name, nameLength, "triggers"))
+        {
+            m_section = Section::Triggers;
+        }
+        else if (Equals(name, nameLength, "combos"))
+        {
+            m_section = Section::Combos;
+        }
+        else
+        {
+            return Fail("unknown section [" + std::string(name, nameLength) + "]");
+        }
+        return true;
+    }
+
+    const char* equals = static_cast<const char*>(std::memchr(line, '=', length));
+    if (!equals)
+    {
+        return Fail("expected <name> = <value>");
+    }
+
+    Token key = { line, static_cast<size_t>(equals - line) };
+    Trim(key.text, key.length);
+    const char* value = equals + 1;
+    size_t valueLength = length - static_cast<size_t>(value - line);
+    Trim(value, valueLength);
+    if (key.length == 0)
+    {
+        return Fail("missing name before '='");
+    }
+
+    if (m_section == Section::None)
+    {
+        return Fail("setting '" + key.ToString() + "' outside a section");
+    }
+
+    if (m_section == Section::Profile)
+    {
+        if (!Equals(key.text, key.length, "name"))
+        {
+            return Fail("unknown setting '" + key.ToString() + "' in [profile]");
+        }
+        if (valueLength >= sizeof(profile.name))
+        {
+            return Fail("profile name longer than " + std::to_string(sizeof(profile.name) - 1) + " bytes");
+        }
+        std::memset(profile.name, 0, sizeof(profile.name));
+        std::memcpy(profile.name, value, valueLength);
+        return true;
+    }
+
+    // Optional trailing "label"
+    m_label = Token();
+    m_labelUsed = false;
+    const char* quote = static_cast<const char*>(std::memchr(value, '"', valueLength));
+    if (quote)
+    {
+        size_t quoteOffset = static_cast<size_t>(quote - value);
+        if (value[valueLength - 1] != '"' || quoteOffset == valueLength - 1)
+        {
+            return Fail("a label must be a single \"quoted\" text at the end of the line");
+        }
+        m_label.text = quote + 1;
+        m_label.length = valueLength - quoteOffset - 2;
+        if (std::memchr(m_label.text, '"', m_label.length))
+        {
+            return Fail("a label must be a single \"quoted\" text at the end of the line");
+        }
+        valueLength = quoteOffset;
+        Trim(value, valueLength);
+    }
+
+    Token tokens[MAX_TOKENS];
+    int count = 0;
+    size_t i = 0;
+    while (i < valueLength)
+    {
+        if (IsSpace(value[i]))
+        {
+            ++i;
+            continue;
+        }
+        if (count == MAX_TOKENS)
+        {
+            return Fail("too many values for '" + key.ToString() + "'");
+        }
+        size_t start = i;
+        while (i < valueLength && !IsSpace(value[i]))
+        {
+            ++i;
+        }
+        tokens[count].text = value + start;
+        tokens[count].length = i - start;
+        ++count;
+    }
+
+    bool parsed = false;
+    switch (m_section)
+    {
+    case Section::Buttons:
+        parsed = ParseButton(key, tokens, count, profile.buttons, profile.buttonLabels, m_boundButtons);
+        break;
+    case Section::Layer:
+        parsed = ParseLayer(key, tokens, count, profile);
+        break;
+    case Section::Sticks:
+        parsed = ParseStick(key, tokens, count, profile);
+        break;
+    case Section::Triggers:
+        parsed = ParseTrigger(key, tokens, count, profile);
+        break;
+    case Section::Combos:
+        parsed = ParseCombo(key, tokens, count, profile);
+        break;
+    default:
+        break;
+    }
+    if (!parsed)
+    {
+        return false;
+    }
+
+    if (m_label.length > 0 && !m_labelUsed)
+    {
+        return Fail("'" + key.ToString() + "' takes no label");
+    }
+    return true;
+}
+
+bool ProfileCompiler::ParseButton(const Token& name, const Token* tokens, int count, BindingTable& buttons,
+                                  char (&labels)[PadButton::COUNT][Profile::LABEL_SIZE], uint16_t& boundButtons)
+{
+    int bit = InputNames::ParseButton(name.text, name.length);
+    if (bit < 0)
+    {
+        return Fail("unknown button '" + name.ToString() + "'");
+    }
+
+    uint16_t button = static_cast<uint16_t>(1u << bit);
+    if (boundButtons & button)
+    {
+        return Fail("button " + name.ToString() + " is bound twice");
+    }
+    if (m_activators & button)
+    {
+        return Fail("button " + name.ToString() + " activates a layer and cannot be bound");
+    }
+    boundButtons |= button;
+
+    if (count == 0)
+    {
+        return Fail("missing binding for " + name.ToString());
+    }
+
+    const Token& type = tokens[0];
+    if (Equals(type.text, type.length, "key"))
+    {
+        uint16_t keyCode;
+        if (count != 2)
+        {
+            return Fail("'key' takes one key");
+        }
+        if (!ParseKey(tokens[1], false, keyCode))
+        {
+            return false;
+        }
+        buttons.BindKey(button, keyCode);
+    }
+    else if (Equals(type.text, type.length, "mouse"))
+    {
+        uint16_t mouseButton;
+        if (count != 2)
+        {
+            return Fail("'mouse' takes one mouse button");
+        }
+        if (!InputNames::ParseMouseButton(tokens[1].text, tokens[1].length, mouseButton))
+        {
+            return Fail("unknown mouse button '" + tokens[1].ToString() + "' (Left, Right, Middle)");
+        }
+        buttons.BindMouseButton(button, mouseButton);
+    }
+    else if (Equals(type.text, type.length, "sequence"))
+    {
+        uint16_t keyCodes[BindingAction::MAX_SEQUENCE_KEYS];
+        if (count < 2 || count > 1 + BindingAction::MAX_SEQUENCE_KEYS)
+        {
+            return Fail("'sequence' takes 1 to " + std::to_string(BindingAction::MAX_SEQUENCE_KEYS) + " keys");
+        }
+        for (int i = 1; i < count; ++i)
+        {
+            if (!ParseKey(tokens[i], false, keyCodes[i - 1]))
+            {
+                return false;
+            }
+        }
+        buttons.BindKeySequence(button, keyCodes, static_cast<size_t>(count - 1));
+    }
+    else if (Equals(type.text, type.length, "macro"))
+    {
+        MacroDefinition macro;
+        if (!ParseMacro(tokens + 1, count - 1, macro))
+        {
+            return false;
+        }
+        buttons.BindMacro(button, macro);
+    }
+    else if (Equals(type.text, type.length, "gesture"))
+    {
+        GestureDefinition gesture = GestureDefinition::Create(0, 0, 0);
+        if (!ParseGesture(tokens + 1, count - 1, gesture))
+        {
+            return false;
+        }
+        buttons.BindGesture(button, gesture);
+    }
+    else if (Equals(type.text, type.length, "none"))
+    {
+        if (count != 1)
+        {
+            return Fail("'none' takes no values");
+        }
+    }
+    else
+    {
+        return Fail("unknown binding '" + type.ToString() + "' (key, mouse, sequence, macro, gesture, none)");
+    }
+
+    return SetLabel(labels[bit]);
+}
+
+bool ProfileCompiler::BeginLayer(const char* name, size_t length, Profile& profile)
+{
+    Trim(name, length);
+    if (length >= BindingLayer::NAME_SIZE)
+    {
+        return Fail("layer name longer than " + std::to_string(BindingLayer::NAME_SIZE - 1) + " bytes");
+    }
+    for (uint32_t i = 0; i < profile.layerCount; ++i)
+    {
+        if (Equals(name, length, profile.layers[i].name))
+        {
+            return Fail("layer " + std::string(name, length) + " is defined twice");
+        }
+    }
+    if (profile.layerCount == Profile::MAX_LAYERS)
+    {
+        return Fail("more than " + std::to_string(Profile::MAX_LAYERS) + " layers");
+    }
+
+    BindingLayer& layer = profile.layers[profile.layerCount++];
+    std::memset(layer.name, 0, sizeof(layer.name));
+    std::memcpy(layer.name, name, length);
+    m_section = Section::Layer;
+    m_layerActivated = false;
+    return true;
+}
+
+bool ProfileCompiler::EndLayer(const Profile& profile)
+{
+    if (m_section == Section::Layer && !m_layerActivated)
+    {
+        return Fail("layer " + std::string(profile.layers[profile.layerCount - 1].name) + " has no 'activate' setting");
+    }
+    return true;
+}
+
+bool ProfileCompiler::ParseLayer(const Token& key, const Token* tokens, int count, Profile& profile)
+{
+    uint32_t index = profile.layerCount - 1;
+    BindingLayer& layer = profile.layers[index];
+    if (!Equals(key.text, key.length, "activate"))
+    {
+        return ParseButton(key, tokens, count, layer.buttons, profile.layerLabels[index], layer.overrideMask);
+    }
+
+    if (m_layerActivated)
+    {
+        return Fail("layer " + std::string(layer.name) + " is activated twice");
+    }
+    if (count != 2)
+    {
+        return Fail("'activate' takes a button, then hold or toggle");
+    }
+    int bit = InputNames::ParseButton(tokens[0].text, tokens[0].length);
+    if (bit < 0)
+    {
+        return Fail("unknown button '" + tokens[0].ToString() + "'");
+    }
+
+    // The activator is consumed: bound in no table, and activating one layer only
+    uint16_t button = static_cast<uint16_t>(1u << bit);
+    uint16_t bound = m_boundButtons;
+    for (uint32_t i = 0; i < profile.layerCount; ++i)
+    {
+        bound |= profile.layers[i].overrideMask;
+    }
+    if (m_activators & button)
+    {
+        return Fail("button " + tokens[0].ToString() + " already activates a layer");
+    }
+    if (bound & button)
+    {
+        return Fail("button " + tokens[0].ToString() + " is bound and cannot activate a layer");
+    }
+
+    if (Equals(tokens[1].text, tokens[1].length, "hold"))
+    {
+        layer.mode = LayerMode::Hold;
+    }
+    else if (Equals(tokens[1].text, tokens[1].length, "toggle"))
+    {
+        layer.mode = LayerMode::Toggle;
+    }
+    else
+    {
+        return Fail("unknown layer mode '" + tokens[1].ToString() + "' (hold, toggle)");
+    }
+    layer.activator = static_cast<uint8_t>(bit);
+    m_activators |= button;
+    m_layerActivated = true;
+    return true;
+}
+
+bool ProfileCompiler::ParseMacro(const Token* tokens, int count, MacroDefinition& macro)
+{
+    std::memset(&macro, 0, sizeof(macro));
+    if (count > 0 && Equals(tokens[0].text, tokens[0].length, "cancel"))
+    {
+        macro.cancelOnRelease = true;
+        ++tokens;
+        --count;
+    }
+
+    if (count < 1 || count > MacroDefinition::MAX_STEPS)
+    {
+        return Fail("'macro' takes 1 to " + std::to_string(MacroDefinition::MAX_STEPS) + " steps");
+    }
+    for (int i = 0; i < count; ++i)
+    {
+        uint8_t repeat;
+        if (!ParseStep(tokens[i], false, macro.steps[i], repeat))
+        {
+            return false;
+        }
+    }
+    macro.stepCount = static_cast<uint8_t>(count);
+    return true;
+}
+
+bool ProfileCompiler::ParseGesture(const Token* tokens, int count, GestureDefinition& gesture)
+{
+    static const char* const KIND_KEYS[GestureDefinition::KIND_COUNT] = { "tap", "hold", "doubletap", "longpress" };
+
+    for (int i = 0; i < count; ++i)
+    {
+        const char* equals = static_cast<const char*>(std::memchr(tokens[i].text, '=', tokens[i].length));
+        if (!equals)
+        {
+            return Fail("expected <setting>=<value> in gesture, got '" + tokens[i].ToString() + "'");
+        }
+        Token name = { tokens[i].text, static_cast<size_t>(equals - tokens[i].text) };
+        Token value = { equals + 1, tokens[i].length - name.length - 1 };
+
+        long ms;
+        if (Equals(name.text, name.length, "holdms"))
+        {
+            if (!ParseNumber(value, 1, MAX_DURATION_MS, ms))
+            {
+                return false;
+            }
+            gesture.holdMs = static_cast<uint16_t>(ms);
+            continue;
+        }
+        if (Equals(name.text, name.length, "doubletapms"))
+        {
+            if (!ParseNumber(value, 1, MAX_DURATION_MS, ms))
+            {
+                return false;
+            }
+            gesture.doubleTapMs = static_cast<uint16_t>(ms);
+            continue;
+        }
+        if (Equals(name.text, name.length, "longpressms"))
+        {
+            if (!ParseNumber(value, 1, MAX_DURATION_MS, ms))
+            {
+                return false;
+            }
+            gesture.longPressMs = static_cast<uint16_t>(ms);
+            continue;
+        }
+
+        int kind = 0;
+        while (kind < GestureDefinition::KIND_COUNT && !Equals(name.text, name.length, KIND_KEYS[kind]))
+        {
+            ++kind;
+        }
+        if (kind == GestureDefinition::KIND_COUNT)
+        {
+            return Fail("unknown gesture setting '" + name.ToString() +
+                        "' (tap, hold, doubletap, longpress, holdms, doubletapms, longpressms)");
+        }
+        if (gesture.Has(static_cast<GestureKind>(kind)))
+        {
+            return Fail(std::string("gesture '") + KIND_KEYS[kind] + "' is bound twice");
+        }
+
+        MacroStep step;
+        uint8_t repeat;
+        bool isHold = (kind == static_cast<int>(GestureKind::Hold));
+        if (!ParseStep(value, !isHold, step, repeat))
+        {
+            return false;
+        }
+        gesture.Set(static_cast<GestureKind>(kind), step, repeat);
+    }
+
+    // Every bound gesture needs the window that decides it
+    if (gesture.boundMask == 0)
+    {
+        return Fail("'gesture' binds no tap, hold, doubletap or longpress");
+    }
+    if ((gesture.Has(GestureKind::Hold) || gesture.Has(GestureKind::LongPress)) && gesture.holdMs == 0)
+    {
+        return Fail("hold and longpress need holdms=<ms>");
+    }
+    if (gesture.Has(GestureKind::DoubleTap) && gesture.doubleTapMs == 0)
+    {
+        return Fail("doubletap needs doubletapms=<ms>");
+    }
+    if (gesture.Has(GestureKind::LongPress) && gesture.longPressMs <= gesture.holdMs)
+    {
+        return Fail("longpress needs longpressms=<ms> above holdms");
+    }
+    return true;
+}
+
+bool ProfileCompiler::ParseStick(const Token& key, const Token* tokens, int count, Profile& profile)
+{
+    StickSettings* stick = nullptr;
+    const char* setting = nullptr;
+    if (key.length > 5 && Equals(key.text, 5, "left."))
+    {
+        stick = &profile.leftStick;
+        setting = key.text + 5;
+    }
+    else if (key.length > 6 && Equals(key.text, 6, "right."))
+    {
+        stick = &profile.rightStick;
+        setting = key.text + 6;
+    }
+
+    if (stick)
+    {
+        size_t settingLength = key.length - static_cast<size_t>(setting - key.text);
+        if (Equals(setting, settingLength, "deadzone"))
+        {
+            long inner;
+            long outer;
+            if (count != 2)
+            {
+                return Fail("'deadzone' takes <inner> <outer>");
+            }
+            if (!ParseNumber(tokens[0], 0, MAX_STICK_VALUE - 1, inner) || !ParseNumber(tokens[1], 1, MAX_STICK_VALUE, outer))
+            {
+                return false;
+            }
+            if (outer <= inner)
+            {
+                return Fail("the outer dead zone must be above the inner one");
+            }
+            stick->innerDeadZone = static_cast<int16_t>(inner);
+            stick->outerDeadZone = static_cast<int16_t>(outer);
+            return true;
+        }
+        if (Equals(setting, settingLength, "curve"))
+        {
+            return ParseCurve(tokens, count, *stick);
+        }
+        return Fail("unknown stick setting '" + key.ToString() + "' (deadzone, curve)");
+    }
+
+    if (Equals(key.text, key.length, "threshold"))
+    {
+        return ParseThreshold(tokens, count, MAX_STICK_VALUE, profile.stickThresholds);
+    }
+
+    if (Equals(key.text, key.length, "move"))
+    {
+        if (count != 4)
+        {
+            return Fail("'move' takes four keys: forward back left right");
+        }
+        for (int i = 0; i < 4; ++i)
+        {
+            if (!ParseKey(tokens[i], true, profile.analogKeys[static_cast<int>(AnalogKey::MoveForward) + i]))
+            {
+                return false;
+            }
+        }
+        return SetLabel(profile.analogLabels[static_cast<int>(AnalogKey::MoveForward)]);
+    }
+
+    return Fail("unknown setting '" + key.ToString() + "' in [sticks]");
+}
+
+bool ProfileCompiler::ParseTrigger(const Token& key, const Token* tokens, int count, Profile& profile)
+{
+    if (Equals(key.text, key.length, "threshold"))
+    {
+        return ParseThreshold(tokens, count, MAX_TRIGGER_VALUE, profile.triggerThresholds);
+    }
+
+    AnalogKey analogKey;
+    if (Equals(key.text, key.length, "left"))
+    {
+        analogKey = AnalogKey::LeftTrigger;
+    }
+    else if (Equals(key.text, key.length, "right"))
+    {
+        analogKey = AnalogKey::RightTrigger;
+    }
+    else if (Equals(key.text, key.length, "both"))
+    {
+        analogKey = AnalogKey::BothTriggers;
+    }
+    else
+    {
+        return Fail("unknown setting '" + key.ToString() + "' in [triggers] (threshold, left, right, both)");
+    }
+
+    if (count != 1)
+    {
+        return Fail("'" + key.ToString() + "' takes one key");
+    }
+    int index = static_cast<int>(analogKey);
+    return ParseKey(tokens[0], true, profile.analogKeys[index]) && SetLabel(profile.analogLabels[index]);
+}
+
+bool ProfileCompiler::ParseCombo(const Token& key, const Token* tokens, int count, Profile& profile)
+{
+    if (!Equals(key.text, key.length, "combo"))
+    {
+        return Fail("unknown setting '" + key.ToString() + "' in [combos] (combo)");
+    }
+    if (profile.comboCount == Profile::MAX_COMBOS)
+    {
+        return Fail("more than " + std::to_string(Profile::MAX_COMBOS) + " combos");
+    }
+
+    // <button>[/<window ms>] ... macro [cancel] <step> ...
+    int pressCount = 0;
+    while (pressCount < count && !Equals(tokens[pressCount].text, tokens[pressCount].length, "macro"))
+    {
+        ++pressCount;
+    }
+    if (pressCount < 2 || pressCount > ComboDefinition::MAX_PRESSES)
+    {
+        return Fail("'combo' takes 2 to " + std::to_string(ComboDefinition::MAX_PRESSES) + " presses, then 'macro' and its steps");
+    }
+
+    ComboDefinition& combo = profile.combos[profile.comboCount];
+    std::memset(&combo, 0, sizeof(combo));
+    for (int i = 0; i < pressCount; ++i)
+    {
+        const Token& press = tokens[i];
+        const char* slash = static_cast<const char*>(std::memchr(press.text, '/', press.length));
+        size_t nameLength = slash ? static_cast<size_t>(slash - press.text) : press.length;
+        int bit = InputNames::ParseButton(press.text, nameLength);
+        if (bit < 0)
+        {
+            return Fail("unknown button '" + std::string(press.text, nameLength) + "'");
+        }
+        combo.buttons[i] = static_cast<uint8_t>(bit);
+        combo.windowMs[i] = (i > 0) ? ComboDefinition::DEFAULT_WINDOW_MS : 0;
+
+        if (slash)
+        {
+            long windowMs;
+            Token window = { slash + 1, press.length - nameLength - 1 };
+            if (i == 0)
+            {
+                return Fail("the first press of a combo takes no window");
+            }
+            if (!ParseNumber(window, 0, MAX_DURATION_MS, windowMs))
+            {
+                return false;
+            }
+            combo.windowMs[i] = static_cast<uint16_t>(windowMs);
+        }
+    }
+    combo.pressCount = static_cast<uint8_t>(pressCount);
+
+    // A macro that stopped on release would stop at once: the combo has no button of its own
+    if (pressCount + 1 < count && Equals(tokens[pressCount + 1].text, tokens[pressCount + 1].length, "cancel"))
+    {
+        return Fail("a combo macro cannot be cancelled on release");
+    }
+    if (!ParseMacro(tokens + pressCount + 1, count - pressCount - 1, combo.action))
+    {
+        return false;
+    }
+
+    return SetLabel(profile.comboLabels[profile.comboCount++]);
+}
+
+bool ProfileCompiler::ParseCurve(const Token* tokens, int count, StickSettings& stick)
+{
+    if (count == 0)
+    {
+        return Fail("missing curve (linear, power <exp>, scurve <exp>, custom <x>:<y> ...)");
+    }
+
+    const Token& type = tokens[0];
+    if (Equals(type.text, type.length, "linear"))
+    {
+        if (count != 1)
+        {
+            return Fail("'linear' takes no values");
+        }
+        stick.curve = ResponseCurve::Linear;
+        stick.exponent = 1.0f;
+        stick.pointCount = 0;
+        return true;
+    }
+
+    if (Equals(type.text, type.length, "power") || Equals(type.text, type.length, "scurve"))
+    {
+        float exponent;
+        if (count != 2)
+        {
+            return Fail("'" + type.ToString() + "' takes an exponent");
+        }
+        if (!ParseFloat(tokens[1], 0.0f, MAX_EXPONENT, exponent))
+        {
+            return false;
+        }
+        if (exponent <= 0.0f)
+        {
+            return Fail("the curve exponent must be above 0");
+        }
+        stick.curve = Equals(type.text, type.length, "power") ? ResponseCurve::Power : ResponseCurve::SCurve;
+        stick.exponent = exponent;
+        stick.pointCount = 0;
+        return true;
+    }
+
+    if (Equals(type.text, type.length, "custom"))
+    {
+        if (count < 2 || count > 1 + StickSettings::MAX_CURVE_POINTS)
+        {
+            return Fail("'custom' takes 1 to " + std::to_string(StickSettings::MAX_CURVE_POINTS) + " <x>:<y> points");
+        }
+        stick.curve = ResponseCurve::Custom;
+        stick.exponent = 1.0f;
+        stick.pointCount = static_cast<uint8_t>(count - 1);
+        for (int i = 1; i < count; ++i)
+        {
+            const char* colon = static_cast<const char*>(std::memchr(tokens[i].text, ':', tokens[i].length));
+            if (!colon)
+            {
+                return Fail("expected <x>:<y>, got '" + tokens[i].ToString() + "'");
+            }
+            Token x = { tokens[i].text, static_cast<size_t>(colon - tokens[i].text) };
+            Token y = { colon + 1, tokens[i].length - x.length - 1 };
+            float& pointX = stick.pointsX[i - 1];
+            if (!ParseFloat(x, 0.0f, 1.0f, pointX) || !ParseFloat(y, 0.0f, 1.0f, stick.pointsY[i - 1]))
+            {
+                return false;
+            }
+            if (pointX <= 0.0f || pointX >= 1.0f || (i > 1 && pointX <= stick.pointsX[i - 2]))
+            {
+                return Fail("curve points need ascending x between 0 and 1");
+            }
+        }
+        return true;
+    }
+
+    return Fail("unknown curve '" + type.ToString() + "' (linear, power, scurve, custom)");
+}
+
+bool ProfileCompiler::ParseThreshold(const Token* tokens, int count, int32_t maxValue, ThresholdSettings& threshold)
+{
+    long press;
+    long release;
+    long holdMs = 0;
+    if (count < 2 || count > 3)
+    {
+        return Fail("'threshold' takes <press> <release> [<hold ms>]");
+    }
+    if (!ParseNumber(tokens[0], 0, maxValue, press) || !ParseNumber(tokens[1], 0, maxValue, release) ||
+        (count == 3 && !ParseNumber(tokens[2], 0, MAX_DURATION_MS, holdMs)))
+    {
+        return false;
+    }
+    if (release > press)
+    {
+        return Fail("the release threshold must not be above the press threshold");
+    }
+
+    threshold.pressThreshold = static_cast<int32_t>(press);
+    threshold.releaseThreshold = static_cast<int32_t>(release);
+    threshold.minHoldNs = static_cast<uint64_t>(holdMs) * 1000000ULL;
+    return true;
+}
+
+bool ProfileCompiler::ParseStep(const Token& token, bool allowRepeat, MacroStep& step, uint8_t& repeat)
+{
+    // <output>[/<hold ms>[/<gap ms>]][*<count>]
+    Token parts[3];
+    int partCount = 0;
+    Token rest = token;
+    repeat = 1;
+
+    const char* star = static_cast<const char*>(std::memchr(rest.text, '*', rest.length));
+    if (star)
+    {
+        if (!allowRepeat)
+        {
+            return Fail("only tap, doubletap and longpress steps take a *<count>");
+        }
+        long count;
+        Token countToken = { star + 1, rest.length - static_cast<size_t>(star - rest.text) - 1 };
+        if (!ParseNumber(countToken, 1, MacroDefinition::MAX_STEPS, count))
+        {
+            return false;
+        }
+        repeat = static_cast<uint8_t>(count);
+        rest.length = static_cast<size_t>(star - rest.text);
+    }
+
+    while (true)
+    {
+        if (partCount == 3)
+        {
+            return Fail("expected <output>/<hold ms>/<gap ms>, got '" + token.ToString() + "'");
+        }
+        const char* slash = static_cast<const char*>(std::memchr(rest.text, '/', rest.length));
+        size_t partLength = slash ? static_cast<size_t>(slash - rest.text) : rest.length;
+        parts[partCount].text = rest.text;
+        parts[partCount].length = partLength;
+        ++partCount;
+        if (!slash)
+        {
+            break;
+        }
+        rest.text = slash + 1;
+        rest.length -= partLength + 1;
+    }
+
+    const Token& output = parts[0];
+    uint16_t mouseButton;
+    if (output.length > 5 && Equals(output.text, 5, "mouse") &&
+        InputNames::ParseMouseButton(output.text + 5, output.length - 5, mouseButton))
+    {
+        step.type = MacroOutputType::MouseButton;
+        step.code = mouseButton;
+    }
+    else
+    {
+        step.type = MacroOutputType::Key;
+        if (!ParseKey(output, false, step.code))
+        {
+            return false;
+        }
+    }
+
+    long holdMs = 0;
+    long gapMs = 0;
+    if ((partCount > 1 && !ParseNumber(parts[1], 0, MAX_DURATION_MS, holdMs)) ||
+        (partCount > 2 && !ParseNumber(parts[2], 0, MAX_DURATION_MS, gapMs)))
+    {
+        return false;
+    }
+    step.holdMs = static_cast<uint16_t>(holdMs);
+    step.gapMs = static_cast<uint16_t>(gapMs);
+    return true;
+}
+
+bool ProfileCompiler::ParseKey(const Token& token, bool allowNone, uint16_t& keyCode)
+{
+    if (Equals(token.text, token.length, "none"))
+    {
+        keyCode = 0;
+        return allowNone || Fail("'none' is not allowed here");
+    }
+    if (!InputNames::ParseKey(token.text, token.length, keyCode))
+    {
+        return Fail("unknown key '" + token.ToString() + "'");
+    }
+    return true;
+}
+
+bool ProfileCompiler::ParseNumber(const Token& token, long minValue, long maxValue, long& value)
+{
+    std::string text = token.ToString();
+    char* end = nullptr;
+    value = std::strtol(text.c_str(), &end, 10);
+    if (text.empty() || end != text.c_str() + text.size())
+    {
+        return Fail("expected a number, got '" + text + "'");
+    }
+    if (value < minValue || value > maxValue)
+    {
+        return Fail(text + " is out of range (" + std::to_string(minValue) + " to " + std::to_string(maxValue) + ")");
+    }
+    return true;
+}
+
+bool ProfileCompiler::ParseFloat(const Token& token, float minValue, float maxValue, float& value)
+{
+    std::string text = token.ToString();
+    char* end = nullptr;
+    value = std::strtof(text.c_str(), &end);
+    if (text.empty() || end != text.c_str() + text.size())
+    {
+        return Fail("expected a number, got '" + text + "'");
+    }
+    if (!(value >= minValue && value <= maxValue))
+    {
+        char range[48];
+        std::snprintf(range, sizeof(range), " is out of range (%g to %g)", minValue, maxValue);
+        return Fail(text + range);
+    }
+    return true;
+}
+
+bool ProfileCompiler::SetLabel(char (&label)[Profile::LABEL_SIZE])
+{
+    m_labelUsed = true;
+    if (m_label.length >= Profile::LABEL_SIZE)
+    {
+        return Fail("label longer than " + std::to_string(Profile::LABEL_SIZE - 1) + " bytes");
+    }
+    std::memset(label, 0, sizeof(label));
+    if (m_label.length > 0)
+    {
+        std::memcpy(label, m_label.text, m_label.length);
+    }
+    return true;
+}
+
+bool ProfileCompiler::Fail(const std::string& message)
+{
+    m_errorLine = m_line;
+    m_error = "line " + std::to_string(m_line) + ": " + message;
+    return false;
+}
@@ -0,0 +1,131 @@
+#pragma once
+
+#include "Profile.h"
+#include <cstddef>
+#include <string>
+
+/**
+ * ProfileCompiler - Validates a text profile and compiles it into a Profile
+ *
+ * INI syntax, one setting per line; ';' or '#' starts a comment. Names
+ * of buttons, keys and mouse buttons are those of InputNames (any case).
+ * Every binding line may end with a "quoted label" shown in the banner.
+ *
+ *   [profile]
+ *   name = The Witcher 1
+ *
+ *   [buttons]
+ *   A  = key Space                      ; held key
+ *   X  = mouse Left                     ; held mouse button
+ *   Y  = sequence 1 6                   ; taps on press (up to 4 keys)
+ *   LB = macro [cancel] 1/30/20 6/30/20 ; timed steps <output>/<hold ms>/<gap ms>
+ *   B  = gesture holdms=200 tap=Escape/30/20 hold=Alt
+ *   DPadLeft = gesture holdms=200 doubletapms=180 tap=LeftBracket/30/20 doubletap=LeftBracket/30/20*2
+ *
+ *   [sticks]
+ *   left.deadzone = 7849 32767          ; inner, outer (radial, raw units)
+ *   left.curve = linear | power <exp> | scurve <exp> | custom <x>:<y> ...
+ *   right.deadzone / right.curve        ; the camera stick
+ *   threshold = 10322 8258 [hold ms]    ; movement keys: press, release
+ *   move = W S A D                      ; forward, back, left, right
+ *
+ *   [triggers]
+ *   threshold = 128 96 [hold ms]
+ *   left = X
+ *   right = Z
+ *   both = C                            ; LT + RT chord
+ *
+ *   [layer signs]                       ; a named binding layer
+ *   activate = LB hold                  ; or toggle: each press turns it on or off
+ *   X  = key 5                          ; same bindings as [buttons]
+ *   Y  = none                           ; silenced while the layer is on
+ *
+ *   [combos]
+ *   combo = DPadDown DPadDown/300 X macro 6/30/20 MouseRight/30/20 "Igni"
+ *
+ * A layer rebinds the buttons it lists while it is on, the others fall
+ * through; later layers win over earlier ones, up to 4. Its activator is
+ * bound in no table.
+ * A combo lists 2 to 8 presses, each after the first with the longest time
+ * since the press before (<button>/<ms>, default 300 ms), then the macro it
+ * plays; up to 16 combos. A step output is a key or MouseLeft/MouseRight/
+ * MouseMiddle; hold and gap default to one timer tick, and gesture steps may
+ * repeat with *<count>.
+ * Compilation stops at the first error, reported with its line number.
+ */
+class ProfileCompiler
+{
+public:
+    ProfileCompiler();
+
+    /**
+     * Compile profile text
+     * @param text Profile text (need not be null-terminated)
+     * @param length Text length in bytes
+     * @param profile Receives the compiled profile (unspecified on failure)
+     * @return false on the first error (see GetError())
+     */
+    bool Compile(const char* text, size_t length, Profile& profile);
+
+    /**
+     * Get the last error as "line <n>: <message>"
+     */
+    const std::string& GetError() const { return m_error; }
+
+    /**
+     * Get the line of the last error (1-based, 0 if none)
+     */
+    int GetErrorLine() const { return m_errorLine; }
+
+private:
+    enum class Section
+    {
+        None,
+        Profile,
+        Buttons,
+        Sticks,
+        Triggers,
+        Layer,
+        Combos
+    };
+
+    struct Token
+    {
+        const char* text;
+        size_t length;
+
+        std::string ToString() const { return std::string(text, length); }
+    };
+
+    static const int MAX_TOKENS = 24;
+
+    bool ParseLine(const char* line, size_t length, Profile& profile);
+    bool ParseButton(const Token& name, const Token* tokens, int count, BindingTable& buttons,
+                     char (&labels)[PadButton::COUNT][Profile::LABEL_SIZE], uint16_t& boundButtons);
+    bool BeginLayer(const char* name, size_t length, Profile& profile);
+    bool EndLayer(const Profile& profile);
+    bool ParseLayer(const Token& key, const Token* tokens, int count, Profile& profile);
+    bool ParseMacro(const Token* tokens, int count, MacroDefinition& macro);
+    bool ParseGesture(const Token* tokens, int count, GestureDefinition& gesture);
+    bool ParseStick(const Token& key, const Token* tokens, int count, Profile& profile);
+    bool ParseTrigger(const Token& key, const Token* tokens, int count, Profile& profile);
+    bool ParseCombo(const Token& key, const Token* tokens, int count, Profile& profile);
+    bool ParseCurve(const Token* tokens, int count, StickSettings& stick);
+    bool ParseThreshold(const Token* tokens, int count, int32_t maxValue, ThresholdSettings& threshold);
+    bool ParseStep(const Token& token, bool allowRepeat, MacroStep& step, uint8_t& repeat);
+    bool ParseKey(const Token& token, bool allowNone, uint16_t& keyCode);
+    bool ParseNumber(const Token& token, long minValue, long maxValue, long& value);
+    bool ParseFloat(const Token& token, float minValue, float maxValue, float& value);
+    bool SetLabel(char (&label)[Profile::LABEL_SIZE]);
+    bool Fail(const std::string& message);
+
+    std::string m_error;
+    int m_errorLine;
+    int m_line;
+    Section m_section;
+    uint16_t m_boundButtons;    // Buttons already bound in [buttons] (rebinding is an error)
+    uint16_t m_activators;      // Buttons that activate a layer (binding them is an error)
+    bool m_layerActivated;      // The current [layer] section has its 'activate' setting
+    Token m_label;              // Label of the current line (length 0 if none)
+    bool m_labelUsed;           // The current setting takes a label
+};
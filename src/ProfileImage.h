@@ -0,0 +1,80 @@
+#pragma once
+
+#include "Profile.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+/**
+ * Compiled profile image format (profile cache)
+ *
+ * A 32-byte header followed by one Profile exactly as it sits in memory, so
+ * the mapped file is used in place. The image is a cache of the text profile
+ * for this build, not an interchange format: the version and payload size
+ * reject images from a build with a different Profile layout, the source
+ * hash tells whether the text changed since it was compiled, and the
+ * checksum catches a torn or damaged file. Any mismatch means "recompile".
+ */
+namespace ProfileImage
+{
+    const char MAGIC[8] = { 'G', 'P', 'M', 'P', 'R', 'O', 'F', 'L' };
+    const uint32_t VERSION = 3;
+
+    const uint64_t FNV_OFFSET = 14695981039346656037ULL;
+    const uint64_t FNV_PRIME = 1099511628211ULL;
+
+    struct Header
+    {
+        char magic[8];          // MAGIC
+        uint32_t version;       // VERSION
+        uint32_t payloadSize;   // sizeof(Profile)
+        uint64_t sourceHash;    // Hash() of the profile text it was compiled from
+        uint64_t checksum;      // Hash() of the payload
+    };
+
+    static_assert(sizeof(Header) == 32, "ProfileImage::Header layout changed");
+    static_assert(sizeof(Header) % alignof(Profile) == 0, "payload must stay aligned after the header");
+
+    /**
+     * 64-bit FNV-1a over 64-bit words (the tail byte by byte)
+     * Eight times fewer steps of the multiply chain than the byte-wise hash; it
+     * only has to notice changed text and damaged images, not resist attacks.
+     */
+    inline uint64_t Hash(const void* data, size_t size)
+    {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        uint64_t hash = FNV_OFFSET;
+        size_t i = 0;
+        for (; i + 8 <= size; i += 8)
+        {
+            uint64_t word;
+            std::memcpy(&word, bytes + i, sizeof(word));
+            hash ^= word;
+            hash *= FNV_PRIME;
+        }
+        for (; i < size; ++i)
+        {
+            hash ^= bytes[i];
+            hash *= FNV_PRIME;
+        }
+        return hash;
+    }
+
+    inline Header MakeHeader(const Profile& profile, uint64_t sourceHash)
+    {
+        Header header = {};
+        std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+        header.version = VERSION;
+        header.payloadSize = sizeof(Profile);
+        header.sourceHash = sourceHash;
+        header.checksum = Hash(&profile, sizeof(Profile));
+        return header;
+    }
+
+    inline bool IsValidHeader(const Header& header)
+    {
+        return std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) == 0 &&
+               header.version == VERSION &&
+               header.payloadSize == sizeof(Profile);
+    }
+}
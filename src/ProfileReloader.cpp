@@ -0,0 +1,187 @@
+#include "ProfileReloader.h"
+#include "Mapper.h"
+
+namespace
+{
+    // Longest the watcher thread sleeps at once, so Stop() is noticed promptly
+    const uint64_t STOP_CHECK_NS = 50000000ULL;     // 50 ms
+}
+
+ProfileReloader::ProfileReloader(IMonotonicClock& clock)
+    : m_clock(clock)
+    , m_log(nullptr)
+    , m_watchedHash(0)
+    , m_nextVersion(1)
+    , m_reclaimedCount(0)
+    , m_reloadCount(0)
+    , m_failedReloadCount(0)
+    , m_version(0)
+    , m_current(nullptr)
+    , m_readerVersion(0)
+    , m_readerSnapshot(nullptr)
+    , m_running(false)
+{
+}
+
+ProfileReloader::~ProfileReloader()
+{
+    Stop();
+
+    // The reader is gone too: everything left can be freed
+    for (ProfileSnapshot* snapshot : m_retired)
+    {
+        delete snapshot;
+    }
+    delete m_current.load(std::memory_order_acquire);
+}
+
+bool ProfileReloader::Load(const char* sourcePath)
+{
+    m_sourcePath = sourcePath;
+    m_imagePath = ProfileCache::GetImagePath(sourcePath);
+    m_error.clear();
+
+    if (!m_cache.Load(m_sourcePath.c_str(), m_imagePath.c_str()))
+    {
+        m_error = m_cache.GetError();
+        return false;
+    }
+
+    m_watchedHash = m_cache.GetSourceHash();
+    Publish(m_cache.GetProfile(), m_watchedHash);
+    return true;
+}
+
+void ProfileReloader::Publish(const Profile& profile, uint64_t sourceHash)
+{
+    // Everything expensive happens here, on the writer side
+    ProfileSnapshot* snapshot = new ProfileSnapshot;
+    snapshot->version = m_nextVersion++;
+    snapshot->sourceHash = sourceHash;
+    snapshot->profile = profile;
+    snapshot->leftStick.Configure(profile.leftStick);
+    snapshot->rightStick.Configure(profile.rightStick);
+    snapshot->combos.Compile(profile.combos, profile.comboCount);
+
+    ProfileSnapshot* previous = m_current.exchange(snapshot, std::memory_order_acq_rel);
+    m_version.store(snapshot->version, std::memory_order_relaxed);
+    if (previous)
+    {
+        m_retired.push_back(previous);
+    }
+    Reclaim();
+}
+
+bool ProfileReloader::Poll()
+{
+    Reclaim();
+
+    // A file that cannot be read right now (an editor replacing it) is tried again next pass
+    if (m_sourcePath.empty() || !ProfileCache::ReadSource(m_sourcePath.c_str(), m_text))
+    {
+        return false;
+    }
+
+    uint64_t hash = ProfileImage::Hash(m_text.data(), m_text.size());
+    if (hash == m_watchedHash)
+    {
+        return false;
+    }
+
+    if (!m_cache.Load(m_sourcePath.c_str(), m_imagePath.c_str()))
+    {
+        // Not retried until the text changes again
+        m_watchedHash = hash;
+        m_error = m_cache.GetError();
+        m_failedReloadCount.fetch_add(1, std::memory_order_relaxed);
+        if (m_log)
+        {
+            *m_log << "ERROR: " << m_error << "; keeping profile version " << GetVersion() << std::endl;
+        }
+        return false;
+    }
+
+    // The text may have changed again since it was hashed; the cache read it last
+    m_watchedHash = m_cache.GetSourceHash();
+    Publish(m_cache.GetProfile(), m_watchedHash);
+    m_reloadCount.fetch_add(1, std::memory_order_relaxed);
+    if (m_log)
+    {
+        *m_log << "Profile reloaded: " << m_sourcePath << (m_cache.WasCompiled() ? " (compiled)" : " (cached)")
+               << ", version " << GetVersion() << std::endl;
+    }
+    return true;
+}
+
+void ProfileReloader::Start()
+{
+    if (m_running.load())
+    {
+        return;
+    }
+
+    m_running.store(true);
+    m_thread = std::thread(&ProfileReloader::ThreadLoop, this);
+}
+
+void ProfileReloader::Stop()
+{
+    m_running.store(false);
+    if (m_thread.joinable())
+    {
+        m_thread.join();
+    }
+}
+
+bool ProfileReloader::Apply(Mapper& mapper)
+{
+    const ProfileSnapshot* snapshot = m_current.load(std::memory_order_acquire);
+    if (snapshot == m_readerSnapshot)
+    {
+        return false;
+    }
+
+    mapper.SetProfile(snapshot->profile, snapshot->leftStick, snapshot->rightStick, snapshot->combos);
+
+    // Release: every use of the older snapshots happened before the writer sees this
+    m_readerSnapshot = snapshot;
+    m_readerVersion.store(snapshot->version, std::memory_order_release);
+    return true;
+}
+
+void ProfileReloader::Reclaim()
+{
+    // Snapshots older than the one the reader switched to are no longer reachable by it
+    uint64_t readerVersion = m_readerVersion.load(std::memory_order_acquire);
+    size_t kept = 0;
+    for (ProfileSnapshot* snapshot : m_retired)
+    {
+        if (snapshot->version < readerVersion)
+        {
+            delete snapshot;
+            ++m_reclaimedCount;
+        }
+        else
+        {
+            m_retired[kept++] = snapshot;
+        }
+    }
+    m_retired.resize(kept);
+}
+
+void ProfileReloader::ThreadLoop()
+{
+    uint64_t nextPoll = m_clock.NowNanoseconds();
+    while (m_running.load())
+    {
+        uint64_t now = m_clock.NowNanoseconds();
+        if (now >= nextPoll)
+        {
+            Poll();
+            nextPoll = now + POLL_INTERVAL_NS;
+        }
+
+        uint64_t wake = now + STOP_CHECK_NS;
+        m_clock.SleepUntil(wake < nextPoll ? wake : nextPoll);
+    }
+}
@@ -0,0 +1,182 @@
+#pragma once
+
+#include "Profile.h"
+#include "ProfileCache.h"
+#include "StickProcessor.h"
+#include "ComboRecognizer.h"
+#include "MonotonicClock.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+class Mapper;
+
+/**
+ * ProfileSnapshot - One immutable, versioned profile published by ProfileReloader
+ *
+ * Holds its own copy of the profile, and the stick tables and combo
+ * automaton built from it, so a mapper switches to it without baking,
+ * copying or allocating anything.
+ * Never modified after it is published.
+ */
+struct ProfileSnapshot
+{
+    uint64_t version;           // 1 for the first snapshot, +1 per publication
+    uint64_t sourceHash;        // Hash of the text it was compiled from (ProfileImage::Hash)
+    Profile profile;
+    StickProcessor leftStick;   // Baked from profile.leftStick
+    StickProcessor rightStick;  // Baked from profile.rightStick
+    ComboAutomaton combos;      // Compiled from profile.combos
+};
+
+/**
+ * ProfileReloader - Hot reload of a text profile without pausing the mapping loop
+ *
+ * A watcher thread checks the profile text every POLL_INTERVAL_NS. When its
+ * hash changes, the text is loaded through a ProfileCache (compiled, image
+ * rewritten) and a new ProfileSnapshot is built and published with a single
+ * atomic pointer swap. A text that does not compile is reported and the
+ * current snapshot stays in use.
+ *
+ * The mapping loop is the only reader. Once per frame it calls Apply(): one
+ * atomic load, and on a change a Mapper::SetProfile() that
+ * only swaps pointers and resets per-profile state; the reconciler releases
+ * keys the old profile held on the next Update(). The reader never locks or
+ * allocates. Reclamation is deferred RCU style: a replaced snapshot is kept
+ * until the reader acknowledges a newer version, which it does only after
+ * switching away, and the writer frees it on a later pass.
+ */
+class ProfileReloader
+{
+public:
+    static const uint64_t POLL_INTERVAL_NS = 250000000ULL;  // 250 ms
+
+    /**
+     * @param clock Clock for the watch interval (must outlive the reloader; once started, the
+     *              watcher thread sleeps on it, so no other thread may sleep on it too)
+     */
+    explicit ProfileReloader(IMonotonicClock& clock);
+    ~ProfileReloader();
+
+    ProfileReloader(const ProfileReloader&) = delete;
+    ProfileReloader& operator=(const ProfileReloader&) = delete;
+
+    /**
+     * Load a profile text and publish it as the first snapshot (before Start)
+     * @param sourcePath Profile text, watched from now on; its image is ProfileCache::GetImagePath()
+     * @return false if it cannot be read or does not compile (see GetError())
+     */
+    bool Load(const char* sourcePath);
+
+    /**
+     * Build a snapshot of a profile and publish it (writer side)
+     * Called by the watcher thread, or by one other thread while it is not running.
+     * @param profile Profile to copy into the snapshot
+     * @param sourceHash Hash of the text it was compiled from
+     */
+    void Publish(const Profile& profile, uint64_t sourceHash);
+
+    /**
+     * Run one watch pass: reload if the text changed, then free acknowledged snapshots
+     * Called by the watcher thread; tests may call it directly instead of Start().
+     * @return True if a new snapshot was published
+     */
+    bool Poll();
+
+    /**
+     * Start the watcher thread
+     */
+    void Start();
+
+    /**
+     * Stop the watcher thread
+     */
+    void Stop();
+
+    /**
+     * Switch a mapper to the newest snapshot if it changed (reader: the mapping loop only)
+     * Called once per frame, between two Update() calls. The snapshot the
+     * mapper used before may be freed as soon as this returns.
+     * @return True if the mapper switched
+     */
+    bool Apply(Mapper& mapper);
+
+    /**
+     * Get the snapshot the reader last switched to (reader side)
+     * @return Snapshot, or nullptr before the first Apply()
+     */
+    const ProfileSnapshot* GetApplied() const { return m_readerSnapshot; }
+
+    /**
+     * Get the version of the newest published snapshot (any thread)
+     */
+    uint64_t GetVersion() const { return m_version.load(std::memory_order_relaxed); }
+
+    /**
+     * Get the number of reloads published, and failed, by Poll() (any thread)
+     */
+    uint64_t GetReloadCount() const { return m_reloadCount.load(std::memory_order_relaxed); }
+    uint64_t GetFailedReloadCount() const { return m_failedReloadCount.load(std::memory_order_relaxed); }
+
+    /**
+     * Get the number of replaced snapshots freed so far, and still waiting to be freed (writer side)
+     */
+    uint64_t GetReclaimedCount() const { return m_reclaimedCount; }
+    size_t GetRetiredCount() const { return m_retired.size(); }
+
+    /**
+     * Get the cache of the last load, e.g. whether it compiled or is mapped (writer side)
+     */
+    const ProfileCache& GetCache() const { return m_cache; }
+
+    /**
+     * Get why the last load or reload failed (writer side)
+     */
+    const std::string& GetError() const { return m_error; }
+
+    /**
+     * Report reloads and reload errors from the watcher thread (nullptr: silent, the default)
+     */
+    void SetLog(std::ostream* log) { m_log = log; }
+
+private:
+    /**
+     * Watcher thread body
+     */
+    void ThreadLoop();
+
+    /**
+     * Free the retired snapshots the reader no longer uses (writer side)
+     */
+    void Reclaim();
+
+    IMonotonicClock& m_clock;
+    std::ostream* m_log;
+
+    // Writer side: the watched text, the cache it is loaded through, and replaced snapshots
+    std::string m_sourcePath;
+    std::string m_imagePath;
+    std::string m_text;
+    uint64_t m_watchedHash;         // Hash of the last text loaded or rejected
+    ProfileCache m_cache;
+    std::string m_error;
+    uint64_t m_nextVersion;
+    std::vector<ProfileSnapshot*> m_retired;
+    uint64_t m_reclaimedCount;
+
+    std::atomic<uint64_t> m_reloadCount;
+    std::atomic<uint64_t> m_failedReloadCount;
+    std::atomic<uint64_t> m_version;
+
+    // The published snapshot, and the newest version the reader switched to
+    alignas(64) std::atomic<ProfileSnapshot*> m_current;
+    alignas(64) std::atomic<uint64_t> m_readerVersion;
+    const ProfileSnapshot* m_readerSnapshot;    // Reader only
+
+    std::thread m_thread;
+    std::atomic<bool> m_running;
+};
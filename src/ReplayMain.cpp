@@ -0,0 +1,308 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include "Mapper.h"
+#include "PadDevice.h"
+#include "MonotonicClock.h"
+#include "FrameScheduler.h"
+#include "StageProfiler.h"
+#include "TraceReader.h"
+#include "TraceReplaySource.h"
+#include "ProfileCache.h"
+
+namespace
+{
+    /**
+     * Output sink that records nothing but a running digest of the event stream,
+     * so two replays of the same trace can be compared for identical output
+     */
+    class DigestOutputSink : public IOutputSink
+    {
+    public:
+        explicit DigestOutputSink(bool printEvents)
+            : m_printEvents(printEvents)
+            , m_digest(FNV_OFFSET)
+            , m_eventCount(0)
+            , m_submitCount(0)
+            , m_mouseX(0)
+            , m_mouseY(0)
+        {
+        }
+
+        size_t Submit(const OutputEvent* events, size_t count) override
+        {
+            ++m_submitCount;
+            for (size_t i = 0; i < count; ++i)
+            {
+                const OutputEvent& event = events[i];
+                Mix(static_cast<uint64_t>(event.type));
+                Mix(event.code);
+                Mix(static_cast<uint32_t>(event.deltaX));
+                Mix(static_cast<uint32_t>(event.deltaY));
+
+                if (event.type == OutputEventType::MouseMove)
+                {
+                    m_mouseX += event.deltaX;
+                    m_mouseY += event.deltaY;
+                }
+
+                if (m_printEvents)
+                {
+                    Print(event);
+                }
+            }
+            m_eventCount += count;
+            return count;
+        }
+
+        uint64_t GetDigest() const { return m_digest; }
+        uint64_t GetEventCount() const { return m_eventCount; }
+        uint64_t GetSubmitCount() const { return m_submitCount; }
+        int64_t GetMouseX() const { return m_mouseX; }
+        int64_t GetMouseY() const { return m_mouseY; }
+
+    private:
+        static const uint64_t FNV_OFFSET = 14695981039346656037ULL;
+        static const uint64_t FNV_PRIME = 1099511628211ULL;
+
+        void Mix(uint64_t value)
+        {
+            for (int i = 0; i < 8; ++i)
+            {
+                m_digest ^= (value >> (i * 8)) & 0xFF;
+                m_digest *= FNV_PRIME;
+            }
+        }
+
+        void Print(const OutputEvent& event) const
+        {
+            switch (event.type)
+            {
+            case OutputEventType::KeyDown:
+                std::cout << "  key down 0x" << std::hex << event.code << std::dec << std::endl;
+                break;
+            case OutputEventType::KeyUp:
+                std::cout << "  key up   0x" << std::hex << event.code << std::dec << std::endl;
+                break;
+            case OutputEventType::MouseButtonDown:
+                std::cout << "  mouse down " << event.code << std::endl;
+                break;
+            case OutputEventType::MouseButtonUp:
+                std::cout << "  mouse up   " << event.code << std::endl;
+                break;
+            case OutputEventType::MouseMove:
+                std::cout << "  mouse move " << event.deltaX << "," << event.deltaY << std::endl;
+                break;
+            }
+        }
+
+        bool m_printEvents;
+        uint64_t m_digest;
+        uint64_t m_eventCount;
+        uint64_t m_submitCount;
+        int64_t m_mouseX;       // Total camera displacement (the same at any --rate)
+        int64_t m_mouseY;
+    };
+
+    void PrintUsage()
+    {
+        std::cout << "Usage: GamepadReplay <trace.gpt> [--realtime] [--rate=<hz>] [--events] [--profile=<file.ini>]" << std::endl;
+        std::cout << "  --realtime    Pace frames on the wall clock (default: as fast as possible)" << std::endl;
+        std::cout << "  --rate=<hz>   Mapper frame rate to simulate (default 200)" << std::endl;
+        std::cout << "  --events      Print every emitted keyboard/mouse event" << std::endl;
+        std::cout << "  --profile=<f> Map with a text profile (default: the built-in Witcher profile)" << std::endl;
+    }
+}
+
+/**
+ * GamepadReplay - Feeds a recorded pad trace through Mapper
+ *
+ * Runs on Windows and Linux without a pad or a game: output goes to a digest
+ * sink instead of SendInput. The default mode advances replay time by one
+ * frame period per frame without sleeping, so the result is deterministic and
+ * the mapper's throughput can be benchmarked; --realtime paces frames like the
+ * live main loop. Prints the event digest and the map stage latency on exit.
+ */
+int main(int argc, char* argv[])
+{
+    const char* tracePath = nullptr;
+    bool realtime = false;
+    bool printEvents = false;
+    uint32_t rateHz = 200;
+    const char* profilePath = nullptr;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--realtime") == 0)
+        {
+            realtime = true;
+        }
+        else if (std::strncmp(argv[i], "--rate=", 7) == 0)
+        {
+            rateHz = static_cast<uint32_t>(std::strtoul(argv[i] + 7, nullptr, 10));
+        }
+        else if (std::strcmp(argv[i], "--events") == 0)
+        {
+            printEvents = true;
+        }
+        else if (std::strncmp(argv[i], "--profile=", 10) == 0)
+        {
+            profilePath = argv[i] + 10;
+        }
+        else if (argv[i][0] != '-' && !tracePath)
+        {
+            tracePath = argv[i];
+        }
+        else
+        {
+            PrintUsage();
+            return 2;
+        }
+    }
+
+    if (!tracePath)
+    {
+        PrintUsage();
+        return 2;
+    }
+
+    TraceReader reader;
+    if (!reader.Open(tracePath))
+    {
+        std::cerr << "ERROR: cannot open trace " << tracePath << std::endl;
+        return 1;
+    }
+
+    // Profile: the mapped image is used in place, so the cache lives as long as the mapper
+    Profile builtInProfile = Profile::CreateWitcher();
+    const Profile* profile = &builtInProfile;
+    ProfileCache profileCache;
+    if (profilePath)
+    {
+        std::string imagePath = ProfileCache::GetImagePath(profilePath);
+        if (!profileCache.Load(profilePath, imagePath.c_str()))
+        {
+            std::cerr << "ERROR: " << profileCache.GetError() << std::endl;
+            return 1;
+        }
+        if (!profileCache.IsMapped())
+        {
+            std::cout << "WARNING: " << profileCache.GetError() << "; using the profile compiled in memory" << std::endl;
+        }
+        profile = &profileCache.GetProfile();
+        std::cout << "Profile: " << profilePath << (profileCache.WasCompiled() ? " (compiled)" : " (cached)") << std::endl;
+    }
+
+    TraceReplaySource source(reader);
+    std::cout << "Trace: " << reader.GetRecordCount() << " records, "
+              << (source.GetDurationNanoseconds() / 1000000ULL) << " ms, controller "
+              << reader.GetHeader().controllerIndex << std::endl;
+
+    SystemClock clock;
+    StageProfiler profiler(clock);
+    profiler.SetEnabled(true);
+
+    DigestOutputSink digest(printEvents);
+    PadDevice pad;
+    Mapper mapper;
+    mapper.Initialize(&pad, &digest);
+    if (profilePath)
+    {
+        mapper.SetProfile(*profile);
+    }
+    else
+    {
+        mapper.SetStaticProfile<WitcherProfile>();
+    }
+
+    FrameScheduler scheduler(clock);
+    scheduler.Initialize(rateHz, OverrunPolicy::Skip);
+    uint64_t periodNs = scheduler.GetPeriodNanoseconds();
+
+    // Replay time of the current frame; the first frame picks up the first record
+    uint64_t replayTimeNs = 0;
+    uint64_t disconnects = 0;
+
+    auto wallStart = std::chrono::steady_clock::now();
+    scheduler.Start();
+
+    while (true)
+    {
+        PadSnapshot snapshot;
+        bool received = false;
+        while (source.Next(replayTimeNs, snapshot))
+        {
+            received = true;
+            bool wasConnected = pad.IsConnected();
+            pad.ApplySnapshot(snapshot);
+
+            if (!pad.IsConnected())
+            {
+                // The live loop exits here; replay releases and waits for a reconnect
+                if (wasConnected)
+                {
+                    ++disconnects;
+                    mapper.ReleaseAllOutputs();
+                }
+                continue;
+            }
+
+            ScopedStageTimer mapTimer(profiler, ProfileStage::Map);
+            mapper.Update(snapshot.timestampNs);
+        }
+
+        if (!received && pad.IsConnected())
+        {
+            pad.MarkUnchanged();
+            ScopedStageTimer mapTimer(profiler, ProfileStage::Map);
+            mapper.Update(source.GetOriginNanoseconds() + replayTimeNs);
+        }
+
+        if (source.IsFinished())
+        {
+            break;
+        }
+
+        if (realtime)
+        {
+            profiler.Record(ProfileStage::FrameLateness, scheduler.WaitForNextFrame());
+        }
+        replayTimeNs += periodNs;
+    }
+
+    mapper.ReleaseAllOutputs();
+
+    double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+
+    std::cout << "Frames: " << mapper.GetFrameCount()
+              << ", unchanged (fast path): " << mapper.GetSkippedFrameCount()
+              << ", disconnects: " << disconnects
+              << ", suppressed key transitions: " << mapper.GetSuppressedTransitionCount() << std::endl;
+    unsigned long long mappedFrames = mapper.GetFrameCount() - mapper.GetSkippedFrameCount();
+    std::cout << "Bindings evaluated: " << mapper.GetEvaluatedBindingCount() << " ("
+              << (mappedFrames ? static_cast<double>(mapper.GetEvaluatedBindingCount()) / static_cast<double>(mappedFrames) : 0.0)
+              << " per mapped frame, " << mapper.GetIndexedBindingCount() << " bound)" << std::endl;
+    if (profile->comboCount > 0)
+    {
+        std::cout << "Combos completed: " << mapper.GetCompletedComboCount() << std::endl;
+    }
+    if (profile->layerCount > 0)
+    {
+        std::cout << "Layer switches: " << mapper.GetLayerSwitchCount() << std::endl;
+    }
+    std::cout << "Output: " << digest.GetEventCount() << " events in " << digest.GetSubmitCount()
+              << " batches, digest " << std::hex << digest.GetDigest() << std::dec << std::endl;
+    std::cout << "Mouse displacement: " << digest.GetMouseX() << ", " << digest.GetMouseY() << std::endl;
+    std::cout << "Wall time: " << wallSeconds << " s";
+    if (wallSeconds > 0.0)
+    {
+        std::cout << " (" << static_cast<uint64_t>(static_cast<double>(mapper.GetFrameCount()) / wallSeconds)
+                  << " mapper updates/s)";
+    }
+    std::cout << std::endl;
+
+    profiler.Print(std::cout, scheduler.GetMissedDeadlineCount());
+    return 0;
+}
@@ -0,0 +1,208 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+/**
+ * SnapshotRing - Lock-free single-producer ring readable by any number of readers
+ *
+ * The producer never waits: it overwrites the oldest slot. Each slot carries a
+ * sequence number (seqlock), so a reader can tell whether the item it copied was
+ * complete and is still the one it asked for. Items are copied through 64-bit
+ * atomic words, so readers racing with the writer are well defined.
+ *
+ * Readers either walk every published item in order (Reader, used by the
+ * mapping stage so no button edge is missed) or just take the newest one
+ * (ReadLatest, used by the virtual controller forwarder).
+ */
+template <typename T, size_t Capacity>
+class SnapshotRing
+{
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+    static_assert(std::is_trivially_copyable<T>::value, "T must be trivially copyable");
+
+public:
+    enum class ReadResult
+    {
+        Ok,
+        NotPublished,   // Index has not been written yet
+        Overwritten     // The producer lapped the reader; the item is gone
+    };
+
+    SnapshotRing()
+        : m_published(0)
+    {
+        for (size_t i = 0; i < Capacity; ++i)
+        {
+            m_slots[i].sequence.store(0, std::memory_order_relaxed);
+            for (size_t w = 0; w < WORDS; ++w)
+            {
+                m_slots[i].words[w].store(0, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    SnapshotRing(const SnapshotRing&) = delete;
+    SnapshotRing& operator=(const SnapshotRing&) = delete;
+
+    /**
+     * Publish an item (producer thread only, never blocks)
+     */
+    void Publish(const T& item)
+    {
+        uint64_t index = m_published.load(std::memory_order_relaxed);
+        Slot& slot = m_slots[index & (Capacity - 1)];
+
+        uint64_t words[WORDS] = {};
+        std::memcpy(words, &item, sizeof(T));
+
+        // Odd sequence = write in progress
+        slot.sequence.store(index * 2 + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (size_t w = 0; w < WORDS; ++w)
+        {
+            slot.words[w].store(words[w], std::memory_order_relaxed);
+        }
+        slot.sequence.store(index * 2 + 2, std::memory_order_release);
+
+        m_published.store(index + 1, std::memory_order_release);
+    }
+
+    /**
+     * Get the number of items published so far (index of the next item)
+     */
+    uint64_t GetPublishedCount() const
+    {
+        return m_published.load(std::memory_order_acquire);
+    }
+
+    /**
+     * Copy the item with the given index
+     * @param index Publication index (0-based)
+     * @param item Receives the item on success
+     * @return Ok, NotPublished or Overwritten
+     */
+    ReadResult Read(uint64_t index, T& item) const
+    {
+        if (index >= GetPublishedCount())
+        {
+            return ReadResult::NotPublished;
+        }
+
+        const Slot& slot = m_slots[index & (Capacity - 1)];
+        uint64_t expected = index * 2 + 2;
+
+        uint64_t before = slot.sequence.load(std::memory_order_acquire);
+        if (before != expected)
+        {
+            return ReadResult::Overwritten;
+        }
+
+        uint64_t words[WORDS];
+        for (size_t w = 0; w < WORDS; ++w)
+        {
+            words[w] = slot.words[w].load(std::memory_order_relaxed);
+        }
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) != expected)
+        {
+            return ReadResult::Overwritten;
+        }
+
+        std::memcpy(&item, words, sizeof(T));
+        return ReadResult::Ok;
+    }
+
+    /**
+     * Copy the newest published item
+     * @return false if nothing has been published yet
+     */
+    bool ReadLatest(T& item) const
+    {
+        while (true)
+        {
+            uint64_t published = GetPublishedCount();
+            if (published == 0)
+            {
+                return false;
+            }
+            if (Read(published - 1, item) == ReadResult::Ok)
+            {
+                return true;
+            }
+            // Overwritten while copying - a newer item exists, try again
+        }
+    }
+
+    /**
+     * Reader - In-order cursor over the ring for one consumer
+     */
+    class Reader
+    {
+    public:
+        explicit Reader(const SnapshotRing& ring)
+            : m_ring(ring)
+            , m_next(ring.GetPublishedCount())
+            , m_lost(0)
+        {
+        }
+
+        /**
+         * Get the next unread item
+         * Items the producer overwrote before they were read are skipped and counted.
+         * @return false if there is nothing new
+         */
+        bool Next(T& item)
+        {
+            while (true)
+            {
+                ReadResult result = m_ring.Read(m_next, item);
+                if (result == ReadResult::Ok)
+                {
+                    ++m_next;
+                    return true;
+                }
+                if (result == ReadResult::NotPublished)
+                {
+                    return false;
+                }
+
+                // Lapped: jump to the oldest item that can still be valid
+                uint64_t published = m_ring.GetPublishedCount();
+                uint64_t oldest = (published > Capacity) ? published - Capacity + 1 : 0;
+                if (oldest <= m_next)
+                {
+                    oldest = m_next + 1;
+                }
+                m_lost += oldest - m_next;
+                m_next = oldest;
+            }
+        }
+
+        /**
+         * Get the number of items skipped because the reader fell behind
+         */
+        uint64_t GetLostCount() const { return m_lost; }
+
+    private:
+        const SnapshotRing& m_ring;
+        uint64_t m_next;
+        uint64_t m_lost;
+    };
+
+private:
+    static const size_t WORDS = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+    struct alignas(64) Slot
+    {
+        std::atomic<uint64_t> sequence;
+        std::atomic<uint64_t> words[WORDS];
+    };
+
+    alignas(64) std::atomic<uint64_t> m_published;
+    Slot m_slots[Capacity];
+};
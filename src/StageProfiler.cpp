@@ -0,0 +1,66 @@
+#include "StageProfiler.h"
+#include <iomanip>
+
+namespace
+{
+    double ToMicroseconds(uint64_t ns)
+    {
+        return static_cast<double>(ns) / 1000.0;
+    }
+}
+
+StageProfiler::StageProfiler(IMonotonicClock& clock)
+    : m_clock(clock)
+    , m_enabled(false)
+{
+}
+
+void StageProfiler::Print(std::ostream& out, uint64_t missedDeadlines) const
+{
+    std::ios::fmtflags flags = out.flags();
+    std::streamsize precision = out.precision();
+
+    out << "Stage latency (us):" << std::endl;
+    out << "  " << std::left << std::setw(18) << "stage"
+        << std::right << std::setw(10) << "count"
+        << std::setw(10) << "p50"
+        << std::setw(10) << "p99"
+        << std::setw(10) << "p99.9"
+        << std::setw(10) << "max" << std::endl;
+
+    out << std::fixed << std::setprecision(1);
+    for (int i = 0; i < static_cast<int>(ProfileStage::Count); ++i)
+    {
+        const LatencyHistogram& histogram = m_histograms[i];
+        if (histogram.GetCount() == 0)
+        {
+            continue;
+        }
+
+        out << "  " << std::left << std::setw(18) << GetStageName(static_cast<ProfileStage>(i))
+            << std::right << std::setw(10) << histogram.GetCount()
+            << std::setw(10) << ToMicroseconds(histogram.GetPercentile(50.0))
+            << std::setw(10) << ToMicroseconds(histogram.GetPercentile(99.0))
+            << std::setw(10) << ToMicroseconds(histogram.GetPercentile(99.9))
+            << std::setw(10) << ToMicroseconds(histogram.GetMax()) << std::endl;
+    }
+    out << "  Missed deadlines: " << missedDeadlines << std::endl;
+
+    out.flags(flags);
+    out.precision(precision);
+}
+
+const char* StageProfiler::GetStageName(ProfileStage stage)
+{
+    switch (stage)
+    {
+    case ProfileStage::Poll: return "poll";
+    case ProfileStage::Map: return "map";
+    case ProfileStage::Output: return "output";
+    case ProfileStage::VirtualController: return "virtual controller";
+    case ProfileStage::Frame: return "frame";
+    case ProfileStage::FrameLateness: return "frame lateness";
+    case ProfileStage::Count: break;
+    }
+    return "unknown";
+}
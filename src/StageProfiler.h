@@ -0,0 +1,135 @@
+#pragma once
+
+#include "LatencyHistogram.h"
+#include "MonotonicClock.h"
+#include "IOutputSink.h"
+#include <cstdint>
+#include <ostream>
+
+/**
+ * Stages of the input pipeline that are timed
+ */
+enum class ProfileStage
+{
+    Poll,               // XInputGetState (main loop or poll thread)
+    Map,                // Mapper::Update
+    Output,             // Keyboard/mouse injection of one batch (KeyboardMouse)
+    VirtualController,  // VirtualController::Update (main loop or forwarder thread)
+    Frame,              // Whole frame of work, excluding the wait
+    FrameLateness,      // How late a frame started relative to its deadline
+    Count
+};
+
+/**
+ * StageProfiler - Per-stage latency histograms for the main loop
+ *
+ * Every stage has its own LatencyHistogram. Recording never allocates. When
+ * disabled, ScopedStageTimer reduces to one predictable branch and no clock reads.
+ * Each stage must be recorded from a single thread.
+ */
+class StageProfiler
+{
+public:
+    /**
+     * @param clock Clock for timestamps (must outlive the profiler)
+     */
+    explicit StageProfiler(IMonotonicClock& clock);
+
+    /**
+     * Enable or disable recording (set before worker threads start)
+     */
+    void SetEnabled(bool enabled) { m_enabled = enabled; }
+
+    bool IsEnabled() const { return m_enabled; }
+
+    /**
+     * Get the current time from the profiler's clock
+     */
+    uint64_t Now() const { return m_clock.NowNanoseconds(); }
+
+    /**
+     * Record one duration for a stage
+     */
+    void Record(ProfileStage stage, uint64_t durationNs)
+    {
+        m_histograms[static_cast<int>(stage)].Record(durationNs);
+    }
+
+    /**
+     * Get the histogram of a stage
+     */
+    const LatencyHistogram& GetHistogram(ProfileStage stage) const
+    {
+        return m_histograms[static_cast<int>(stage)];
+    }
+
+    /**
+     * Print p50/p99/p99.9/max for every stage with samples
+     * @param out Output stream
+     * @param missedDeadlines Number of frames whose work ran past their deadline
+     */
+    void Print(std::ostream& out, uint64_t missedDeadlines) const;
+
+    /**
+     * Get a printable name for a stage
+     */
+    static const char* GetStageName(ProfileStage stage);
+
+private:
+    IMonotonicClock& m_clock;
+    bool m_enabled;
+    LatencyHistogram m_histograms[static_cast<int>(ProfileStage::Count)];
+};
+
+/**
+ * ScopedStageTimer - Times the enclosing scope into a stage histogram
+ */
+class ScopedStageTimer
+{
+public:
+    ScopedStageTimer(StageProfiler& profiler, ProfileStage stage)
+        : m_profiler(profiler.IsEnabled() ? &profiler : nullptr)
+        , m_stage(stage)
+        , m_start(m_profiler ? profiler.Now() : 0)
+    {
+    }
+
+    ~ScopedStageTimer()
+    {
+        if (m_profiler)
+        {
+            m_profiler->Record(m_stage, m_profiler->Now() - m_start);
+        }
+    }
+
+    ScopedStageTimer(const ScopedStageTimer&) = delete;
+    ScopedStageTimer& operator=(const ScopedStageTimer&) = delete;
+
+private:
+    StageProfiler* m_profiler;
+    ProfileStage m_stage;
+    uint64_t m_start;
+};
+
+/**
+ * ProfiledOutputSink - Times every batch handed to another sink as ProfileStage::Output
+ */
+class ProfiledOutputSink : public IOutputSink
+{
+public:
+    ProfiledOutputSink(IOutputSink& target, StageProfiler& profiler)
+        : m_target(target)
+        , m_profiler(profiler)
+    {
+    }
+
+    size_t Submit(const OutputEvent* events, size_t count) override
+    {
+        ScopedStageTimer timer(m_profiler, ProfileStage::Output);
+        return m_target.Submit(events, count);
+    }
+
+private:
+    IOutputSink& m_target;
+    StageProfiler& m_profiler;
+};
@@ -0,0 +1,470 @@
+#pragma once
+
+#include "BindingTable.h"
+#include "MacroPlayer.h"
+#include "OutputState.h"
+#include "Profile.h"
+#include "ThresholdSwitch.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <initializer_list>
+#include <utility>
+
+/**
+ * StaticBinding - One button binding as a compile-time constant
+ *
+ * The constexpr counterpart of a BindingTable entry; a built-in profile is an
+ * array of these (see WitcherProfile.h).
+ */
+struct StaticBinding
+{
+    uint16_t button;                                    // Single button flag
+    BindingActionType type;
+    uint8_t count;                                      // Entries in codes (Key, MouseButton, KeySequence)
+    uint16_t codes[BindingAction::MAX_SEQUENCE_KEYS];   // Key codes, or the mouse button index
+    MacroDefinition macro;                              // Macro
+    GestureDefinition gesture;                          // Gesture
+    const char* label;                                  // Banner text ("" for none)
+
+    static constexpr StaticBinding Key(uint16_t button, uint16_t keyCode, const char* label = "")
+    {
+        StaticBinding binding = Create(button, BindingActionType::Key, label);
+        binding.count = 1;
+        binding.codes[0] = keyCode;
+        return binding;
+    }
+
+    static constexpr StaticBinding Mouse(uint16_t button, uint16_t mouseButton, const char* label = "")
+    {
+        StaticBinding binding = Create(button, BindingActionType::MouseButton, label);
+        binding.count = 1;
+        binding.codes[0] = mouseButton;
+        return binding;
+    }
+
+    static constexpr StaticBinding Sequence(uint16_t button, std::initializer_list<uint16_t> keyCodes, const char* label = "")
+    {
+        StaticBinding binding = Create(button, BindingActionType::KeySequence, label);
+        binding.count = static_cast<uint8_t>(keyCodes.size());
+        for (size_t i = 0; i < keyCodes.size() && i < BindingAction::MAX_SEQUENCE_KEYS; ++i)
+        {
+            binding.codes[i] = keyCodes.begin()[i];
+        }
+        return binding;
+    }
+
+    static constexpr StaticBinding Macro(uint16_t button, std::initializer_list<MacroStep> steps, bool cancelOnRelease,
+                                         const char* label = "")
+    {
+        StaticBinding binding = Create(button, BindingActionType::Macro, label);
+        binding.macro.stepCount = static_cast<uint8_t>(steps.size());
+        binding.macro.cancelOnRelease = cancelOnRelease;
+        for (size_t i = 0; i < steps.size() && i < MacroDefinition::MAX_STEPS; ++i)
+        {
+            binding.macro.steps[i] = steps.begin()[i];
+        }
+        return binding;
+    }
+
+    static constexpr StaticBinding Gesture(uint16_t button, const GestureDefinition& gesture, const char* label = "")
+    {
+        StaticBinding binding = Create(button, BindingActionType::Gesture, label);
+        binding.gesture = gesture;
+        return binding;
+    }
+
+private:
+    static constexpr StaticBinding Create(uint16_t button, BindingActionType type, const char* label)
+    {
+        StaticBinding binding = {};
+        binding.button = button;
+        binding.type = type;
+        binding.label = label;
+        return binding;
+    }
+};
+
+/**
+ * Compile-time lookups over a StaticBinding array, and the checks behind the
+ * static_asserts of StaticProfile (the rules ProfileCompiler enforces on text)
+ */
+namespace StaticBindings
+{
+    // Mask of the buttons bound to one kind of action
+    constexpr uint32_t MaskOf(const StaticBinding* bindings, size_t count, BindingActionType type)
+    {
+        uint32_t mask = 0;
+        for (size_t i = 0; i < count; ++i)
+        {
+            mask |= (bindings[i].type == type) ? bindings[i].button : 0u;
+        }
+        return mask;
+    }
+
+    // Index of the binding of a button bit, or -1
+    constexpr int Find(const StaticBinding* bindings, size_t count, size_t bit)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (bindings[i].button == (1u << bit))
+            {
+                return static_cast<int>(i);
+            }
+        }
+        return -1;
+    }
+
+    constexpr bool IsSingleButton(uint16_t button)
+    {
+        return button != 0 && (button & (button - 1)) == 0;
+    }
+
+    // A Win32 virtual-key code (1 to 254)
+    constexpr bool IsKey(uint16_t code)
+    {
+        return code >= 0x01 && code <= 0xFE;
+    }
+
+    constexpr bool IsStep(const MacroStep& step)
+    {
+        return step.type == MacroOutputType::Key ? IsKey(step.code) : step.code <= MouseButton::Middle;
+    }
+
+    constexpr bool ButtonsAreSingle(const StaticBinding* bindings, size_t count)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (!IsSingleButton(bindings[i].button))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    constexpr bool ButtonsAreUnique(const StaticBinding* bindings, size_t count)
+    {
+        uint32_t seen = 0;
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (seen & bindings[i].button)
+            {
+                return false;
+            }
+            seen |= bindings[i].button;
+        }
+        return true;
+    }
+
+    constexpr bool OutputsAreKnown(const StaticBinding* bindings, size_t count)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            const StaticBinding& binding = bindings[i];
+            switch (binding.type)
+            {
+            case BindingActionType::Key:
+            case BindingActionType::KeySequence:
+                for (int k = 0; k < binding.count; ++k)
+                {
+                    if (!IsKey(binding.codes[k]))
+                    {
+                        return false;
+                    }
+                }
+                break;
+            case BindingActionType::MouseButton:
+                if (binding.codes[0] > MouseButton::Middle)
+                {
+                    return false;
+                }
+                break;
+            case BindingActionType::Macro:
+                for (int step = 0; step < binding.macro.stepCount; ++step)
+                {
+                    if (!IsStep(binding.macro.steps[step]))
+                    {
+                        return false;
+                    }
+                }
+                break;
+            case BindingActionType::Gesture:
+                for (int kind = 0; kind < GestureDefinition::KIND_COUNT; ++kind)
+                {
+                    if (binding.gesture.Has(static_cast<GestureKind>(kind)) && !IsStep(binding.gesture.actions[kind]))
+                    {
+                        return false;
+                    }
+                }
+                break;
+            case BindingActionType::None:
+                return false;
+            }
+        }
+        return true;
+    }
+
+    constexpr bool SizesAreValid(const StaticBinding* bindings, size_t count)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            const StaticBinding& binding = bindings[i];
+            if (binding.type == BindingActionType::KeySequence &&
+                (binding.count == 0 || binding.count > BindingAction::MAX_SEQUENCE_KEYS))
+            {
+                return false;
+            }
+            if (binding.type == BindingActionType::Macro &&
+                (binding.macro.stepCount == 0 || binding.macro.stepCount > MacroDefinition::MAX_STEPS))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    constexpr bool GestureWindowsAreValid(const StaticBinding* bindings, size_t count)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            const GestureDefinition& gesture = bindings[i].gesture;
+            if (bindings[i].type != BindingActionType::Gesture)
+            {
+                continue;
+            }
+            if (gesture.boundMask == 0 ||
+                (gesture.Has(GestureKind::DoubleTap) && gesture.doubleTapMs == 0) ||
+                (gesture.Has(GestureKind::LongPress) && gesture.longPressMs <= gesture.holdMs))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    constexpr bool AnalogKeysAreKnown(const uint16_t* keys)
+    {
+        for (int i = 0; i < Profile::ANALOG_KEY_COUNT; ++i)
+        {
+            if (keys[i] != 0 && !IsKey(keys[i]))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    constexpr bool ThresholdsAreValid(const ThresholdSettings& settings, int32_t maximum)
+    {
+        return settings.pressThreshold > 0 && settings.pressThreshold <= maximum &&
+               settings.releaseThreshold >= 0 && settings.releaseThreshold <= settings.pressThreshold;
+    }
+}
+
+/**
+ * StaticProfile - A built-in profile compiled into a specialized button stage
+ *
+ * Definition is a struct of constexpr members: NAME, BUTTONS (StaticBinding
+ * array), ANALOG_KEYS and ANALOG_LABELS (per AnalogKey), STICK_THRESHOLDS and
+ * TRIGGER_THRESHOLDS. An invalid definition (a button bound twice, an
+ * unknown key, a gesture without its window...) fails to compile.
+ *
+ * The stage functions are unrolled over the 16 button bits at compile time:
+ * every held Key/MouseButton binding becomes a branch-free shift-and-or into
+ * the desired state, binding kinds the profile does not use generate no code,
+ * and nothing is looked up in a table. They run in bit order, like the
+ * BindingTable path of Mapper, so both produce the same events. Build()
+ * gives the same profile as data, for the banner, the gesture recognizer
+ * and the stick and trigger stages.
+ */
+template <typename Definition>
+class StaticProfile
+{
+public:
+    static constexpr size_t BINDING_COUNT = sizeof(Definition::BUTTONS) / sizeof(Definition::BUTTONS[0]);
+
+    static_assert(StaticBindings::ButtonsAreSingle(Definition::BUTTONS, BINDING_COUNT), "each binding needs exactly one button");
+    static_assert(StaticBindings::ButtonsAreUnique(Definition::BUTTONS, BINDING_COUNT), "a button is bound twice");
+    static_assert(StaticBindings::OutputsAreKnown(Definition::BUTTONS, BINDING_COUNT), "unknown key or mouse button");
+    static_assert(StaticBindings::SizesAreValid(Definition::BUTTONS, BINDING_COUNT), "empty or too long sequence or macro");
+    static_assert(StaticBindings::GestureWindowsAreValid(Definition::BUTTONS, BINDING_COUNT), "gesture without an action or its timing window");
+    static_assert(StaticBindings::AnalogKeysAreKnown(Definition::ANALOG_KEYS), "unknown stick or trigger key");
+    static_assert(StaticBindings::ThresholdsAreValid(Definition::STICK_THRESHOLDS, 32767), "bad stick thresholds");
+    static_assert(StaticBindings::ThresholdsAreValid(Definition::TRIGGER_THRESHOLDS, 255), "bad trigger thresholds");
+
+    static constexpr uint32_t GESTURE_MASK =
+        StaticBindings::MaskOf(Definition::BUTTONS, BINDING_COUNT, BindingActionType::Gesture);
+
+    /**
+     * Held bindings: set the key or mouse button of every bound button that is down
+     */
+    static void ApplyHeld(uint32_t buttons, OutputState& desired)
+    {
+        ApplyHeld(buttons, desired, std::make_index_sequence<PadButton::COUNT>());
+    }
+
+    /**
+     * Sequence bindings: queue their taps on the press edge
+     */
+    static void ApplySequences(uint32_t pressed, OutputState& desired)
+    {
+        ApplySequences(pressed, desired, std::make_index_sequence<PadButton::COUNT>());
+    }
+
+    /**
+     * Macro bindings: start on the press edge, cancel on the release edge if they ask for it
+     */
+    static void ApplyMacros(uint32_t pressed, uint32_t released, MacroPlayer& macros, uint64_t timestampNs)
+    {
+        StartMacros(pressed, macros, timestampNs, std::make_index_sequence<PadButton::COUNT>());
+        CancelMacros(released, macros, std::make_index_sequence<PadButton::COUNT>());
+    }
+
+    /**
+     * The same profile as data
+     */
+    static Profile Build()
+    {
+        Profile profile = Profile::CreateEmpty();
+        std::snprintf(profile.name, sizeof(profile.name), "%s", Definition::NAME);
+        profile.buttons = BuildBindings();
+        profile.stickThresholds = Definition::STICK_THRESHOLDS;
+        profile.triggerThresholds = Definition::TRIGGER_THRESHOLDS;
+        for (int key = 0; key < Profile::ANALOG_KEY_COUNT; ++key)
+        {
+            profile.analogKeys[key] = Definition::ANALOG_KEYS[key];
+            Profile::SetLabel(profile.analogLabels[key], Definition::ANALOG_LABELS[key]);
+        }
+        for (const StaticBinding& binding : Definition::BUTTONS)
+        {
+            Profile::SetLabel(profile.buttonLabels[BindingTable::ButtonToBitIndex(binding.button)], binding.label);
+        }
+        return profile;
+    }
+
+    /**
+     * The button bindings as a BindingTable
+     */
+    static BindingTable BuildBindings()
+    {
+        BindingTable table;
+        for (const StaticBinding& binding : Definition::BUTTONS)
+        {
+            switch (binding.type)
+            {
+            case BindingActionType::Key:
+                table.BindKey(binding.button, binding.codes[0]);
+                break;
+            case BindingActionType::MouseButton:
+                table.BindMouseButton(binding.button, binding.codes[0]);
+                break;
+            case BindingActionType::KeySequence:
+                table.BindKeySequence(binding.button, binding.codes, binding.count);
+                break;
+            case BindingActionType::Macro:
+                table.BindMacro(binding.button, binding.macro);
+                break;
+            case BindingActionType::Gesture:
+                table.BindGesture(binding.button, binding.gesture);
+                break;
+            case BindingActionType::None:
+                break;
+            }
+        }
+        return table;
+    }
+
+private:
+    static constexpr int Find(size_t bit)
+    {
+        return StaticBindings::Find(Definition::BUTTONS, BINDING_COUNT, bit);
+    }
+
+    static constexpr bool Is(size_t bit, BindingActionType type)
+    {
+        return Find(bit) >= 0 && Definition::BUTTONS[Find(bit)].type == type;
+    }
+
+    template <size_t... Bits>
+    static void ApplyHeld(uint32_t buttons, OutputState& desired, std::index_sequence<Bits...>)
+    {
+        (ApplyHeldBit<Bits>(buttons, desired), ...);
+    }
+
+    template <size_t Bit>
+    static void ApplyHeldBit(uint32_t buttons, OutputState& desired)
+    {
+        if constexpr (Is(Bit, BindingActionType::Key))
+        {
+            constexpr uint16_t code = Definition::BUTTONS[Find(Bit)].codes[0];
+            desired.keys[(code >> 6) & 3] |= static_cast<uint64_t>((buttons >> Bit) & 1u) << (code & 63);
+        }
+        else if constexpr (Is(Bit, BindingActionType::MouseButton))
+        {
+            constexpr uint16_t button = Definition::BUTTONS[Find(Bit)].codes[0];
+            desired.mouseButtons |= static_cast<uint8_t>(((buttons >> Bit) & 1u) << button);
+        }
+    }
+
+    template <size_t... Bits>
+    static void ApplySequences(uint32_t pressed, OutputState& desired, std::index_sequence<Bits...>)
+    {
+        (ApplySequenceBit<Bits>(pressed, desired), ...);
+    }
+
+    template <size_t Bit>
+    static void ApplySequenceBit(uint32_t pressed, OutputState& desired)
+    {
+        if constexpr (Is(Bit, BindingActionType::KeySequence))
+        {
+            if (pressed & (1u << Bit))
+            {
+                constexpr StaticBinding binding = Definition::BUTTONS[Find(Bit)];
+                for (int i = 0; i < binding.count; ++i)
+                {
+                    desired.AddTap(binding.codes[i]);
+                }
+            }
+        }
+    }
+
+    template <size_t... Bits>
+    static void StartMacros(uint32_t pressed, MacroPlayer& macros, uint64_t timestampNs, std::index_sequence<Bits...>)
+    {
+        (StartMacroBit<Bits>(pressed, macros, timestampNs), ...);
+    }
+
+    template <size_t Bit>
+    static void StartMacroBit(uint32_t pressed, MacroPlayer& macros, uint64_t timestampNs)
+    {
+        if constexpr (Is(Bit, BindingActionType::Macro))
+        {
+            if (pressed & (1u << Bit))
+            {
+                macros.Start(static_cast<int>(Bit), Definition::BUTTONS[Find(Bit)].macro, timestampNs);
+            }
+        }
+    }
+
+    template <size_t... Bits>
+    static void CancelMacros(uint32_t released, MacroPlayer& macros, std::index_sequence<Bits...>)
+    {
+        (CancelMacroBit<Bits>(released, macros), ...);
+    }
+
+    template <size_t Bit>
+    static void CancelMacroBit(uint32_t released, MacroPlayer& macros)
+    {
+        if constexpr (Is(Bit, BindingActionType::Macro))
+        {
+            if constexpr (Definition::BUTTONS[Find(Bit)].macro.cancelOnRelease)
+            {
+                if (released & (1u << Bit))
+                {
+                    macros.Cancel(static_cast<int>(Bit));
+                }
+            }
+        }
+    }
+};
@@ -0,0 +1,114 @@
+#include "StickProcessor.h"
+#include <cmath>
+
+namespace
+{
+    /**
+     * Output length for a raw stick length, following the settings exactly
+     * @return Shaped length (0 to OUTPUT_MAX)
+     */
+    double ShapeMagnitude(const StickSettings& settings, double magnitude)
+    {
+        double inner = settings.innerDeadZone;
+        double outer = (settings.outerDeadZone > settings.innerDeadZone) ? settings.outerDeadZone : inner + 1.0;
+        if (magnitude <= inner)
+        {
+            return 0.0;
+        }
+
+        double t = (magnitude >= outer) ? 1.0 : (magnitude - inner) / (outer - inner);
+        return settings.Evaluate(static_cast<float>(t)) * static_cast<double>(StickProcessor::OUTPUT_MAX);
+    }
+}
+
+StickSettings StickSettings::Default()
+{
+    StickSettings settings = {};
+    settings.innerDeadZone = 7849;  // ~24% (XINPUT_GAMEPAD_LEFT_THUMB_DEADZONE)
+    settings.outerDeadZone = 32767;
+    settings.curve = ResponseCurve::Linear;
+    settings.exponent = 1.0f;
+    settings.pointCount = 0;
+    return settings;
+}
+
+float StickSettings::Evaluate(float t) const
+{
+    if (t <= 0.0f)
+    {
+        return 0.0f;
+    }
+    if (t >= 1.0f)
+    {
+        return 1.0f;
+    }
+
+    switch (curve)
+    {
+    case ResponseCurve::Power:
+        return std::pow(t, exponent);
+
+    case ResponseCurve::SCurve:
+    {
+        float rising = std::pow(t, exponent);
+        return rising / (rising + std::pow(1.0f - t, exponent));
+    }
+
+    case ResponseCurve::Custom:
+    {
+        // Walk the segments, with (0,0) and (1,1) as the implied end points
+        float x0 = 0.0f;
+        float y0 = 0.0f;
+        int count = (pointCount > MAX_CURVE_POINTS) ? MAX_CURVE_POINTS : pointCount;
+        for (int i = 0; i <= count; ++i)
+        {
+            float x1 = (i < count) ? pointsX[i] : 1.0f;
+            float y1 = (i < count) ? pointsY[i] : 1.0f;
+            if (t <= x1)
+            {
+                return (x1 > x0) ? y0 + (y1 - y0) * (t - x0) / (x1 - x0) : y1;
+            }
+            x0 = x1;
+            y0 = y1;
+        }
+        return 1.0f;
+    }
+
+    case ResponseCurve::Linear:
+    default:
+        return t;
+    }
+}
+
+StickProcessor::StickProcessor()
+{
+    Configure(StickSettings::Default());
+}
+
+void StickProcessor::Configure(const StickSettings& settings)
+{
+    m_settings = settings;
+
+    // Each bucket takes the gain at its middle; bucket 0 is always inside any sensible dead zone
+    for (int i = 0; i < TABLE_SIZE; ++i)
+    {
+        double magnitude = std::sqrt((static_cast<double>(i) + 0.5) * static_cast<double>(1u << INDEX_SHIFT));
+        double gain = ShapeMagnitude(settings, magnitude) / magnitude;
+        m_gain[i] = static_cast<uint32_t>(gain * static_cast<double>(1 << GAIN_SHIFT) + 0.5);
+    }
+}
+
+void StickProcessor::ProcessReference(const StickSettings& settings, int16_t x, int16_t y, float& outX, float& outY)
+{
+    double magnitude = std::sqrt(static_cast<double>(x) * x + static_cast<double>(y) * y);
+    if (magnitude <= 0.0)
+    {
+        outX = 0.0f;
+        outY = 0.0f;
+        return;
+    }
+
+    double scale = ShapeMagnitude(settings, magnitude) / magnitude;
+    outX = static_cast<float>(x * scale);
+    outY = static_cast<float>(y * scale);
+}
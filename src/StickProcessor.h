@@ -0,0 +1,112 @@
+#pragma once
+
+#include <cstdint>
+
+/**
+ * Response curve applied to the stick magnitude between the dead zones
+ */
+enum class ResponseCurve : uint8_t
+{
+    Linear,     // output = input
+    Power,      // output = input^exponent (> 1: finer control near the center)
+    SCurve,     // output = t^e / (t^e + (1 - t)^e): slow at both ends, fast in the middle
+    Custom      // Piecewise linear through the given points
+};
+
+/**
+ * StickSettings - How one analog stick is shaped
+ *
+ * Dead zones are radial, in raw stick units: below innerDeadZone the stick
+ * reads zero, from outerDeadZone on it reads full deflection, and the range
+ * in between is rescaled to 0..1 and passed through the response curve.
+ */
+struct StickSettings
+{
+    static const int MAX_CURVE_POINTS = 8;
+
+    int16_t innerDeadZone;
+    int16_t outerDeadZone;
+    ResponseCurve curve;
+    float exponent;                         // Power and SCurve
+    uint8_t pointCount;                     // Custom: points between the implied (0,0) and (1,1)
+    float pointsX[MAX_CURVE_POINTS];        // Custom: ascending inputs in (0, 1)
+    float pointsY[MAX_CURVE_POINTS];        // Custom: outputs in [0, 1]
+
+    /**
+     * Settings matching the original mapper: ~24% dead zone, linear response
+     */
+    static StickSettings Default();
+
+    /**
+     * Evaluate the response curve (the float reference the lookup table is baked from)
+     * @param t Normalized magnitude between the dead zones (0 to 1)
+     * @return Normalized output magnitude (0 to 1)
+     */
+    float Evaluate(float t) const;
+};
+
+/**
+ * StickProcessor - Radial dead zone and response curve as a baked lookup table
+ *
+ * Configure() bakes the settings into a fixed-point gain table indexed by the
+ * squared stick magnitude (no square root per frame). Process() then costs
+ * one table lookup and a couple of integer multiplies per stick; the stick
+ * direction is kept and only its length is reshaped.
+ */
+class StickProcessor
+{
+public:
+    // 4096 buckets over the squared magnitude (0 to 2 * 32768^2): about 33 raw
+    // units wide at the default dead zone, finer further out
+    static const int INDEX_SHIFT = 19;
+    static const int TABLE_SIZE = (1 << (31 - INDEX_SHIFT)) + 1;
+    static const int GAIN_SHIFT = 16;
+    static const int32_t OUTPUT_MAX = 32767;
+
+    StickProcessor();
+
+    /**
+     * Bake new settings into the lookup table (profile load, not per frame)
+     */
+    void Configure(const StickSettings& settings);
+
+    /**
+     * Get the settings the table was baked from
+     */
+    const StickSettings& GetSettings() const { return m_settings; }
+
+    /**
+     * Get the baked gain table (TABLE_SIZE entries, Q16), for batched kernels
+     */
+    const uint32_t* GetGainTable() const { return m_gain; }
+
+    /**
+     * Shape a raw stick position
+     * @param x, y Raw stick axes (-32768 to 32767)
+     * @param outX, outY Shaped axes (-32767 to 32767), 0 inside the dead zone
+     */
+    void Process(int16_t x, int16_t y, int16_t& outX, int16_t& outY) const
+    {
+        uint32_t squared = static_cast<uint32_t>(static_cast<int32_t>(x) * x) +
+                           static_cast<uint32_t>(static_cast<int32_t>(y) * y);
+        int64_t gain = m_gain[squared >> INDEX_SHIFT];
+
+        // Division (not shift) truncates toward zero, so both directions scale the same
+        outX = Clamp(static_cast<int32_t>((x * gain) / (1 << GAIN_SHIFT)));
+        outY = Clamp(static_cast<int32_t>((y * gain) / (1 << GAIN_SHIFT)));
+    }
+
+    /**
+     * Reference implementation: the same shaping in floating point with an exact magnitude
+     */
+    static void ProcessReference(const StickSettings& settings, int16_t x, int16_t y, float& outX, float& outY);
+
+private:
+    static int16_t Clamp(int32_t value)
+    {
+        return static_cast<int16_t>(value > OUTPUT_MAX ? OUTPUT_MAX : (value < -OUTPUT_MAX ? -OUTPUT_MAX : value));
+    }
+
+    StickSettings m_settings;
+    uint32_t m_gain[TABLE_SIZE];    // Output length / input length, Q16
+};
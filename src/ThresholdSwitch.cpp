@@ -0,0 +1,85 @@
+#include "ThresholdSwitch.h"
+
+ThresholdSettings ThresholdSettings::DefaultStick()
+{
+    // Press where the original mapper did (twice the dead zone on one axis),
+    // release 20% lower; no hold time, so releases are not delayed
+    ThresholdSettings settings = {};
+    settings.pressThreshold = 10322;
+    settings.releaseThreshold = 8258;
+    settings.minHoldNs = 0;
+    return settings;
+}
+
+ThresholdSettings ThresholdSettings::DefaultTrigger()
+{
+    // Press at 50% as before, release at 37.5%
+    ThresholdSettings settings = {};
+    settings.pressThreshold = 128;
+    settings.releaseThreshold = 96;
+    settings.minHoldNs = 0;
+    return settings;
+}
+
+ThresholdSwitch::ThresholdSwitch()
+    : m_settings(ThresholdSettings::DefaultStick())
+    , m_on(false)
+    , m_pending(false)
+    , m_plainOn(false)
+    , m_changed(false)
+    , m_changedNs(0)
+    , m_suppressedCount(0)
+{
+}
+
+void ThresholdSwitch::Configure(const ThresholdSettings& settings)
+{
+    m_settings = settings;
+    if (m_settings.releaseThreshold > m_settings.pressThreshold)
+    {
+        m_settings.releaseThreshold = m_settings.pressThreshold;
+    }
+}
+
+bool ThresholdSwitch::Update(int32_t value, uint64_t timestampNs)
+{
+    bool wanted = m_on ? (value > m_settings.releaseThreshold) : (value > m_settings.pressThreshold);
+
+    m_pending = false;
+    if (wanted != m_on)
+    {
+        // A timestamp before the last change (snapshot raced the frame) counts as no time held
+        bool held = !m_changed || m_settings.minHoldNs == 0 ||
+                    (timestampNs > m_changedNs && timestampNs - m_changedNs >= m_settings.minHoldNs);
+        if (held)
+        {
+            m_on = wanted;
+            m_changed = true;
+            m_changedNs = timestampNs;
+        }
+        else
+        {
+            m_pending = true;
+        }
+    }
+
+    bool plainOn = value > m_settings.pressThreshold;
+    if (plainOn != m_plainOn)
+    {
+        m_plainOn = plainOn;
+        if (plainOn != m_on)
+        {
+            ++m_suppressedCount;
+        }
+    }
+
+    return m_on;
+}
+
+void ThresholdSwitch::Reset()
+{
+    m_on = false;
+    m_pending = false;
+    m_plainOn = false;
+    m_changed = false;
+}
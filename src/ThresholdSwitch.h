@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cstdint>
+
+/**
+ * ThresholdSettings - When an analog value counts as a pressed key
+ *
+ * The switch turns on above pressThreshold and off again only at or below
+ * releaseThreshold, so a value resting near the boundary does not flip it
+ * every frame. With pressThreshold == releaseThreshold it is a plain
+ * "value > threshold" comparison.
+ */
+struct ThresholdSettings
+{
+    int32_t pressThreshold;     // Turns on when the value is above this
+    int32_t releaseThreshold;   // Turns off when the value is at or below this (<= pressThreshold)
+    uint64_t minHoldNs;         // Minimum time between two changes of the output (0 = none)
+
+    /**
+     * Left-stick movement keys (shaped axis, -32767 to 32767)
+     */
+    static ThresholdSettings DefaultStick();
+
+    /**
+     * Triggers (raw value, 0 to 255)
+     */
+    static ThresholdSettings DefaultTrigger();
+};
+
+/**
+ * ThresholdSwitch - Analog-to-digital switch with hysteresis and a minimum hold time
+ *
+ * Counts suppressed transitions: changes of a plain single threshold at the
+ * press level that the switch did not follow when they happened (inside the
+ * hysteresis band, or too soon after the previous change).
+ */
+class ThresholdSwitch
+{
+public:
+    ThresholdSwitch();
+
+    /**
+     * Replace the thresholds; the current output is kept
+     */
+    void Configure(const ThresholdSettings& settings);
+
+    /**
+     * Get the current thresholds
+     */
+    const ThresholdSettings& GetSettings() const { return m_settings; }
+
+    /**
+     * Feed the current value
+     * @param value Analog value in the units of the thresholds
+     * @param timestampNs Time of the value (monotonic)
+     * @return True if the switch is on
+     */
+    bool Update(int32_t value, uint64_t timestampNs);
+
+    /**
+     * Check if the switch is on
+     */
+    bool IsOn() const { return m_on; }
+
+    /**
+     * Check if a change the value asks for is waiting for the minimum hold time
+     * The owner must keep calling Update() (even without new values) until it clears.
+     */
+    bool IsPending() const { return m_pending; }
+
+    /**
+     * Turn the switch off without a hold time (outputs released, pad lost)
+     */
+    void Reset();
+
+    /**
+     * Get the number of suppressed transitions since construction
+     */
+    uint64_t GetSuppressedCount() const { return m_suppressedCount; }
+
+private:
+    ThresholdSettings m_settings;
+    bool m_on;
+    bool m_pending;
+    bool m_plainOn;             // What a single threshold at pressThreshold would say
+    bool m_changed;             // m_changedNs is valid
+    uint64_t m_changedNs;       // Time of the last output change
+    uint64_t m_suppressedCount;
+};
@@ -0,0 +1,180 @@
+#include "TimerWheel.h"
+
+namespace
+{
+    // Ticks covered by all levels together; later due times wait in the top level
+    const uint64_t WHEEL_RANGE = 1ULL << (TimerWheel::SLOT_BITS * TimerWheel::LEVELS);
+}
+
+TimerWheel::TimerWheel(uint64_t tickNs)
+    : m_tickNs(tickNs > 0 ? tickNs : 1)
+    , m_nextTick(0)
+    , m_pendingCount(0)
+{
+    for (int i = 0; i < MAX_TIMERS; ++i)
+    {
+        m_nodes[i].generation = 0;
+    }
+    Clear();
+}
+
+void TimerWheel::Clear()
+{
+    for (int16_t& head : m_heads)
+    {
+        head = NO_NODE;
+    }
+    for (int i = 0; i < MAX_TIMERS; ++i)
+    {
+        ++m_nodes[i].generation;
+        m_nodes[i].list = NO_NODE;
+        Link(i, FREE_LIST);
+    }
+    m_pendingCount = 0;
+}
+
+uint32_t TimerWheel::Schedule(uint64_t dueNs, uint32_t cookie)
+{
+    int node = m_heads[FREE_LIST];
+    if (node == NO_NODE)
+    {
+        return INVALID_TIMER;
+    }
+
+    // Round up: a timer must not fire before its due time
+    uint64_t dueTick = dueNs / m_tickNs + ((dueNs % m_tickNs) != 0 ? 1 : 0);
+
+    Unlink(node);
+    m_nodes[node].dueTick = (dueTick < m_nextTick) ? m_nextTick : dueTick;
+    m_nodes[node].cookie = cookie;
+    Insert(node);
+    ++m_pendingCount;
+    return (static_cast<uint32_t>(m_nodes[node].generation) << 16) | static_cast<uint32_t>(node);
+}
+
+void TimerWheel::Cancel(uint32_t timer)
+{
+    int node = NodeFromHandle(timer);
+    if (node != NO_NODE)
+    {
+        Release(node);
+    }
+}
+
+bool TimerWheel::IsPending(uint32_t timer) const
+{
+    return NodeFromHandle(timer) != NO_NODE;
+}
+
+int TimerWheel::NodeFromHandle(uint32_t timer) const
+{
+    if (timer == INVALID_TIMER)
+    {
+        return NO_NODE;
+    }
+
+    int node = static_cast<int>(timer & 0xFFFFu);
+    if (node >= MAX_TIMERS || m_nodes[node].generation != (timer >> 16) || m_nodes[node].list == FREE_LIST)
+    {
+        return NO_NODE;
+    }
+    return node;
+}
+
+void TimerWheel::Insert(int node)
+{
+    uint64_t dueTick = m_nodes[node].dueTick;
+    uint64_t delta = dueTick - m_nextTick;
+    if (delta >= WHEEL_RANGE)
+    {
+        // Parked at the far end of the wheel; re-inserted when it comes round
+        delta = WHEEL_RANGE - 1;
+        dueTick = m_nextTick + delta;
+    }
+
+    int level = 0;
+    while (level < LEVELS - 1 && delta >= (1ULL << (SLOT_BITS * (level + 1))))
+    {
+        ++level;
+    }
+    int slot = static_cast<int>((dueTick >> (SLOT_BITS * level)) & (SLOTS - 1));
+    Link(node, level * SLOTS + slot);
+}
+
+void TimerWheel::Cascade(uint64_t tick)
+{
+    // Each level's slot moves down when the level below wraps; stop at the first level that did not wrap
+    for (int level = 1; level < LEVELS; ++level)
+    {
+        int slot = static_cast<int>((tick >> (SLOT_BITS * level)) & (SLOTS - 1));
+        int list = level * SLOTS + slot;
+        while (m_heads[list] != NO_NODE)
+        {
+            int node = m_heads[list];
+            Unlink(node);
+            Insert(node);
+        }
+        if (slot != 0)
+        {
+            break;
+        }
+    }
+}
+
+void TimerWheel::MoveList(int from, int to)
+{
+    while (m_heads[from] != NO_NODE)
+    {
+        int node = m_heads[from];
+        Unlink(node);
+
+        // A timer parked beyond the wheel range is not due yet: back into the wheel
+        if (m_nodes[node].dueTick >= m_nextTick)
+        {
+            Insert(node);
+        }
+        else
+        {
+            Link(node, to);
+        }
+    }
+}
+
+void TimerWheel::Link(int node, int list)
+{
+    Node& entry = m_nodes[node];
+    entry.list = static_cast<int16_t>(list);
+    entry.previous = NO_NODE;
+    entry.next = m_heads[list];
+    if (entry.next != NO_NODE)
+    {
+        m_nodes[entry.next].previous = static_cast<int16_t>(node);
+    }
+    m_heads[list] = static_cast<int16_t>(node);
+}
+
+void TimerWheel::Unlink(int node)
+{
+    Node& entry = m_nodes[node];
+    if (entry.previous != NO_NODE)
+    {
+        m_nodes[entry.previous].next = entry.next;
+    }
+    else
+    {
+        m_heads[entry.list] = entry.next;
+    }
+    if (entry.next != NO_NODE)
+    {
+        m_nodes[entry.next].previous = entry.previous;
+    }
+    entry.list = NO_NODE;
+}
+
+void TimerWheel::Release(int node)
+{
+    Unlink(node);
+    ++m_nodes[node].generation;
+    Link(node, FREE_LIST);
+    --m_pendingCount;
+}
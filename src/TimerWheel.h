@@ -0,0 +1,141 @@
+#pragma once
+
+#include <cstdint>
+
+/**
+ * TimerWheel - Hierarchical timing wheel for one-shot timers (fixed pool, no heap)
+ *
+ * Four levels of 64 slots: level 0 holds timers due within 64 ticks, each
+ * further level covers 64 times the range of the one below. Advance() visits
+ * every tick up to now; a tick costs one slot and, every 64 ticks, moving
+ * one slot of the level above down (cascading). Scheduling and cancelling
+ * are O(1) list operations. With nothing scheduled, Advance() jumps straight
+ * to now, so an idle wheel costs nothing.
+ *
+ * Timers never fire early: a timer due at t fires on the first Advance(now)
+ * with now >= t, at tick resolution.
+ */
+class TimerWheel
+{
+public:
+    static const int MAX_TIMERS = 64;
+    static const uint32_t INVALID_TIMER = 0xFFFFFFFFu;
+
+    static const int SLOT_BITS = 6;
+    static const int SLOTS = 1 << SLOT_BITS;
+    static const int LEVELS = 4;
+
+    /**
+     * @param tickNs Resolution of the wheel in nanoseconds
+     */
+    explicit TimerWheel(uint64_t tickNs);
+
+    /**
+     * Cancel every timer
+     */
+    void Clear();
+
+    /**
+     * Schedule a timer
+     * @param dueNs Time at which the timer fires (a time already passed fires on the next tick)
+     * @param cookie Value passed to the expiry callback
+     * @return Timer handle, or INVALID_TIMER if all MAX_TIMERS are in use
+     */
+    uint32_t Schedule(uint64_t dueNs, uint32_t cookie);
+
+    /**
+     * Cancel a timer (no effect if it already fired or was cancelled)
+     */
+    void Cancel(uint32_t timer);
+
+    /**
+     * Check if a timer is still waiting to fire
+     */
+    bool IsPending(uint32_t timer) const;
+
+    /**
+     * Get the number of scheduled timers
+     */
+    int GetPendingCount() const { return m_pendingCount; }
+
+    /**
+     * Get the wheel resolution
+     */
+    uint64_t GetTickNanoseconds() const { return m_tickNs; }
+
+    /**
+     * Fire every timer due up to now, in tick order
+     * The callback may schedule and cancel timers; new timers fire on later ticks.
+     * @param nowNs Current time (a time before the last Advance() does nothing)
+     * @param onExpire Called as onExpire(cookie) for each expired timer
+     */
+    template <typename Callback>
+    void Advance(uint64_t nowNs, Callback&& onExpire)
+    {
+        uint64_t nowTick = nowNs / m_tickNs;
+        if (m_pendingCount == 0)
+        {
+            if (nowTick >= m_nextTick)
+            {
+                m_nextTick = nowTick + 1;
+            }
+            return;
+        }
+
+        while (m_nextTick <= nowTick)
+        {
+            uint64_t tick = m_nextTick;
+            int index = static_cast<int>(tick & (SLOTS - 1));
+            if (index == 0)
+            {
+                Cascade(tick);
+            }
+            ++m_nextTick;
+
+            // Detach the slot first: callbacks may schedule or cancel while it drains
+            MoveList(index, EXPIRING_LIST);
+            while (m_heads[EXPIRING_LIST] != NO_NODE)
+            {
+                int node = m_heads[EXPIRING_LIST];
+                uint32_t cookie = m_nodes[node].cookie;
+                Release(node);
+                onExpire(cookie);
+            }
+
+            if (m_pendingCount == 0)
+            {
+                m_nextTick = nowTick + 1;
+            }
+        }
+    }
+
+private:
+    static const int16_t NO_NODE = -1;
+    static const int LIST_COUNT = LEVELS * SLOTS;
+    static const int EXPIRING_LIST = LIST_COUNT;    // Timers of the tick being fired
+    static const int FREE_LIST = LIST_COUNT + 1;
+
+    struct Node
+    {
+        uint64_t dueTick;
+        uint32_t cookie;
+        uint16_t generation;    // Bumped on release, so stale handles do nothing
+        int16_t list;           // List the node is on
+        int16_t previous;
+        int16_t next;
+    };
+
+    void Insert(int node);
+    void Cascade(uint64_t tick);
+    void MoveList(int from, int to);
+    void Link(int node, int list);
+    void Unlink(int node);
+    void Release(int node);
+    int NodeFromHandle(uint32_t timer) const;
+
+    uint64_t m_tickNs;
+    uint64_t m_nextTick;        // First tick not yet fired
+    int m_pendingCount;
+    int16_t m_heads[LIST_COUNT + 2];
+    Node m_nodes[MAX_TIMERS];
+};
@@ -0,0 +1,144 @@
+#include "TraceReader.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+TraceReader::TraceReader()
+    : m_data(nullptr)
+    , m_size(0)
+    , m_records(nullptr)
+    , m_recordCount(0)
+#ifdef _WIN32
+    , m_file(INVALID_HANDLE_VALUE)
+    , m_mapping(nullptr)
+#else
+    , m_fd(-1)
+#endif
+{
+}
+
+TraceReader::~TraceReader()
+{
+    Close();
+}
+
+bool TraceReader::Open(const char* path)
+{
+    Close();
+
+    if (!Map(path))
+    {
+        Close();
+        return false;
+    }
+
+    if (!PadTrace::IsValidHeader(GetHeader()))
+    {
+        Close();
+        return false;
+    }
+
+    m_records = reinterpret_cast<const PadTrace::Record*>(m_data + sizeof(PadTrace::Header));
+    m_recordCount = (m_size - sizeof(PadTrace::Header)) / sizeof(PadTrace::Record);
+    return true;
+}
+
+#ifdef _WIN32
+
+bool TraceReader::Map(const char* path)
+{
+    m_file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                         FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (m_file == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(m_file, &size) || size.QuadPart < static_cast<LONGLONG>(sizeof(PadTrace::Header)))
+    {
+        return false;
+    }
+    m_size = static_cast<size_t>(size.QuadPart);
+
+    m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!m_mapping)
+    {
+        return false;
+    }
+
+    m_data = static_cast<const unsigned char*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+    return m_data != nullptr;
+}
+
+#else
+
+bool TraceReader::Map(const char* path)
+{
+    m_fd = open(path, O_RDONLY);
+    if (m_fd < 0)
+    {
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(m_fd, &info) != 0 || info.st_size < static_cast<off_t>(sizeof(PadTrace::Header)))
+    {
+        return false;
+    }
+    m_size = static_cast<size_t>(info.st_size);
+
+    void* data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, m_fd, 0);
+    if (data == MAP_FAILED)
+    {
+        return false;
+    }
+    m_data = static_cast<const unsigned char*>(data);
+
+    // Replay walks the records front to back
+    madvise(data, m_size, MADV_SEQUENTIAL);
+    return true;
+}
+
+#endif
+
+void TraceReader::Close()
+{
+#ifdef _WIN32
+    if (m_data)
+    {
+        UnmapViewOfFile(m_data);
+    }
+    if (m_mapping)
+    {
+        CloseHandle(m_mapping);
+        m_mapping = nullptr;
+    }
+    if (m_file != INVALID_HANDLE_VALUE)
+    {
+        CloseHandle(m_file);
+        m_file = INVALID_HANDLE_VALUE;
+    }
+#else
+    if (m_data)
+    {
+        munmap(const_cast<unsigned char*>(m_data), m_size);
+    }
+    if (m_fd >= 0)
+    {
+        close(m_fd);
+        m_fd = -1;
+    }
+#endif
+
+    m_data = nullptr;
+    m_size = 0;
+    m_records = nullptr;
+    m_recordCount = 0;
+}
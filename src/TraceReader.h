@@ -0,0 +1,69 @@
+#pragma once
+
+#include "PadTrace.h"
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * TraceReader - Read-only memory-mapped view of a pad trace
+ *
+ * The file is mapped, not loaded: records are paged in by the OS as replay
+ * walks them, so multi-hour traces cost no more memory than the pages being
+ * read. Uses CreateFileMapping on Windows and mmap elsewhere.
+ */
+class TraceReader
+{
+public:
+    TraceReader();
+    ~TraceReader();
+
+    TraceReader(const TraceReader&) = delete;
+    TraceReader& operator=(const TraceReader&) = delete;
+
+    /**
+     * Map a trace file and validate its header
+     * @param path Trace file path
+     * @return false if the file cannot be mapped or is not a supported trace
+     */
+    bool Open(const char* path);
+
+    /**
+     * Unmap the file
+     */
+    void Close();
+
+    bool IsOpen() const { return m_data != nullptr; }
+
+    /**
+     * Get the trace header (valid while open)
+     */
+    const PadTrace::Header& GetHeader() const { return *reinterpret_cast<const PadTrace::Header*>(m_data); }
+
+    /**
+     * Get the number of complete records
+     */
+    size_t GetRecordCount() const { return m_recordCount; }
+
+    /**
+     * Get a record by index (index < GetRecordCount())
+     */
+    const PadTrace::Record& GetRecord(size_t index) const { return m_records[index]; }
+
+private:
+    /**
+     * Open and map the whole file (platform specific)
+     */
+    bool Map(const char* path);
+
+    const unsigned char* m_data;
+    size_t m_size;
+    const PadTrace::Record* m_records;
+    size_t m_recordCount;
+
+#ifdef _WIN32
+    void* m_file;       // HANDLE
+    void* m_mapping;    // HANDLE
+#else
+    int m_fd;
+#endif
+};
@@ -0,0 +1,116 @@
+#include "TraceRecorder.h"
+#include <chrono>
+
+namespace
+{
+    // Recording is not latency critical; an idle writer checks the queue every 20 ms
+    const std::chrono::milliseconds WRITER_IDLE_SLEEP(20);
+}
+
+TraceRecorder::TraceRecorder(IMonotonicClock& clock)
+    : m_clock(clock)
+    , m_file(nullptr)
+    , m_running(false)
+    , m_written(0)
+    , m_dropped(0)
+    , m_writeError(false)
+{
+}
+
+TraceRecorder::~TraceRecorder()
+{
+    Close();
+}
+
+bool TraceRecorder::Open(const char* path, uint32_t controllerIndex)
+{
+    if (m_file)
+    {
+        return false;
+    }
+
+    m_file = std::fopen(path, "wb");
+    if (!m_file)
+    {
+        return false;
+    }
+
+    PadTrace::Header header = PadTrace::MakeHeader(m_clock.NowNanoseconds(), controllerIndex);
+    if (std::fwrite(&header, sizeof(header), 1, m_file) != 1)
+    {
+        std::fclose(m_file);
+        m_file = nullptr;
+        return false;
+    }
+
+    m_written.store(0);
+    m_dropped.store(0);
+    m_writeError.store(false);
+    m_running.store(true);
+    m_thread = std::thread(&TraceRecorder::WriterLoop, this);
+    return true;
+}
+
+void TraceRecorder::Close()
+{
+    m_running.store(false);
+    if (m_thread.joinable())
+    {
+        m_thread.join();
+    }
+
+    if (m_file)
+    {
+        // The producer has stopped by now; pick up whatever it queued last
+        Drain();
+        std::fclose(m_file);
+        m_file = nullptr;
+    }
+}
+
+void TraceRecorder::Record(const PadSnapshot& snapshot)
+{
+    if (!m_queue.TryPush(snapshot))
+    {
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void TraceRecorder::WriterLoop()
+{
+    while (m_running.load(std::memory_order_relaxed))
+    {
+        if (Drain() == 0)
+        {
+            std::this_thread::sleep_for(WRITER_IDLE_SLEEP);
+        }
+    }
+    Drain();
+    std::fflush(m_file);
+}
+
+size_t TraceRecorder::Drain()
+{
+    size_t total = 0;
+    while (true)
+    {
+        size_t count = 0;
+        PadSnapshot snapshot;
+        while (count < WRITE_BLOCK && m_queue.TryPop(snapshot))
+        {
+            m_block[count++] = PadTrace::ToRecord(snapshot);
+        }
+        if (count == 0)
+        {
+            break;
+        }
+
+        if (std::fwrite(m_block, sizeof(PadTrace::Record), count, m_file) != count)
+        {
+            m_writeError.store(true, std::memory_order_relaxed);
+        }
+        m_written.fetch_add(count, std::memory_order_relaxed);
+        total += count;
+    }
+    return total;
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include "PadState.h"
+#include "PadTrace.h"
+#include "MonotonicClock.h"
+#include "SpscQueue.h"
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <thread>
+
+/**
+ * TraceRecorder - Writes pad snapshots to a binary trace on a background thread
+ *
+ * Record() is called from the thread that polls the pad; it only pushes into
+ * a lock-free SPSC queue, so disk I/O never delays polling. A writer thread
+ * drains the queue and appends PadTrace records in blocks. If the writer
+ * falls more than QUEUE_CAPACITY snapshots behind, new snapshots are dropped
+ * and counted rather than blocking the poller.
+ */
+class TraceRecorder
+{
+public:
+    static const size_t QUEUE_CAPACITY = 4096;
+
+    /**
+     * @param clock Clock used for snapshot timestamps (must outlive the recorder)
+     */
+    explicit TraceRecorder(IMonotonicClock& clock);
+    ~TraceRecorder();
+
+    TraceRecorder(const TraceRecorder&) = delete;
+    TraceRecorder& operator=(const TraceRecorder&) = delete;
+
+    /**
+     * Create the trace file, write its header and start the writer thread
+     * @param path Output file path (overwritten)
+     * @param controllerIndex Source controller slot, stored in the header
+     * @return false if the file could not be created
+     */
+    bool Open(const char* path, uint32_t controllerIndex);
+
+    /**
+     * Write everything still queued, stop the writer thread and close the file
+     * Stop the producer first so no snapshot is left behind.
+     */
+    void Close();
+
+    /**
+     * Queue one snapshot (single producer thread, never blocks)
+     */
+    void Record(const PadSnapshot& snapshot);
+
+    /**
+     * Get the current time on the recorder's clock (for snapshot timestamps)
+     */
+    uint64_t Now() const { return m_clock.NowNanoseconds(); }
+
+    /**
+     * Get the number of records written to the file
+     */
+    uint64_t GetWrittenCount() const { return m_written.load(std::memory_order_relaxed); }
+
+    /**
+     * Get the number of snapshots dropped because the queue was full
+     */
+    uint64_t GetDroppedCount() const { return m_dropped.load(std::memory_order_relaxed); }
+
+    /**
+     * Check whether the writer hit an I/O error
+     */
+    bool HasWriteError() const { return m_writeError.load(std::memory_order_relaxed); }
+
+private:
+    static const size_t WRITE_BLOCK = 256;
+
+    /**
+     * Writer thread body
+     */
+    void WriterLoop();
+
+    /**
+     * Move queued snapshots to the file
+     * @return Number of records written
+     */
+    size_t Drain();
+
+    IMonotonicClock& m_clock;
+    std::FILE* m_file;
+    SpscQueue<PadSnapshot, QUEUE_CAPACITY> m_queue;
+    PadTrace::Record m_block[WRITE_BLOCK];  // Used only by the writer thread
+
+    std::thread m_thread;
+    std::atomic<bool> m_running;
+    std::atomic<uint64_t> m_written;
+    std::atomic<uint64_t> m_dropped;
+    std::atomic<bool> m_writeError;
+};
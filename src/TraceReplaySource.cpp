@@ -0,0 +1,45 @@
+#include "TraceReplaySource.h"
+
+TraceReplaySource::TraceReplaySource(const TraceReader& reader)
+    : m_reader(reader)
+    , m_originNs(0)
+    , m_position(0)
+{
+    if (m_reader.GetRecordCount() > 0)
+    {
+        m_originNs = m_reader.GetRecord(0).timestampNs;
+    }
+}
+
+bool TraceReplaySource::Next(uint64_t replayTimeNs, PadSnapshot& snapshot)
+{
+    if (IsFinished())
+    {
+        return false;
+    }
+
+    const PadTrace::Record& record = m_reader.GetRecord(m_position);
+
+    // A timestamp before the origin (clock went backwards) is due immediately
+    uint64_t offset = (record.timestampNs > m_originNs) ? record.timestampNs - m_originNs : 0;
+    if (offset > replayTimeNs)
+    {
+        return false;
+    }
+
+    snapshot = PadTrace::ToSnapshot(record);
+    ++m_position;
+    return true;
+}
+
+uint64_t TraceReplaySource::GetDurationNanoseconds() const
+{
+    size_t count = m_reader.GetRecordCount();
+    if (count == 0)
+    {
+        return 0;
+    }
+
+    uint64_t last = m_reader.GetRecord(count - 1).timestampNs;
+    return (last > m_originNs) ? last - m_originNs : 0;
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "PadState.h"
+#include "TraceReader.h"
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * TraceReplaySource - Feeds a recorded trace back as pad snapshots
+ *
+ * Replay time starts at zero at the first record. The caller decides how
+ * replay time advances: from a real clock (real-time replay) or by a fixed
+ * step per frame (as fast as possible, fully deterministic).
+ */
+class TraceReplaySource
+{
+public:
+    /**
+     * @param reader Open trace (must outlive the source)
+     */
+    explicit TraceReplaySource(const TraceReader& reader);
+
+    /**
+     * Get the next snapshot that is due by the given replay time
+     * @param replayTimeNs Time since the first record
+     * @param snapshot Receives the snapshot (original timestamp)
+     * @return false if no further record is due yet
+     */
+    bool Next(uint64_t replayTimeNs, PadSnapshot& snapshot);
+
+    /**
+     * Check whether every record has been returned
+     */
+    bool IsFinished() const { return m_position >= m_reader.GetRecordCount(); }
+
+    /**
+     * Start again from the first record
+     */
+    void Rewind() { m_position = 0; }
+
+    /**
+     * Get the time between the first and the last record
+     */
+    uint64_t GetDurationNanoseconds() const;
+
+    /**
+     * Get the timestamp of the first record (replay time 0 on the recorded clock)
+     */
+    uint64_t GetOriginNanoseconds() const { return m_originNs; }
+
+    /**
+     * Get the number of records returned so far
+     */
+    size_t GetPosition() const { return m_position; }
+
+private:
+    const TraceReader& m_reader;
+    uint64_t m_originNs;
+    size_t m_position;
+};
@@ -0,0 +1,307 @@
+#include "UinputOutputSink.h"
+#include "InputCodes.h"
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <linux/uinput.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+namespace
+{
+    struct KeyMapping
+    {
+        uint16_t virtualKey;
+        uint16_t evdevKey;
+    };
+
+    // Every key the Witcher profile and the stick/trigger stages can emit, plus the rest of the letters and digits
+    const KeyMapping KEY_MAP[] =
+    {
+        { 'A', KEY_A }, { 'B', KEY_B }, { 'C', KEY_C }, { 'D', KEY_D }, { 'E', KEY_E },
+        { 'F', KEY_F }, { 'G', KEY_G }, { 'H', KEY_H }, { 'I', KEY_I }, { 'J', KEY_J },
+        { 'K', KEY_K }, { 'L', KEY_L }, { 'M', KEY_M }, { 'N', KEY_N }, { 'O', KEY_O },
+        { 'P', KEY_P }, { 'Q', KEY_Q }, { 'R', KEY_R }, { 'S', KEY_S }, { 'T', KEY_T },
+        { 'U', KEY_U }, { 'V', KEY_V }, { 'W', KEY_W }, { 'X', KEY_X }, { 'Y', KEY_Y },
+        { 'Z', KEY_Z },
+        { '0', KEY_0 }, { '1', KEY_1 }, { '2', KEY_2 }, { '3', KEY_3 }, { '4', KEY_4 },
+        { '5', KEY_5 }, { '6', KEY_6 }, { '7', KEY_7 }, { '8', KEY_8 }, { '9', KEY_9 },
+        { KeyCode::Tab, KEY_TAB },
+        { KeyCode::Enter, KEY_ENTER },
+        { KeyCode::Shift, KEY_LEFTSHIFT },
+        { KeyCode::Control, KEY_LEFTCTRL },
+        { KeyCode::Alt, KEY_LEFTALT },
+        { KeyCode::Escape, KEY_ESC },
+        { KeyCode::Space, KEY_SPACE },
+        { KeyCode::Minus, KEY_MINUS },
+        { KeyCode::Equals, KEY_EQUAL },
+        { KeyCode::LeftBracket, KEY_LEFTBRACE },
+        { KeyCode::RightBracket, KEY_RIGHTBRACE },
+    };
+
+    /**
+     * Direct-indexed copy of KEY_MAP (virtual keys are 8-bit)
+     */
+    struct KeyLookup
+    {
+        uint16_t evdevKeys[256];
+
+        KeyLookup()
+            : evdevKeys()
+        {
+            for (const KeyMapping& mapping : KEY_MAP)
+            {
+                evdevKeys[mapping.virtualKey] = mapping.evdevKey;
+            }
+        }
+    };
+
+    const KeyLookup& GetKeyLookup()
+    {
+        static const KeyLookup lookup;
+        return lookup;
+    }
+}
+
+UinputOutputSink::UinputOutputSink()
+    : m_fd(-1)
+    , m_capturing(false)
+    , m_recordCount(0)
+    , m_touchedCount(0)
+    , m_writeCount(0)
+    , m_untranslatedCount(0)
+{
+}
+
+UinputOutputSink::~UinputOutputSink()
+{
+    Close();
+}
+
+bool UinputOutputSink::Open(const char* path)
+{
+    Close();
+
+    int fd = open(path, O_WRONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    // Declare every key and button we may send, plus relative motion
+    bool ok = ioctl(fd, UI_SET_EVBIT, EV_KEY) >= 0 &&
+              ioctl(fd, UI_SET_EVBIT, EV_REL) >= 0 &&
+              ioctl(fd, UI_SET_EVBIT, EV_SYN) >= 0 &&
+              ioctl(fd, UI_SET_RELBIT, REL_X) >= 0 &&
+              ioctl(fd, UI_SET_RELBIT, REL_Y) >= 0;
+    for (const KeyMapping& mapping : KEY_MAP)
+    {
+        ok = ok && ioctl(fd, UI_SET_KEYBIT, mapping.evdevKey) >= 0;
+    }
+    for (uint16_t button = MouseButton::Left; button <= MouseButton::Middle; ++button)
+    {
+        ok = ok && ioctl(fd, UI_SET_KEYBIT, TranslateMouseButton(button)) >= 0;
+    }
+
+    uinput_setup setup;
+    std::memset(&setup, 0, sizeof(setup));
+    setup.id.bustype = BUS_VIRTUAL;
+    setup.id.vendor = 0x1209;   // pid.codes open-source vendor id
+    setup.id.product = 0x0001;
+    setup.id.version = 1;
+    std::strncpy(setup.name, "GamepadMapper keyboard/mouse", UINPUT_MAX_NAME_SIZE - 1);
+
+    ok = ok && ioctl(fd, UI_DEV_SETUP, &setup) >= 0 &&
+         ioctl(fd, UI_DEV_CREATE) >= 0;
+    if (!ok)
+    {
+        close(fd);
+        return false;
+    }
+
+    m_fd = fd;
+    m_capturing = false;
+    return true;
+}
+
+bool UinputOutputSink::OpenCapture(const char* path)
+{
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0)
+    {
+        return false;
+    }
+    return OpenCaptureFd(fd);
+}
+
+bool UinputOutputSink::OpenCaptureFd(int fd)
+{
+    Close();
+
+    m_fd = fd;
+    m_capturing = true;
+    return true;
+}
+
+bool UinputOutputSink::OpenWithFallback(const char* capturePath)
+{
+    return Open() || OpenCapture(capturePath);
+}
+
+void UinputOutputSink::Close()
+{
+    if (m_fd < 0)
+    {
+        return;
+    }
+
+    if (!m_capturing)
+    {
+        ioctl(m_fd, UI_DEV_DESTROY);
+    }
+    close(m_fd);
+    m_fd = -1;
+    m_capturing = false;
+}
+
+uint16_t UinputOutputSink::TranslateKey(uint16_t virtualKey)
+{
+    if (virtualKey > 0xFF)
+    {
+        return 0;
+    }
+    return GetKeyLookup().evdevKeys[virtualKey];
+}
+
+uint16_t UinputOutputSink::TranslateMouseButton(uint16_t button)
+{
+    switch (button)
+    {
+    case MouseButton::Left: return BTN_LEFT;
+    case MouseButton::Right: return BTN_RIGHT;
+    case MouseButton::Middle: return BTN_MIDDLE;
+    default: return 0;
+    }
+}
+
+size_t UinputOutputSink::Submit(const OutputEvent* events, size_t count)
+{
+    if (m_fd < 0)
+    {
+        return 0;
+    }
+
+    size_t delivered = 0;
+    for (size_t offset = 0; offset < count; offset += EVENTS_PER_WRITE)
+    {
+        size_t chunk = count - offset;
+        if (chunk > EVENTS_PER_WRITE)
+        {
+            chunk = EVENTS_PER_WRITE;
+        }
+        size_t written = SubmitChunk(events + offset, chunk);
+        delivered += written;
+        if (written < chunk)
+        {
+            // Later chunks must not overtake the events that did not go out
+            break;
+        }
+    }
+    return delivered;
+}
+
+size_t UinputOutputSink::SubmitChunk(const OutputEvent* events, size_t count)
+{
+    m_recordCount = 0;
+    m_touchedCount = 0;
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        const OutputEvent& event = events[i];
+
+        if (event.type == OutputEventType::MouseMove)
+        {
+            if (event.deltaX != 0)
+            {
+                Append(EV_REL, REL_X, event.deltaX);
+            }
+            if (event.deltaY != 0)
+            {
+                Append(EV_REL, REL_Y, event.deltaY);
+            }
+            continue;
+        }
+
+        bool isKey = (event.type == OutputEventType::KeyDown || event.type == OutputEventType::KeyUp);
+        uint16_t code = isKey ? TranslateKey(event.code) : TranslateMouseButton(event.code);
+        if (code == 0)
+        {
+            // Resending would not help: consume it and count it
+            ++m_untranslatedCount;
+            continue;
+        }
+
+        bool down = (event.type == OutputEventType::KeyDown || event.type == OutputEventType::MouseButtonDown);
+        Append(EV_KEY, code, down ? 1 : 0);
+    }
+
+    if (m_recordCount == 0)
+    {
+        return count;
+    }
+
+    Append(EV_SYN, SYN_REPORT, 0);
+    return WriteRecords() ? count : 0;
+}
+
+void UinputOutputSink::Append(uint16_t type, uint16_t code, int32_t value)
+{
+    if (type != EV_SYN)
+    {
+        // A code may change only once per report: a tap (down then up) or two
+        // moves in one batch start a new report, or readers would merge them
+        uint32_t key = (static_cast<uint32_t>(type) << 16) | code;
+        for (size_t i = 0; i < m_touchedCount; ++i)
+        {
+            if (m_touched[i] == key)
+            {
+                Append(EV_SYN, SYN_REPORT, 0);
+                m_touchedCount = 0;
+                break;
+            }
+        }
+        m_touched[m_touchedCount++] = key;
+    }
+
+    // Timestamps are left zero; the kernel stamps events written to uinput
+    input_event& record = m_records[m_recordCount++];
+    std::memset(&record, 0, sizeof(record));
+    record.type = type;
+    record.code = code;
+    record.value = value;
+}
+
+bool UinputOutputSink::WriteRecords()
+{
+    const char* data = reinterpret_cast<const char*>(m_records);
+    size_t remaining = m_recordCount * sizeof(input_event);
+
+    ++m_writeCount;
+    while (remaining > 0)
+    {
+        ssize_t written = write(m_fd, data, remaining);
+        if (written < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return false;
+        }
+
+        // uinput takes the whole batch; a pipe may accept it in pieces
+        data += written;
+        remaining -= static_cast<size_t>(written);
+    }
+    return true;
+}
@@ -0,0 +1,130 @@
+#pragma once
+
+#include "IOutputSink.h"
+#include <cstddef>
+#include <cstdint>
+#include <linux/input.h>
+
+/**
+ * UinputOutputSink - Linux keyboard/mouse output through a uinput virtual device
+ *
+ * The Linux counterpart of KeyboardMouse. Each Submit() batch is encoded into
+ * a preallocated input_event array (key codes translated from Win32 virtual
+ * keys) and written with a single write() call ending in SYN_REPORT. A code
+ * that changes twice in one batch (a tap) gets a SYN_REPORT in between, in
+ * the same write, so readers see two separate reports. A key with no evdev
+ * equivalent cannot be sent: it is consumed, so it is not retried, and counted
+ * (GetUntranslatedCount()).
+ *
+ * When /dev/uinput cannot be used, the same byte stream can be sent to a
+ * capture file or pipe instead (OpenCapture), so encoding and batching can
+ * be checked without a display or privileges.
+ */
+class UinputOutputSink : public IOutputSink
+{
+public:
+    UinputOutputSink();
+    ~UinputOutputSink() override;
+
+    UinputOutputSink(const UinputOutputSink&) = delete;
+    UinputOutputSink& operator=(const UinputOutputSink&) = delete;
+
+    /**
+     * Create the virtual keyboard/mouse device
+     * @param path uinput device node
+     * @return false if uinput is unavailable (module not loaded, no permission)
+     */
+    bool Open(const char* path = "/dev/uinput");
+
+    /**
+     * Write the encoded event stream to a file instead of a device
+     * @param path Capture file or FIFO path (truncated)
+     * @return false if the file cannot be created
+     */
+    bool OpenCapture(const char* path);
+
+    /**
+     * Write the encoded event stream to an already open fd (takes ownership)
+     */
+    bool OpenCaptureFd(int fd);
+
+    /**
+     * Create the uinput device, or capture to a file if uinput is unavailable
+     * @param capturePath Fallback capture file
+     * @return false if neither works
+     */
+    bool OpenWithFallback(const char* capturePath);
+
+    /**
+     * Destroy the virtual device (or close the capture)
+     */
+    void Close();
+
+    bool IsOpen() const { return m_fd >= 0; }
+
+    /**
+     * Check whether output goes to a capture file rather than a uinput device
+     */
+    bool IsCapturing() const { return m_capturing; }
+
+    /**
+     * Encode and write a batch
+     * @return Number of leading events delivered or consumed untranslated; a failed
+     *         write stops the batch there
+     */
+    size_t Submit(const OutputEvent* events, size_t count) override;
+
+    /**
+     * Translate a Win32 virtual-key code to an evdev KEY_* code
+     * @return 0 if the key has no mapping
+     */
+    static uint16_t TranslateKey(uint16_t virtualKey);
+
+    /**
+     * Translate a MouseButton index to an evdev BTN_* code
+     * @return 0 if the button has no mapping
+     */
+    static uint16_t TranslateMouseButton(uint16_t button);
+
+    /**
+     * Get the number of write() calls made
+     */
+    uint64_t GetWriteCount() const { return m_writeCount; }
+
+    /**
+     * Get the number of key and mouse button events dropped because they have no evdev code
+     */
+    uint64_t GetUntranslatedCount() const { return m_untranslatedCount; }
+
+private:
+    // Up to 64 events per write. A mouse move takes two records, and each
+    // record may be preceded by a SYN_REPORT that splits the batch into reports.
+    static const size_t EVENTS_PER_WRITE = 64;
+    static const size_t MAX_RECORDS = EVENTS_PER_WRITE * 4 + 1;
+
+    /**
+     * Encode up to EVENTS_PER_WRITE events and write them
+     * @return count, or 0 if the write failed
+     */
+    size_t SubmitChunk(const OutputEvent* events, size_t count);
+
+    /**
+     * Add one record to the pending write
+     */
+    void Append(uint16_t type, uint16_t code, int32_t value);
+
+    /**
+     * Write the encoded records in one call
+     * @return false on error
+     */
+    bool WriteRecords();
+
+    int m_fd;
+    bool m_capturing;
+    input_event m_records[MAX_RECORDS];
+    size_t m_recordCount;
+    uint32_t m_touched[MAX_RECORDS];    // (type << 16 | code) changed in the current report
+    size_t m_touchedCount;
+    uint64_t m_writeCount;
+    uint64_t m_untranslatedCount;
+};
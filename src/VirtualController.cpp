@@ -179,6 +179,19 @@ bool VirtualController::Update(const XINPUT_STATE& state)
 #endif
 }
 
+bool VirtualController::Update(const PadState& pad)
+{
+    XINPUT_STATE state = { 0 };
+    state.Gamepad.wButtons = pad.buttons;
+    state.Gamepad.bLeftTrigger = pad.leftTrigger;
+    state.Gamepad.bRightTrigger = pad.rightTrigger;
+    state.Gamepad.sThumbLX = pad.thumbLX;
+    state.Gamepad.sThumbLY = pad.thumbLY;
+    state.Gamepad.sThumbRX = pad.thumbRX;
+    state.Gamepad.sThumbRY = pad.thumbRY;
+    return Update(state);
+}
+
 void VirtualController::Shutdown()
 {
 #ifdef VIGEM_SDK_AVAILABLE
@@ -2,6 +2,7 @@
 
 #include <windows.h>
 #include <XInput.h>
+#include "PadState.h"
 
 // Forward declarations for ViGEmClient
 // Note: User needs to include ViGEmClient.h from the SDK
@@ -34,6 +35,13 @@ public:
      */
     bool Update(const XINPUT_STATE& state);
 
+    /**
+     * Update the virtual controller state from a platform-neutral pad state
+     * @param pad Pad state to forward to the virtual controller
+     * @return true if successful
+     */
+    bool Update(const PadState& pad);
+
     /**
      * Check if the virtual controller is connected
      * @return true if connected
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "StaticProfile.h"
+
+/**
+ * WitcherProfile - Built-in The Witcher 1 profile (the same bindings as profiles/witcher.ini)
+ *
+ * The one definition of the default mapping: Profile::CreateWitcher() and
+ * BindingTable::CreateWitcherProfile() build it as data, and
+ * Mapper::SetStaticProfile<WitcherProfile>() maps it through the stage
+ * StaticProfile generates from it.
+ */
+struct WitcherProfile
+{
+    static constexpr const char* NAME = "The Witcher 1";
+
+    static constexpr StaticBinding BUTTONS[] =
+    {
+        // A -> Space (Zatrzymanie gry / Pause game)
+        StaticBinding::Key(PadButton::A, KeyCode::Space, "Zatrzymanie gry"),
+
+        // B -> Escape on tap, Alt held on hold (dodge with a direction)
+        StaticBinding::Gesture(PadButton::B, GestureDefinition::Create(200, 0, 0)
+            .Set(GestureKind::Tap, MacroStep::Key(KeyCode::Escape, 30, 20))
+            .Set(GestureKind::Hold, MacroStep::Key(KeyCode::Alt, 0, 0))),
+
+        // X -> Left Mouse Button (Lewa mysz), Y -> Right Mouse Button (Prawa mysz)
+        StaticBinding::Mouse(PadButton::X, MouseButton::Left),
+        StaticBinding::Mouse(PadButton::Y, MouseButton::Right),
+
+        // Right Stick Click -> TAB (Tryb Rozmowy / Conversation mode)
+        StaticBinding::Key(PadButton::RightThumb, KeyCode::Tab, "Tryb Rozmowy"),
+
+        // LB -> 1 and 6, RB -> 2 and 7 (Eliksiry szybki dostęp), each held 30 ms with 20 ms
+        // between, so games that sample the keyboard once per frame see both presses.
+        // Plays to the end even on a quick tap.
+        StaticBinding::Macro(PadButton::LeftShoulder, { MacroStep::Key('1', 30, 20), MacroStep::Key('6', 30, 20) }, false,
+                             "Eliksiry szybki dostęp"),
+        StaticBinding::Macro(PadButton::RightShoulder, { MacroStep::Key('2', 30, 20), MacroStep::Key('7', 30, 20) }, false,
+                             "Eliksiry szybki dostęp"),
+
+        // D-Pad Up -> - (Następny Znak / Next Sign), D-Pad Down -> = (Poprzedni Znak / Previous Sign)
+        StaticBinding::Key(PadButton::DPadUp, KeyCode::Minus, "Następny Znak"),
+        StaticBinding::Key(PadButton::DPadDown, KeyCode::Equals, "Poprzedni Znak"),
+
+        // D-Pad Left/Right -> [ and ] (Poprzednia / Następna broń); double-tap skips two
+        StaticBinding::Gesture(PadButton::DPadLeft, GestureDefinition::Create(200, 180, 0)
+            .Set(GestureKind::Tap, MacroStep::Key(KeyCode::LeftBracket, 30, 20))
+            .Set(GestureKind::DoubleTap, MacroStep::Key(KeyCode::LeftBracket, 30, 20), 2), "Poprzednia broń"),
+        StaticBinding::Gesture(PadButton::DPadRight, GestureDefinition::Create(200, 180, 0)
+            .Set(GestureKind::Tap, MacroStep::Key(KeyCode::RightBracket, 30, 20))
+            .Set(GestureKind::DoubleTap, MacroStep::Key(KeyCode::RightBracket, 30, 20), 2), "Następna broń"),
+
+        // Start (Menu button) -> H (Bohater / Hero), Back (View button) -> I (Ekwipunek / Inventory)
+        StaticBinding::Key(PadButton::Start, 'H', "Bohater"),
+        StaticBinding::Key(PadButton::Back, 'I', "Ekwipunek"),
+    };
+
+    // Per AnalogKey: WSAD on the left stick; Styl Szybki / Silny / Grupowy (Fast / Strong / Group Style) on the triggers
+    static constexpr uint16_t ANALOG_KEYS[Profile::ANALOG_KEY_COUNT] = { 'W', 'S', 'A', 'D', 'X', 'Z', 'C' };
+    static constexpr const char* ANALOG_LABELS[Profile::ANALOG_KEY_COUNT] =
+    {
+        "Movement", "", "", "", "Styl Szybki", "Styl Silny", "Styl Grupowy"
+    };
+
+    // ThresholdSettings::DefaultStick() and DefaultTrigger()
+    static constexpr ThresholdSettings STICK_THRESHOLDS = { 10322, 8258, 0 };
+    static constexpr ThresholdSettings TRIGGER_THRESHOLDS = { 128, 96, 0 };
+};
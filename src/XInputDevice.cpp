@@ -1,12 +1,8 @@
 #include "XInputDevice.h"
-#include <cstring>
 
-XInputDevice::XInputDevice()
-    : m_controllerIndex(-1)
-    , m_isConnected(false)
+XInputDevice::XInputDevice(int controllerIndex)
+    : m_controllerIndex((controllerIndex >= 0 && controllerIndex <= 3) ? controllerIndex : -1)
 {
-    std::memset(&m_currentState, 0, sizeof(XINPUT_STATE));
-    std::memset(&m_previousState, 0, sizeof(XINPUT_STATE));
 }
 
 XInputDevice::~XInputDevice()
@@ -21,16 +17,14 @@ bool XInputDevice::Initialize(int controllerIndex)
     }
 
     m_controllerIndex = controllerIndex;
-    
+
     // Try to read the controller state to check if it's connected
-    DWORD result = XInputGetState(m_controllerIndex, &m_currentState);
-    m_isConnected = (result == ERROR_SUCCESS);
-    
+    ReadXInput();
     if (m_isConnected)
     {
         m_previousState = m_currentState;
     }
-    
+
     return m_isConnected;
 }
 
@@ -41,103 +35,36 @@ bool XInputDevice::Update()
         return false;
     }
 
-    // Store previous state before reading new state
-    m_previousState = m_currentState;
-
-    // Read current state
-    DWORD result = XInputGetState(m_controllerIndex, &m_currentState);
-    m_isConnected = (result == ERROR_SUCCESS);
-
+    ReadXInput();
     return m_isConnected;
 }
 
-bool XInputDevice::IsButtonPressed(WORD button) const
+bool XInputDevice::Read(uint64_t timestampNs, PadSnapshot& snapshot)
 {
-    if (!m_isConnected)
-    {
-        return false;
-    }
-
-    return (m_currentState.Gamepad.wButtons & button) != 0;
+    Update();
+    snapshot = GetSnapshot(timestampNs);
+    return HasStateChanged();
 }
 
-bool XInputDevice::IsButtonJustPressed(WORD button) const
+void XInputDevice::ReadXInput()
 {
-    if (!m_isConnected)
+    XINPUT_STATE state;
+    DWORD result = XInputGetState(m_controllerIndex, &state);
+    if (result != ERROR_SUCCESS)
     {
-        return false;
+        // Keep the last reading; only the connection changes
+        Advance(m_currentState, m_packetNumber, false);
+        return;
     }
 
-    bool wasPressed = (m_previousState.Gamepad.wButtons & button) != 0;
-    bool isPressed = (m_currentState.Gamepad.wButtons & button) != 0;
-
-    return !wasPressed && isPressed;
+    // The packet number only advances when the pad reports something new
+    PadState pad;
+    pad.buttons = state.Gamepad.wButtons;
+    pad.leftTrigger = state.Gamepad.bLeftTrigger;
+    pad.rightTrigger = state.Gamepad.bRightTrigger;
+    pad.thumbLX = state.Gamepad.sThumbLX;
+    pad.thumbLY = state.Gamepad.sThumbLY;
+    pad.thumbRX = state.Gamepad.sThumbRX;
+    pad.thumbRY = state.Gamepad.sThumbRY;
+    Advance(pad, state.dwPacketNumber, true);
 }
-
-bool XInputDevice::IsButtonJustReleased(WORD button) const
-{
-    if (!m_isConnected)
-    {
-        return false;
-    }
-
-    bool wasPressed = (m_previousState.Gamepad.wButtons & button) != 0;
-    bool isPressed = (m_currentState.Gamepad.wButtons & button) != 0;
-
-    return wasPressed && !isPressed;
-}
-
-SHORT XInputDevice::GetLeftStickX() const
-{
-    if (!m_isConnected)
-    {
-        return 0;
-    }
-    return m_currentState.Gamepad.sThumbLX;
-}
-
-SHORT XInputDevice::GetLeftStickY() const
-{
-    if (!m_isConnected)
-    {
-        return 0;
-    }
-    return m_currentState.Gamepad.sThumbLY;
-}
-
-SHORT XInputDevice::GetRightStickX() const
-{
-    if (!m_isConnected)
-    {
-        return 0;
-    }
-    return m_currentState.Gamepad.sThumbRX;
-}
-
-SHORT XInputDevice::GetRightStickY() const
-{
-    if (!m_isConnected)
-    {
-        return 0;
-    }
-    return m_currentState.Gamepad.sThumbRY;
-}
-
-BYTE XInputDevice::GetLeftTrigger() const
-{
-    if (!m_isConnected)
-    {
-        return 0;
-    }
-    return m_currentState.Gamepad.bLeftTrigger;
-}
-
-BYTE XInputDevice::GetRightTrigger() const
-{
-    if (!m_isConnected)
-    {
-        return 0;
-    }
-    return m_currentState.Gamepad.bRightTrigger;
-}
-
@@ -1,9 +1,39 @@
 #include <windows.h>
+#include <atomic>
 #include <iostream>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
 #include "XInputDevice.h"
+#include "DeviceWatcher.h"
 #include "KeyboardMouse.h"
 #include "Mapper.h"
 #include "VirtualController.h"
+#include "MonotonicClock.h"
+#include "FrameScheduler.h"
+#include "AsyncOutputSink.h"
+#include "InputPoller.h"
+#include "StageProfiler.h"
+#include "TraceRecorder.h"
+#include "ProfileReloader.h"
+
+namespace
+{
+    std::atomic<bool> g_exitRequested(false);
+
+    BOOL WINAPI ConsoleCtrlHandler(DWORD ctrlType)
+    {
+        if (ctrlType == CTRL_C_EVENT || ctrlType == CTRL_BREAK_EVENT)
+        {
+            // Let the main loop release held keys and print its stats before exiting
+            g_exitRequested.store(true);
+            return TRUE;
+        }
+        return FALSE;
+    }
+}
 
 /**
  * Check if the application is running with administrator privileges
@@ -25,17 +55,116 @@ bool IsRunningAsAdministrator()
     return isAdmin == TRUE;
 }
 
+/**
+ * Handle a pad connect/disconnect seen by the main loop
+ * On disconnect every held key and button is released, so nothing stays stuck
+ * in the game while the pad is away.
+ * @return The new connection state
+ */
+bool ReportConnectionChange(const PadDevice& controller, Mapper& mapper, const DeviceWatcher& watcher)
+{
+    if (controller.IsConnected())
+    {
+        std::cout << "Controller connected (slot " << watcher.GetActiveSlot() << ")." << std::endl;
+        return true;
+    }
+
+    mapper.ReleaseAllOutputs();
+    std::cout << "Controller disconnected. Keys released, waiting for reconnect..." << std::endl;
+    return false;
+}
+
 /**
  * Main entry point for GamepadMapper application
  * 
  * This application maps Xbox controller input to keyboard and mouse events
  * for The Witcher 1, and optionally creates a virtual Xbox 360 controller
- * using ViGEm. The main loop runs at approximately 200 Hz (5ms per frame).
+ * using ViGEm. The main loop runs at 200 Hz by default (5ms per frame);
+ * pass --rate=<hz> to change it (up to 1000 Hz). Keyboard/mouse output is
+ * emitted on its own thread; --sync-output emits it inline instead. The pad
+ * is polled on its own thread as well; --inline-poll polls on the main loop.
+ * With the poll thread, the virtual controller is fed from a forwarder thread
+ * that takes the newest snapshot, so ViGEm never delays mapping.
+ * --stats records per-stage latency histograms and prints them every
+ * --stats-interval=<seconds> (default 10) and on exit. --record=<file> writes
+ * every pad state change to a binary trace that GamepadReplay can play back.
+ * --profile=<file.ini> loads a text profile through its compiled cache
+ * (<file.ini>.bin) and reloads it whenever the file changes, between two
+ * frames; without it the built-in Witcher profile is used.
+ *
+ * The pad may be plugged into any XInput slot, before or after startup. A
+ * background DeviceWatcher finds it; on disconnect every held key is
+ * released and mapping resumes as soon as a pad is connected again.
  */
-int main()
+int main(int argc, char* argv[])
 {
+    uint32_t updateRateHz = 200;
+    bool asyncOutputEnabled = true;
+    bool pollThreadEnabled = true;
+    bool statsEnabled = false;
+    uint32_t statsIntervalSeconds = 10;
+    const char* recordPath = nullptr;
+    const char* profilePath = nullptr;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strncmp(argv[i], "--rate=", 7) == 0)
+        {
+            updateRateHz = static_cast<uint32_t>(std::strtoul(argv[i] + 7, nullptr, 10));
+        }
+        else if (std::strcmp(argv[i], "--sync-output") == 0)
+        {
+            asyncOutputEnabled = false;
+        }
+        else if (std::strcmp(argv[i], "--inline-poll") == 0)
+        {
+            pollThreadEnabled = false;
+        }
+        else if (std::strcmp(argv[i], "--stats") == 0)
+        {
+            statsEnabled = true;
+        }
+        else if (std::strncmp(argv[i], "--stats-interval=", 17) == 0)
+        {
+            statsEnabled = true;
+            statsIntervalSeconds = static_cast<uint32_t>(std::strtoul(argv[i] + 17, nullptr, 10));
+        }
+        else if (std::strncmp(argv[i], "--record=", 9) == 0)
+        {
+            recordPath = argv[i] + 9;
+        }
+        else if (std::strncmp(argv[i], "--profile=", 10) == 0)
+        {
+            profilePath = argv[i] + 10;
+        }
+    }
+
     std::cout << "GamepadMapper - The Witcher 1 Controller Support" << std::endl;
     std::cout << "================================================" << std::endl;
+
+    SystemClock clock;
+
+    // Profile: a --profile text is watched and hot-reloaded; the mapper uses the
+    // reloader's snapshots in place, so the reloader outlives the mapper. Its
+    // watcher thread sleeps on a clock of its own, not on the main loop's.
+    Profile builtInProfile = Profile::CreateWitcher();
+    const Profile* profile = &builtInProfile;
+    SystemClock reloaderClock;
+    ProfileReloader profileReloader(reloaderClock);
+    if (profilePath)
+    {
+        if (!profileReloader.Load(profilePath))
+        {
+            std::cout << "ERROR: " << profileReloader.GetError() << std::endl;
+            return 1;
+        }
+        const ProfileCache& profileCache = profileReloader.GetCache();
+        if (!profileCache.IsMapped())
+        {
+            std::cout << "WARNING: " << profileCache.GetError() << "; using the profile compiled in memory" << std::endl;
+        }
+        std::cout << "Profile: " << profilePath << (profileCache.WasCompiled() ? " (compiled)" : " (cached)")
+                  << ", reloaded when it changes" << std::endl;
+    }
     
     // Check for administrator privileges (required for SendInput to work with games)
     if (!IsRunningAsAdministrator())
@@ -52,18 +181,7 @@ int main()
     
     std::cout << "Press Ctrl+C to exit" << std::endl << std::endl;
 
-    // Initialize XInput device (controller index 0)
-    XInputDevice controller;
-    if (!controller.Initialize(0))
-    {
-        std::cout << "ERROR: No Xbox controller detected on index 0." << std::endl;
-        std::cout << "Please connect an Xbox controller and try again." << std::endl;
-        std::cout << "Press Enter to exit..." << std::endl;
-        std::cin.get();
-        return 1;
-    }
-
-    std::cout << "Physical controller connected successfully!" << std::endl;
+    SetConsoleCtrlHandler(ConsoleCtrlHandler, TRUE);
 
     // Initialize virtual controller (required per Requirements.md - needs ViGEmBus)
     VirtualController virtualController;
@@ -76,81 +194,316 @@ int main()
         std::cout << "See SETUP_VIGEM.md for SDK integration instructions." << std::endl;
     }
 
+    // Hot-plug: the watcher probes the four XInput slots off the hot loop (empty
+    // slots are slow to query) and hands a connected pad to whoever reads padSource.
+    // Its thread sleeps on a clock of its own, not on the main loop's waitable timer.
+    XInputDevice slotDevices[DeviceWatcher::MAX_SLOTS] = { XInputDevice(0), XInputDevice(1), XInputDevice(2), XInputDevice(3) };
+    SystemClock watcherClock;
+    DeviceWatcher deviceWatcher(watcherClock);
+    for (int slot = 0; slot < DeviceWatcher::MAX_SLOTS; ++slot)
+    {
+        deviceWatcher.SetSlot(slot, &slotDevices[slot]);
+    }
+    HotplugInputSource padSource(deviceWatcher);
+    deviceWatcher.Start();
+
+    // The pad state the mapper sees, fed from padSource
+    PadDevice controller;
+    bool padConnected = false;
+
+    // Latency instrumentation (--stats); when disabled each timed scope costs one branch
+    StageProfiler profiler(clock);
+    profiler.SetEnabled(statsEnabled);
+
     // Initialize keyboard/mouse emulator
     KeyboardMouse keyboardMouse;
+    ProfiledOutputSink profiledOutput(keyboardMouse, profiler);
+
+    // Output thread: a hung game window (SendMessage) must not stall polling
+    AsyncOutputSink asyncOutput(profiledOutput);
+    IOutputSink* output = &profiledOutput;
+    if (asyncOutputEnabled)
+    {
+        asyncOutput.Start();
+        output = &asyncOutput;
+    }
 
     // Initialize mapper
     Mapper mapper;
-    if (virtualControllerAvailable)
+    mapper.Initialize(&controller, output);
+    if (profilePath)
     {
-        mapper.Initialize(&controller, &keyboardMouse, &virtualController);
+        profileReloader.Apply(mapper);
+        profile = &profileReloader.GetApplied()->profile;
     }
     else
     {
-        mapper.Initialize(&controller, &keyboardMouse, nullptr);
+        // The built-in profile maps buttons through its compile-time generated stage
+        mapper.SetStaticProfile<WitcherProfile>();
     }
 
     std::cout << std::endl;
-    std::cout << "Controller mappings (The Witcher 1):" << std::endl;
-    std::cout << "  Left Stick -> WASD (Movement)" << std::endl;
-    std::cout << "  Right Stick -> Mouse (Camera)" << std::endl;
-    std::cout << "  Right Stick Click -> TAB (Tryb Rozmowy)" << std::endl;
-    std::cout << "  A -> Space (Zatrzymanie gry)" << std::endl;
-    std::cout << "  B -> Escape" << std::endl;
-    std::cout << "  X -> Left Mouse Button" << std::endl;
-    std::cout << "  Y -> Right Mouse Button" << std::endl;
-    std::cout << "  LB -> 1, 6 (Eliksiry szybki dostęp)" << std::endl;
-    std::cout << "  RB -> 2, 7 (Eliksiry szybki dostęp)" << std::endl;
-    std::cout << "  LT -> X (Styl Szybki)" << std::endl;
-    std::cout << "  RT -> Z (Styl Silny)" << std::endl;
-    std::cout << "  LT + RT -> C (Styl Grupowy)" << std::endl;
-    std::cout << "  D-Pad Up -> - (Następny Znak)" << std::endl;
-    std::cout << "  D-Pad Down -> = (Poprzedni Znak)" << std::endl;
-    std::cout << "  D-Pad Left -> [ (Poprzednia broń)" << std::endl;
-    std::cout << "  D-Pad Right -> ] (Następna broń)" << std::endl;
-    std::cout << "  Start -> H (Bohater)" << std::endl;
-    std::cout << "  Back -> I (Ekwipunek)" << std::endl;
+    std::cout << "Controller mappings (" << profile->name << "):" << std::endl;
+    profile->PrintBanner(std::cout);
     std::cout << std::endl;
 
-    // Main loop - runs at ~200 Hz (5ms per frame)
-    const DWORD frameTimeMs = 5; // 200 Hz = 5ms per frame
-    DWORD lastTime = GetTickCount();
+    // From here on the watcher thread may replace the profile (reported on the console)
+    if (profilePath)
+    {
+        profileReloader.SetLog(&std::cout);
+        profileReloader.Start();
+    }
+
+    // Main loop - paced on absolute deadlines by the frame scheduler
+    FrameScheduler scheduler(clock);
+    scheduler.Initialize(updateRateHz, OverrunPolicy::Skip);
 
-    std::cout << "Running... (Press Ctrl+C to exit)" << std::endl;
+    std::cout << "Running at " << (1000000000ULL / scheduler.GetPeriodNanoseconds()) << " Hz... (Press Ctrl+C to exit)" << std::endl;
     std::cout << "IMPORTANT: Make sure The Witcher 1 window is in focus for keyboard input to work!" << std::endl;
     std::cout << std::endl;
     std::cout << "DEBUG: If buttons don't work, check the console for debug messages (Debug build only)." << std::endl;
     std::cout << std::endl;
 
-    while (true)
+    // Poll thread: XInputGetState runs on its own schedule and publishes snapshots.
+    // The mapping stage below walks every snapshot in order; the virtual
+    // controller forwarder only takes the newest one.
+    PadSnapshotRing snapshotRing;
+    PadSnapshotRing::Reader snapshotReader(snapshotRing);
+    InputPoller poller(snapshotRing, padSource);
+
+    // Trace capture: the thread that reads the pad queues snapshots, a writer thread does the I/O
+    TraceRecorder recorder(clock);
+    bool recording = false;
+    if (recordPath)
+    {
+        recording = recorder.Open(recordPath, 0);
+        if (!recording)
+        {
+            std::cout << "WARNING: cannot create trace file " << recordPath << std::endl;
+        }
+        else if (pollThreadEnabled)
+        {
+            poller.SetRecorder(&recorder);
+        }
+        else
+        {
+            recorder.Record(controller.GetSnapshot(recorder.Now()));
+        }
+    }
+
+    if (pollThreadEnabled)
+    {
+        if (statsEnabled)
+        {
+            poller.SetProfiler(&profiler);
+        }
+        poller.Start(updateRateHz);
+    }
+
+    // Forwarder thread: the virtual controller gets the newest snapshot on a schedule
+    // of its own (and a clock of its own), so a slow ViGEm update never delays mapping
+    std::atomic<bool> forwarding(pollThreadEnabled && virtualControllerAvailable);
+    SystemClock forwarderClock;
+    std::thread forwarder;
+    if (forwarding.load())
+    {
+        forwarder = std::thread([&snapshotRing, &virtualController, &forwarding, &forwarderClock, &profiler, updateRateHz]()
+        {
+            FrameScheduler forwardScheduler(forwarderClock);
+            forwardScheduler.Initialize(updateRateHz, OverrunPolicy::Skip);
+            forwardScheduler.Start();
+            bool forwardedAny = false;
+            DWORD lastForwardedPacket = 0;
+            while (forwarding.load())
+            {
+                PadSnapshot latest;
+                if (snapshotRing.ReadLatest(latest) && latest.connected &&
+                    (!forwardedAny || latest.packetNumber != lastForwardedPacket))
+                {
+                    ScopedStageTimer forwardTimer(profiler, ProfileStage::VirtualController);
+                    virtualController.Update(latest.pad);
+                    lastForwardedPacket = latest.packetNumber;
+                    forwardedAny = true;
+                }
+                forwardScheduler.WaitForNextFrame();
+            }
+        });
+    }
+
+    std::cout << "Waiting for an Xbox controller (any slot)..." << std::endl;
+
+    const uint64_t statsIntervalNs = static_cast<uint64_t>(statsIntervalSeconds) * 1000000000ULL;
+    uint64_t nextStatsDump = clock.NowNanoseconds() + statsIntervalNs;
+
+    scheduler.Start();
+
+    while (!g_exitRequested.load())
+    {
+        {
+            ScopedStageTimer frameTimer(profiler, ProfileStage::Frame);
+
+            // A reloaded profile takes effect between two frames (one atomic load when unchanged)
+            if (profilePath)
+            {
+                profileReloader.Apply(mapper);
+            }
+
+            if (pollThreadEnabled)
+            {
+                // Map every snapshot published since the last frame, so no edge is lost
+                PadSnapshot snapshot;
+                bool received = false;
+                while (snapshotReader.Next(snapshot))
+                {
+                    received = true;
+                    controller.ApplySnapshot(snapshot);
+                    if (controller.IsConnected() != padConnected)
+                    {
+                        padConnected = ReportConnectionChange(controller, mapper, deviceWatcher);
+                    }
+                    if (padConnected)
+                    {
+                        ScopedStageTimer mapTimer(profiler, ProfileStage::Map);
+                        mapper.Update(snapshot.timestampNs);
+                    }
+                }
+
+                // Nothing new: still run the time-dependent output (camera motion)
+                if (!received && padConnected)
+                {
+                    controller.MarkUnchanged();
+                    ScopedStageTimer mapTimer(profiler, ProfileStage::Map);
+                    mapper.Update(clock.NowNanoseconds());
+                }
+            }
+            else
+            {
+                // Update controller state (cheap while disconnected: the watcher does the probing)
+                uint64_t now = clock.NowNanoseconds();
+                {
+                    ScopedStageTimer pollTimer(profiler, ProfileStage::Poll);
+                    PadSnapshot snapshot;
+                    if (padSource.Read(now, snapshot))
+                    {
+                        controller.ApplySnapshot(snapshot);
+                        if (recording)
+                        {
+                            recorder.Record(snapshot);
+                        }
+                    }
+                    else
+                    {
+                        controller.MarkUnchanged();
+                    }
+                }
+                if (controller.IsConnected() != padConnected)
+                {
+                    padConnected = ReportConnectionChange(controller, mapper, deviceWatcher);
+                }
+                if (padConnected)
+                {
+                    // Process mappings
+                    ScopedStageTimer mapTimer(profiler, ProfileStage::Map);
+                    mapper.Update(now);
+                }
+            }
+
+            // Inline polling: forward the new state to the virtual controller after mapping
+            if (!pollThreadEnabled && padConnected && virtualControllerAvailable && controller.HasStateChanged())
+            {
+                ScopedStageTimer forwardTimer(profiler, ProfileStage::VirtualController);
+                virtualController.Update(controller.GetState());
+            }
+        }
+
+        // Wait for the next deadline (sleep, then spin the last stretch)
+        uint64_t lateness = scheduler.WaitForNextFrame();
+
+        if (statsEnabled)
+        {
+            profiler.Record(ProfileStage::FrameLateness, lateness);
+
+            // Periodic dump; the print itself lands in the next frame's lateness, not its work
+            if (statsIntervalNs > 0 && clock.NowNanoseconds() >= nextStatsDump)
+            {
+                profiler.Print(std::cout, scheduler.GetMissedDeadlineCount());
+                nextStatsDump += statsIntervalNs;
+            }
+        }
+    }
+
+    forwarding.store(false);
+    if (forwarder.joinable())
     {
-        // Calculate frame time for consistent loop timing
-        DWORD currentTime = GetTickCount();
-        DWORD elapsed = currentTime - lastTime;
+        forwarder.join();
+    }
+    poller.Stop();
+    deviceWatcher.Stop();
+    profileReloader.Stop();
 
-        // Update controller state
-        if (!controller.Update())
+    if (recording)
+    {
+        recorder.Close();
+        std::cout << "Trace: " << recorder.GetWrittenCount() << " records written to " << recordPath;
+        if (recorder.GetDroppedCount() > 0)
+        {
+            std::cout << ", " << recorder.GetDroppedCount() << " dropped";
+        }
+        if (recorder.HasWriteError())
         {
-            std::cout << "Controller disconnected. Exiting..." << std::endl;
-            break;
+            std::cout << " (write error, trace is incomplete)";
         }
+        std::cout << std::endl;
+    }
 
-        // Process mappings
-        mapper.Update();
+    if (pollThreadEnabled && snapshotReader.GetLostCount() > 0)
+    {
+        std::cout << "WARNING: mapping fell behind the poll thread, " << snapshotReader.GetLostCount()
+                  << " snapshots skipped" << std::endl;
+    }
 
-        // Sleep to maintain ~200 Hz update rate
-        if (elapsed < frameTimeMs)
+    std::cout << "Frames: " << mapper.GetFrameCount()
+              << ", unchanged (fast path): " << mapper.GetSkippedFrameCount() << std::endl;
+
+    // Cleanup - make sure nothing stays held in the game
+    mapper.ReleaseAllOutputs();
+    bool outputStopped = asyncOutput.Stop();
+
+    if (asyncOutputEnabled)
+    {
+        std::cout << "Output thread: " << asyncOutput.GetDeliveredEventCount() << " events, "
+                  << asyncOutput.GetCoalescedMoveCount() << " mouse moves coalesced, "
+                  << asyncOutput.GetOverflowedEventCount() << " edges deferred, "
+                  << asyncOutput.GetShortWriteCount() << " short writes resent, "
+                  << asyncOutput.GetDiscardedEventCount() << " discarded at exit" << std::endl;
+        if (!outputStopped)
         {
-            Sleep(frameTimeMs - elapsed);
+            std::cout << "WARNING: the target window did not answer, output thread abandoned" << std::endl;
         }
+    }
 
-        lastTime = GetTickCount();
+    const InjectionStrategySelector& injection = keyboardMouse.GetInjectionSelector();
+    std::cout << "Key injection method: " << InjectionStrategySelector::GetMethodName(injection.GetSelectedMethod())
+              << " (" << injection.GetProbeCount() << " probes)" << std::endl;
+    for (int i = 0; i < static_cast<int>(InjectionMethod::Count); ++i)
+    {
+        InjectionMethod method = static_cast<InjectionMethod>(i);
+        const InjectionMethodStats& stats = injection.GetStats(method);
+        if (stats.attempts == 0)
+        {
+            continue;
+        }
+        std::cout << "  " << InjectionStrategySelector::GetMethodName(method)
+                  << ": " << stats.successes << " ok, " << stats.failures << " failed, avg "
+                  << (stats.totalLatencyNs / stats.attempts / 1000) << " us, max "
+                  << (stats.maxLatencyNs / 1000) << " us" << std::endl;
+    }
 
-        // Exit on controller disconnect (handled above)
-        // User can exit with Ctrl+C in console
+    if (statsEnabled)
+    {
+        profiler.Print(std::cout, scheduler.GetMissedDeadlineCount());
     }
 
-    // Cleanup
     virtualController.Shutdown();
 
     std::cout << "Exiting..." << std::endl;